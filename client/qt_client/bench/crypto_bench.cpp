@@ -0,0 +1,330 @@
+// Crypto primitive benchmarks (Google Benchmark): AES-256-CTR, SHA-256 and base64 swept
+// over payload sizes; Ed25519, ML-DSA-87 and X25519 per operation; KeyBundle generation
+// and the login KDF. The per-request primitives also run across thread counts.
+//
+//   cmake -DQT_CLIENT_BUILD_BENCHMARKS=ON ... && ./crypto_bench [--max_bytes=N] [benchmark flags]
+//
+// Sizes go from 32 B to 1 GiB by default; --max_bytes lowers the ceiling (the 1 GiB
+// cases need ~3 GiB of memory). For comparing commits, write JSON and diff it with
+// Google Benchmark's tools/compare.py:
+//
+//   ./crypto_bench --benchmark_out=crypto.json --benchmark_out_format=json
+//   compare.py benchmarks before.json crypto.json
+
+#include "../src/utils/crypto/symmetric.h"
+#include "../src/utils/crypto/hash.h"
+#include "../src/utils/crypto/signer_ed.h"
+#include "../src/utils/crypto/signer_dilithium.h"
+#include "../src/utils/crypto/kem_ecdh.h"
+#include "../src/utils/crypto/keybundle.h"
+#include "../src/utils/crypto/FileClientData.h"
+#include "../src/utils/clientstore.h"
+
+#include <benchmark/benchmark.h>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int64_t kMinBytes    = 32;
+constexpr int64_t kMaxBytes    = int64_t(1) << 30;
+constexpr int     kSizeStep    = 32;            // 32 B, 1 KiB, 32 KiB, 1 MiB, 32 MiB, 1 GiB
+constexpr int64_t kThreadBytes = 64 * 1024;     // payload for the thread sweeps
+
+// Roughly what gets signed per upload: "username|sha256hex|sha256hex"
+constexpr size_t  kSignedBytes = 150;
+
+std::vector<uint8_t> payload(size_t n)
+{
+    std::vector<uint8_t> data(n);
+    for (size_t i = 0; i < n; ++i)
+        data[i] = static_cast<uint8_t>(i * 131 + 7);
+    return data;
+}
+
+const std::vector<uint8_t>& key32()
+{
+    static const std::vector<uint8_t> key = payload(32);
+    return key;
+}
+
+void setBytes(benchmark::State& state)
+{
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+// ── Symmetric ──────────────────────────────────────────────────────────────────────
+
+void BM_AesCtrEncrypt(benchmark::State& state)
+{
+    const auto plain = payload(state.range(0));
+    for (auto _ : state) {
+        auto r = Symmetric::encrypt(plain, key32());
+        benchmark::DoNotOptimize(r);
+    }
+    setBytes(state);
+}
+
+void BM_AesCtrDecrypt(benchmark::State& state)
+{
+    const auto enc = Symmetric::encrypt(payload(state.range(0)), key32());
+    for (auto _ : state) {
+        auto r = Symmetric::decrypt(enc.data, key32(), enc.iv);
+        benchmark::DoNotOptimize(r);
+    }
+    setBytes(state);
+}
+
+// The listing hot path: decrypt into a caller-owned buffer, no allocation
+void BM_AesCtrDecryptInto(benchmark::State& state)
+{
+    const auto enc = Symmetric::encrypt(payload(state.range(0)), key32());
+    std::vector<uint8_t> out(enc.data.size());
+    for (auto _ : state) {
+        Symmetric::decryptInto(enc.data.data(), enc.data.size(), key32().data(), enc.iv.data(), out.data());
+        benchmark::ClobberMemory();
+    }
+    setBytes(state);
+}
+
+// ── Hash / encoding ────────────────────────────────────────────────────────────────
+
+void BM_Sha256(benchmark::State& state)
+{
+    const auto data = payload(state.range(0));
+    for (auto _ : state) {
+        auto r = Hash::sha256(data);
+        benchmark::DoNotOptimize(r);
+    }
+    setBytes(state);
+}
+
+void BM_Base64Encode(benchmark::State& state)
+{
+    const auto data = payload(state.range(0));
+    for (auto _ : state) {
+        auto r = FileClientData::base64_encode(data.data(), data.size());
+        benchmark::DoNotOptimize(r);
+    }
+    setBytes(state);
+}
+
+void BM_Base64Decode(benchmark::State& state)
+{
+    const auto data = payload(state.range(0));
+    const std::string b64 = FileClientData::base64_encode(data.data(), data.size());
+    for (auto _ : state) {
+        auto r = FileClientData::base64_decode(b64);
+        benchmark::DoNotOptimize(r);
+    }
+    setBytes(state);
+}
+
+// ── Signatures ─────────────────────────────────────────────────────────────────────
+
+void BM_Ed25519Keygen(benchmark::State& state)
+{
+    for (auto _ : state) {
+        Signer_Ed signer;
+        signer.keygen();
+        auto sk = signer.getSecretKeyBuffer();
+        benchmark::DoNotOptimize(sk);
+    }
+}
+
+void BM_Ed25519Sign(benchmark::State& state)
+{
+    Signer_Ed signer;
+    signer.keygen();
+    const auto msg = payload(kSignedBytes);
+    for (auto _ : state) {
+        auto r = signer.sign(msg);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_Ed25519Verify(benchmark::State& state)
+{
+    Signer_Ed signer;
+    signer.keygen();
+    const auto msg = payload(kSignedBytes);
+    const auto sig = signer.sign(msg);
+    for (auto _ : state) {
+        auto r = signer.verify(msg, sig);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_DilithiumKeygen(benchmark::State& state)
+{
+    for (auto _ : state) {
+        Signer_Dilithium signer;
+        signer.keygen();
+        auto sk = signer.getSecretKeyBuffer();
+        benchmark::DoNotOptimize(sk);
+    }
+}
+
+void BM_DilithiumSign(benchmark::State& state)
+{
+    Signer_Dilithium signer;
+    signer.keygen();
+    const auto msg = payload(kSignedBytes);
+    for (auto _ : state) {
+        auto r = signer.sign(msg);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_DilithiumVerify(benchmark::State& state)
+{
+    Signer_Dilithium signer;
+    signer.keygen();
+    const auto msg = payload(kSignedBytes);
+    const auto sig = signer.sign(msg);
+    for (auto _ : state) {
+        auto r = signer.verify(msg, sig);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+// ── Key agreement / bundles / KDF ──────────────────────────────────────────────────
+
+void BM_X25519Keygen(benchmark::State& state)
+{
+    for (auto _ : state) {
+        Kem_Ecdh kem;
+        kem.keygen();
+        auto r = kem.pub();
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_X25519Encap(benchmark::State& state)
+{
+    Kem_Ecdh recipient;
+    recipient.keygen();
+    const auto peerPk = recipient.pub();
+    Kem_Ecdh sender;
+    for (auto _ : state) {
+        auto r = sender.encap(peerPk);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_X25519Decap(benchmark::State& state)
+{
+    Kem_Ecdh recipient;
+    recipient.keygen();
+    const Encaps enc = Kem_Ecdh().encap(recipient.pub());
+    for (auto _ : state) {
+        auto r = recipient.decap(enc.ciphertext);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_KeyBundleGenerate(benchmark::State& state)
+{
+    for (auto _ : state) {
+        auto r = KeyBundle();
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+void BM_DerivePasswordKey(benchmark::State& state)
+{
+    const std::vector<uint8_t> salt = payload(crypto_pwhash_SALTBYTES);
+    std::vector<uint8_t> key;
+    for (auto _ : state) {
+        auto r = ClientStore::derivePasswordKey("correct horse battery staple", salt, key);
+        benchmark::DoNotOptimize(r);
+    }
+}
+
+// ── Registration ───────────────────────────────────────────────────────────────────
+
+using Fn = void (*)(benchmark::State&);
+
+void sizeSweep(const char* name, Fn fn, int64_t maxBytes)
+{
+    benchmark::RegisterBenchmark(name, fn)
+        ->RangeMultiplier(kSizeStep)
+        ->Range(kMinBytes, maxBytes)
+        ->Unit(benchmark::kMicrosecond)
+        ->UseRealTime();
+}
+
+void threadSweep(const std::string& name, Fn fn, int64_t bytes = 0)
+{
+    auto* b = benchmark::RegisterBenchmark(name.c_str(), fn)
+                  ->ThreadRange(1, std::max(1u, std::thread::hardware_concurrency()))
+                  ->Unit(benchmark::kMicrosecond)
+                  ->UseRealTime();
+    if (bytes)
+        b->Arg(bytes);
+}
+
+void registerAll(int64_t maxBytes)
+{
+    sizeSweep("aes_ctr/encrypt", BM_AesCtrEncrypt, maxBytes);
+    sizeSweep("aes_ctr/decrypt", BM_AesCtrDecrypt, maxBytes);
+    sizeSweep("aes_ctr/decrypt_into", BM_AesCtrDecryptInto, maxBytes);
+    sizeSweep("sha256", BM_Sha256, maxBytes);
+    sizeSweep("base64/encode", BM_Base64Encode, maxBytes);
+    sizeSweep("base64/decode", BM_Base64Decode, maxBytes);
+
+    // everything an upload/download/share does per request, under concurrency
+    threadSweep("aes_ctr/encrypt/threads", BM_AesCtrEncrypt, kThreadBytes);
+    threadSweep("sha256/threads", BM_Sha256, kThreadBytes);
+    threadSweep("ed25519/sign", BM_Ed25519Sign);
+    threadSweep("ed25519/verify", BM_Ed25519Verify);
+    threadSweep("mldsa87/sign", BM_DilithiumSign);
+    threadSweep("mldsa87/verify", BM_DilithiumVerify);
+    threadSweep("x25519/encap", BM_X25519Encap);
+    threadSweep("x25519/decap", BM_X25519Decap);
+
+    benchmark::RegisterBenchmark("ed25519/keygen", BM_Ed25519Keygen)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("mldsa87/keygen", BM_DilithiumKeygen)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("x25519/keygen", BM_X25519Keygen)->Unit(benchmark::kMicrosecond);
+    benchmark::RegisterBenchmark("keybundle/generate", BM_KeyBundleGenerate)->Unit(benchmark::kMillisecond);
+    // Argon2id at MODERATE limits is ~0.5 s and 256 MiB per call; a few iterations suffice
+    benchmark::RegisterBenchmark("argon2id/derive_password_key", BM_DerivePasswordKey)
+        ->Unit(benchmark::kMillisecond)
+        ->Iterations(3);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    // our one flag; everything else is Google Benchmark's
+    int64_t maxBytes = kMaxBytes;
+    int kept = 1;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strncmp(argv[i], "--max_bytes=", 12) == 0)
+            maxBytes = std::clamp<int64_t>(std::strtoll(argv[i] + 12, nullptr, 10), kMinBytes, kMaxBytes);
+        else
+            argv[kept++] = argv[i];
+    }
+    argc = kept;
+
+    // ClientStore logs every KDF call
+    QLoggingCategory::setFilterRules("*.debug=false");
+
+    if (sodium_init() < 0)
+        return 1;
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv))
+        return 1;
+    registerAll(maxBytes);
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,173 @@
+// Listing decode benchmark: the per-entry metadata pipeline as it was (std::vector at
+// every step plus a json DOM) against ListingDecoder drawing from a PageArena that is
+// reset once per page, for both legacy JSON and binary metadata records. Counts global
+// heap allocations with a replaced operator new.
+//
+//   cmake -DQT_CLIENT_BUILD_BENCHMARKS=ON ... && ./listing_bench [pages] [entries-per-page]
+
+#include "../src/utils/listingdecoder.h"
+#include "../src/utils/metadatarecord.h"
+#include "../src/utils/pagearena.h"
+#include "../src/utils/crypto/symmetric.h"
+#include "../src/utils/crypto/FileClientData.h"
+
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+using json = nlohmann::json;
+
+static std::atomic<size_t> g_allocations{0};
+
+void* operator new(std::size_t n)
+{
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Entry {
+    std::string             metadataB64;
+    std::vector<uint8_t>    iv;
+};
+
+struct Result {
+    size_t      allocations = 0;
+    double      nsPerEntry  = 0;
+    uint64_t    checksum    = 0;    // keeps the optimizer honest
+};
+
+std::vector<Entry> makePage(int page, int perPage, const std::vector<uint8_t>& mek, bool binary)
+{
+    std::vector<Entry> entries;
+    for (int i = 0; i < perPage; ++i) {
+        std::string name = "quarterly report " + std::to_string(page * perPage + i) + " (final).pdf";
+        uint64_t size = 1024ULL * (i + 1);
+
+        std::vector<uint8_t> plain;
+        if (binary) {
+            plain = MetadataRecord::encode(name, size);
+        } else {
+            std::string text = json{ { "filename", name }, { "filesize", size } }.dump();
+            plain.assign(text.begin(), text.end());
+        }
+        Symmetric::Ciphertext ct = Symmetric::encrypt(plain, mek);
+        entries.push_back({ FileClientData::base64_encode(ct.data.data(), ct.data.size()), ct.iv });
+    }
+    return entries;
+}
+
+// What parseAndDecryptSingle did before the arena: copy, copy, copy, DOM
+uint64_t decodeBaseline(const Entry& e, const std::vector<uint8_t>& mek)
+{
+    std::vector<uint8_t> finalMEK(32);
+    std::vector<uint8_t> ivMeta(16);
+    finalMEK = { mek.begin(), mek.end() };
+    ivMeta   = { e.iv.begin(), e.iv.end() };
+
+    std::vector<uint8_t> metaCipherBytes = FileClientData::base64_decode(e.metadataB64);
+    Symmetric::Ciphertext ctext;
+    ctext.data = metaCipherBytes;
+    ctext.iv   = ivMeta;
+    Symmetric::Plaintext ptxt = Symmetric::decrypt(ctext.data, finalMEK, ctext.iv);
+
+    std::string metaJsonStr(reinterpret_cast<char*>(ptxt.data.data()), ptxt.data.size());
+    json metaJson = json::parse(metaJsonStr);
+    std::string name = metaJson.at("filename").get<std::string>();
+    return name.size() + metaJson.at("filesize").get<uint64_t>();
+}
+
+double meanB64Length(const std::vector<std::vector<Entry>>& pages)
+{
+    size_t total = 0, n = 0;
+    for (const auto& page : pages)
+        for (const auto& e : page) {
+            total += e.metadataB64.size();
+            ++n;
+        }
+    return static_cast<double>(total) / n;
+}
+
+template <class Fn>
+Result run(const std::vector<std::vector<Entry>>& pages, Fn&& decodePage)
+{
+    Result r;
+    size_t entries = 0;
+    size_t before = g_allocations.load();
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& page : pages) {
+        r.checksum += decodePage(page);
+        entries += page.size();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    r.allocations = g_allocations.load() - before;
+    r.nsPerEntry = std::chrono::duration<double, std::nano>(elapsed).count() / entries;
+    return r;
+}
+
+}
+
+int main(int argc, char** argv)
+{
+    const int pages   = argc > 1 ? std::atoi(argv[1]) : 200;
+    const int perPage = argc > 2 ? std::atoi(argv[2]) : 50;
+
+    std::vector<uint8_t> mek(32, 0x42);
+    std::vector<std::vector<Entry>> jsonListing, binaryListing;
+    for (int p = 0; p < pages; ++p) {
+        jsonListing.push_back(makePage(p, perPage, mek, false));
+        binaryListing.push_back(makePage(p, perPage, mek, true));
+    }
+
+    Result baseline = run(jsonListing, [&](const std::vector<Entry>& page) {
+        uint64_t sum = 0;
+        for (const auto& e : page)
+            sum += decodeBaseline(e, mek);
+        return sum;
+    });
+
+    PageArena arena;
+    auto decodePage = [&](const std::vector<Entry>& page) {
+        uint64_t sum = 0;
+        for (const auto& e : page) {
+            auto meta = ListingDecoder::decodeMetadata(e.metadataB64, mek.data(), e.iv.data(),
+                                                       arena.resource());
+            sum += meta.filename.size() + meta.size_bytes;
+        }
+        arena.reset();
+        return sum;
+    };
+    Result jsonArena   = run(jsonListing, decodePage);
+    Result binaryArena = run(binaryListing, decodePage);
+
+    if (baseline.checksum != jsonArena.checksum || baseline.checksum != binaryArena.checksum) {
+        std::fprintf(stderr, "decoders disagree: %llu / %llu / %llu\n",
+                     static_cast<unsigned long long>(baseline.checksum),
+                     static_cast<unsigned long long>(jsonArena.checksum),
+                     static_cast<unsigned long long>(binaryArena.checksum));
+        return 1;
+    }
+
+    const double entries = static_cast<double>(pages) * perPage;
+    auto row = [entries](const char* name, const Result& r, double b64) {
+        std::printf("%-14s %12zu %14.2f %12.0f %14.1f\n", name,
+                    r.allocations, r.allocations / entries, r.nsPerEntry, b64);
+    };
+    std::printf("%d pages x %d entries\n", pages, perPage);
+    std::printf("%-14s %12s %14s %12s %14s\n", "pipeline", "allocs", "allocs/entry", "ns/entry", "metadata b64");
+    row("json dom",     baseline,    meanB64Length(jsonListing));
+    row("json arena",   jsonArena,   meanB64Length(jsonListing));
+    row("binary arena", binaryArena, meanB64Length(binaryListing));
+    std::printf("arena spilled to the heap %zu times\n", arena.upstreamAllocations());
+    return 0;
+}
@@ -0,0 +1,669 @@
+// Multi-user load generator for sizing the server. Registers N throwaway users, then
+// runs a weighted mix of list / upload / download / share / delete as those users,
+// either closed-loop (a fixed number of operations in flight) or open-loop (a target
+// operation rate). Requests are built and signed exactly like the handlers do it
+// (NetworkAuthUtils::makeAuthHeaders, dual-signed uploads, X25519-wrapped shares) and
+// go out on AsyncSslClient, so one process can hold thousands of requests in flight.
+//
+//   ./loadgen --host localhost --port 3000 --ca cacert.pem --users 50 \
+//             --mix list=50,upload=20,download=20,share=5,delete=5 --rate 200 --duration 60
+//
+//   --host H / --port P / --ca FILE   server and CA bundle (default: src/config.h values)
+//   --users N                         simulated users (default 10)
+//   --prefix NAME                     username prefix (default: lg<unix time>)
+//   --mix op=w,...                    operation weights (default above)
+//   --concurrency C                   closed loop: C operations in flight (default 8)
+//   --rate R                          open loop: R operations/s, replaces --concurrency
+//   --max-in-flight N                 open loop: skip (and count) starts beyond this (1024)
+//   --duration S                      measured seconds (default 30)
+//   --size BYTES                      upload payload, K/M suffixes (default 64K)
+//   --seed-files N                    uploads per user before measuring (default 2)
+//   --json                            one JSON report instead of the tables
+//
+// Per endpoint it reports requests/s, error rate, status codes and a latency
+// histogram; per operation, latency from the scheduled start, so an open-loop run that
+// falls behind shows the queueing instead of hiding it.
+
+#include "../src/config.h"
+#include "../src/utils/coro.h"
+#include "../src/utils/executor.h"
+#include "../src/utils/metadatarecord.h"
+#include "../src/utils/NetworkAuthUtils.h"
+#include "../src/utils/crypto/FileClientData.h"
+#include "../src/utils/crypto/hash.h"
+#include "../src/utils/crypto/kem_ecdh.h"
+#include "../src/utils/crypto/keybundle.h"
+#include "../src/utils/crypto/signer_dilithium.h"
+#include "../src/utils/crypto/signer_ed.h"
+#include "../src/utils/crypto/symmetric.h"
+#include "../src/utils/networking/asiosslclient.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using json  = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum class Op { List, Upload, Download, Share, Delete };
+constexpr std::array<const char*, 5> kOpNames = { "list", "upload", "download", "share", "delete" };
+
+struct Settings {
+    std::string             host;
+    int                     port = 0;
+    std::string             caBundle;
+    int                     users = 10;
+    std::string             prefix;
+    std::array<int, 5>      mix = { 50, 20, 20, 5, 5 };
+    int                     concurrency = 8;
+    double                  rate = 0;           // > 0: open loop
+    int                     maxInFlight = 1024;
+    int                     durationSec = 30;
+    size_t                  uploadBytes = 64 * 1024;
+    int                     seedFiles = 2;
+    bool                    json = false;
+};
+
+// ── Latency histogram: 8 log buckets per power of two of microseconds, lock-free ────
+
+class LatencyHistogram {
+public:
+    static constexpr int kPerOctave = 8;
+    static constexpr int kBuckets   = 27 * kPerOctave;     // up to 2^27 µs ≈ 134 s
+
+    void record(double micros)
+    {
+        const int i = std::clamp(static_cast<int>(std::log2(std::max(1.0, micros)) * kPerOctave),
+                                 0, kBuckets - 1);
+        m_counts[i].fetch_add(1, std::memory_order_relaxed);
+        ++m_total;
+        double seen = m_maxMicros.load(std::memory_order_relaxed);
+        while (micros > seen && !m_maxMicros.compare_exchange_weak(seen, micros)) {}
+    }
+
+    uint64_t count() const { return m_total.load(); }
+    double maxMs() const { return m_maxMicros.load() / 1000.0; }
+
+    // Upper edge of the bucket holding the p-th percentile
+    double percentileMs(double p) const
+    {
+        const uint64_t total = count();
+        if (total == 0)
+            return 0;
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(p / 100.0 * total)));
+        uint64_t seen = 0;
+        for (int i = 0; i < kBuckets; ++i) {
+            seen += m_counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank)
+                return std::min(upperMicros(i) / 1000.0, maxMs());
+        }
+        return maxMs();
+    }
+
+    // Non-empty buckets as [[upper_ms, count], ...]
+    json buckets() const
+    {
+        json out = json::array();
+        for (int i = 0; i < kBuckets; ++i) {
+            if (uint64_t n = m_counts[i].load(std::memory_order_relaxed))
+                out.push_back({ upperMicros(i) / 1000.0, n });
+        }
+        return out;
+    }
+
+private:
+    static double upperMicros(int i) { return std::exp2(double(i + 1) / kPerOctave); }
+
+    std::array<std::atomic<uint64_t>, kBuckets> m_counts{};
+    std::atomic<uint64_t>                       m_total{0};
+    std::atomic<double>                         m_maxMicros{0};
+};
+
+struct EndpointStats {
+    LatencyHistogram        latency;        // every response, errors included
+    std::atomic<uint64_t>   ok{0};
+    std::atomic<uint64_t>   errors{0};
+    std::atomic<uint64_t>   bytesOut{0};    // request bodies
+    std::atomic<uint64_t>   bytesIn{0};     // response bodies
+    std::mutex              statusMutex;
+    std::map<int, uint64_t> statuses;       // 0/500 from the client itself included
+
+    void record(int status, double micros, size_t sent, size_t received)
+    {
+        latency.record(micros);
+        (status >= 200 && status < 300 ? ok : errors).fetch_add(1, std::memory_order_relaxed);
+        bytesOut += sent;
+        bytesIn += received;
+        std::lock_guard<std::mutex> lock(statusMutex);
+        ++statuses[status];
+    }
+};
+
+struct OpStats {
+    LatencyHistogram        latency;        // from the scheduled start
+    std::atomic<uint64_t>   ok{0};
+    std::atomic<uint64_t>   failed{0};
+};
+
+// ── Simulated users ────────────────────────────────────────────────────────────────
+
+struct VUser {
+    std::string     name;
+    KeyBundle       bundle;         // generated on construction; only the public half is registered
+
+    std::mutex                              mutex;
+    std::vector<std::pair<uint64_t, FileClientData>> files;    // owned, with their keys
+};
+
+struct Run {
+    Settings                                            settings;
+    std::vector<std::unique_ptr<VUser>>                 users;
+    std::map<std::string, std::unique_ptr<EndpointStats>> endpoints;
+    std::array<OpStats, 5>                              ops;
+    std::atomic<bool>                                   measuring{false};
+    Clock::time_point                                   deadline;
+
+    std::atomic<int>                                    inFlight{0};
+    std::atomic<uint64_t>                               skipped{0};     // open loop, over --max-in-flight
+    std::mutex                                          doneMutex;
+    std::condition_variable                             doneCv;
+
+    EndpointStats& endpoint(const std::string& path) { return *endpoints.at(path); }
+
+    void finishOne()
+    {
+        if (--inFlight == 0) {
+            std::lock_guard<std::mutex> lock(doneMutex);
+            doneCv.notify_all();
+        }
+    }
+
+    void waitIdle()
+    {
+        std::unique_lock<std::mutex> lock(doneMutex);
+        doneCv.wait(lock, [this]() { return inFlight.load() == 0; });
+    }
+};
+
+std::mt19937_64& rng()
+{
+    thread_local std::mt19937_64 gen(std::random_device{}());
+    return gen;
+}
+
+size_t pick(size_t n)
+{
+    return std::uniform_int_distribution<size_t>(0, n - 1)(rng());
+}
+
+std::string toHex(const std::vector<uint8_t>& data)
+{
+    static const char* lut = "0123456789abcdef";
+    std::string out;
+    out.reserve(data.size() * 2);
+    for (uint8_t b : data) {
+        out.push_back(lut[b >> 4]);
+        out.push_back(lut[b & 0x0F]);
+    }
+    return out;
+}
+
+std::string b64(const std::vector<uint8_t>& data)
+{
+    return FileClientData::base64_encode(data.data(), data.size());
+}
+
+// ── Requests ───────────────────────────────────────────────────────────────────────
+
+// Signs (on the CPU pool) and sends one request as u, recording it under its path.
+// Resumes on the I/O pool. Statistics are only kept once the measured window starts.
+Coro::Task<HttpResponse> send(Run* run, VUser* u, std::string path, std::string body)
+{
+    co_await Coro::resumeOnCpu();
+    auto headers = NetworkAuthUtils::makeAuthHeaders(u->name, u->bundle, "POST", path, body);
+    const size_t sent = body.size();
+    HttpRequest req(HttpRequest::Method::POST, path, std::move(body), headers);
+
+    const Clock::time_point t0 = Clock::now();
+    HttpResponse resp = co_await Coro::request(std::move(req));
+    const double micros = std::chrono::duration<double, std::micro>(Clock::now() - t0).count();
+    if (run->measuring)
+        run->endpoint(path).record(resp.statusCode, micros, sent, resp.body.size());
+    co_return resp;
+}
+
+Coro::Task<bool> doList(Run* run, VUser* u)
+{
+    const std::string body = json{ { "page", 1 } }.dump();
+    HttpResponse resp = co_await send(run, u, "/api/fs/list", body);
+    co_return resp.statusCode == 200;
+}
+
+// Same payload shape and signature input as FileUploadHandler::prepareUpload
+Coro::Task<bool> doUpload(Run* run, VUser* u)
+{
+    co_await Coro::resumeOnCpu();
+    std::vector<uint8_t> plaintext(run->settings.uploadBytes);
+    randombytes_buf(plaintext.data(), plaintext.size());
+
+    FileClientData fcd(true);
+    fcd.filename = "loadgen_" + std::to_string(rng()()) + ".bin";
+    Symmetric::Ciphertext encFile = Symmetric::encrypt(plaintext, { fcd.fek.begin(), fcd.fek.end() });
+    std::copy(encFile.iv.begin(), encFile.iv.end(), fcd.file_nonce.begin());
+    Symmetric::Ciphertext encMeta = Symmetric::encrypt(
+        MetadataRecord::encode(fcd.filename, plaintext.size()), { fcd.mek.begin(), fcd.mek.end() });
+    std::copy(encMeta.iv.begin(), encMeta.iv.end(), fcd.metadata_nonce.begin());
+
+    const std::string sigInput = u->name + "|" + toHex(Hash::sha256(encFile.data))
+                               + "|" + toHex(Hash::sha256(encMeta.data));
+    const std::vector<uint8_t> msg(sigInput.begin(), sigInput.end());
+
+    const std::vector<uint8_t> edPriv = FileClientData::base64_decode(u->bundle.getEd25519PrivateKeyBase64());
+    Signer_Ed ed;
+    ed.loadPrivateKey(edPriv.data(), edPriv.size());
+    const std::vector<uint8_t> pqPriv = FileClientData::base64_decode(u->bundle.getDilithiumPrivateKeyBase64());
+    Signer_Dilithium pq;
+    pq.loadPrivateKey(pqPriv.data(), pqPriv.size());
+
+    nlohmann::ordered_json body;
+    body["file_content"]           = b64(encFile.data);
+    body["metadata"]               = b64(encMeta.data);
+    body["pre_quantum_signature"]  = b64(ed.sign(msg));
+    body["post_quantum_signature"] = b64(pq.sign(msg));
+
+    HttpResponse resp = co_await send(run, u, "/api/fs/upload", body.dump());
+    if (resp.statusCode != 201)
+        co_return false;
+    const uint64_t fileId = json::parse(resp.body).at("file_id").get<uint64_t>();
+    std::lock_guard<std::mutex> lock(u->mutex);
+    u->files.emplace_back(fileId, std::move(fcd));
+    co_return true;
+}
+
+std::optional<std::pair<uint64_t, FileClientData>> anyFile(VUser* u, bool take)
+{
+    std::lock_guard<std::mutex> lock(u->mutex);
+    // keep one file back for download/share to work on
+    if (u->files.empty() || (take && u->files.size() < 2))
+        return std::nullopt;
+    const size_t i = pick(u->files.size());
+    auto file = u->files[i];
+    if (take) {
+        std::swap(u->files[i], u->files.back());
+        u->files.pop_back();
+    }
+    return file;
+}
+
+Coro::Task<bool> doDownload(Run* run, VUser* u, uint64_t fileId)
+{
+    const std::string body = json{ { "file_id", fileId } }.dump();
+    HttpResponse resp = co_await send(run, u, "/api/fs/download", body);
+    co_return resp.statusCode == 200;
+}
+
+// getbundle + the same X25519 key wrap as FileShareHandler::processShare + share
+Coro::Task<bool> doShare(Run* run, VUser* u, uint64_t fileId, FileClientData fcd, VUser* target)
+{
+    const std::string bundleReq = json{ { "username", target->name } }.dump();
+    HttpResponse bundleResp = co_await send(run, u, "/api/keyhandler/getbundle", bundleReq);
+    if (bundleResp.statusCode != 200)
+        co_return false;
+    co_await Coro::resumeOnCpu();
+    const KeyBundle targetPub = KeyBundle::fromJson(json::parse(bundleResp.body).at("key_bundle").dump());
+
+    Kem_Ecdh eph;
+    eph.keygen();
+    std::vector<uint8_t> shared(crypto_scalarmult_BYTES);
+    if (crypto_scalarmult(shared.data(), eph.getSecretKey().data(), targetPub.getX25519Pub().data()) != 0)
+        co_return false;
+    const std::vector<uint8_t> aesKey = Hash::sha256(shared);
+    const Symmetric::Ciphertext fek = Symmetric::encrypt({ fcd.fek.begin(), fcd.fek.end() }, aesKey);
+    const Symmetric::Ciphertext mek = Symmetric::encrypt({ fcd.mek.begin(), fcd.mek.end() }, aesKey);
+
+    nlohmann::ordered_json body;
+    body["file_id"]               = fileId;
+    body["shared_with_username"]  = target->name;
+    body["encrypted_fek"]         = b64(fek.data);
+    body["encrypted_fek_nonce"]   = b64(fek.iv);
+    body["encrypted_mek"]         = b64(mek.data);
+    body["encrypted_mek_nonce"]   = b64(mek.iv);
+    body["ephemeral_public_key"]  = b64(eph.pub());
+    body["file_content_nonce"]    = FileClientData::base64_encode(fcd.file_nonce.data(), fcd.file_nonce.size());
+    body["metadata_nonce"]        = FileClientData::base64_encode(fcd.metadata_nonce.data(), fcd.metadata_nonce.size());
+
+    HttpResponse resp = co_await send(run, u, "/api/fs/share", body.dump());
+    // sharing the same file with the same user twice is a 4xx; still a served request
+    co_return resp.statusCode == 201 || resp.statusCode == 409;
+}
+
+Coro::Task<bool> doDelete(Run* run, VUser* u, uint64_t fileId)
+{
+    const std::string body = json{ { "file_id", fileId } }.dump();
+    HttpResponse resp = co_await send(run, u, "/api/fs/delete", body);
+    co_return resp.statusCode == 200;
+}
+
+Op pickOp(const std::array<int, 5>& mix)
+{
+    std::discrete_distribution<int> dist(mix.begin(), mix.end());
+    return static_cast<Op>(dist(rng()));
+}
+
+// One weighted operation as a random user. An operation that needs a file the user does
+// not have (yet) turns into an upload, so the mix keeps its request rate.
+Coro::Task<void> runOp(Run* run, Clock::time_point scheduled)
+{
+    VUser* u = run->users[pick(run->users.size())].get();
+    Op op = pickOp(run->settings.mix);
+    bool ok = false;
+    try {
+        if (op == Op::Download || op == Op::Share || op == Op::Delete) {
+            auto file = anyFile(u, op == Op::Delete);
+            if (!file)
+                op = Op::Upload;
+            else if (op == Op::Download)
+                ok = co_await doDownload(run, u, file->first);
+            else if (op == Op::Delete)
+                ok = co_await doDelete(run, u, file->first);
+            else if (run->users.size() > 1) {
+                VUser* target = u;
+                while (target == u)
+                    target = run->users[pick(run->users.size())].get();
+                ok = co_await doShare(run, u, file->first, file->second, target);
+            } else {
+                op = Op::Download;
+                ok = co_await doDownload(run, u, file->first);
+            }
+        }
+        if (op == Op::List)
+            ok = co_await doList(run, u);
+        else if (op == Op::Upload)
+            ok = co_await doUpload(run, u);
+    } catch (const std::exception& ex) {
+        qWarning() << "[LoadGen]" << kOpNames[size_t(op)] << "threw:" << ex.what();
+    }
+
+    if (run->measuring) {
+        OpStats& s = run->ops[size_t(op)];
+        (ok ? s.ok : s.failed).fetch_add(1, std::memory_order_relaxed);
+        s.latency.record(std::chrono::duration<double, std::micro>(Clock::now() - scheduled).count());
+    }
+}
+
+// Closed loop: one of C workers, each running operations back to back
+Coro::Task<void> worker(Run* run)
+{
+    co_await Coro::resumeOnIo();
+    while (Clock::now() < run->deadline)
+        co_await runOp(run, Clock::now());
+    run->finishOne();
+}
+
+// Open loop: each scheduled operation is its own flow
+Coro::Task<void> scheduled(Run* run, Clock::time_point at)
+{
+    co_await Coro::resumeOnIo();
+    co_await runOp(run, at);
+    run->finishOne();
+}
+
+// ── Setup ──────────────────────────────────────────────────────────────────────────
+
+Coro::Task<void> registerUser(Run* run, VUser* u, std::atomic<int>* failures)
+{
+    co_await Coro::resumeOnCpu();
+    json body = { { "username", u->name }, { "key_bundle", u->bundle.toJsonPublic() } };
+    HttpRequest req(HttpRequest::Method::POST, "/api/keyhandler/register", body.dump(),
+                    { { "Content-Type", "application/json" } });
+    HttpResponse resp = co_await Coro::request(std::move(req));
+    if (resp.statusCode != 201) {
+        qWarning() << "[LoadGen] register" << QString::fromStdString(u->name) << "→" << resp.statusCode
+                   << QString::fromStdString(resp.body);
+        ++*failures;
+    } else {
+        for (int i = 0; i < run->settings.seedFiles; ++i) {
+            if (!co_await doUpload(run, u))
+                ++*failures;
+        }
+    }
+    run->finishOne();
+}
+
+// ── Report ─────────────────────────────────────────────────────────────────────────
+
+json histogramJson(const LatencyHistogram& h)
+{
+    return { { "p50_ms", h.percentileMs(50) }, { "p90_ms", h.percentileMs(90) },
+             { "p99_ms", h.percentileMs(99) }, { "p999_ms", h.percentileMs(99.9) },
+             { "max_ms", h.maxMs() }, { "buckets", h.buckets() } };
+}
+
+void report(Run& run, double seconds)
+{
+    json endpoints = json::object();
+    for (auto& [path, s] : run.endpoints) {
+        const uint64_t total = s->ok + s->errors;
+        if (total == 0)
+            continue;
+        json statuses = json::object();
+        {
+            std::lock_guard<std::mutex> lock(s->statusMutex);
+            for (const auto& [code, n] : s->statuses)
+                statuses[std::to_string(code)] = n;
+        }
+        endpoints[path] = { { "requests", total }, { "requests_per_s", total / seconds },
+                            { "errors", s->errors.load() }, { "error_rate", double(s->errors) / total },
+                            { "statuses", statuses }, { "mb_out", s->bytesOut / 1048576.0 },
+                            { "mb_in", s->bytesIn / 1048576.0 }, { "latency", histogramJson(s->latency) } };
+    }
+    json ops = json::object();
+    for (size_t i = 0; i < run.ops.size(); ++i) {
+        const OpStats& s = run.ops[i];
+        const uint64_t total = s.ok + s.failed;
+        if (total == 0)
+            continue;
+        ops[kOpNames[i]] = { { "ops", total }, { "ops_per_s", total / seconds },
+                             { "failed", s.failed.load() }, { "latency", histogramJson(s.latency) } };
+    }
+
+    if (run.settings.json) {
+        json out = { { "seconds", seconds }, { "users", run.users.size() },
+                     { "mode", run.settings.rate > 0 ? "rate" : "concurrency" },
+                     { "target", run.settings.rate > 0 ? run.settings.rate : double(run.settings.concurrency) },
+                     { "skipped", run.skipped.load() }, { "endpoints", endpoints }, { "ops", ops } };
+        std::printf("%s\n", out.dump(2).c_str());
+        return;
+    }
+
+    std::printf("\n%-28s %8s %8s %7s %8s %8s %8s %8s %8s\n",
+                "endpoint", "reqs", "req/s", "err%", "p50 ms", "p90 ms", "p99 ms", "p99.9", "max ms");
+    for (auto& [path, e] : endpoints.items()) {
+        const json& l = e["latency"];
+        std::printf("%-28s %8llu %8.1f %7.2f %8.1f %8.1f %8.1f %8.1f %8.1f\n", path.c_str(),
+                    e["requests"].get<unsigned long long>(), e["requests_per_s"].get<double>(),
+                    100 * e["error_rate"].get<double>(), l["p50_ms"].get<double>(), l["p90_ms"].get<double>(),
+                    l["p99_ms"].get<double>(), l["p999_ms"].get<double>(), l["max_ms"].get<double>());
+        std::string codes;
+        for (auto& [code, n] : e["statuses"].items())
+            codes += " " + code + "×" + std::to_string(n.get<uint64_t>());
+        std::printf("%-28s status:%s\n", "", codes.c_str());
+    }
+    std::printf("\n%-28s %8s %8s %7s %8s %8s %8s %8s %8s\n",
+                "operation", "ops", "ops/s", "fail", "p50 ms", "p90 ms", "p99 ms", "p99.9", "max ms");
+    for (auto& [name, o] : ops.items()) {
+        const json& l = o["latency"];
+        std::printf("%-28s %8llu %8.1f %7llu %8.1f %8.1f %8.1f %8.1f %8.1f\n", name.c_str(),
+                    o["ops"].get<unsigned long long>(), o["ops_per_s"].get<double>(),
+                    o["failed"].get<unsigned long long>(), l["p50_ms"].get<double>(), l["p90_ms"].get<double>(),
+                    l["p99_ms"].get<double>(), l["p999_ms"].get<double>(), l["max_ms"].get<double>());
+    }
+    if (run.skipped)
+        std::printf("\n%llu scheduled operations skipped: --max-in-flight reached\n",
+                    static_cast<unsigned long long>(run.skipped.load()));
+}
+
+// ── Flags ──────────────────────────────────────────────────────────────────────────
+
+size_t parseBytes(QString text)
+{
+    size_t mult = 1;
+    if (text.endsWith('K', Qt::CaseInsensitive))      mult = 1024;
+    else if (text.endsWith('M', Qt::CaseInsensitive)) mult = 1024 * 1024;
+    if (mult != 1)
+        text.chop(1);
+    return text.toULongLong() * mult;
+}
+
+bool parseMix(const QString& text, std::array<int, 5>& mix)
+{
+    mix.fill(0);
+    for (const QString& part : text.split(',', Qt::SkipEmptyParts)) {
+        const QStringList kv = part.split('=');
+        const auto it = std::find(kOpNames.begin(), kOpNames.end(), kv.value(0).trimmed().toStdString());
+        bool ok = false;
+        const int weight = kv.value(1).toInt(&ok);
+        if (kv.size() != 2 || it == kOpNames.end() || !ok || weight < 0)
+            return false;
+        mix[size_t(it - kOpNames.begin())] = weight;
+    }
+    return std::any_of(mix.begin(), mix.end(), [](int w) { return w > 0; });
+}
+
+bool parseArgs(const QStringList& args, Settings& s)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args[i];
+        const bool hasValue = i + 1 < args.size();
+        const QString v = hasValue ? args[i + 1] : QString();
+        if (!hasValue && a != "--json")
+            return false;
+
+        if (a == "--host")                  s.host = v.toStdString();
+        else if (a == "--port")             s.port = v.toInt();
+        else if (a == "--ca")               s.caBundle = v.toStdString();
+        else if (a == "--users")            s.users = v.toInt();
+        else if (a == "--prefix")           s.prefix = v.toStdString();
+        else if (a == "--mix")              { if (!parseMix(v, s.mix)) return false; }
+        else if (a == "--concurrency")      s.concurrency = v.toInt();
+        else if (a == "--rate")             s.rate = v.toDouble();
+        else if (a == "--max-in-flight")    s.maxInFlight = v.toInt();
+        else if (a == "--duration")         s.durationSec = v.toInt();
+        else if (a == "--size")             s.uploadBytes = parseBytes(v);
+        else if (a == "--seed-files")       s.seedFiles = v.toInt();
+        else if (a == "--json")             { s.json = true; continue; }
+        else return false;
+        ++i;
+    }
+    return s.users > 0 && s.concurrency > 0 && s.rate >= 0 && s.maxInFlight > 0
+        && s.durationSec > 0 && s.uploadBytes > 0 && s.seedFiles >= 0 && s.port > 0;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+
+    Run run;
+    Settings& s = run.settings;
+    auto& cfg = Config::instance();
+    s.host     = cfg.serverHost;
+    s.port     = cfg.serverPort;
+    s.caBundle = cfg.caBundle;
+    s.prefix   = "lg" + std::to_string(QDateTime::currentSecsSinceEpoch());
+    if (!parseArgs(app.arguments(), s)) {
+        std::fprintf(stderr,
+            "usage: loadgen [--host H] [--port P] [--ca FILE] [--users N] [--prefix NAME]\n"
+            "               [--mix list=50,upload=20,download=20,share=5,delete=5]\n"
+            "               [--concurrency C | --rate R [--max-in-flight N]] [--duration S]\n"
+            "               [--size BYTES] [--seed-files N] [--json]\n");
+        return 2;
+    }
+
+    // the request path logs every call
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    if (sodium_init() < 0)
+        return 1;
+
+    cfg.serverHost = s.host;
+    cfg.serverPort = s.port;
+    cfg.caBundle   = s.caBundle;
+    AsioSslClient tlsSetup;
+    tlsSetup.init(cfg.caBundle);
+
+    for (const char* path : { "/api/fs/list", "/api/fs/upload", "/api/fs/download",
+                              "/api/keyhandler/getbundle", "/api/fs/share", "/api/fs/delete" })
+        run.endpoints.emplace(path, std::make_unique<EndpointStats>());
+
+    // register everyone and seed their files (not measured)
+    std::fprintf(stderr, "loadgen: registering %d users as %s_N on %s:%d\n",
+                 s.users, s.prefix.c_str(), s.host.c_str(), s.port);
+    std::atomic<int> setupFailures{0};
+    for (int i = 0; i < s.users; ++i) {
+        run.users.push_back(std::make_unique<VUser>());
+        run.users.back()->name = s.prefix + "_" + std::to_string(i);
+    }
+    run.inFlight = s.users;
+    for (auto& u : run.users)
+        Coro::spawn(registerUser(&run, u.get(), &setupFailures));
+    run.waitIdle();
+    if (setupFailures) {
+        std::fprintf(stderr, "loadgen: %d setup request(s) failed; is the server up and the CA right?\n",
+                     setupFailures.load());
+        return 1;
+    }
+
+    std::fprintf(stderr, "loadgen: %s for %d s\n",
+                 s.rate > 0 ? qPrintable(QString("%1 ops/s").arg(s.rate))
+                            : qPrintable(QString("%1 in flight").arg(s.concurrency)),
+                 s.durationSec);
+    run.measuring = true;
+    const Clock::time_point start = Clock::now();
+    run.deadline = start + std::chrono::seconds(s.durationSec);
+
+    if (s.rate > 0) {
+        // pace starts on this thread; a start that finds the cap reached is counted, not queued
+        run.inFlight = 1;
+        const auto interval = std::chrono::duration<double>(1.0 / s.rate);
+        for (uint64_t n = 0;; ++n) {
+            const Clock::time_point at = start + std::chrono::duration_cast<Clock::duration>(interval * double(n));
+            if (at >= run.deadline)
+                break;
+            std::this_thread::sleep_until(at);
+            if (run.inFlight.load() > s.maxInFlight) {
+                ++run.skipped;
+                continue;
+            }
+            ++run.inFlight;
+            Coro::spawn(scheduled(&run, at));
+        }
+        run.finishOne();
+    } else {
+        run.inFlight = s.concurrency;
+        for (int i = 0; i < s.concurrency; ++i)
+            Coro::spawn(worker(&run));
+    }
+    run.waitIdle();
+    run.measuring = false;
+
+    report(run, std::chrono::duration<double>(Clock::now() - start).count());
+    return 0;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "mockserver.h"
+#include "../src/utils/networking/NetworkClient.h"
+
+/**
+ * LoopbackClient – a NetworkClient that hands requests straight to a MockServer in the
+ * same process: no socket, no TLS, no HTTP text. Install it with
+ * NetworkClient::setTransport() and the handlers' crypto, JSON and ClientStore work is
+ * all that is left to profile.
+ *
+ * The request body is moved into the mock and the reply body moved back, so the only
+ * copies are the ones the handlers and routes make themselves. Requests are served on
+ * the calling thread and `done` runs before sendAsync() returns.
+ *
+ * Host and port are ignored. ChangeSubscriber streams through AsioSslClient directly and
+ * is not routed here.
+ */
+class LoopbackClient : public NetworkClient {
+public:
+    explicit LoopbackClient(MockServer& api);
+
+    void init(const std::string& caCertPath) override;
+
+    using NetworkClient::sendRequest;
+    HttpResponse sendRequest(const std::string& host, int port, const HttpRequest& request,
+                             int timeoutSeconds = DEFAULT_TIMEOUT) override;
+
+    void sendAsync(HttpRequest request, Completion done, int timeoutSeconds = DEFAULT_TIMEOUT) override;
+
+private:
+    MockServer& m_api;
+};
@@ -0,0 +1,545 @@
+#include "mockserver.h"
+#include "../src/utils/NetworkAuthUtils.h"
+#include "../src/utils/crypto/FileClientData.h"
+#include "../src/utils/crypto/hash.h"
+#include "../src/utils/crypto/signer_ed.h"
+#include "../src/utils/crypto/signer_dilithium.h"
+
+#include <boost/beast/core.hpp>
+#include <openssl/evp.h>
+#include <openssl/pem.h>
+#include <openssl/x509v3.h>
+#include <QDateTime>
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+
+namespace asio  = boost::asio;
+namespace ssl   = boost::asio::ssl;
+namespace beast = boost::beast;
+namespace http  = boost::beast::http;
+using tcp  = boost::asio::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+
+constexpr size_t kListPageSize    = 25;     // server/src/api/fs/list PAGE_SIZE
+constexpr size_t kChangesPageSize = 500;    // server/src/api/fs/changes PAGE_SIZE
+constexpr size_t kMaxBodyBytes    = 128 * 1024 * 1024;
+
+std::string toHex(const std::vector<uint8_t>& data)
+{
+    static const char* lut = "0123456789abcdef";
+    std::string out;
+    out.reserve(data.size() * 2);
+    for (uint8_t b : data) {
+        out.push_back(lut[b >> 4]);
+        out.push_back(lut[b & 0x0F]);
+    }
+    return out;
+}
+
+// ── Throwaway PKI: a self-signed CA and a localhost leaf it signs ──────────────────
+
+using KeyPtr  = std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)>;
+using CertPtr = std::unique_ptr<X509, decltype(&X509_free)>;
+
+bool addExtension(X509* cert, X509* issuer, int nid, const char* value)
+{
+    X509V3_CTX ctx;
+    X509V3_set_ctx_nodb(&ctx);
+    X509V3_set_ctx(&ctx, issuer, cert, nullptr, nullptr, 0);
+    X509_EXTENSION* ext = X509V3_EXT_conf_nid(nullptr, &ctx, nid, value);
+    if (!ext)
+        return false;
+    const bool ok = X509_add_ext(cert, ext, -1) == 1;
+    X509_EXTENSION_free(ext);
+    return ok;
+}
+
+CertPtr makeCert(EVP_PKEY* key, const char* commonName, long serial,
+                 X509* issuer, EVP_PKEY* issuerKey, bool isCa)
+{
+    CertPtr cert(X509_new(), &X509_free);
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), serial);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), -3600);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 7L * 24 * 3600);
+    X509_set_pubkey(cert.get(), key);
+
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(commonName), -1, -1, 0);
+    X509* signer = issuer ? issuer : cert.get();
+    X509_set_issuer_name(cert.get(), X509_get_subject_name(signer));
+
+    const bool ok = isCa
+        ? addExtension(cert.get(), signer, NID_basic_constraints, "critical,CA:TRUE")
+            && addExtension(cert.get(), signer, NID_key_usage, "critical,keyCertSign,cRLSign")
+        : addExtension(cert.get(), signer, NID_basic_constraints, "critical,CA:FALSE")
+            && addExtension(cert.get(), signer, NID_subject_alt_name, "DNS:localhost,IP:127.0.0.1")
+            && addExtension(cert.get(), signer, NID_ext_key_usage, "serverAuth");
+    if (!ok || X509_sign(cert.get(), issuerKey ? issuerKey : key, EVP_sha256()) == 0)
+        return CertPtr(nullptr, &X509_free);
+    return cert;
+}
+
+std::string toPem(X509* cert)
+{
+    std::unique_ptr<BIO, decltype(&BIO_free)> bio(BIO_new(BIO_s_mem()), &BIO_free);
+    PEM_write_bio_X509(bio.get(), cert);
+    char* data = nullptr;
+    const long len = BIO_get_mem_data(bio.get(), &data);
+    return std::string(data, static_cast<size_t>(len));
+}
+
+} // namespace
+
+// ── One TLS connection: handshake, then request → response until the client closes ──
+
+class MockServer::Session : public std::enable_shared_from_this<Session> {
+public:
+    Session(MockServer& server, tcp::socket socket)
+        : m_server(server), m_stream(std::move(socket), server.m_ssl) {}
+
+    void run()
+    {
+        m_stream.async_handshake(ssl::stream_base::server,
+            [self = shared_from_this()](const beast::error_code& ec) {
+                if (!ec)
+                    self->read();
+            });
+    }
+
+private:
+    void read()
+    {
+        m_parser.emplace();
+        m_parser->body_limit(kMaxBodyBytes);
+        http::async_read(m_stream, m_buffer, *m_parser,
+            [self = shared_from_this()](const beast::error_code& ec, size_t) {
+                if (ec)
+                    return self->close();
+                self->respond(self->m_parser->release());
+            });
+    }
+
+    void respond(Request req)
+    {
+        auto res = std::make_shared<Response>(m_server.handle(req));
+        http::async_write(m_stream, *res,
+            [self = shared_from_this(), res](const beast::error_code& ec, size_t) {
+                if (ec || res->need_eof())
+                    return self->close();
+                self->read();
+            });
+    }
+
+    void close()
+    {
+        // the client never reuses a connection and does not wait for close_notify
+        beast::error_code ignored;
+        m_stream.lowest_layer().close(ignored);
+    }
+
+    MockServer&                             m_server;
+    ssl::stream<tcp::socket>                m_stream;
+    beast::flat_buffer                      m_buffer;
+    std::optional<http::request_parser<http::string_body>> m_parser;
+};
+
+// ── Lifecycle ──────────────────────────────────────────────────────────────────────
+
+MockServer::MockServer(Options options)
+    : m_options(options), m_ssl(ssl::context::tls_server), m_acceptor(m_io)
+{
+}
+
+MockServer::~MockServer()
+{
+    stop();
+}
+
+bool MockServer::start(std::string& outError)
+{
+    KeyPtr caKey(EVP_EC_gen("P-256"), &EVP_PKEY_free);
+    KeyPtr leafKey(EVP_EC_gen("P-256"), &EVP_PKEY_free);
+    if (!caKey || !leafKey) {
+        outError = "EC key generation failed";
+        return false;
+    }
+    CertPtr ca = makeCert(caKey.get(), "ssshare bench CA", 1, nullptr, nullptr, true);
+    CertPtr leaf = ca ? makeCert(leafKey.get(), "localhost", 2, ca.get(), caKey.get(), false)
+                      : CertPtr(nullptr, &X509_free);
+    if (!leaf) {
+        outError = "certificate generation failed";
+        return false;
+    }
+    m_caPem = toPem(ca.get());
+
+    SSL_CTX* ctx = m_ssl.native_handle();
+    if (SSL_CTX_use_certificate(ctx, leaf.get()) != 1 || SSL_CTX_use_PrivateKey(ctx, leafKey.get()) != 1) {
+        outError = "loading the server certificate failed";
+        return false;
+    }
+
+    beast::error_code ec;
+    const tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), m_options.port);
+    m_acceptor.open(endpoint.protocol(), ec);
+    if (!ec) m_acceptor.set_option(asio::socket_base::reuse_address(true), ec);
+    if (!ec) m_acceptor.bind(endpoint, ec);
+    if (!ec) m_acceptor.listen(asio::socket_base::max_listen_connections, ec);
+    if (ec) {
+        outError = "listen: " + ec.message();
+        return false;
+    }
+    m_port = m_acceptor.local_endpoint().port();
+
+    accept();
+    for (int i = 0; i < std::max(1, m_options.threads); ++i)
+        m_threads.emplace_back([this]() { m_io.run(); });
+    return true;
+}
+
+void MockServer::stop()
+{
+    m_io.stop();
+    for (std::thread& t : m_threads)
+        t.join();
+    m_threads.clear();
+}
+
+void MockServer::accept()
+{
+    m_acceptor.async_accept([this](const beast::error_code& ec, tcp::socket socket) {
+        if (ec)
+            return;
+        std::make_shared<Session>(*this, std::move(socket))->run();
+        accept();
+    });
+}
+
+void MockServer::addUser(const std::string& username, const KeyBundle& publicBundle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_users.insert_or_assign(username, publicBundle);
+}
+
+void MockServer::reset()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_files.clear();
+}
+
+MockServer::Stats MockServer::stats() const
+{
+    return { m_requests.load(), m_rejected.load(), m_bytesIn.load(), m_bytesOut.load() };
+}
+
+HttpResponse MockServer::serve(HttpRequest request)
+{
+    static const http::verb kVerbs[] = { http::verb::get, http::verb::post, http::verb::put, http::verb::delete_ };
+    Request req{ kVerbs[static_cast<int>(request.method())], request.path(), 11 };
+    for (const auto& [name, value] : request.headers())
+        req.set(name, value);
+    req.body() = request.takeBody();
+    req.prepare_payload();
+
+    Response res = handle(req);
+    HttpResponse out;
+    out.statusCode = static_cast<int>(res.result_int());
+    for (const auto& field : res)
+        out.headers.emplace(std::string(field.name_string()), std::string(field.value()));
+    out.body = std::move(res.body());
+    return out;
+}
+
+// ── Dispatch & auth ────────────────────────────────────────────────────────────────
+
+MockServer::Response MockServer::handle(const Request& req)
+{
+    ++m_requests;
+    m_bytesIn += req.body().size();
+
+    Response res = [&]() -> Response {
+        if (req.find("X-Trace-Response-Bytes") != req.end())
+            return traceReply(req);
+
+        const std::string path(req.target());
+        if (req.method() != http::verb::post)
+            return reply(req, 404, { { "message", "Not found" } });
+
+        json body;
+        try {
+            body = json::parse(req.body());
+        } catch (const std::exception&) {
+            return reply(req, 400, { { "message", "Invalid JSON" } });
+        }
+
+        if (path == "/api/keyhandler/getbundle")
+            return getBundle(req, body);
+
+        using Route = Response (MockServer::*)(const Request&, const std::string&, const json&);
+        static const std::map<std::string, Route> routes = {
+            { "/api/fs/upload",   &MockServer::upload },
+            { "/api/fs/download", &MockServer::download },
+            { "/api/fs/list",     &MockServer::list },
+            { "/api/fs/changes",  &MockServer::changes },
+            { "/api/fs/share",    &MockServer::share },
+        };
+        auto route = routes.find(path);
+        if (route == routes.end())
+            return reply(req, 404, { { "message", "Not found" } });
+
+        std::optional<std::string> user = authenticate(req);
+        if (!user)
+            return reply(req, 401, { { "message", "Unauthorized" } });
+        try {
+            return (this->*route->second)(req, *user, body);
+        } catch (const std::exception&) {
+            return reply(req, 400, { { "message", "Invalid request body" } });
+        }
+    }();
+
+    if (res.result_int() >= 400)
+        ++m_rejected;
+    m_bytesOut += res.body().size();
+    return res;
+}
+
+std::optional<std::string> MockServer::authenticate(const Request& req) const
+{
+    const std::string username(req["X-Username"]);
+    std::optional<KeyBundle> bundle = bundleOf(username);
+    if (!bundle)
+        return std::nullopt;
+    if (!m_options.verifyAuth)
+        return username;
+
+    const std::string signature(req["X-Signature"]);
+    const size_t sep = signature.find("||");
+    if (sep == std::string::npos)
+        return std::nullopt;
+
+    const std::string canonical = NetworkAuthUtils::makeCanonicalString(
+        username, std::string(req["X-Timestamp"]), std::string(req.method_string()),
+        std::string(req.target()), req.body());
+    if (!verifyBoth(*bundle, canonical, signature.substr(0, sep), signature.substr(sep + 2)))
+        return std::nullopt;
+    return username;
+}
+
+std::optional<KeyBundle> MockServer::bundleOf(const std::string& username) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_users.find(username);
+    if (it == m_users.end())
+        return std::nullopt;
+    return it->second;
+}
+
+bool MockServer::verifyBoth(const KeyBundle& bundle, const std::string& message,
+                            const std::string& edSigB64, const std::string& pqSigB64)
+{
+    try {
+        const std::vector<uint8_t> msg(message.begin(), message.end());
+
+        Signer_Ed ed;
+        ed.loadPublicKey(bundle.getEd25519Pub().data(), bundle.getEd25519Pub().size());
+        if (!ed.verify(msg, FileClientData::base64_decode(edSigB64)))
+            return false;
+
+        Signer_Dilithium pq;
+        pq.loadPublicKey(bundle.getDilithiumPub().data(), bundle.getDilithiumPub().size());
+        return pq.verify(msg, FileClientData::base64_decode(pqSigB64));
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+MockServer::Response MockServer::reply(const Request& req, unsigned status, const json& body)
+{
+    Response res{ static_cast<http::status>(status), req.version() };
+    res.set(http::field::content_type, "application/json");
+    res.keep_alive(false);
+    res.body() = body.dump();
+    res.prepare_payload();
+    return res;
+}
+
+MockServer::Response MockServer::traceReply(const Request& req)
+{
+    const size_t size = std::strtoull(std::string(req["X-Trace-Response-Bytes"]).c_str(), nullptr, 10);
+    const unsigned status = req.find("X-Trace-Status") != req.end()
+        ? static_cast<unsigned>(std::strtoul(std::string(req["X-Trace-Status"]).c_str(), nullptr, 10))
+        : 200;
+
+    // a JSON object of exactly `size` bytes where that fits, filler otherwise
+    std::string body;
+    if (size >= 8)
+        body = "{\"r\":\"" + std::string(size - 8, 'x') + "\"}";
+    else
+        body.assign(size, ' ');
+
+    Response res{ static_cast<http::status>(status >= 100 && status < 600 ? status : 500), req.version() };
+    res.set(http::field::content_type, "application/json");
+    res.keep_alive(false);
+    res.body() = std::move(body);
+    res.prepare_payload();
+    return res;
+}
+
+// ── Routes ─────────────────────────────────────────────────────────────────────────
+
+MockServer::Response MockServer::upload(const Request& req, const std::string& user, const json& body)
+{
+    StoredFile f;
+    f.owner    = user;
+    f.content  = body.at("file_content").get<std::string>();
+    f.metadata = body.at("metadata").get<std::string>();
+    f.edSig    = body.at("pre_quantum_signature").get<std::string>();
+    f.pqSig    = body.at("post_quantum_signature").get<std::string>();
+
+    const std::vector<uint8_t> content = FileClientData::base64_decode(f.content);
+    if (content.size() > m_options.maxFileBytes)
+        return reply(req, 413, { { "message", "File too large" } });
+
+    if (m_options.verifyUploads) {
+        std::optional<KeyBundle> bundle = bundleOf(user);
+        const std::string signed_ = user + "|" + toHex(Hash::sha256(content)) + "|"
+                                  + toHex(Hash::sha256(FileClientData::base64_decode(f.metadata)));
+        if (!bundle || !verifyBoth(*bundle, signed_, f.edSig, f.pqSig))
+            return reply(req, 401, { { "message", "Unauthorized" } });
+    }
+    f.uploadedAt = QDateTime::currentDateTimeUtc().toString(Qt::ISODate).toStdString();
+
+    uint64_t fileId;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        fileId = f.fileId = m_nextFileId++;
+        f.changeId = m_nextChangeId++;
+        m_files.emplace(fileId, std::move(f));
+    }
+    return reply(req, 201, { { "message", "File uploaded successfully" }, { "file_id", fileId } });
+}
+
+MockServer::Response MockServer::download(const Request& req, const std::string& user, const json& body)
+{
+    const uint64_t fileId = body.at("file_id").get<uint64_t>();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_files.find(fileId);
+    if (it == m_files.end() || !visibleTo(it->second, user))
+        return reply(req, 404, { { "message", "File not found" } });
+
+    json out = entryFor(it->second, user);
+    out["file_content"] = it->second.content;
+    return reply(req, 200, out);
+}
+
+MockServer::Response MockServer::list(const Request& req, const std::string& user, const json& body)
+{
+    const size_t page = std::max<int64_t>(1, body.value("page", int64_t(1)));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    json files = json::array();
+    size_t skip = (page - 1) * kListPageSize;
+    bool hasNextPage = false;
+    // newest first, like ORDER BY file_id DESC
+    for (auto it = m_files.rbegin(); it != m_files.rend(); ++it) {
+        if (!visibleTo(it->second, user))
+            continue;
+        if (skip > 0) {
+            --skip;
+            continue;
+        }
+        if (files.size() == kListPageSize) {
+            hasNextPage = true;
+            break;
+        }
+        files.push_back(entryFor(it->second, user));
+    }
+    return reply(req, 200, { { "fileData", std::move(files) }, { "hasNextPage", hasNextPage } });
+}
+
+MockServer::Response MockServer::changes(const Request& req, const std::string& user, const json& body)
+{
+    const uint64_t cursor = body.value("cursor", uint64_t(0));
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<const StoredFile*> pending;
+    for (const auto& [id, f] : m_files) {
+        if (f.changeId > cursor && visibleTo(f, user))
+            pending.push_back(&f);
+    }
+    std::sort(pending.begin(), pending.end(),
+              [](const StoredFile* a, const StoredFile* b) { return a->changeId < b->changeId; });
+
+    const bool hasMore = pending.size() > kChangesPageSize;
+    if (hasMore)
+        pending.resize(kChangesPageSize);
+
+    json items = json::array();
+    for (const StoredFile* f : pending) {
+        items.push_back({ { "change_id", f->changeId }, { "file_id", f->fileId },
+                          { "change_type", "added" }, { "file", entryFor(*f, user) } });
+    }
+    const uint64_t next = pending.empty() ? cursor : pending.back()->changeId;
+    return reply(req, 200, { { "changes", std::move(items) }, { "cursor", next }, { "hasMore", hasMore } });
+}
+
+MockServer::Response MockServer::share(const Request& req, const std::string& user, const json& body)
+{
+    const uint64_t fileId = body.at("file_id").get<uint64_t>();
+    const std::string target = body.at("shared_with_username").get<std::string>();
+
+    json access;
+    for (const char* key : { "encrypted_fek", "encrypted_fek_nonce", "encrypted_mek",
+                             "encrypted_mek_nonce", "ephemeral_public_key",
+                             "file_content_nonce", "metadata_nonce" })
+        access[key] = body.at(key).get<std::string>();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_files.find(fileId);
+    if (it == m_files.end() || it->second.owner != user)
+        return reply(req, 404, { { "message", "File not found" } });
+    if (target == user)
+        return reply(req, 400, { { "message", "Cannot share with yourself" } });
+    if (!m_users.count(target))
+        return reply(req, 404, { { "message", "User not found" } });
+
+    it->second.shares.insert_or_assign(target, std::move(access));
+    it->second.changeId = m_nextChangeId++;
+    return reply(req, 201, { { "message", "File shared successfully" } });
+}
+
+MockServer::Response MockServer::getBundle(const Request& req, const json& body)
+{
+    std::optional<KeyBundle> bundle = bundleOf(body.value("username", std::string()));
+    if (!bundle)
+        return reply(req, 400, { { "message", "Invalid username" } });
+    return reply(req, 200, { { "key_bundle", bundle->toJsonPublic() } });
+}
+
+// ── Views ──────────────────────────────────────────────────────────────────────────
+
+bool MockServer::visibleTo(const StoredFile& f, const std::string& user) const
+{
+    return f.owner == user || f.shares.count(user);
+}
+
+json MockServer::entryFor(const StoredFile& f, const std::string& user) const
+{
+    json entry = {
+        { "file_id",                f.fileId },
+        { "metadata",               f.metadata },
+        { "pre_quantum_signature",  f.edSig },
+        { "post_quantum_signature", f.pqSig },
+        { "upload_timestamp",       f.uploadedAt },
+        { "is_owner",               f.owner == user },
+        { "owner_username",         f.owner },
+    };
+    if (f.owner != user)
+        entry["shared_access"] = f.shares.at(user);
+    return entry;
+}
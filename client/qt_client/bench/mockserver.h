@@ -0,0 +1,141 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../src/utils/crypto/keybundle.h"
+#include "../src/utils/networking/HttpRequest.h"
+#include "../src/utils/networking/HttpResponse.h"
+
+/**
+ * MockServer – an in-process HTTPS stand-in for the Bun server, for benchmarks.
+ *
+ * Serves the routes the transfer handlers use, from memory:
+ *   /api/fs/upload, /api/fs/download, /api/fs/list, /api/fs/changes, /api/fs/share,
+ *   /api/keyhandler/getbundle
+ * with the same request and response shapes and status codes as server/src/api. Anything
+ * else (including /api/fs/events) is a 404, which ChangeSubscriber simply backs off from.
+ *
+ * start() generates a throwaway CA and a localhost certificate signed by it; point the
+ * client's CA bundle at caPem() and Config at localhost:port(). Users are added directly
+ * with their public KeyBundle — there is no registration route.
+ *
+ * serve() answers a request in-process, without start(), sockets or TLS — the fake API
+ * behind LoopbackClient (bench/loopbackclient.h).
+ *
+ * A request carrying X-Trace-Response-Bytes (bench/trace_replay.cpp) skips all of that
+ * and is answered with that many bytes and the X-Trace-Status status, so recorded
+ * traffic can be replayed without accounts or state.
+ *
+ * The dual-signature checks can be switched off to take the server's own verify cost
+ * out of a measurement: verifyAuth for the X-Signature request headers, verifyUploads
+ * for the per-file signatures on upload.
+ */
+class MockServer {
+public:
+    struct Options {
+        bool        verifyAuth     = true;
+        bool        verifyUploads  = true;
+        int         threads        = 2;
+        size_t      maxFileBytes   = 50 * 1024 * 1024;  // server/src/api/fs/upload MAX_FILE_SIZE
+        uint16_t    port           = 0;                 // 0 = any free port
+    };
+
+    struct Stats {
+        uint64_t    requests = 0;
+        uint64_t    rejected = 0;   // answered with 4xx/5xx
+        uint64_t    bytesIn  = 0;   // request bodies
+        uint64_t    bytesOut = 0;   // response bodies
+    };
+
+    explicit MockServer(Options options);
+    ~MockServer();
+
+    MockServer(const MockServer&) = delete;
+    MockServer& operator=(const MockServer&) = delete;
+
+    /** Creates the certificates, listens on 127.0.0.1:Options::port and starts the threads */
+    bool start(std::string& outError);
+    void stop();
+
+    uint16_t port() const { return m_port; }
+    const std::string& caPem() const { return m_caPem; }
+
+    void addUser(const std::string& username, const KeyBundle& publicBundle);
+
+    /** Thread-safe; the request body is moved into the route, the reply body out of it */
+    HttpResponse serve(HttpRequest request);
+
+    /** Drops every file, share and change; users stay. File ids keep counting up. */
+    void reset();
+
+    Stats stats() const;
+
+private:
+    using Request  = boost::beast::http::request<boost::beast::http::string_body>;
+    using Response = boost::beast::http::response<boost::beast::http::string_body>;
+
+    class Session;
+
+    struct StoredFile {
+        uint64_t        fileId = 0;
+        std::string     owner;
+        std::string     content;        // base64, as uploaded
+        std::string     metadata;       // base64
+        std::string     edSig;
+        std::string     pqSig;
+        std::string     uploadedAt;     // ISO 8601
+        uint64_t        changeId = 0;   // last change, for /api/fs/changes
+        std::map<std::string, nlohmann::json> shares;   // username → shared_access
+    };
+
+    void accept();
+    Response handle(const Request& req);
+
+    // The caller's username if the X-* headers check out (or checks are off)
+    std::optional<std::string> authenticate(const Request& req) const;
+    std::optional<KeyBundle> bundleOf(const std::string& username) const;
+    static bool verifyBoth(const KeyBundle& bundle, const std::string& message,
+                           const std::string& edSigB64, const std::string& pqSigB64);
+
+    Response upload(const Request& req, const std::string& user, const nlohmann::json& body);
+    Response download(const Request& req, const std::string& user, const nlohmann::json& body);
+    Response list(const Request& req, const std::string& user, const nlohmann::json& body);
+    Response changes(const Request& req, const std::string& user, const nlohmann::json& body);
+    Response share(const Request& req, const std::string& user, const nlohmann::json& body);
+    Response getBundle(const Request& req, const nlohmann::json& body);
+
+    // The listing/change-feed view of a file for `user`; caller holds m_mutex
+    nlohmann::json entryFor(const StoredFile& f, const std::string& user) const;
+    bool visibleTo(const StoredFile& f, const std::string& user) const;
+
+    static Response reply(const Request& req, unsigned status, const nlohmann::json& body);
+    static Response traceReply(const Request& req);
+
+    Options                         m_options;
+    boost::asio::io_context         m_io;
+    boost::asio::ssl::context       m_ssl;
+    boost::asio::ip::tcp::acceptor  m_acceptor;
+    std::vector<std::thread>        m_threads;
+    uint16_t                        m_port = 0;
+    std::string                     m_caPem;
+
+    mutable std::mutex                      m_mutex;
+    std::map<std::string, KeyBundle>        m_users;
+    std::map<uint64_t, StoredFile>          m_files;
+    uint64_t                                m_nextFileId = 1;
+    uint64_t                                m_nextChangeId = 1;
+
+    mutable std::atomic<uint64_t>   m_requests{0};
+    mutable std::atomic<uint64_t>   m_rejected{0};
+    std::atomic<uint64_t>           m_bytesIn{0};
+    std::atomic<uint64_t>           m_bytesOut{0};
+};
@@ -0,0 +1,359 @@
+// trace_replay – re-issues a recorded traffic trace (src/utils/networking/tracerecorder.h)
+// against a stand-in server, to reproduce a field workload's shape locally: the same
+// paths, request and response sizes, overlap and pacing, without the user's account or
+// data.
+//
+//   SSSHARE_TRACE=field.sstrace ./qt_client        # on the affected machine
+//
+//   ./trace_replay field.sstrace --info            # what is in it
+//   ./trace_replay field.sstrace                   # original timing, in-process stand-in
+//   ./trace_replay field.sstrace --speed 4         # four times as fast
+//   ./trace_replay field.sstrace --max -j 32       # as fast as possible, 32 in flight
+//
+// The stand-in is MockServer answering each request with its recorded status and
+// response size. To put a network in between, run the stand-in on its own and point
+// the replay at a WanProxy in front of it:
+//
+//   ./trace_replay --serve 9443 --ca-out standin.pem
+//   ./wanproxy --listen 9444 --target localhost:9443 --scenario bench/scenarios/broadband.json
+//   ./trace_replay field.sstrace --target localhost:9444 --ca standin.pem
+//
+// Requests re-send the recorded body when the trace has one (redacted or full) and the
+// same number of filler bytes otherwise.
+
+#include "mockserver.h"
+#include "../src/config.h"
+#include "../src/utils/networking/asiosslclient.h"
+#include "../src/utils/networking/asyncsslclient.h"
+#include "../src/utils/networking/tracerecorder.h"
+
+#include <QCoreApplication>
+#include <QLoggingCategory>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using json  = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+using Trace = TraceRecorder::Trace;
+
+namespace {
+
+struct Settings {
+    std::string     tracePath;
+    bool            info = false;
+    double          speed = 1.0;
+    bool            max = false;
+    int             concurrency = 0;        // --max; 0 = the trace's own peak overlap
+    std::string     targetHost;             // empty = in-process stand-in
+    int             targetPort = 0;
+    std::string     caBundle;
+    int             servePort = -1;         // --serve
+    std::string     caOut;
+    bool            json = false;
+};
+
+const char* methodName(uint8_t m)
+{
+    switch (static_cast<HttpRequest::Method>(m)) {
+    case HttpRequest::Method::GET:    return "GET";
+    case HttpRequest::Method::POST:   return "POST";
+    case HttpRequest::Method::PUT:    return "PUT";
+    case HttpRequest::Method::DELETE: return "DELETE";
+    }
+    return "?";
+}
+
+double percentileMs(std::vector<double> v, double p)
+{
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5))];
+}
+
+// Most exchanges that were in flight at the same moment
+int peakOverlap(const std::vector<TraceRecorder::Exchange>& xs)
+{
+    std::vector<std::pair<uint64_t, int>> edges;
+    for (const auto& x : xs) {
+        edges.emplace_back(x.startMicros, +1);
+        edges.emplace_back(x.startMicros + x.durationMicros, -1);
+    }
+    std::sort(edges.begin(), edges.end());
+    int now = 0, peak = 0;
+    for (const auto& e : edges)
+        peak = std::max(peak, now += e.second);
+    return std::max(1, peak);
+}
+
+uint64_t spanMicros(const std::vector<TraceRecorder::Exchange>& xs)
+{
+    uint64_t end = 0;
+    for (const auto& x : xs)
+        end = std::max(end, x.startMicros + x.durationMicros);
+    return xs.empty() ? 0 : end - xs.front().startMicros;
+}
+
+// ── Replay ─────────────────────────────────────────────────────────────────────────
+
+struct PathStats {
+    std::vector<double> recordedMs;
+    std::vector<double> replayedMs;
+    uint64_t            requestBytes = 0;
+    uint64_t            responseBytes = 0;
+    uint64_t            statusMismatches = 0;   // replayed status differs from the recorded one
+};
+
+class Replayer {
+public:
+    Replayer(const Trace& trace, const Settings& s) : m_trace(trace), m_settings(s) {}
+
+    double run()
+    {
+        const auto& xs = m_trace.exchanges;
+        const int limit = m_settings.max
+            ? (m_settings.concurrency > 0 ? m_settings.concurrency : peakOverlap(xs))
+            : std::numeric_limits<int>::max();
+        const uint64_t origin = xs.empty() ? 0 : xs.front().startMicros;
+        const Clock::time_point t0 = Clock::now();
+
+        for (size_t i = 0; i < xs.size(); ++i) {
+            if (!m_settings.max) {
+                const double offset = (xs[i].startMicros - origin) / m_settings.speed;
+                std::this_thread::sleep_until(t0 + std::chrono::duration_cast<Clock::duration>(
+                                                       std::chrono::duration<double, std::micro>(offset)));
+            }
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait(lock, [&]() { return m_inFlight < limit; });
+                ++m_inFlight;
+            }
+            issue(xs[i]);
+        }
+
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_cv.wait(lock, [&]() { return m_inFlight == 0; });
+        return std::chrono::duration<double>(Clock::now() - t0).count();
+    }
+
+    std::map<std::string, PathStats>& stats() { return m_stats; }
+
+private:
+    void issue(const TraceRecorder::Exchange& x)
+    {
+        std::string body = x.body.empty() ? std::string(x.requestBytes, 'x') : x.body;
+        HttpRequest req(static_cast<HttpRequest::Method>(x.method), x.path, std::move(body),
+                        { { "X-Trace-Response-Bytes", std::to_string(x.responseBytes) },
+                          { "X-Trace-Status", std::to_string(x.status) } });
+
+        const Clock::time_point sent = Clock::now();
+        AsyncSslClient::instance().send(req, [this, &x, sent](HttpResponse resp) {
+            const double ms = std::chrono::duration<double, std::milli>(Clock::now() - sent).count();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            PathStats& s = m_stats[std::string(methodName(x.method)) + " " + x.path];
+            s.recordedMs.push_back(x.durationMicros / 1000.0);
+            s.replayedMs.push_back(ms);
+            s.requestBytes += x.requestBytes;
+            s.responseBytes += resp.body.size();
+            if (resp.statusCode != x.status)
+                ++s.statusMismatches;
+            --m_inFlight;
+            m_cv.notify_all();
+        });
+    }
+
+    const Trace&                        m_trace;
+    const Settings&                     m_settings;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_cv;
+    int                                 m_inFlight = 0;
+    std::map<std::string, PathStats>    m_stats;
+};
+
+// ── Output ─────────────────────────────────────────────────────────────────────────
+
+void printInfo(const Trace& trace, const Settings& s)
+{
+    static const char* kBodies[] = { "none", "redacted", "full" };
+    std::map<std::string, PathStats> byPath;
+    for (const auto& x : trace.exchanges) {
+        PathStats& p = byPath[std::string(methodName(x.method)) + " " + x.path];
+        p.recordedMs.push_back(x.durationMicros / 1000.0);
+        p.requestBytes += x.requestBytes;
+        p.responseBytes += x.responseBytes;
+    }
+
+    const double spanSec = spanMicros(trace.exchanges) / 1e6;
+    if (s.json) {
+        json paths = json::object();
+        for (const auto& [path, p] : byPath)
+            paths[path] = { { "count", p.recordedMs.size() }, { "request_bytes", p.requestBytes },
+                            { "response_bytes", p.responseBytes },
+                            { "p50_ms", percentileMs(p.recordedMs, 50) }, { "p99_ms", percentileMs(p.recordedMs, 99) } };
+        std::printf("%s\n", json{ { "exchanges", trace.exchanges.size() }, { "span_s", spanSec },
+                                  { "bodies", kBodies[int(trace.bodies)] },
+                                  { "start_unix_us", trace.startUnixMicros },
+                                  { "peak_in_flight", peakOverlap(trace.exchanges) },
+                                  { "paths", paths } }.dump(2).c_str());
+        return;
+    }
+    std::printf("%zu exchanges over %.1f s, peak %d in flight, bodies: %s\n",
+                trace.exchanges.size(), spanSec, peakOverlap(trace.exchanges), kBodies[int(trace.bodies)]);
+    std::printf("%-36s %7s %12s %12s %9s %9s\n", "request", "count", "req bytes", "resp bytes", "p50 ms", "p99 ms");
+    for (const auto& [path, p] : byPath)
+        std::printf("%-36s %7zu %12llu %12llu %9.1f %9.1f\n", path.c_str(), p.recordedMs.size(),
+                    static_cast<unsigned long long>(p.requestBytes), static_cast<unsigned long long>(p.responseBytes),
+                    percentileMs(p.recordedMs, 50), percentileMs(p.recordedMs, 99));
+}
+
+void printReplay(const Trace& trace, std::map<std::string, PathStats>& stats, double seconds, const Settings& s)
+{
+    const double recordedSec = spanMicros(trace.exchanges) / 1e6;
+    if (s.json) {
+        json paths = json::object();
+        for (const auto& [path, p] : stats)
+            paths[path] = { { "count", p.replayedMs.size() }, { "status_mismatches", p.statusMismatches },
+                            { "recorded_p50_ms", percentileMs(p.recordedMs, 50) },
+                            { "recorded_p99_ms", percentileMs(p.recordedMs, 99) },
+                            { "replayed_p50_ms", percentileMs(p.replayedMs, 50) },
+                            { "replayed_p99_ms", percentileMs(p.replayedMs, 99) } };
+        std::printf("%s\n", json{ { "recorded_s", recordedSec }, { "replayed_s", seconds },
+                                  { "paths", paths } }.dump(2).c_str());
+        return;
+    }
+    std::printf("recorded %.2f s, replayed in %.2f s\n", recordedSec, seconds);
+    std::printf("%-36s %7s %9s %9s %9s %9s %8s\n", "request", "count",
+                "rec p50", "rec p99", "rep p50", "rep p99", "status≠");
+    for (const auto& [path, p] : stats)
+        std::printf("%-36s %7zu %9.1f %9.1f %9.1f %9.1f %8llu\n", path.c_str(), p.replayedMs.size(),
+                    percentileMs(p.recordedMs, 50), percentileMs(p.recordedMs, 99),
+                    percentileMs(p.replayedMs, 50), percentileMs(p.replayedMs, 99),
+                    static_cast<unsigned long long>(p.statusMismatches));
+}
+
+// ── Flags ──────────────────────────────────────────────────────────────────────────
+
+bool splitHostPort(const QString& text, std::string& host, int& port)
+{
+    const int colon = text.lastIndexOf(':');
+    if (colon <= 0)
+        return false;
+    host = text.left(colon).toStdString();
+    port = text.mid(colon + 1).toInt();
+    return port > 0 && port <= 65535;
+}
+
+bool parseArgs(const QStringList& args, Settings& s)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (a == "--info")                              s.info = true;
+        else if (a == "--max")                          s.max = true;
+        else if (a == "--json")                         s.json = true;
+        else if (a == "--speed" && hasValue)            s.speed = args[++i].toDouble();
+        else if ((a == "-j" || a == "--concurrency") && hasValue) s.concurrency = args[++i].toInt();
+        else if (a == "--ca" && hasValue)               s.caBundle = args[++i].toStdString();
+        else if (a == "--serve" && hasValue)            s.servePort = args[++i].toInt();
+        else if (a == "--ca-out" && hasValue)           s.caOut = args[++i].toStdString();
+        else if (a == "--target" && hasValue) {
+            if (!splitHostPort(args[++i], s.targetHost, s.targetPort))
+                return false;
+        }
+        else if (!a.startsWith('-') && s.tracePath.empty()) s.tracePath = a.toStdString();
+        else return false;
+    }
+    if (s.servePort >= 0)
+        return s.servePort <= 65535 && !s.caOut.empty();
+    return !s.tracePath.empty() && s.speed > 0 && s.concurrency >= 0
+        && (s.targetHost.empty() || !s.caBundle.empty());
+}
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int)
+{
+    g_stop = 1;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    Settings s;
+    if (!parseArgs(app.arguments(), s)) {
+        std::fprintf(stderr,
+            "usage: trace_replay TRACE [--info] [--speed X | --max [-j N]] [--target HOST:PORT --ca FILE] [--json]\n"
+            "       trace_replay --serve PORT --ca-out FILE\n");
+        return 2;
+    }
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    // stand-in only: serve until Ctrl-C
+    if (s.servePort >= 0) {
+        MockServer::Options options;
+        options.port = static_cast<uint16_t>(s.servePort);
+        MockServer standIn(options);
+        std::string err;
+        if (!standIn.start(err)) {
+            std::fprintf(stderr, "trace_replay: %s\n", err.c_str());
+            return 1;
+        }
+        std::ofstream(s.caOut) << standIn.caPem();
+        std::printf("trace_replay: stand-in on localhost:%u, CA in %s\n", standIn.port(), s.caOut.c_str());
+        std::fflush(stdout);
+        std::signal(SIGINT, onSignal);
+        std::signal(SIGTERM, onSignal);
+        while (!g_stop)
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        return 0;
+    }
+
+    Trace trace;
+    std::string err;
+    if (!TraceRecorder::read(s.tracePath, trace, err)) {
+        std::fprintf(stderr, "trace_replay: %s\n", err.c_str());
+        return 1;
+    }
+    std::stable_sort(trace.exchanges.begin(), trace.exchanges.end(),
+                     [](const auto& a, const auto& b) { return a.startMicros < b.startMicros; });
+    if (s.info) {
+        printInfo(trace, s);
+        return 0;
+    }
+
+    std::unique_ptr<MockServer> standIn;
+    auto& cfg = Config::instance();
+    if (s.targetHost.empty()) {
+        standIn = std::make_unique<MockServer>(MockServer::Options{});
+        if (!standIn->start(err)) {
+            std::fprintf(stderr, "trace_replay: %s\n", err.c_str());
+            return 1;
+        }
+        s.caBundle = (QCoreApplication::applicationDirPath() + "/trace_replay_ca.pem").toStdString();
+        std::ofstream(s.caBundle) << standIn->caPem();
+        s.targetHost = "localhost";
+        s.targetPort = standIn->port();
+    }
+    cfg.serverHost = s.targetHost;
+    cfg.serverPort = s.targetPort;
+    cfg.caBundle   = s.caBundle;
+    AsioSslClient tlsSetup;
+    tlsSetup.init(cfg.caBundle);
+
+    Replayer replayer(trace, s);
+    const double seconds = replayer.run();
+    printReplay(trace, replayer.stats(), seconds, s);
+    return 0;
+}
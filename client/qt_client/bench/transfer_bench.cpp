@@ -0,0 +1,578 @@
+// End-to-end transfer benchmark: drives the real upload/download/share/list handlers
+// against an in-process HTTPS mock of the server (bench/mockserver.h) over loopback, and
+// reports throughput, per-item latency percentiles and peak RSS for every
+// file size × concurrency cell.
+//
+//   cmake -DQT_CLIENT_BUILD_BENCHMARKS=ON ... && ./transfer_bench [options]
+//
+//   --sizes 16K,1M,16M      file sizes (K/M suffixes)
+//   --concurrency 1,4,16    items in flight at once
+//   --files N               files per cell (default 32)
+//   --no-verify-auth        mock skips the X-Signature request checks
+//   --no-verify-uploads     mock skips the per-file upload signature checks
+//   --server-threads N      mock server I/O threads (default 2)
+//   --wan FILE              route through a WanProxy with this scenario (bench/scenarios/)
+//   --in-process            no sockets or TLS: requests go straight to the mock
+//                           (bench/loopbackclient.h), leaving only the handlers' own cost
+//   --json                  one JSON object per row instead of the table
+//
+// Latency is from the handler call to its per-item result signal, so it includes the
+// UiEventPump frame (up to ~16 ms) the result waits for. Peak RSS is the whole process,
+// mock server included, reset before each phase where the OS allows it.
+//
+// Built with QT_CLIENT_ALLOC_TRACKING=ON, every row also gets the heap high-water mark
+// and, per span stage (src/utils/alloctracker.h), allocations and bytes per item.
+
+#include "loopbackclient.h"
+#include "mockserver.h"
+#include "wanproxy.h"
+#include "../src/config.h"
+#include "../src/handlers/filedownloadhandler.h"
+#include "../src/handlers/filelisthandler.h"
+#include "../src/handlers/filesharehandler.h"
+#include "../src/handlers/fileuploadhandler.h"
+#include "../src/utils/alloctracker.h"
+#include "../src/utils/clientstore.h"
+#include "../src/utils/metrics.h"
+#include "../src/utils/uieventpump.h"
+#include "../src/utils/networking/asiosslclient.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+using json = nlohmann::json;
+
+namespace {
+
+const char* kOwner     = "bench_alice";
+const char* kRecipient = "bench_bob";
+
+struct Settings {
+    std::vector<qint64> sizes       = { 16 * 1024, 1024 * 1024, 16 * 1024 * 1024 };
+    std::vector<int>    concurrency = { 1, 4, 16 };
+    int                 files       = 32;
+    bool                json        = false;
+    MockServer::Options server;
+    QString             wanScenario;
+    bool                inProcess   = false;
+};
+
+// ── Peak RSS ───────────────────────────────────────────────────────────────────────
+
+// Starts a new high-water mark where the OS lets us (Linux); elsewhere peaks only grow
+void resetPeakRss()
+{
+#if defined(Q_OS_LINUX)
+    QFile f("/proc/self/clear_refs");
+    if (f.open(QIODevice::WriteOnly))
+        f.write("5");
+#endif
+}
+
+qint64 peakRssBytes()
+{
+#if defined(Q_OS_WIN)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return static_cast<qint64>(pmc.PeakWorkingSetSize);
+    return 0;
+#else
+#if defined(Q_OS_LINUX)
+    QFile f("/proc/self/status");
+    if (f.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        for (const QByteArray& line : f.readAll().split('\n')) {
+            if (line.startsWith("VmHWM:"))
+                return line.mid(6).trimmed().split(' ').value(0).toLongLong() * 1024;
+        }
+    }
+#endif
+    rusage ru{};
+    getrusage(RUSAGE_SELF, &ru);
+#if defined(Q_OS_MACOS)
+    return ru.ru_maxrss;            // bytes
+#else
+    return ru.ru_maxrss * 1024;     // KiB
+#endif
+#endif
+}
+
+// ── Allocations (QT_CLIENT_ALLOC_TRACKING builds) ──────────────────────────────────
+
+struct AllocDelta {
+    uint64_t allocs = 0;
+    uint64_t bytes  = 0;
+};
+
+// "alloc.<category>.<name>.allocs|bytes" counters keyed by "<category>.<name>"
+std::map<std::string, AllocDelta> stageAllocs()
+{
+    std::map<std::string, AllocDelta> stages;
+    const json counters = Metrics::instance().snapshot().at("counters");
+    for (const auto& [name, value] : counters.items()) {
+        if (name.rfind("alloc.", 0) != 0)
+            continue;
+        const size_t dot = name.rfind('.');
+        const std::string stage = name.substr(6, dot - 6);
+        if (name.compare(dot, std::string::npos, ".allocs") == 0)
+            stages[stage].allocs = value.get<uint64_t>();
+        else if (name.compare(dot, std::string::npos, ".bytes") == 0)
+            stages[stage].bytes = value.get<uint64_t>();
+    }
+    return stages;
+}
+
+// ── One phase: items through a handler with at most N in flight ────────────────────
+
+struct PhaseResult {
+    int                 ok = 0;
+    int                 failed = 0;
+    double              wallSec = 0;
+    std::vector<double> latencyMs;      // successful items only
+    qint64              peakRss = 0;
+    QString             firstError;
+
+    // allocation-tracking builds only
+    AllocDelta                          heap;           // whole process during the phase
+    int64_t                             heapPeak = 0;   // above the live heap at the start
+    std::map<std::string, AllocDelta>   stages;         // stages that allocated
+};
+
+class Phase {
+public:
+    explicit Phase(int concurrency) : m_limit(std::max(1, concurrency)) {}
+
+    void add(const QString& key, std::function<void()> launch)
+    {
+        m_queue.push_back({ key, std::move(launch) });
+    }
+
+    // Called from the handler's per-item result signal
+    void done(const QString& key, bool ok, const QString& message)
+    {
+        auto it = m_started.find(key);
+        if (it == m_started.end())
+            return;
+        if (ok) {
+            ++m_result.ok;
+            m_result.latencyMs.push_back(it->second.nsecsElapsed() / 1e6);
+        } else {
+            ++m_result.failed;
+            if (m_result.firstError.isEmpty())
+                m_result.firstError = message;
+        }
+        m_started.erase(it);
+        pump();
+    }
+
+    PhaseResult run()
+    {
+        std::map<std::string, AllocDelta> stagesBefore;
+        AllocTracker::Counts heapBefore;
+        if (AllocTracker::kEnabled) {
+            stagesBefore = stageAllocs();
+            heapBefore = AllocTracker::process();
+            AllocTracker::resetPeak();
+        }
+
+        resetPeakRss();
+        m_clock.start();
+        pump();
+        if (!m_started.empty())
+            m_loop.exec();
+        m_result.wallSec = m_clock.nsecsElapsed() / 1e9;
+        m_result.peakRss = peakRssBytes();
+
+        if (AllocTracker::kEnabled) {
+            const AllocTracker::Counts heapAfter = AllocTracker::process();
+            m_result.heap     = { heapAfter.allocs - heapBefore.allocs, heapAfter.bytes - heapBefore.bytes };
+            m_result.heapPeak = heapAfter.peak - heapBefore.live;
+            for (const auto& [stage, after] : stageAllocs()) {
+                const AllocDelta before = stagesBefore[stage];
+                if (after.allocs != before.allocs)
+                    m_result.stages[stage] = { after.allocs - before.allocs, after.bytes - before.bytes };
+            }
+        }
+        return std::move(m_result);
+    }
+
+private:
+    void pump()
+    {
+        while (!m_queue.empty() && static_cast<int>(m_started.size()) < m_limit) {
+            auto [key, launch] = std::move(m_queue.front());
+            m_queue.pop_front();
+            m_started[key].start();
+            launch();
+        }
+        if (m_queue.empty() && m_started.empty())
+            m_loop.quit();
+    }
+
+    int                                                 m_limit;
+    std::deque<std::pair<QString, std::function<void()>>> m_queue;
+    std::map<QString, QElapsedTimer>                    m_started;
+    QElapsedTimer                                       m_clock;
+    QEventLoop                                          m_loop;
+    PhaseResult                                         m_result;
+};
+
+// ── Reporting ──────────────────────────────────────────────────────────────────────
+
+double percentile(std::vector<double> v, double p)
+{
+    if (v.empty())
+        return 0;
+    std::sort(v.begin(), v.end());
+    const size_t rank = static_cast<size_t>(p / 100.0 * (v.size() - 1) + 0.5);
+    return v[std::min(rank, v.size() - 1)];
+}
+
+QString sizeLabel(qint64 bytes)
+{
+    if (bytes % (1024 * 1024) == 0) return QString::number(bytes / (1024 * 1024)) + "M";
+    if (bytes % 1024 == 0)          return QString::number(bytes / 1024) + "K";
+    return QString::number(bytes);
+}
+
+void report(const Settings& s, const char* op, qint64 size, int conc, const PhaseResult& r,
+            qint64 bytesPerItem)
+{
+    const double filesPerSec = r.wallSec > 0 ? r.ok / r.wallSec : 0;
+    const double mbPerSec = r.wallSec > 0 ? double(bytesPerItem) * r.ok / (1024.0 * 1024.0) / r.wallSec : 0;
+    const double p50 = percentile(r.latencyMs, 50), p90 = percentile(r.latencyMs, 90),
+                 p99 = percentile(r.latencyMs, 99), max = percentile(r.latencyMs, 100);
+    const double rssMb = r.peakRss / (1024.0 * 1024.0);
+
+    if (s.json) {
+        json row = { { "op", op }, { "size", size }, { "concurrency", conc },
+                     { "ok", r.ok }, { "failed", r.failed }, { "wall_s", r.wallSec },
+                     { "files_per_s", filesPerSec }, { "mb_per_s", mbPerSec },
+                     { "p50_ms", p50 }, { "p90_ms", p90 }, { "p99_ms", p99 }, { "max_ms", max },
+                     { "peak_rss_mb", rssMb } };
+        if (!r.firstError.isEmpty())
+            row["first_error"] = r.firstError.toStdString();
+        if (AllocTracker::kEnabled) {
+            const double items = std::max(1, r.ok);
+            row["heap_peak_mb"]       = r.heapPeak / (1024.0 * 1024.0);
+            row["allocs_per_item"]    = r.heap.allocs / items;
+            row["alloc_mb_per_item"]  = r.heap.bytes / items / (1024.0 * 1024.0);
+            json stages = json::object();
+            for (const auto& [stage, d] : r.stages)
+                stages[stage] = { { "allocs_per_item", d.allocs / items },
+                                  { "alloc_mb_per_item", d.bytes / items / (1024.0 * 1024.0) } };
+            row["stages"] = std::move(stages);
+        }
+        std::printf("%s\n", row.dump().c_str());
+    } else {
+        std::printf("%-9s %6s %5d %5d %5d %9.1f %9.1f %8.1f %8.1f %8.1f %8.1f %9.1f\n",
+                    op, qPrintable(sizeLabel(size)), conc, r.ok, r.failed, filesPerSec, mbPerSec,
+                    p50, p90, p99, max, rssMb);
+        if (!r.firstError.isEmpty())
+            std::printf("          first error: %s\n", qPrintable(r.firstError));
+        if (AllocTracker::kEnabled) {
+            // per item: whole process (mock included), then each span stage on its own
+            const double items = std::max(1, r.ok);
+            std::printf("          heap peak %.1f MB, %.0f allocs / %.2f MB per item\n",
+                        r.heapPeak / (1024.0 * 1024.0), r.heap.allocs / items,
+                        r.heap.bytes / items / (1024.0 * 1024.0));
+            for (const auto& [stage, d] : r.stages)
+                std::printf("            %-28s %9.1f allocs %10.3f MB\n", stage.c_str(),
+                            d.allocs / items, d.bytes / items / (1024.0 * 1024.0));
+        }
+    }
+    std::fflush(stdout);
+}
+
+// ── Cells ──────────────────────────────────────────────────────────────────────────
+
+QStringList writeInputFiles(const QString& dir, qint64 size, int count)
+{
+    // incompressible and different per file
+    std::mt19937_64 rng(static_cast<uint64_t>(size));
+    QByteArray data(size, '\0');
+    QStringList paths;
+    for (int i = 0; i < count; ++i) {
+        for (qint64 off = 0; off + 8 <= size; off += 8) {
+            const uint64_t word = rng();
+            std::memcpy(data.data() + off, &word, 8);
+        }
+        const QString path = QDir(dir).filePath(QString("in_%1_%2.bin").arg(sizeLabel(size)).arg(i));
+        QFile f(path);
+        if (!f.open(QIODevice::WriteOnly) || f.write(data) != size)
+            return {};
+        paths << path;
+    }
+    return paths;
+}
+
+void runCell(const Settings& s, MockServer& server, ClientStore& store, const QString& workDir,
+             const QStringList& inputs, qint64 size, int conc)
+{
+    server.reset();
+
+    // upload
+    std::vector<qulonglong> fileIds;
+    {
+        FileUploadHandler handler(&store);
+        Phase phase(conc);
+        QObject::connect(&handler, &FileUploadHandler::uploadItemResult,
+                         [&](const QString& path, qulonglong fileId, const QString& status, const QString& message) {
+            if (status == "uploaded")
+                fileIds.push_back(fileId);
+            phase.done(path, status == "uploaded", message);
+        });
+        for (const QString& path : inputs)
+            phase.add(path, [&handler, path]() { handler.uploadFiles({ path }); });
+        report(s, "upload", size, conc, phase.run(), size);
+    }
+
+    // download
+    {
+        const QString outDir = QDir(workDir).filePath("downloads");
+        QDir(outDir).removeRecursively();
+        QDir().mkpath(outDir);
+
+        FileDownloadHandler handler(&store);
+        handler.setDownloadDir(outDir);
+        Phase phase(conc);
+        QObject::connect(&handler, &FileDownloadHandler::downloadItemResult,
+                         [&](qulonglong fileId, const QString&, const QString& status, const QString& message) {
+            phase.done(QString::number(fileId), status == "downloaded", message);
+        });
+        for (qulonglong id : fileIds)
+            phase.add(QString::number(id), [&handler, id]() { handler.downloadFile(id); });
+        report(s, "download", size, conc, phase.run(), size);
+    }
+
+    // share: getbundle + key wrap + POST per file; payload size does not matter here
+    {
+        FileShareHandler handler(&store);
+        Phase phase(conc);
+        QObject::connect(&handler, &FileShareHandler::shareItemResult,
+                         [&](qulonglong fileId, const QString&, const QString& status, const QString& message) {
+            phase.done(QString::number(fileId), status == "shared", message);
+        });
+        for (qulonglong id : fileIds)
+            phase.add(QString::number(id), [&handler, id]() { handler.shareFile(id, kRecipient); });
+        report(s, "share", size, conc, phase.run(), 0);
+    }
+
+    // list: a cold "All files" listing (no metadata cache) of everything just uploaded
+    {
+        QFile::remove(QString::fromStdString(store.directory()) + "/metadata_cache_" + kOwner + ".json");
+        FileListHandler handler(&store);
+        Phase phase(1);
+        QObject::connect(&handler, &FileListHandler::listingFinished, [&]() { phase.done("list", true, {}); });
+        QObject::connect(&handler, &FileListHandler::errorOccurred,
+                         [&](const QString& message) { phase.done("list", false, message); });
+        phase.add("list", [&handler]() { handler.listAllPages(); });
+        PhaseResult r = phase.run();
+        // one listing of fileIds.size() rows; rate it per row
+        if (r.ok) {
+            r.ok = static_cast<int>(fileIds.size());
+            r.latencyMs.assign(1, r.latencyMs.front());
+        }
+        report(s, "list", size, conc, r, 0);
+    }
+}
+
+// ── Flags ──────────────────────────────────────────────────────────────────────────
+
+qint64 parseSize(QString text)
+{
+    qint64 mult = 1;
+    if (text.endsWith('K', Qt::CaseInsensitive))      mult = 1024;
+    else if (text.endsWith('M', Qt::CaseInsensitive)) mult = 1024 * 1024;
+    if (mult != 1)
+        text.chop(1);
+    bool ok = false;
+    const qint64 n = text.toLongLong(&ok);
+    return ok && n > 0 ? n * mult : 0;
+}
+
+bool parseArgs(const QStringList& args, Settings& s)
+{
+    for (int i = 1; i < args.size(); ++i) {
+        const QString& a = args[i];
+        const bool hasValue = i + 1 < args.size();
+        if (a == "--sizes" && hasValue) {
+            s.sizes.clear();
+            for (const QString& part : args[++i].split(',', Qt::SkipEmptyParts)) {
+                const qint64 n = parseSize(part);
+                if (n == 0)
+                    return false;
+                s.sizes.push_back(n);
+            }
+        } else if (a == "--concurrency" && hasValue) {
+            s.concurrency.clear();
+            for (const QString& part : args[++i].split(',', Qt::SkipEmptyParts)) {
+                const int n = part.toInt();
+                if (n < 1)
+                    return false;
+                s.concurrency.push_back(n);
+            }
+        } else if (a == "--files" && hasValue) {
+            s.files = args[++i].toInt();
+        } else if (a == "--server-threads" && hasValue) {
+            s.server.threads = args[++i].toInt();
+        } else if (a == "--wan" && hasValue) {
+            s.wanScenario = args[++i];
+        } else if (a == "--in-process") {
+            s.inProcess = true;
+        } else if (a == "--no-verify-auth") {
+            s.server.verifyAuth = false;
+        } else if (a == "--no-verify-uploads") {
+            s.server.verifyUploads = false;
+        } else if (a == "--json") {
+            s.json = true;
+        } else {
+            return false;
+        }
+    }
+    return !s.sizes.empty() && !s.concurrency.empty() && s.files > 0 && s.server.threads > 0
+        && !(s.inProcess && !s.wanScenario.isEmpty());
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    AllocTracker::install();
+    QCoreApplication app(argc, argv);
+
+    Settings settings;
+    if (!parseArgs(app.arguments(), settings)) {
+        std::fprintf(stderr,
+            "usage: transfer_bench [--sizes 16K,1M,16M] [--concurrency 1,4,16] [--files N]\n"
+            "                      [--no-verify-auth] [--no-verify-uploads] [--server-threads N]\n"
+            "                      [--wan SCENARIO.json | --in-process] [--json]\n");
+        return 2;
+    }
+
+    // the handlers log every step
+    QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    if (sodium_init() < 0)
+        return 1;
+    UiEventPump::instance();
+
+    QTemporaryDir workDir;
+    if (!workDir.isValid())
+        return 1;
+
+    MockServer server(settings.server);
+    std::string err;
+    if (settings.inProcess)
+        NetworkClient::setTransport(std::make_shared<LoopbackClient>(server));
+    else if (!server.start(err)) {
+        std::fprintf(stderr, "transfer_bench: mock server: %s\n", err.c_str());
+        return 1;
+    }
+
+    // optionally a slow, lossy link in front of the mock; TLS passes through it
+    std::unique_ptr<WanProxy> wan;
+    if (!settings.wanScenario.isEmpty()) {
+        auto scenario = WanProxy::Scenario::load(settings.wanScenario.toStdString(), err);
+        if (scenario) {
+            wan = std::make_unique<WanProxy>(*scenario);
+            if (!wan->start(0, "127.0.0.1", server.port(), err))
+                scenario.reset();
+        }
+        if (!scenario) {
+            std::fprintf(stderr, "transfer_bench: wan: %s\n", err.c_str());
+            return 1;
+        }
+    }
+
+    const QString caPath = workDir.filePath("bench_ca.pem");
+    {
+        QFile f(caPath);
+        if (!f.open(QIODevice::WriteOnly) || f.write(server.caPem().c_str()) < 0)
+            return 1;
+    }
+    auto& cfg = Config::instance();
+    cfg.serverHost = "localhost";
+    cfg.serverPort = wan ? wan->port() : server.port();
+    cfg.caBundle   = caPath.toStdString();
+    // the large cells at high concurrency queue behind each other on the mock
+    cfg.readTimeoutMs = std::chrono::milliseconds(120000);
+
+    AsioSslClient httpClient;
+    if (!settings.inProcess)
+        httpClient.init(cfg.caBundle);
+
+    // "registration": the owner logs in locally, both public bundles go to the mock
+    ClientStore store(workDir.filePath("client_store.json").toStdString());
+    store.setUserWithPassword(kOwner, "transfer-bench", KeyBundle());
+    server.addUser(kOwner, store.getUser()->publicBundle);
+    server.addUser(kRecipient, KeyBundle());
+
+    if (!settings.json) {
+        if (settings.inProcess)
+            std::printf("# server: in-process, auth checks %s, upload checks %s\n",
+                        settings.server.verifyAuth ? "on" : "off",
+                        settings.server.verifyUploads ? "on" : "off");
+        else
+            std::printf("# server: 127.0.0.1:%u, %d threads, auth checks %s, upload checks %s\n",
+                        server.port(), settings.server.threads,
+                        settings.server.verifyAuth ? "on" : "off",
+                        settings.server.verifyUploads ? "on" : "off");
+        if (wan)
+            std::printf("# wan: %s\n", wan->scenario().toJson().dump().c_str());
+        std::printf("%-9s %6s %5s %5s %5s %9s %9s %8s %8s %8s %8s %9s\n",
+                    "op", "size", "conc", "ok", "fail", "files/s", "MB/s",
+                    "p50 ms", "p90 ms", "p99 ms", "max ms", "peak MB");
+    }
+
+    for (qint64 size : settings.sizes) {
+        const QStringList inputs = writeInputFiles(workDir.path(), size, settings.files);
+        if (inputs.isEmpty()) {
+            std::fprintf(stderr, "transfer_bench: could not write %s input files\n", qPrintable(sizeLabel(size)));
+            return 1;
+        }
+        for (int conc : settings.concurrency)
+            runCell(settings, server, store, workDir.path(), inputs, size, conc);
+        for (const QString& path : inputs)
+            QFile::remove(path);
+    }
+
+    const MockServer::Stats stats = server.stats();
+    if (!settings.json) {
+        std::printf("# server: %llu requests (%llu rejected), %.1f MB in, %.1f MB out\n",
+                    static_cast<unsigned long long>(stats.requests),
+                    static_cast<unsigned long long>(stats.rejected),
+                    stats.bytesIn / (1024.0 * 1024.0), stats.bytesOut / (1024.0 * 1024.0));
+        if (wan) {
+            const WanProxy::Stats w = wan->stats();
+            std::printf("# wan: %llu connections, %llu reset, %llu stalls\n",
+                        static_cast<unsigned long long>(w.connections),
+                        static_cast<unsigned long long>(w.resets),
+                        static_cast<unsigned long long>(w.stalls));
+        }
+    }
+    if (wan)
+        wan->stop();
+    server.stop();
+    return 0;
+}
@@ -0,0 +1,393 @@
+#include "wanproxy.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <vector>
+
+namespace asio = boost::asio;
+using tcp   = boost::asio::ip::tcp;
+using json  = nlohmann::json;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+// A direction stops reading once this much is queued, so a slow link pushes back on the
+// sender like a full TCP window instead of buffering the whole transfer
+constexpr size_t kMaxQueuedBytes = 4 * 1024 * 1024;
+
+Clock::duration fromMs(double ms)
+{
+    return std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::milli>(ms));
+}
+
+bool readLink(const json& j, WanProxy::Link& link, std::string& outError)
+{
+    if (!j.is_object()) {
+        outError = "link must be an object";
+        return false;
+    }
+    link.latencyMs        = j.value("latency_ms", 0.0);
+    link.jitterMs         = j.value("jitter_ms", 0.0);
+    link.bandwidthKbps    = j.value("bandwidth_kbps", 0.0);
+    link.stallProbability = j.value("stall_probability", 0.0);
+    link.stallMs          = j.value("stall_ms", 0.0);
+    if (link.latencyMs < 0 || link.jitterMs < 0 || link.bandwidthKbps < 0 || link.stallMs < 0
+        || link.stallProbability < 0 || link.stallProbability > 1) {
+        outError = "link values must be >= 0 and probabilities <= 1";
+        return false;
+    }
+    return true;
+}
+
+json linkJson(const WanProxy::Link& link)
+{
+    return { { "latency_ms", link.latencyMs }, { "jitter_ms", link.jitterMs },
+             { "bandwidth_kbps", link.bandwidthKbps },
+             { "stall_probability", link.stallProbability }, { "stall_ms", link.stallMs } };
+}
+
+} // namespace
+
+// ── Scenario ───────────────────────────────────────────────────────────────────────
+
+std::optional<WanProxy::Scenario> WanProxy::Scenario::fromJson(const json& j, std::string& outError)
+{
+    try {
+        Scenario s;
+        s.name = j.value("name", s.name);
+        s.seed = j.value("seed", s.seed);
+        if (j.contains("up") && !readLink(j["up"], s.up, outError))
+            return std::nullopt;
+        if (j.contains("down") && !readLink(j["down"], s.down, outError))
+            return std::nullopt;
+        s.resetProbability = j.value("reset_probability", 0.0);
+        if (j.contains("reset_after_bytes")) {
+            s.resetMinBytes = j["reset_after_bytes"].at(0).get<uint64_t>();
+            s.resetMaxBytes = j["reset_after_bytes"].at(1).get<uint64_t>();
+        }
+        s.chunkBytes = j.value("chunk_bytes", s.chunkBytes);
+        if (s.resetProbability < 0 || s.resetProbability > 1 || s.resetMinBytes > s.resetMaxBytes
+            || s.chunkBytes == 0) {
+            outError = "reset_probability must be in [0, 1], reset_after_bytes [min, max], chunk_bytes > 0";
+            return std::nullopt;
+        }
+        return s;
+    } catch (const std::exception& ex) {
+        outError = ex.what();
+        return std::nullopt;
+    }
+}
+
+std::optional<WanProxy::Scenario> WanProxy::Scenario::load(const std::string& path, std::string& outError)
+{
+    std::ifstream in(path);
+    if (!in) {
+        outError = "cannot open " + path;
+        return std::nullopt;
+    }
+    json j = json::parse(in, nullptr, false);
+    if (j.is_discarded()) {
+        outError = path + " is not valid JSON";
+        return std::nullopt;
+    }
+    return fromJson(j, outError);
+}
+
+json WanProxy::Scenario::toJson() const
+{
+    return { { "name", name }, { "seed", seed }, { "up", linkJson(up) }, { "down", linkJson(down) },
+             { "reset_probability", resetProbability },
+             { "reset_after_bytes", { resetMinBytes, resetMaxBytes } }, { "chunk_bytes", chunkBytes } };
+}
+
+// ── One direction of a connection ──────────────────────────────────────────────────
+
+class WanProxy::Pipe {
+public:
+    Pipe(Connection& conn, tcp::socket& from, tcp::socket& to, const Link& link,
+         std::atomic<uint64_t>& counter)
+        : m_conn(conn), m_from(from), m_to(to), m_link(link), m_counter(counter),
+          m_timer(from.get_executor()) {}
+
+    void start();
+    void cancel() { m_timer.cancel(); }
+    bool finished() const { return m_readDone && m_queue.empty() && !m_writing; }
+
+private:
+    struct Chunk {
+        Clock::time_point       at;
+        std::vector<uint8_t>    data;
+    };
+
+    void read();
+    void enqueue(std::vector<uint8_t> data);
+    void write();
+
+    Connection&             m_conn;
+    tcp::socket&            m_from;
+    tcp::socket&            m_to;
+    const Link&             m_link;
+    std::atomic<uint64_t>&  m_counter;
+    asio::steady_timer      m_timer;
+
+    std::deque<Chunk>       m_queue;
+    size_t                  m_queuedBytes = 0;
+    Clock::time_point       m_linkFree{};       // when the link finishes sending what it has
+    Clock::time_point       m_lastDelivery{};
+    bool                    m_reading = false;
+    bool                    m_readDone = false;
+    bool                    m_writing = false;
+};
+
+class WanProxy::Connection : public std::enable_shared_from_this<Connection> {
+public:
+    Connection(WanProxy& proxy, tcp::socket client, uint64_t index)
+        : m_proxy(proxy), m_client(std::move(client)), m_server(proxy.m_io), m_timer(proxy.m_io),
+          m_rng(proxy.m_scenario.seed ^ (index * 0x9E3779B97F4A7C15ull)),
+          m_up(*this, m_client, m_server, proxy.m_scenario.up, proxy.m_bytesUp),
+          m_down(*this, m_server, m_client, proxy.m_scenario.down, proxy.m_bytesDown)
+    {
+        const Scenario& s = proxy.m_scenario;
+        if (std::bernoulli_distribution(s.resetProbability)(m_rng))
+            m_resetAfter = std::uniform_int_distribution<uint64_t>(s.resetMinBytes, s.resetMaxBytes)(m_rng);
+    }
+
+    void start()
+    {
+        // the SYN / SYN-ACK round trip before the server sees the connection
+        const Scenario& s = m_proxy.m_scenario;
+        m_timer.expires_after(fromMs(s.up.latencyMs + s.down.latencyMs));
+        m_timer.async_wait([self = shared_from_this()](const boost::system::error_code& ec) {
+            if (ec)
+                return self->close();
+            asio::async_connect(self->m_server, self->m_proxy.m_target,
+                [self](const boost::system::error_code& ec, const tcp::endpoint&) {
+                    if (ec)
+                        return self->close();
+                    boost::system::error_code ignored;
+                    self->m_server.set_option(tcp::no_delay(true), ignored);
+                    self->m_up.start();
+                    self->m_down.start();
+                });
+        });
+    }
+
+    std::shared_ptr<Connection> ref() { return shared_from_this(); }
+    std::mt19937_64& rng() { return m_rng; }
+    WanProxy& proxy() { return m_proxy; }
+
+    // Counts forwarded bytes; true if the scenario cut the connection here
+    bool forwarded(size_t n)
+    {
+        m_forwarded += n;
+        if (m_resetAfter && m_forwarded >= *m_resetAfter) {
+            ++m_proxy.m_resets;
+            reset();
+            return true;
+        }
+        return false;
+    }
+
+    // One direction is done; the connection goes once both are
+    void pipeFinished()
+    {
+        if (m_up.finished() && m_down.finished())
+            close();
+    }
+
+    void reset()
+    {
+        // linger 0 turns the close into an RST on both sides
+        boost::system::error_code ignored;
+        m_client.set_option(asio::socket_base::linger(true, 0), ignored);
+        m_server.set_option(asio::socket_base::linger(true, 0), ignored);
+        close();
+    }
+
+    void close()
+    {
+        if (m_closed)
+            return;
+        m_closed = true;
+        boost::system::error_code ignored;
+        m_timer.cancel();
+        m_up.cancel();
+        m_down.cancel();
+        m_client.close(ignored);
+        m_server.close(ignored);
+    }
+
+    bool closed() const { return m_closed; }
+
+private:
+    WanProxy&               m_proxy;
+    tcp::socket             m_client;
+    tcp::socket             m_server;
+    asio::steady_timer      m_timer;
+    std::mt19937_64         m_rng;
+    Pipe                    m_up;
+    Pipe                    m_down;
+    std::optional<uint64_t> m_resetAfter;
+    uint64_t                m_forwarded = 0;
+    bool                    m_closed = false;
+};
+
+void WanProxy::Pipe::start()
+{
+    read();
+}
+
+void WanProxy::Pipe::read()
+{
+    if (m_reading || m_readDone || m_conn.closed() || m_queuedBytes >= kMaxQueuedBytes)
+        return;
+    m_reading = true;
+    auto buf = std::make_shared<std::vector<uint8_t>>(m_conn.proxy().m_scenario.chunkBytes);
+    m_from.async_read_some(asio::buffer(*buf),
+        [this, self = m_conn.ref(), buf](const boost::system::error_code& ec, size_t n) {
+            m_reading = false;
+            if (m_conn.closed())
+                return;
+            if (n > 0) {
+                buf->resize(n);
+                enqueue(std::move(*buf));
+            }
+            if (ec && ec != asio::error::eof)
+                return m_conn.close();
+            if (ec) {
+                // send what is queued, then pass the half-close on
+                m_readDone = true;
+                write();
+                return;
+            }
+            read();
+        });
+}
+
+void WanProxy::Pipe::enqueue(std::vector<uint8_t> data)
+{
+    const Clock::time_point now = Clock::now();
+
+    // serialisation at the link rate, one chunk after the other
+    Clock::time_point sent = std::max(now, m_linkFree);
+    if (m_link.bandwidthKbps > 0)
+        sent += fromMs(data.size() * 8.0 / m_link.bandwidthKbps);
+    m_linkFree = sent;
+
+    double delayMs = m_link.latencyMs;
+    if (m_link.jitterMs > 0)
+        delayMs += std::uniform_real_distribution<double>(-m_link.jitterMs, m_link.jitterMs)(m_conn.rng());
+    Clock::time_point at = sent + fromMs(std::max(0.0, delayMs));
+
+    // a "lost" chunk holds up everything behind it until it is resent
+    if (m_link.stallProbability > 0 && std::bernoulli_distribution(m_link.stallProbability)(m_conn.rng())) {
+        at += fromMs(m_link.stallMs);
+        ++m_conn.proxy().m_stalls;
+    }
+    at = std::max(at, m_lastDelivery);
+    m_lastDelivery = at;
+
+    m_queuedBytes += data.size();
+    m_queue.push_back({ at, std::move(data) });
+    write();
+}
+
+void WanProxy::Pipe::write()
+{
+    if (m_writing || m_conn.closed())
+        return;
+    if (m_queue.empty()) {
+        if (m_readDone) {
+            boost::system::error_code ignored;
+            m_to.shutdown(tcp::socket::shutdown_send, ignored);
+            m_conn.pipeFinished();
+        }
+        return;
+    }
+
+    m_writing = true;
+    m_timer.expires_at(m_queue.front().at);
+    m_timer.async_wait([this, self = m_conn.ref()](const boost::system::error_code& ec) {
+        if (ec || m_conn.closed())
+            return;
+        asio::async_write(m_to, asio::buffer(m_queue.front().data),
+            [this, self](const boost::system::error_code& ec, size_t n) {
+                m_writing = false;
+                if (ec)
+                    return m_conn.close();
+                m_counter += n;
+                m_queuedBytes -= m_queue.front().data.size();
+                m_queue.pop_front();
+                if (m_conn.forwarded(n))
+                    return;
+                read();     // in case the queue had filled up
+                write();
+            });
+    });
+}
+
+// ── Proxy ──────────────────────────────────────────────────────────────────────────
+
+WanProxy::WanProxy(Scenario scenario)
+    : m_scenario(std::move(scenario)), m_acceptor(m_io)
+{
+}
+
+WanProxy::~WanProxy()
+{
+    stop();
+}
+
+bool WanProxy::start(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort,
+                     std::string& outError)
+{
+    boost::system::error_code ec;
+    tcp::resolver resolver(m_io);
+    m_target = resolver.resolve(targetHost, std::to_string(targetPort), ec);
+    if (ec) {
+        outError = "resolve " + targetHost + ": " + ec.message();
+        return false;
+    }
+
+    const tcp::endpoint endpoint(asio::ip::make_address("127.0.0.1"), listenPort);
+    m_acceptor.open(endpoint.protocol(), ec);
+    if (!ec) m_acceptor.set_option(asio::socket_base::reuse_address(true), ec);
+    if (!ec) m_acceptor.bind(endpoint, ec);
+    if (!ec) m_acceptor.listen(asio::socket_base::max_listen_connections, ec);
+    if (ec) {
+        outError = "listen: " + ec.message();
+        return false;
+    }
+    m_port = m_acceptor.local_endpoint().port();
+
+    accept();
+    m_thread = std::thread([this]() { m_io.run(); });
+    return true;
+}
+
+void WanProxy::stop()
+{
+    m_io.stop();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void WanProxy::accept()
+{
+    m_acceptor.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (ec)
+            return;
+        ++m_connections;
+        boost::system::error_code ignored;
+        socket.set_option(tcp::no_delay(true), ignored);
+        std::make_shared<Connection>(*this, std::move(socket), m_nextConnection++)->start();
+        accept();
+    });
+}
+
+WanProxy::Stats WanProxy::stats() const
+{
+    return { m_connections.load(), m_resets.load(), m_stalls.load(), m_bytesUp.load(), m_bytesDown.load() };
+}
@@ -0,0 +1,110 @@
+#pragma once
+#include <boost/asio.hpp>
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+
+/**
+ * WanProxy – a local TCP proxy that makes loopback behave like a long, lossy link.
+ *
+ * Every accepted connection is piped to the target (the mock server, a local Bun
+ * server, …) with each direction shaped independently:
+ *
+ *   latency + jitter   each chunk is delivered latency ± jitter after it was read,
+ *                      never before the chunk ahead of it (TCP stays in order)
+ *   bandwidth          chunks queue behind each other at the link rate
+ *   stalls             with some probability a chunk, and everything behind it, is held
+ *                      for an extra while — what a lost segment and its retransmission
+ *                      timeout look like to the application
+ *   resets             a connection may be cut (RST) after a random number of bytes
+ *
+ * Opening a connection costs one round trip (up + down latency) before the target sees
+ * it. TLS passes through untouched, so certificates and hostname checks still apply.
+ *
+ * A Scenario comes from a JSON file (bench/scenarios/): the seed makes a run
+ * reproducible — connection n always draws the same delays, stalls and reset point.
+ *
+ *   {
+ *     "name": "transatlantic-lossy",
+ *     "seed": 7,
+ *     "up":   { "latency_ms": 90, "jitter_ms": 15, "bandwidth_kbps": 20000,
+ *               "stall_probability": 0.005, "stall_ms": 400 },
+ *     "down": { ... same keys ... },
+ *     "reset_probability": 0.02, "reset_after_bytes": [ 4096, 4194304 ],
+ *     "chunk_bytes": 16384
+ *   }
+ *
+ * Omitted keys mean "no effect". "up" is client → server.
+ */
+class WanProxy {
+public:
+    struct Link {
+        double      latencyMs        = 0;
+        double      jitterMs         = 0;
+        double      bandwidthKbps    = 0;       // 0 = unlimited
+        double      stallProbability = 0;       // per chunk
+        double      stallMs          = 0;
+    };
+
+    struct Scenario {
+        std::string name = "passthrough";
+        uint64_t    seed = 1;
+        Link        up;
+        Link        down;
+        double      resetProbability = 0;       // per connection
+        uint64_t    resetMinBytes    = 0;
+        uint64_t    resetMaxBytes    = 0;
+        size_t      chunkBytes       = 16 * 1024;
+
+        static std::optional<Scenario> fromJson(const nlohmann::json& j, std::string& outError);
+        static std::optional<Scenario> load(const std::string& path, std::string& outError);
+        nlohmann::json toJson() const;
+    };
+
+    struct Stats {
+        uint64_t    connections = 0;
+        uint64_t    resets      = 0;        // cut by the scenario
+        uint64_t    stalls      = 0;
+        uint64_t    bytesUp     = 0;
+        uint64_t    bytesDown   = 0;
+    };
+
+    explicit WanProxy(Scenario scenario);
+    ~WanProxy();
+
+    WanProxy(const WanProxy&) = delete;
+    WanProxy& operator=(const WanProxy&) = delete;
+
+    /** Listens on 127.0.0.1:listenPort (0 = any free port) and forwards to target */
+    bool start(uint16_t listenPort, const std::string& targetHost, uint16_t targetPort,
+               std::string& outError);
+    void stop();
+
+    uint16_t port() const { return m_port; }
+    const Scenario& scenario() const { return m_scenario; }
+    Stats stats() const;
+
+private:
+    class Connection;
+    class Pipe;
+
+    void accept();
+
+    Scenario                                m_scenario;
+    boost::asio::io_context                 m_io;
+    boost::asio::ip::tcp::acceptor          m_acceptor;
+    boost::asio::ip::tcp::resolver::results_type m_target;
+    std::thread                             m_thread;
+    uint16_t                                m_port = 0;
+    uint64_t                                m_nextConnection = 0;   // io thread only
+
+    std::atomic<uint64_t>                   m_connections{0};
+    std::atomic<uint64_t>                   m_resets{0};
+    std::atomic<uint64_t>                   m_stalls{0};
+    std::atomic<uint64_t>                   m_bytesUp{0};
+    std::atomic<uint64_t>                   m_bytesDown{0};
+};
@@ -0,0 +1,105 @@
+// wanproxy – standalone WAN-conditions proxy (see wanproxy.h), for putting a slow,
+// lossy link between any client (qt_client, ssshare-cli, loadgen) and a local server:
+//
+//   ./wanproxy --listen 8443 --target localhost:3000 --scenario bench/scenarios/transatlantic_lossy.json
+//
+// then point the client at localhost:8443. Ctrl-C stops it and prints the totals.
+
+#include "wanproxy.h"
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <thread>
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+void onSignal(int)
+{
+    g_stop = 1;
+}
+
+void printStats(const WanProxy::Stats& s)
+{
+    std::fprintf(stderr, "wanproxy: %llu connections, %llu reset, %llu stalls, %.1f MB up, %.1f MB down\n",
+                 static_cast<unsigned long long>(s.connections), static_cast<unsigned long long>(s.resets),
+                 static_cast<unsigned long long>(s.stalls), s.bytesUp / 1048576.0, s.bytesDown / 1048576.0);
+}
+
+int usage()
+{
+    std::fprintf(stderr,
+        "usage: wanproxy --target HOST:PORT [--listen PORT] [--scenario FILE] [--stats-every S]\n"
+        "  --listen PORT       local port on 127.0.0.1 (default: any free port, printed)\n"
+        "  --scenario FILE     JSON scenario; without one the proxy only forwards\n"
+        "  --stats-every S     print counters every S seconds\n");
+    return 2;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::string targetHost, scenarioPath;
+    int targetPort = 0, listenPort = 0, statsEvery = 0;
+
+    for (int i = 1; i < argc; ++i) {
+        const bool hasValue = i + 1 < argc;
+        if (std::strcmp(argv[i], "--target") == 0 && hasValue) {
+            const std::string t = argv[++i];
+            const size_t colon = t.rfind(':');
+            if (colon == std::string::npos)
+                return usage();
+            targetHost = t.substr(0, colon);
+            targetPort = std::atoi(t.c_str() + colon + 1);
+        } else if (std::strcmp(argv[i], "--listen") == 0 && hasValue) {
+            listenPort = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--scenario") == 0 && hasValue) {
+            scenarioPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--stats-every") == 0 && hasValue) {
+            statsEvery = std::atoi(argv[++i]);
+        } else {
+            return usage();
+        }
+    }
+    if (targetHost.empty() || targetPort <= 0 || targetPort > 65535 || listenPort < 0 || listenPort > 65535)
+        return usage();
+
+    WanProxy::Scenario scenario;
+    std::string err;
+    if (!scenarioPath.empty()) {
+        auto loaded = WanProxy::Scenario::load(scenarioPath, err);
+        if (!loaded) {
+            std::fprintf(stderr, "wanproxy: %s\n", err.c_str());
+            return 2;
+        }
+        scenario = *loaded;
+    }
+
+    WanProxy proxy(scenario);
+    if (!proxy.start(static_cast<uint16_t>(listenPort), targetHost, static_cast<uint16_t>(targetPort), err)) {
+        std::fprintf(stderr, "wanproxy: %s\n", err.c_str());
+        return 1;
+    }
+    std::printf("wanproxy: 127.0.0.1:%u -> %s:%d, scenario %s\n%s\n", proxy.port(), targetHost.c_str(),
+                targetPort, scenario.name.c_str(), scenario.toJson().dump().c_str());
+    std::fflush(stdout);
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+    auto lastStats = std::chrono::steady_clock::now();
+    while (!g_stop) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        if (statsEvery > 0 && std::chrono::steady_clock::now() - lastStats >= std::chrono::seconds(statsEvery)) {
+            lastStats = std::chrono::steady_clock::now();
+            printStats(proxy.stats());
+        }
+    }
+    proxy.stop();
+    printStats(proxy.stats());
+    return 0;
+}
@@ -46,6 +46,36 @@ Rectangle {
                 background: null
                 font.pixelSize: 14
                 // no explicit height here
+
+                // filters the table locally via the trigram index; no server round trip
+                onTextChanged: {
+                    if (fileListHandler)
+                        fileListHandler.view.searchText = text
+                }
+            }
+        }
+
+        // — Sort selector: re-sorts the view locally —
+        ComboBox {
+            id: sortBox
+            Layout.preferredWidth: 170
+            Layout.preferredHeight: 40
+            Layout.alignment: Qt.AlignVCenter
+            textRole: "text"
+            model: [
+                { text: qsTr("Newest first"),  key: "modified", asc: false },
+                { text: qsTr("Oldest first"),  key: "modified", asc: true  },
+                { text: qsTr("Name A–Z"),      key: "name",     asc: true  },
+                { text: qsTr("Name Z–A"),      key: "name",     asc: false },
+                { text: qsTr("Largest first"), key: "size",     asc: false },
+                { text: qsTr("Smallest first"),key: "size",     asc: true  }
+            ]
+            onActivated: function(index) {
+                if (!fileListHandler)
+                    return
+                var choice = model[index]
+                fileListHandler.view.sortKey = choice.key
+                fileListHandler.view.sortAscending = choice.asc
             }
         }
 
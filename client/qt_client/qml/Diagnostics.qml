@@ -0,0 +1,109 @@
+import QtQuick 2.15
+import QtQuick.Controls 2.15
+import QtQuick.Controls.Material 2.15
+import QtQuick.Layouts 1.15
+
+// Hidden diagnostics page (Ctrl+Shift+D in Main.qml): live view of the metrics registry
+Dialog {
+    id: diagDialog
+    modal: true
+    standardButtons: Dialog.NoButton
+    anchors.centerIn: parent
+    width: Math.min(parent ? parent.width - 48 : 860, 860)
+    height: parent ? parent.height - 48 : 480
+
+    property var metricRows: []
+
+    function refresh() {
+        if (typeof diagnostics !== "undefined")
+            metricRows = diagnostics.rows()
+    }
+
+    onOpened: refresh()
+
+    // the registry is cheap to read; poll only while the page is up
+    Timer {
+        interval: 1000
+        repeat: true
+        running: diagDialog.visible
+        onTriggered: diagDialog.refresh()
+    }
+
+    background: Rectangle {
+        color: "white"
+        radius: 12
+    }
+
+    contentItem: ColumnLayout {
+        spacing: 12
+
+        RowLayout {
+            Layout.fillWidth: true
+
+            Label {
+                text: qsTr("Diagnostics")
+                font.pixelSize: 20
+                Layout.fillWidth: true
+            }
+            Button {
+                text: qsTr("Write snapshot")
+                flat: true
+                onClicked: statusLabel.text = diagnostics.dumpNow()
+                           ? qsTr("Wrote %1").arg(diagnostics.dumpPath)
+                           : qsTr("Could not write %1").arg(diagnostics.dumpPath)
+            }
+            Button {
+                text: qsTr("Close")
+                flat: true
+                onClicked: diagDialog.close()
+            }
+        }
+
+        ListView {
+            id: metricList
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+            model: diagDialog.metricRows
+            ScrollBar.vertical: ScrollBar {}
+
+            section.property: "section"
+            section.delegate: Label {
+                text: section
+                font.bold: true
+                topPadding: 8
+                bottomPadding: 4
+                color: Material.color(Material.DeepPurple)
+            }
+
+            delegate: RowLayout {
+                width: metricList.width
+                spacing: 16
+
+                Label {
+                    text: modelData.name
+                    font.family: "monospace"
+                    font.pixelSize: 12
+                    Layout.preferredWidth: 260
+                    elide: Text.ElideRight
+                }
+                Label {
+                    text: modelData.value
+                    font.family: "monospace"
+                    font.pixelSize: 12
+                    Layout.fillWidth: true
+                    elide: Text.ElideRight
+                }
+            }
+        }
+
+        Label {
+            id: statusLabel
+            Layout.fillWidth: true
+            color: "#666666"
+            font.pixelSize: 12
+            text: qsTr("Also written every minute to %1").arg(diagnostics.dumpPath)
+            elide: Text.ElideMiddle
+        }
+    }
+}
@@ -38,6 +38,7 @@ Item {
     }
 
     property int fileId: -1
+    property bool selected: false
     property alias fileName: nameLabel.text
     property alias fileSize: sizeLabel.text
 
@@ -45,6 +46,7 @@ Item {
         signal shareRequested(int fileId, string shareToUser)
         signal deleteRequested(int fileId)
         signal revokeRequested(int fileId, string revokeFromUser)
+        signal selectionToggled(int fileId, bool checked)
 
         Rectangle {
             anchors.fill: parent
@@ -63,6 +65,13 @@ Item {
             anchors.margins: 8
             spacing: 12
 
+            // 0) Multi-select checkbox
+            CheckBox {
+                checked: root.selected
+                Layout.alignment: Qt.AlignVCenter
+                onToggled: selectionToggled(root.fileId, checked)
+            }
+
             // 1) File‐type Icon
             Label {
                 text: fileIcon
@@ -357,7 +366,8 @@ Item {
                     Layout.preferredHeight: 40
                     Layout.preferredWidth: (revokeField.width - 12) / 2
                     onClicked: {
-                        revokeRequested(revokeField.text)
+                        if (revokeField.text.length === 0) return;
+                        revokeRequested(root.fileId, revokeField.text)
                         revokeField.text = ""
                         revokeDialog.close()
                     }
@@ -11,49 +11,88 @@ Item {
     height: "parent" in root ? root.parent.height : 480
 
     // ─────────────────────────────────────────
-    // Our dynamic ListModel, cleared + repopulated on filesLoaded(...)
+    // Rows come from fileListHandler.view: the C++ FileListModel filtered by
+    // the search box. Roles:
+    //    file_id, name, size, modified, is_owner, is_shared, shared_from
+    // The handler applies row-level diffs, so only changed delegates rebuild.
     // ─────────────────────────────────────────
-    ListModel {
-        id: fileModel
-        // Each element will hold:
-        //    file_id  (int)
-        //    name     (string)
-        //    size     (string)
-        //    modified (QDateTime as string, or displayable text)
-        //    is_owner (bool)
-        //    is_shared (bool)
-        //    shared_from (string)
-    }
+    property var fileModel: fileListHandler ? fileListHandler.view : null
 
     // ─────────────────────────────────────────
-    // Listen for the C++ signal “filesLoaded” and update `fileModel`
+    // Multi-select: file_id → true. Reassigned (never mutated in place) so
+    // delegate bindings on it re-evaluate.
     // ─────────────────────────────────────────
+    property var selectedIds: ({})
+    property int selectedCount: 0
+
+    // Running bulk delete / revoke; progress arrives at most once a frame
+    property string bulkLabel: ""
+    property int bulkDone: 0
+    property int bulkTotal: 0
+
+    function showProgress(label, done, total) {
+        bulkLabel = label
+        bulkDone = done
+        bulkTotal = total
+    }
+
+    function setSelected(fileId, checked) {
+        var next = Object.assign({}, selectedIds)
+        if (checked)
+            next[fileId] = true
+        else
+            delete next[fileId]
+        selectedIds = next
+        selectedCount = Object.keys(next).length
+    }
+
+    function selectAllVisible() {
+        var next = {}
+        var ids = fileModel ? fileModel.fileIds() : []
+        for (var i = 0; i < ids.length; ++i)
+            next[ids[i]] = true
+        selectedIds = next
+        selectedCount = ids.length
+    }
+
+    function clearSelection() {
+        selectedIds = ({})
+        selectedCount = 0
+    }
+
+    function deleteSelected() {
+        var ids = Object.keys(selectedIds).map(function(k) { return Number(k) })
+        clearSelection()
+        // rows disappear at once; any that fail to delete come back on their own
+        fileListHandler.deleteFiles(ids)
+    }
+
     Connections {
         target: fileListHandler   // fileListHandler was registered in main.cpp
-        onFilesLoaded: {
-            fileModel.clear()
-            for (var i = 0; i < decryptedFiles.length; ++i) {
-                var f = decryptedFiles[i]
-                // decryptedFiles[i] is a QVariantMap with keys:
-                //   file_id, filename, size, modified (QDateTime), is_owner, is_shared, shared_from
-                fileModel.append({
-                    "file_id":    f.file_id,
-                    "name":       f.filename,
-                    "size":       f.size,
-                    "modified":   f.modified.toString(Qt.ISODate),
-                                 // or format as you like
-                    "is_owner":   f.is_owner,
-                    "is_shared":  f.is_shared,
-                    "shared_from":f.shared_from
-                })
-            }
-        }
         onErrorOccurred: {
             // If you want to show an error popup:
             console.error("Error retrieving file list: " + message)
         }
     }
 
+    Connections {
+        target: fileListHandler
+        onDeleteFailed: console.warn("Delete failed for file", fileId + ":", message)
+        onDeleteProgress: showProgress(qsTr("Deleting"), done, total)
+        onDeleteResult: bulkTotal = 0
+    }
+
+    Connections {
+        target: shareHandler
+        onRevokeItemResult: {
+            if (status === "failed")
+                console.warn("Revoke failed for file", fileId, "user", username + ":", message)
+        }
+        onRevokeResult: console.log("Revoke:", title, message)
+        onRevokeProgress: showProgress(qsTr("Revoking"), done, total)
+        onRevokeFinished: bulkTotal = 0
+    }
+
     Connections {
         target: downloadHandler
         onFileReady: console.log("File", fileName, "written to Downloads")
@@ -66,15 +105,114 @@ Item {
             font.pixelSize: 18
             color: "#666666"
             anchors.centerIn: parent
-            visible: fileModel.count === 0
+            visible: !fileModel || fileModel.count === 0
         }
 
     // ─────────────────────────────────────────
     // ListView that uses our “fileModel” and FileRow delegate
     // ─────────────────────────────────────────
+    // Selection bar, only while something is selected
+    Rectangle {
+        id: selectionBar
+        anchors.top: parent.top
+        anchors.left: parent.left
+        anchors.right: parent.right
+        height: selectedCount > 0 ? 44 : 0
+        visible: selectedCount > 0
+        color: Material.color(Material.DeepPurple, Material.Shade50)
+
+        RowLayout {
+            anchors.fill: parent
+            anchors.leftMargin: 12
+            anchors.rightMargin: 12
+            spacing: 12
+
+            Label {
+                text: qsTr("%1 selected").arg(selectedCount)
+                font.pixelSize: 14
+                Layout.alignment: Qt.AlignVCenter
+            }
+
+            Item { Layout.fillWidth: true }
+
+            Button {
+                text: qsTr("Select all")
+                flat: true
+                onClicked: selectAllVisible()
+            }
+
+            Button {
+                text: qsTr("Clear")
+                flat: true
+                onClicked: clearSelection()
+            }
+
+            Button {
+                text: qsTr("Revoke user…")
+                flat: true
+                onClicked: revokeSelectedDialog.open()
+            }
+
+            Button {
+                text: qsTr("Delete selected")
+                Layout.preferredHeight: 32
+                onClicked: deleteSelected()
+
+                background: Rectangle {
+                    anchors.fill: parent
+                    radius: height / 2
+                    color: "#E53935"
+                }
+                contentItem: Label {
+                    text: parent.text
+                    color: "white"
+                    horizontalAlignment: Text.AlignHCenter
+                    verticalAlignment: Text.AlignVCenter
+                    font.pixelSize: 12
+                }
+            }
+        }
+    }
+
+    // Bulk job progress, only while one is running
+    Rectangle {
+        id: bulkBar
+        anchors.top: selectionBar.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        height: bulkTotal > 0 ? 32 : 0
+        visible: bulkTotal > 0
+        color: "transparent"
+
+        RowLayout {
+            anchors.fill: parent
+            anchors.leftMargin: 12
+            anchors.rightMargin: 12
+            spacing: 12
+
+            Label {
+                text: qsTr("%1 %2 of %3…").arg(bulkLabel).arg(bulkDone).arg(bulkTotal)
+                font.pixelSize: 12
+                color: "#666666"
+                Layout.alignment: Qt.AlignVCenter
+            }
+
+            ProgressBar {
+                from: 0
+                to: Math.max(1, bulkTotal)
+                value: bulkDone
+                Layout.fillWidth: true
+                Layout.alignment: Qt.AlignVCenter
+            }
+        }
+    }
+
     ListView {
         id: fileListView
-        anchors.fill: parent
+        anchors.top: bulkBar.bottom
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.bottom: parent.bottom
         spacing: 2
         model: fileModel
         clip: true
@@ -83,6 +221,15 @@ Item {
             fileId: file_id             // pass model’s file_id into FileRow.fileId
             fileName: name              // model.name
             fileSize: size              // model.size
+            selected: root.selectedIds[file_id] === true
+
+            onSelectionToggled: function(theFileId, checked) {
+                root.setSelected(theFileId, checked)
+            }
+            onRevokeRequested: function(theFileId, revokeFromUser) {
+                console.log("QML → revokeRequested(" + theFileId + ", " + revokeFromUser + ")")
+                shareHandler.revokeAccess(theFileId, revokeFromUser)
+            }
 
             // Wire up the row’s signals to C++ (or JS) slots:
             onDownloadRequested: function(theFileId) {
@@ -101,4 +248,59 @@ Item {
 
         }
     }
+
+    // Offboarding: revoke one user from every selected file in one batch
+    Dialog {
+        id: revokeSelectedDialog
+        modal: true
+        anchors.centerIn: parent
+        standardButtons: Dialog.NoButton
+        width: 320
+
+        background: Rectangle {
+            anchors.fill: parent
+            color: "white"
+            radius: 12
+        }
+
+        contentItem: ColumnLayout {
+            anchors.fill: parent
+            anchors.margins: 16
+            spacing: 16
+
+            Label {
+                text: qsTr("Revoke a user from %1 file(s)").arg(selectedCount)
+                font.pixelSize: 18
+                horizontalAlignment: Text.AlignHCenter
+                Layout.alignment: Qt.AlignHCenter
+            }
+
+            TextField {
+                id: revokeUserField
+                placeholderText: qsTr("Username")
+                Layout.fillWidth: true
+                font.pixelSize: 14
+            }
+
+            RowLayout {
+                spacing: 12
+                Layout.alignment: Qt.AlignHCenter
+
+                Button {
+                    text: qsTr("Revoke")
+                    onClicked: {
+                        if (revokeUserField.text.length === 0) return;
+                        var ids = Object.keys(selectedIds).map(function(k) { return Number(k) })
+                        shareHandler.revokeUserFromFiles(revokeUserField.text, ids)
+                        revokeUserField.text = ""
+                        revokeSelectedDialog.close()
+                    }
+                }
+                Button {
+                    text: qsTr("Cancel")
+                    onClicked: revokeSelectedDialog.close()
+                }
+            }
+        }
+    }
 }
@@ -173,6 +173,8 @@ Item {
         function onUploadResult(title, message) {
             console.log("UploadHandler says:", title, message)
             // (You could pop up a MessageDialog here if you like.)
+            if (title === "Success")
+                fileListHandler.syncChanges()
         }
     }
 }
@@ -43,4 +43,15 @@ ApplicationWindow {
                 ? "qrc:/qml/Login.qml"
                 : "qrc:/qml/Register.qml"
     }
+
+    // hidden: not in any menu
+    Diagnostics {
+        id: diagnosticsPage
+    }
+
+    Shortcut {
+        sequence: "Ctrl+Shift+D"
+        context: Qt.ApplicationShortcut
+        onActivated: diagnosticsPage.visible ? diagnosticsPage.close() : diagnosticsPage.open()
+    }
 }
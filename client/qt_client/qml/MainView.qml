@@ -15,8 +15,8 @@ Item {                      //  ◄── was ApplicationWindow
     Material.accent: Material.DeepPurple
 
     Component.onCompleted: {
-            console.log("MainView: calling listAllFiles(1) right after login")
-            fileListHandler.listAllFiles(1)
+            console.log("MainView: syncing file listing right after login")
+            fileListHandler.syncChanges()
         }
 
 
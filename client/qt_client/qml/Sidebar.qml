@@ -77,17 +77,17 @@ Rectangle {
                     cursorShape: Qt.PointingHandCursor
 
                     onClicked: {
+                        // ownership is a local filter on the synced listing; no refetch
                         if (labelText === "All files") {
-                            console.log("Requesting ALL files (page 1)…")
-                            fileListHandler.listAllFiles(1)
+                            console.log("Syncing ALL files…")
+                            fileListHandler.view.ownership = "all"
+                            fileListHandler.syncChanges()
                         }
                         else if (labelText === "My files") {
-                            console.log("Requesting MY files (page 1)…")
-                            fileListHandler.listOwnedFiles(1)
+                            fileListHandler.view.ownership = "owned"
                         }
                         else if (labelText === "Shared with me") {
-                            console.log("Requesting SHARED files (page 1)…")
-                            fileListHandler.listSharedFiles(1)
+                            fileListHandler.view.ownership = "shared"
                         }
                     }
                 }
@@ -109,19 +109,7 @@ Rectangle {
         target: fileListHandler
 
         onFilesLoaded: {
-            console.log("=== filesLoaded signal received ===")
-            for (var i = 0; i < decryptedFiles.length; ++i) {
-                var f = decryptedFiles[i]
-                console.log(
-                    " • id=" + f.file_id
-                  + ", name=\"" + f.filename + "\""
-                  + ", size=" + f.size
-                  + ", modified=" + f.modified.toString()
-                  + ", owner?=" + f.is_owner
-                  + ", shared?=" + f.is_shared
-                  + ", shared_from=" + f.shared_from
-                )
-            }
+            console.log("=== filesLoaded: " + fileCount + " files in the table ===")
         }
 
         onErrorOccurred: {
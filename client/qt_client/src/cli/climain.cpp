@@ -0,0 +1,171 @@
+// ssshare-cli – headless front-end for scripted bulk transfers; see clirunner.h
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QTextStream>
+#include <QTimer>
+#include <cstdio>
+
+#include "clirunner.h"
+#include "../daemon/daemonclient.h"
+#include "../handlers/LoginHandler.h"
+#include "../config.h"
+#include "../utils/clientstore.h"
+#include "../utils/uieventpump.h"
+#include "../utils/tracing.h"
+#include "../utils/alloctracker.h"
+#include "../utils/networking/asiosslclient.h"
+
+static QString defaultStorePath() {
+#ifdef Q_OS_WIN
+    return QDir::homePath() + "/AppData/Roaming/.ssshare/client_store.json";
+#else
+    return QDir::homePath() + "/.ssshare/client_store.json";
+#endif
+}
+
+// --password-file, then $SSSHARE_PASSWORD, then one line on stdin
+static QString readPassword(const QString& passwordFile)
+{
+    if (!passwordFile.isEmpty()) {
+        QFile f(passwordFile);
+        if (!f.open(QIODevice::ReadOnly | QIODevice::Text))
+            return {};
+        return QString::fromUtf8(f.readLine()).trimmed();
+    }
+    if (qEnvironmentVariableIsSet("SSSHARE_PASSWORD"))
+        return qEnvironmentVariable("SSSHARE_PASSWORD");
+    return QTextStream(stdin).readLine();
+}
+
+// how long to wait for an ssshared that is already listening
+static constexpr int kDaemonConnectMs = 200;
+
+static int usageError(const QCommandLineParser& parser, const QString& message)
+{
+    std::fprintf(stderr, "ssshare-cli: %s\n\n%s", qPrintable(message), qPrintable(parser.helpText()));
+    return 2;
+}
+
+int main(int argc, char *argv[])
+{
+    // no-op unless built with QT_CLIENT_ALLOC_TRACKING
+    AllocTracker::install();
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ssshare-cli");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Scripted access to ssshare.\n\n"
+        "  upload FILE...               encrypt and upload files\n"
+        "  download FILE_ID...          download and decrypt into --out (default: Downloads)\n"
+        "  list                         print the file listing\n"
+        "  share USER FILE_ID...        share files with USER\n"
+        "  revoke USER FILE_ID...       revoke USER's access to files\n\n"
+        "Results go to stdout one line per item; exit status is 0 if every item succeeded,\n"
+        "1 if any failed and 2 on a usage or login error.");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "upload | download | list | share | revoke");
+    parser.addPositionalArgument("args", "Files, file ids or USER FILE_ID...", "[args...]");
+
+    const QCommandLineOption userOpt({ "u", "user" }, "Account to log in as (default: $SSSHARE_USER).", "name");
+    const QCommandLineOption passwordFileOpt("password-file",
+        "Read the password from the first line of file (default: $SSSHARE_PASSWORD, else stdin).", "file");
+    const QCommandLineOption jobsOpt({ "j", "jobs" }, "Items in flight at once (default 4).", "n", "4");
+    const QCommandLineOption outOpt({ "o", "out" }, "Download destination directory.", "dir");
+    const QCommandLineOption jsonOpt("json", "One JSON object per line, then a summary object.");
+    const QCommandLineOption storeOpt("store", "ClientStore file (default: the GUI's).", "path");
+    const QCommandLineOption verboseOpt({ "v", "verbose" }, "Log handler activity to stderr.");
+    parser.addOptions({ userOpt, passwordFileOpt, jobsOpt, outOpt, jsonOpt, storeOpt, verboseOpt });
+    parser.process(app);
+
+    // the handlers log every step; stdout stays results-only, stderr warnings-only
+    if (!parser.isSet(verboseOpt))
+        QLoggingCategory::setFilterRules("*.debug=false\n*.info=false");
+
+    CliRunner::Options options;
+    QStringList args = parser.positionalArguments();
+    if (args.isEmpty())
+        return usageError(parser, "missing command");
+    const QString command = args.takeFirst();
+
+    if (command == "upload")        options.command = CliRunner::Command::Upload;
+    else if (command == "download") options.command = CliRunner::Command::Download;
+    else if (command == "list")     options.command = CliRunner::Command::List;
+    else if (command == "share")    options.command = CliRunner::Command::Share;
+    else if (command == "revoke")   options.command = CliRunner::Command::Revoke;
+    else return usageError(parser, "unknown command " + command);
+
+    const bool targetsUser = options.command == CliRunner::Command::Share
+                          || options.command == CliRunner::Command::Revoke;
+    if (targetsUser) {
+        if (args.isEmpty())
+            return usageError(parser, command + " needs a USER");
+        options.username = args.takeFirst();
+    }
+    if (options.command != CliRunner::Command::List && args.isEmpty())
+        return usageError(parser, command + " needs at least one item");
+    if (options.command != CliRunner::Command::Upload) {
+        for (const QString& id : args) {
+            qulonglong fileId = 0;
+            if (!CliRunner::parseFileId(id, fileId))
+                return usageError(parser, "not a file id: " + id);
+        }
+    }
+    options.items  = args;
+    options.outDir = parser.value(outOpt);
+    options.json   = parser.isSet(jsonOpt);
+    bool jobsOk = false;
+    options.jobs   = parser.value(jobsOpt).toInt(&jobsOk);
+    if (!jobsOk || options.jobs < 1)
+        return usageError(parser, "--jobs must be a positive number");
+
+    const QString username = parser.isSet(userOpt) ? parser.value(userOpt)
+                                                   : qEnvironmentVariable("SSSHARE_USER");
+    if (username.isEmpty())
+        return usageError(parser, "no account: pass --user or set SSSHARE_USER");
+
+    // worker → main-thread event pump; handler signals are emitted from here
+    UiEventPump::instance();
+
+    Tracing::setThreadName("main");
+    Tracing::startFromEnvironment();
+
+    ClientStore clientStore(parser.isSet(storeOpt) ? parser.value(storeOpt).toStdString()
+                                                   : defaultStorePath().toStdString());
+    clientStore.load();
+
+    auto &cfg = Config::instance();
+    QString absPem = QDir(QCoreApplication::applicationDirPath())
+                         .filePath(QString::fromStdString(cfg.caBundle));
+    cfg.caBundle = absPem.toStdString();
+
+    AsioSslClient httpClient;
+    httpClient.init(Config::instance().caBundle);
+
+    // Unlock the way the GUI does: through a running ssshared if there is one (no Argon2 when
+    // it is already unlocked), else in-process. One command never starts a daemon.
+    DaemonClient daemon;
+    daemon.attachExisting(kDaemonConnectMs);
+    LoginHandler login(&clientStore);
+    login.setDaemon(&daemon);
+
+    CliRunner runner(&clientStore, options);
+    QObject::connect(&runner, &CliRunner::finished, &app, &QCoreApplication::exit, Qt::QueuedConnection);
+    QObject::connect(&login, &LoginHandler::loginResult, &app,
+                     [&](const QString& title, const QString& message) {
+        if (title != "Success") {
+            std::fprintf(stderr, "ssshare-cli: login failed: %s\n", qPrintable(message));
+            QCoreApplication::exit(2);
+            return;
+        }
+        runner.start();
+    });
+    const QString password = readPassword(parser.value(passwordFileOpt));
+    QTimer::singleShot(0, &login, [&login, username, password]() { login.validateLogin(username, password); });
+
+    return app.exec();
+}
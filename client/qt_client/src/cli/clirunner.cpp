@@ -0,0 +1,219 @@
+#include "clirunner.h"
+#include <QVariant>
+#include <QDebug>
+#include <algorithm>
+#include <cstdio>
+#include "../daemon/daemonprotocol.h"
+#include "../handlers/filelisthandler.h"
+#include "../handlers/fileuploadhandler.h"
+#include "../handlers/filedownloadhandler.h"
+#include "../handlers/filesharehandler.h"
+
+using json = nlohmann::json;
+
+CliRunner::CliRunner(ClientStore* store, Options options, QObject* parent)
+    : QObject(parent), m_store(store), m_options(std::move(options))
+{
+    m_options.jobs = std::max(1, m_options.jobs);
+}
+
+CliRunner::~CliRunner() = default;
+
+bool CliRunner::parseFileId(const QString& text, qulonglong& out)
+{
+    bool ok = false;
+    out = text.toULongLong(&ok);
+    return ok && out != 0;
+}
+
+void CliRunner::start()
+{
+    m_clock.start();
+    if (m_options.command != Command::Upload) {
+        for (const QString& item : m_options.items) {
+            qulonglong fileId = 0;
+            if (!parseFileId(item, fileId)) {
+                std::fprintf(stderr, "ssshare-cli: not a file id: %s\n", qPrintable(item));
+                m_finished = true;
+                emit finished(2);
+                return;
+            }
+            m_fileIds.push_back(fileId);
+        }
+    }
+    switch (m_options.command) {
+    case Command::Upload:   return startUpload();
+    case Command::Download: return startDownload();
+    case Command::List:     return startList();
+    case Command::Share:    return startShare();
+    case Command::Revoke:   return startRevoke();
+    }
+}
+
+QString CliRunner::commandName() const
+{
+    switch (m_options.command) {
+    case Command::Upload:   return "upload";
+    case Command::Download: return "download";
+    case Command::List:     return "list";
+    case Command::Share:    return "share";
+    case Command::Revoke:   return "revoke";
+    }
+    return {};
+}
+
+void CliRunner::startUpload()
+{
+    m_upload.reset(new FileUploadHandler(m_store));
+    connect(m_upload.get(), &FileUploadHandler::uploadItemResult, this,
+            [this](const QString& path, qulonglong fileId, const QString& status, const QString& message) {
+        itemDone({ { "op", "upload" }, { "path", path.toStdString() }, { "file_id", fileId },
+                   { "status", status.toStdString() }, { "message", message.toStdString() } },
+                 status == "uploaded");
+    });
+
+    // one file per uploadFiles() call, so a slot frees up as soon as its file is done
+    for (const QString& path : m_options.items)
+        m_queue.push_back([this, path]() { m_upload->uploadFiles({ path }); });
+    pump();
+}
+
+void CliRunner::startDownload()
+{
+    m_download.reset(new FileDownloadHandler(m_store));
+    if (!m_options.outDir.isEmpty())
+        m_download->setDownloadDir(m_options.outDir);
+    connect(m_download.get(), &FileDownloadHandler::downloadItemResult, this,
+            [this](qulonglong fileId, const QString& savedPath, const QString& status, const QString& message) {
+        itemDone({ { "op", "download" }, { "file_id", fileId }, { "path", savedPath.toStdString() },
+                   { "status", status.toStdString() }, { "message", message.toStdString() } },
+                 status == "downloaded");
+    });
+
+    for (qulonglong fileId : m_fileIds)
+        m_queue.push_back([this, fileId]() { m_download->downloadFile(fileId); });
+    pump();
+}
+
+void CliRunner::startShare()
+{
+    m_share.reset(new FileShareHandler(m_store));
+    connect(m_share.get(), &FileShareHandler::shareItemResult, this,
+            [this](qulonglong fileId, const QString& username, const QString& status, const QString& message) {
+        itemDone({ { "op", "share" }, { "file_id", fileId }, { "username", username.toStdString() },
+                   { "status", status.toStdString() }, { "message", message.toStdString() } },
+                 status == "shared");
+    });
+
+    for (qulonglong fileId : m_fileIds)
+        m_queue.push_back([this, fileId]() { m_share->shareFile(fileId, m_options.username); });
+    pump();
+}
+
+void CliRunner::startRevoke()
+{
+    // FileShareHandler already runs a batch with a bounded set of workers; size it to --jobs
+    m_share.reset(new FileShareHandler(m_store));
+    m_share->setRevokeWorkers(m_options.jobs);
+    connect(m_share.get(), &FileShareHandler::revokeItemResult, this,
+            [this](qulonglong fileId, const QString& username, const QString& status, const QString& message) {
+        itemDone({ { "op", "revoke" }, { "file_id", fileId }, { "username", username.toStdString() },
+                   { "status", status.toStdString() }, { "message", message.toStdString() } },
+                 status != "failed");
+    });
+    connect(m_share.get(), &FileShareHandler::revokeFinished, this, &CliRunner::finish);
+
+    QVariantList fileIds;
+    for (qulonglong fileId : m_fileIds)
+        fileIds.push_back(fileId);
+    m_share->revokeUserFromFiles(m_options.username, fileIds);
+}
+
+void CliRunner::startList()
+{
+    // one paged listing and out: no change-feed subscription, no follow-up sync
+    m_list.reset(new FileListHandler(m_store, FileListHandler::Mode::OneShot));
+
+    // errorOccurred comes first when a page fails; the stream still closes with listingFinished
+    connect(m_list.get(), &FileListHandler::errorOccurred, this, [this](const QString& message) {
+        print({ { "op", "error" }, { "message", message.toStdString() } }, "error\t" + message);
+        ++m_failed;
+    });
+    connect(m_list.get(), &FileListHandler::listingFinished, this, [this]() {
+        if (m_failed == 0) {
+            const FileListModel* model = m_list->model();
+            for (int row = 0; row < model->count(); ++row) {
+                const DecryptedFile& f = model->at(row);
+                json entry = DaemonProtocol::fileEntry(f);
+                entry["op"] = "file";
+                print(entry, QString("%1\t%2\t%3\t%4")
+                                 .arg(f.file_id)
+                                 .arg(f.size_bytes)
+                                 .arg(f.upload_timestamp.toString(Qt::ISODate), f.filename));
+                ++m_ok;
+            }
+        }
+        finish();
+    });
+    m_list->listAllPages();
+}
+
+void CliRunner::pump()
+{
+    while (m_inFlight < m_options.jobs && !m_queue.empty()) {
+        auto launch = std::move(m_queue.front());
+        m_queue.pop_front();
+        ++m_inFlight;
+        launch();
+    }
+    if (m_inFlight == 0 && m_queue.empty())
+        finish();
+}
+
+void CliRunner::itemDone(const json& item, bool ok)
+{
+    if (ok)
+        ++m_ok;
+    else
+        ++m_failed;
+    --m_inFlight;
+
+    QString text = QString::fromStdString(item.at("status").get<std::string>());
+    for (const char* key : { "path", "file_id", "username", "message" }) {
+        if (!item.contains(key))
+            continue;
+        const json& v = item.at(key);
+        text += QLatin1Char('\t');
+        text += QString::fromStdString(v.is_string() ? v.get<std::string>() : v.dump());
+    }
+    print(item, text);
+
+    // revoke batches report through revokeFinished instead
+    if (m_options.command != Command::Revoke)
+        pump();
+}
+
+void CliRunner::print(const json& item, const QString& text)
+{
+    const std::string line = m_options.json ? item.dump() : text.toStdString();
+    std::fputs(line.c_str(), stdout);
+    std::fputc('\n', stdout);
+    std::fflush(stdout);    // scripts read results as they arrive
+}
+
+void CliRunner::finish()
+{
+    if (m_finished)
+        return;
+    m_finished = true;
+
+    const qint64 elapsed = m_clock.elapsed();
+    if (m_options.json) {
+        print({ { "op", "summary" }, { "command", commandName().toStdString() },
+                { "ok", m_ok }, { "failed", m_failed }, { "elapsed_ms", elapsed } }, {});
+    } else {
+        std::fprintf(stderr, "%s: %d ok, %d failed in %lld ms\n",
+                     qPrintable(commandName()), m_ok, m_failed, static_cast<long long>(elapsed));
+    }
+    emit finished(m_failed == 0 ? 0 : 1);
+}
@@ -0,0 +1,92 @@
+#pragma once
+#include <QElapsedTimer>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../utils/clientstore.h"
+#include "../utils/coro.h"
+
+class FileListHandler;
+class FileUploadHandler;
+class FileDownloadHandler;
+class FileShareHandler;
+
+/**
+ * CliRunner – runs one ssshare-cli command against an unlocked ClientStore.
+ *
+ * It drives the same handlers the GUI binds to QML, on a QCoreApplication: uploads and
+ * downloads keep up to `jobs` files in flight, starting the next one as each per-item
+ * result arrives; revoke hands the whole list to FileShareHandler::revokeMany with
+ * `jobs` workers. list fetches the paged listing once, without subscribing to the change
+ * feed, and prints it when the last page is in.
+ *
+ * Every item prints one line to stdout as it completes: tab-separated text, or with
+ * `json` one object per line followed by a summary object, e.g.
+ *
+ *   {"op":"upload","path":"a.bin","file_id":42,"status":"uploaded","message":"…"}
+ *   {"op":"summary","command":"upload","ok":1,"failed":0,"elapsed_ms":812}
+ *
+ * finished(exitCode) fires once: 0 if every item succeeded, 1 if any failed, 2 if an
+ * item is not a valid file id.
+ */
+class CliRunner : public QObject {
+    Q_OBJECT
+public:
+    enum class Command { Upload, Download, List, Share, Revoke };
+
+    struct Options {
+        Command     command = Command::List;
+        QStringList items;      // paths for upload, file ids otherwise
+        QString     username;   // share / revoke target
+        QString     outDir;     // download destination; empty = Downloads
+        int         jobs = 4;
+        bool        json = false;
+    };
+
+    CliRunner(ClientStore* store, Options options, QObject* parent = nullptr);
+    ~CliRunner() override;
+
+    void start();
+
+    // A file id argument: a positive decimal number
+    static bool parseFileId(const QString& text, qulonglong& out);
+
+signals:
+    void finished(int exitCode);
+
+private:
+    void startUpload();
+    void startDownload();
+    void startList();
+    void startShare();
+    void startRevoke();
+
+    // Starts queued items until `jobs` are in flight, or finishes once all are done
+    void pump();
+    void itemDone(const nlohmann::json& item, bool ok);
+    void print(const nlohmann::json& item, const QString& text);
+    void finish();
+
+    QString commandName() const;
+
+    ClientStore*    m_store;
+    Options         m_options;
+    QElapsedTimer   m_clock;
+
+    std::unique_ptr<FileListHandler, Coro::RetireLater>      m_list;
+    std::unique_ptr<FileUploadHandler, Coro::RetireLater>    m_upload;
+    std::unique_ptr<FileDownloadHandler, Coro::RetireLater>  m_download;
+    std::unique_ptr<FileShareHandler, Coro::RetireLater>     m_share;
+
+    std::vector<qulonglong>             m_fileIds;  // items, parsed, for all but upload
+    std::deque<std::function<void()>>   m_queue;
+    int     m_inFlight = 0;
+    int     m_ok = 0;
+    int     m_failed = 0;
+    bool    m_finished = false;
+};
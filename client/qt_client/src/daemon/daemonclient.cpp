@@ -0,0 +1,120 @@
+#include "daemonclient.h"
+#include "daemonprotocol.h"
+#include <QCoreApplication>
+#include <QLocalSocket>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QDebug>
+
+using json = nlohmann::json;
+
+DaemonClient::DaemonClient(QObject* parent)
+    : QObject(parent), m_socket(new QLocalSocket(this))
+{
+    connect(m_socket, &QLocalSocket::connected, this, [this]() {
+        qInfo() << "[DaemonClient] attached to" << m_socket->fullServerName();
+        emit connected();
+    });
+    connect(m_socket, &QLocalSocket::readyRead, this, &DaemonClient::onReadyRead);
+    connect(m_socket, &QLocalSocket::disconnected, this, &DaemonClient::onDisconnected);
+    connect(m_socket, &QLocalSocket::errorOccurred, this, [this](QLocalSocket::LocalSocketError) {
+        if (m_socket->state() == QLocalSocket::ConnectedState || m_attemptsLeft <= 0)
+            return;
+
+        // nobody home: start ssshared once, then give it a moment to come up
+        if (!m_launched) {
+            m_launched = true;
+            const QString exe = QStandardPaths::findExecutable(
+                "ssshared", { QCoreApplication::applicationDirPath() });
+            if (exe.isEmpty() || !QProcess::startDetached(exe, {})) {
+                qDebug() << "[DaemonClient] no ssshared to start; running standalone";
+                m_attemptsLeft = 0;
+                return;
+            }
+            qInfo() << "[DaemonClient] started" << exe;
+        }
+        if (--m_attemptsLeft > 0)
+            QTimer::singleShot(kRetryMs, this, &DaemonClient::tryConnect);
+    });
+}
+
+void DaemonClient::attach()
+{
+    m_attemptsLeft = kConnectAttempts;
+    tryConnect();
+}
+
+bool DaemonClient::attachExisting(int msecs)
+{
+    // no attempts left, so a refused connection does not launch a daemon
+    m_attemptsLeft = 0;
+    m_socket->abort();
+    m_socket->connectToServer(DaemonProtocol::socketName());
+    return m_socket->waitForConnected(msecs);
+}
+
+bool DaemonClient::isConnected() const
+{
+    return m_socket->state() == QLocalSocket::ConnectedState;
+}
+
+void DaemonClient::tryConnect()
+{
+    if (isConnected())
+        return;
+    m_socket->abort();
+    m_socket->connectToServer(DaemonProtocol::socketName());
+}
+
+void DaemonClient::call(const QString& method, json params, Callback done)
+{
+    if (!isConnected()) {
+        done(false, kUnavailable);
+        return;
+    }
+    const int64_t id = m_nextId++;
+    m_pending.emplace(id, std::move(done));
+    m_socket->write(DaemonProtocol::frame({
+        { "id", id }, { "method", method.toStdString() }, { "params", std::move(params) } }));
+}
+
+void DaemonClient::onReadyRead()
+{
+    m_buffer.append(m_socket->readAll());
+
+    qsizetype newline;
+    while ((newline = m_buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = m_buffer.left(newline);
+        m_buffer.remove(0, newline + 1);
+
+        json message;
+        try {
+            message = json::parse(line.constData(), line.constData() + line.size());
+        } catch (const std::exception& ex) {
+            qWarning() << "[DaemonClient] bad message from daemon:" << ex.what();
+            continue;
+        }
+
+        auto it = m_pending.find(message.value("id", int64_t(0)));
+        if (it == m_pending.end())
+            continue;
+        Callback done = std::move(it->second);
+        m_pending.erase(it);
+        if (message.value("ok", false))
+            done(true, message.value("result", json::object()));
+        else
+            done(false, message.value("error", std::string("unknown error")));
+    }
+}
+
+void DaemonClient::onDisconnected()
+{
+    qInfo() << "[DaemonClient] daemon went away";
+    m_buffer.clear();
+    auto pending = std::move(m_pending);
+    m_pending.clear();
+    for (auto& [id, done] : pending)
+        done(false, kUnavailable);
+    emit disconnected();
+}
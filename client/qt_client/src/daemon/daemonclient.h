@@ -0,0 +1,58 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <functional>
+#include <map>
+#include <nlohmann/json.hpp>
+
+class QLocalSocket;
+
+/**
+ * DaemonClient – a front-end's connection to ssshared (see daemonprotocol.h).
+ *
+ *   DaemonClient daemon;
+ *   daemon.attach();                       // connects, or starts ssshared and keeps trying
+ *   daemon.call("status", {}, [](bool ok, const nlohmann::json& payload) { … });
+ *
+ * `done` runs on this object's thread with ok + the result, or !ok + the error string.
+ * Calls made while disconnected, or cut off by a disconnect, fail with kUnavailable so
+ * the caller can fall back to doing the work in-process.
+ */
+class DaemonClient : public QObject {
+    Q_OBJECT
+public:
+    using Callback = std::function<void(bool ok, const nlohmann::json& payload)>;
+
+    static constexpr const char* kUnavailable = "daemon unavailable";
+
+    explicit DaemonClient(QObject* parent = nullptr);
+
+    /** Connects to this user's ssshared; if none answers, starts one (if installed beside us) and retries. */
+    void attach();
+
+    /** Connects to an ssshared that is already running, waiting up to msecs; never starts one. */
+    bool attachExisting(int msecs);
+
+    bool isConnected() const;
+
+    void call(const QString& method, nlohmann::json params, Callback done);
+
+signals:
+    void connected();
+    void disconnected();
+
+private:
+    void tryConnect();
+    void onReadyRead();
+    void onDisconnected();
+
+    static constexpr int kConnectAttempts = 20;
+    static constexpr int kRetryMs = 150;
+
+    QLocalSocket*               m_socket;
+    QByteArray                  m_buffer;
+    int64_t                     m_nextId = 1;
+    std::map<int64_t, Callback> m_pending;
+    int                         m_attemptsLeft = 0;
+    bool                        m_launched = false;
+};
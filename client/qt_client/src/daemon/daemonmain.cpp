@@ -0,0 +1,57 @@
+// ssshared – per-user background engine; see daemonserver.h
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QDebug>
+
+#include "daemonserver.h"
+#include "../config.h"
+#include "../utils/clientstore.h"
+#include "../utils/uieventpump.h"
+#include "../utils/tracing.h"
+#include "../utils/metrics.h"
+#include "../utils/alloctracker.h"
+#include "../utils/networking/asiosslclient.h"
+
+static QString defaultStorePath() {
+#ifdef Q_OS_WIN
+    return QDir::homePath() + "/AppData/Roaming/.ssshare/client_store.json";
+#else
+    return QDir::homePath() + "/.ssshare/client_store.json";
+#endif
+}
+
+int main(int argc, char *argv[])
+{
+    // before anything touches OpenSSL (no-op unless QT_CLIENT_ALLOC_TRACKING)
+    AllocTracker::install();
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName("ssshared");
+
+    // worker → main-thread event pump; Argon2 unlocks report back through it
+    UiEventPump::instance();
+
+    Tracing::setThreadName("main");
+    Tracing::startFromEnvironment();
+
+    ClientStore clientStore(defaultStorePath().toStdString());
+    clientStore.load();
+
+    const QString metricsFile = QFileInfo(defaultStorePath()).dir().filePath("metrics-ssshared.json");
+    Metrics::Dumper metricsDumper(metricsFile.toStdString(), Metrics::dumpInterval());
+
+    auto &cfg = Config::instance();
+    QString absPem = QDir(QCoreApplication::applicationDirPath())
+                         .filePath(QString::fromStdString(cfg.caBundle));
+    cfg.caBundle = absPem.toStdString();
+
+    AsioSslClient httpClient;
+    httpClient.init(Config::instance().caBundle);
+
+    DaemonServer server(&clientStore);
+    if (!server.listen())
+        return 1;
+
+    return app.exec();
+}
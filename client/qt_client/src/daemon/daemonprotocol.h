@@ -0,0 +1,66 @@
+#pragma once
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+#include <nlohmann/json.hpp>
+#include "../utils/decryptedfile.h"
+
+/**
+ * Wire format between ssshared and its front-ends (the Qt app, scripts).
+ *
+ * One JSON object per line over a QLocalSocket — a Unix-domain socket on Linux/macOS,
+ * a named pipe on Windows — that only the owning user can open:
+ *
+ *   → {"id": 7, "method": "session", "params": {"password": "..."}}
+ *   ← {"id": 7, "ok": true, "result": {...}}      or   {"id": 7, "ok": false, "error": "..."}
+ *
+ * Replies may come back out of order; match them on id. The daemon only shares the
+ * unlock; listing, transfers and shares run in each front-end's own handlers.
+ *
+ * Methods:
+ *   status                          → {version, unlocked, username, clients, in_flight}
+ *   metrics                         → Metrics::snapshot(): {uptime_s, counters, gauges, histograms}
+ *   unlock   {username, password}   → {username, warm}   (warm: already unlocked, no Argon2,
+ *                                      password checked against the unlocking one)
+ *   lock                            → {}
+ *   session  {password}             → {username, master_key}   (base64 MEK, same check as a warm unlock)
+ */
+namespace DaemonProtocol {
+
+inline constexpr int kVersion = 1;
+
+// The error of an unlock or session refused for the password alone; front-ends fall back
+// to unlocking in-process on any other error
+inline constexpr const char* kBadCredentials = "Invalid username or password";
+
+// Per-user endpoint; QLocalServer maps it into the temp/runtime directory
+inline QString socketName()
+{
+    QString user = qEnvironmentVariable("USER");
+    if (user.isEmpty())
+        user = qEnvironmentVariable("USERNAME");
+    return QStringLiteral("ssshared-") + (user.isEmpty() ? QStringLiteral("default") : user);
+}
+
+inline QByteArray frame(const nlohmann::json& message)
+{
+    QByteArray line = QByteArray::fromStdString(message.dump());
+    line.append('\n');
+    return line;
+}
+
+// One row of ssshare-cli's --json listing
+inline nlohmann::json fileEntry(const DecryptedFile& f)
+{
+    return {
+        { "file_id",     f.file_id },
+        { "name",        f.filename.toStdString() },
+        { "size",        f.size_bytes },
+        { "modified",    f.upload_timestamp.toString(Qt::ISODate).toStdString() },
+        { "is_owner",    f.is_owner },
+        { "is_shared",   f.is_shared },
+        { "shared_from", f.shared_from.toStdString() },
+    };
+}
+
+} // namespace DaemonProtocol
@@ -0,0 +1,261 @@
+#include "daemonserver.h"
+#include "daemonprotocol.h"
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QDateTime>
+#include <QDebug>
+#include "../utils/handlerutils.h"
+#include "../utils/metrics.h"
+#include "../utils/uieventpump.h"
+#include "../utils/networking/asyncsslclient.h"
+
+using json = nlohmann::json;
+
+namespace {
+// a client that sends this much without a newline is not speaking the protocol
+constexpr qsizetype kMaxLineBytes = 4 * 1024 * 1024;
+}
+
+DaemonServer::DaemonServer(ClientStore* store, QObject* parent)
+    : QObject(parent), m_store(store), m_server(new QLocalServer(this))
+{
+    // only this user may connect: the socket hands out an unlocked session
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+    connect(m_server, &QLocalServer::newConnection, this, &DaemonServer::onNewConnection);
+}
+
+DaemonServer::~DaemonServer()
+{
+    sodium_memzero(m_passwordKey.data(), m_passwordKey.size());
+    sodium_memzero(m_passwordTag.data(), m_passwordTag.size());
+}
+
+bool DaemonServer::listen()
+{
+    const QString name = DaemonProtocol::socketName();
+
+    // a socket file nobody answers on is left over from a crash; anything else is a live daemon
+    QLocalSocket probe;
+    probe.connectToServer(name);
+    if (probe.waitForConnected(200)) {
+        qWarning() << "[Daemon] another ssshared is already serving" << name;
+        return false;
+    }
+    QLocalServer::removeServer(name);
+
+    if (!m_server->listen(name)) {
+        qWarning() << "[Daemon] listen failed on" << name << ":" << m_server->errorString();
+        return false;
+    }
+    qInfo() << "[Daemon] listening on" << m_server->fullServerName();
+    return true;
+}
+
+void DaemonServer::onNewConnection()
+{
+    while (QLocalSocket* socket = m_server->nextPendingConnection()) {
+        m_buffers[socket];
+        connect(socket, &QLocalSocket::readyRead, this, [this, socket]() { onReadyRead(socket); });
+        connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+            m_buffers.erase(socket);
+            socket->deleteLater();
+        });
+        qDebug() << "[Daemon] client connected;" << m_buffers.size() << "attached";
+    }
+}
+
+void DaemonServer::onReadyRead(QLocalSocket* socket)
+{
+    auto it = m_buffers.find(socket);
+    if (it == m_buffers.end())
+        return;
+    QByteArray& buffer = it->second;
+    buffer.append(socket->readAll());
+
+    qsizetype newline;
+    while ((newline = buffer.indexOf('\n')) >= 0) {
+        const QByteArray line = buffer.left(newline);
+        buffer.remove(0, newline + 1);
+        if (line.trimmed().isEmpty())
+            continue;
+
+        json request;
+        try {
+            request = json::parse(line.constData(), line.constData() + line.size());
+        } catch (const std::exception& ex) {
+            fail(socket, nullptr, QString("Bad request: %1").arg(ex.what()));
+            continue;
+        }
+        dispatch(socket, request);
+    }
+
+    if (buffer.size() > kMaxLineBytes) {
+        qWarning() << "[Daemon] dropping a client with an oversized request";
+        socket->disconnectFromServer();
+    }
+}
+
+void DaemonServer::dispatch(QLocalSocket* socket, const json& request)
+{
+    // value() throws on anything but an object, and nothing may escape the readyRead slot
+    if (!request.is_object())
+        return fail(socket, nullptr, "Bad request: not a JSON object");
+
+    const json id = request.value("id", json());
+    std::string method;
+
+    try {
+        // a non-string method throws too
+        method = request.value("method", std::string());
+        const json params = request.value("params", json::object());
+
+        if (method == "status")
+            return reply(socket, id, status());
+        if (method == "metrics")
+            return reply(socket, id, Metrics::instance().snapshot());
+        if (method == "unlock")
+            return unlock(socket, id, params);
+        if (method == "lock") {
+            // the store is being decrypted on the CPU pool; clearing it now would race that
+            if (m_unlocking)
+                return fail(socket, id, "Busy: unlock in progress");
+            lock();
+            return reply(socket, id, json::object());
+        }
+
+        if (!unlocked())
+            return fail(socket, id, "Locked: unlock first");
+
+        if (method == "session") {
+            if (!passwordMatches(params.at("password").get<std::string>()))
+                return fail(socket, id, DaemonProtocol::kBadCredentials);
+            return reply(socket, id, session());
+        }
+    } catch (const std::exception& ex) {
+        return fail(socket, id, QString("Bad params for %1: %2")
+                                    .arg(QString::fromStdString(method), ex.what()));
+    }
+
+    fail(socket, id, QString("Unknown method: %1").arg(QString::fromStdString(method)));
+}
+
+void DaemonServer::reply(QLocalSocket* socket, const json& id, json result)
+{
+    socket->write(DaemonProtocol::frame({ { "id", id }, { "ok", true }, { "result", std::move(result) } }));
+}
+
+void DaemonServer::fail(QLocalSocket* socket, const json& id, const QString& error)
+{
+    socket->write(DaemonProtocol::frame({ { "id", id }, { "ok", false }, { "error", error.toStdString() } }));
+}
+
+void DaemonServer::unlock(QLocalSocket* socket, const json& id, const json& params)
+{
+    const std::string username = params.at("username").get<std::string>();
+    const std::string password = params.at("password").get<std::string>();
+
+    if (unlocked()) {
+        const std::string current = m_store->getUser()->username;
+        if (current != username)
+            return fail(socket, id, QString("Unlocked as %1; lock first").arg(QString::fromStdString(current)));
+        // the point of the daemon: a second front-end skips Argon2 entirely, yet still has to
+        // know the password
+        if (!passwordMatches(password))
+            return fail(socket, id, DaemonProtocol::kBadCredentials);
+        return reply(socket, id, { { "username", username }, { "warm", true } });
+    }
+
+    // one cold unlock at a time: the others wait for it, then go again (warm if it worked)
+    if (m_unlocking) {
+        m_unlockWaiters.push_back({ QPointer<QLocalSocket>(socket), id, params });
+        return;
+    }
+    m_unlocking = true;
+
+    // Argon2 is all CPU; the answer comes back through the pump, and only if the client is still there
+    QPointer<QLocalSocket> peer(socket);
+    HandlerUtils::runAsync([this, peer, id, username, password]() {
+        // pick up a user the GUI registered, or a password it changed, since we started
+        m_store->load();
+        std::string err;
+        const bool ok = m_store->loginAndDecrypt(username, password, err);
+        UiEventPump::instance().post(this, [this, peer, id, username, password, ok, err]() {
+            m_unlocking = false;
+            if (ok) {
+                rememberPassword(password);
+                qInfo() << "[Daemon] unlocked for" << QString::fromStdString(username);
+            }
+            if (peer) {
+                if (ok)
+                    reply(peer, id, { { "username", username }, { "warm", false } });
+                else
+                    fail(peer, id, err.empty() ? QString(DaemonProtocol::kBadCredentials)
+                                               : QString::fromStdString(err));
+            }
+
+            std::vector<UnlockWaiter> waiters;
+            waiters.swap(m_unlockWaiters);
+            for (const UnlockWaiter& w : waiters) {
+                if (w.peer)
+                    unlock(w.peer, w.id, w.params);
+            }
+        });
+    }, Executor::Pool::Cpu);
+}
+
+void DaemonServer::lock()
+{
+    m_hasPasswordTag = false;
+    sodium_memzero(m_passwordTag.data(), m_passwordTag.size());
+    sodium_memzero(m_passwordKey.data(), m_passwordKey.size());
+    // clearUser() drops the encrypted fields too; reload them so unlock works again
+    m_store->clearUser();
+    m_store->load();
+}
+
+json DaemonServer::status() const
+{
+    auto user = m_store->getUser();
+    return {
+        { "version",   DaemonProtocol::kVersion },
+        { "unlocked",  unlocked() },
+        { "username",  user ? user->username : std::string() },
+        { "clients",   m_buffers.size() },
+        { "in_flight", AsyncSslClient::instance().inFlight() },
+    };
+}
+
+json DaemonServer::session() const
+{
+    auto user = m_store->getUser();
+    return {
+        { "username",   user->username },
+        { "master_key", FileClientData::base64_encode(user->masterKey.data(), user->masterKey.size()) },
+    };
+}
+
+void DaemonServer::rememberPassword(const std::string& password)
+{
+    randombytes_buf(m_passwordKey.data(), m_passwordKey.size());
+    crypto_generichash(m_passwordTag.data(), m_passwordTag.size(),
+                       reinterpret_cast<const unsigned char*>(password.data()), password.size(),
+                       m_passwordKey.data(), m_passwordKey.size());
+    m_hasPasswordTag = true;
+}
+
+bool DaemonServer::passwordMatches(const std::string& password) const
+{
+    if (!m_hasPasswordTag)
+        return false;
+    std::array<uint8_t, crypto_generichash_BYTES> tag{};
+    crypto_generichash(tag.data(), tag.size(),
+                       reinterpret_cast<const unsigned char*>(password.data()), password.size(),
+                       m_passwordKey.data(), m_passwordKey.size());
+    return sodium_memcmp(tag.data(), m_passwordTag.data(), tag.size()) == 0;
+}
+
+bool DaemonServer::unlocked() const
+{
+    auto user = m_store->getUser();
+    return user.has_value() && !user->masterKey.empty() && m_hasPasswordTag;
+}
@@ -0,0 +1,75 @@
+#pragma once
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <array>
+#include <map>
+#include <vector>
+#include <nlohmann/json.hpp>
+#include "../utils/clientstore.h"
+#include <sodium.h>
+
+class QLocalServer;
+class QLocalSocket;
+
+/**
+ * DaemonServer – the engine behind ssshared.
+ *
+ * Keeps the user's ClientStore unlocked across front-end launches (shared unlock), so
+ * a GUI login after the first one skips Argon2 and borrows the MEK over "session".
+ * That is all it holds: it runs no file handlers, so the GUI and ssshare-cli list, sync
+ * and transfer in-process, each with its own metadata cache and change feed. The store
+ * file and metadata_cache_<user>.json are shared on disk, not in memory; both are
+ * written under a lock file (ClientStore::save, MetadataCache::save).
+ *
+ * The socket is user-only, and still every front-end has to prove it knows the
+ * password: a warm "unlock" and "session" (which hands out the MEK) are checked against
+ * a keyed BLAKE2b tag of the password kept from the Argon2 unlock, so they stay cheap
+ * without taking any password for the running user.
+ */
+class DaemonServer : public QObject {
+    Q_OBJECT
+public:
+    explicit DaemonServer(ClientStore* store, QObject* parent = nullptr);
+    ~DaemonServer() override;
+
+    /** Starts listening; false if another ssshared already serves this user. */
+    bool listen();
+
+private:
+    void onNewConnection();
+    void onReadyRead(QLocalSocket* socket);
+    void dispatch(QLocalSocket* socket, const nlohmann::json& request);
+
+    void reply(QLocalSocket* socket, const nlohmann::json& id, nlohmann::json result);
+    void fail(QLocalSocket* socket, const nlohmann::json& id, const QString& error);
+
+    // Method bodies; each answers through reply()/fail()
+    void unlock(QLocalSocket* socket, const nlohmann::json& id, const nlohmann::json& params);
+    void lock();
+    nlohmann::json status() const;
+    nlohmann::json session() const;
+    bool unlocked() const;
+
+    // The tag of the password that unlocked the store; a constant-time comparison
+    void rememberPassword(const std::string& password);
+    bool passwordMatches(const std::string& password) const;
+
+    ClientStore*    m_store;
+    QLocalServer*   m_server;
+    std::map<QLocalSocket*, QByteArray> m_buffers;  // partial lines per client
+
+    // set by a successful unlock, cleared by lock; the key is per unlock and never leaves memory
+    std::array<uint8_t, crypto_generichash_KEYBYTES>    m_passwordKey{};
+    std::array<uint8_t, crypto_generichash_BYTES>       m_passwordTag{};
+    bool                                                m_hasPasswordTag = false;
+
+    // a cold unlock is running; unlocks arriving meanwhile wait for it
+    struct UnlockWaiter {
+        QPointer<QLocalSocket>  peer;
+        nlohmann::json          id;
+        nlohmann::json          params;
+    };
+    bool                        m_unlocking = false;
+    std::vector<UnlockWaiter>   m_unlockWaiters;
+};
@@ -1,7 +1,12 @@
 #include "LoginHandler.h"
 #include "../utils/ClientStore.h"
 #include "../utils/HandlerUtils.h"
+#include "../utils/crypto/FileClientData.h"
+#include "../daemon/daemonclient.h"
+#include "../daemon/daemonprotocol.h"
+#include "../utils/tracing.h"
 #include <QMetaObject>
+#include <QDebug>
 
 LoginHandler::LoginHandler(ClientStore* store, QObject* parent)
     : QObject(parent), m_store(store) {}
@@ -14,13 +19,64 @@ void LoginHandler::validateLogin(const QString& username,
         return;
     }
 
-    // run background work off the UI thread
-    HandlerUtils::runAsync([=] { doValidateLogin(username, password); });
+    // the daemon derives the key once for every front-end; this process then borrows the MEK.
+    // Only a wrong password ends the login there: anything else (no daemon, unlocked for
+    // another user, a store it cannot read) falls back to unlocking in-process.
+    if (m_daemon && m_daemon->isConnected()) {
+        m_daemon->call("unlock",
+                       { { "username", username.toStdString() }, { "password", password.toStdString() } },
+                       [this, username, password](bool ok, const nlohmann::json& payload) {
+            if (ok)
+                return adoptDaemonSession(username, password);
+            if (payload == DaemonProtocol::kBadCredentials)
+                return report("Error", DaemonProtocol::kBadCredentials);
+            qDebug() << "[LoginHandler] daemon unlock refused, logging in locally:"
+                     << QString::fromStdString(payload.get<std::string>());
+            loginLocally(username, password);
+        });
+        return;
+    }
+
+    loginLocally(username, password);
+}
+
+void LoginHandler::loginLocally(const QString& username, const QString& password)
+{
+    // run background work off the UI thread; unlocking the store is all KDF, so CPU pool
+    HandlerUtils::runAsync([=] { doValidateLogin(username, password); }, Executor::Pool::Cpu);
+}
+
+void LoginHandler::adoptDaemonSession(const QString& username, const QString& password)
+{
+    // the daemon hands out its MEK only to whoever knows the password
+    m_daemon->call("session", { { "password", password.toStdString() } },
+                   [this, username, password](bool ok, const nlohmann::json& payload) {
+        if (!ok) {
+            if (payload == DaemonProtocol::kBadCredentials)
+                return report("Error", DaemonProtocol::kBadCredentials);
+            return loginLocally(username, password);
+        }
+        const std::string daemonUser = payload.at("username").get<std::string>();
+        const std::vector<uint8_t> masterKey =
+            FileClientData::base64_decode(payload.at("master_key").get<std::string>());
+
+        // one AES pass and no Argon2, but still off the UI thread
+        HandlerUtils::runAsync([this, username, password, daemonUser, masterKey]() {
+            std::string err;
+            if (m_store->unlockWithMasterKey(daemonUser, masterKey, err)) {
+                report("Success", "Login successful!");
+                return;
+            }
+            qWarning() << "[LoginHandler] cannot use the daemon's session:" << QString::fromStdString(err);
+            doValidateLogin(username, password);
+        }, Executor::Pool::Cpu);
+    });
 }
 
 void LoginHandler::doValidateLogin(const QString& username,
                                    const QString& password)
 {
+    TRACE_SPAN("login", "login");
     std::string err;
     bool success = m_store->loginAndDecrypt(
         username.toStdString(),
@@ -35,15 +91,13 @@ void LoginHandler::doValidateLogin(const QString& username,
         message = err.empty() ? "Invalid username or password"
                               : QString::fromStdString(err);
     }
+    report(title, message);
+}
 
+void LoginHandler::report(const QString& title, const QString& message)
+{
     QMetaObject::invokeMethod(
         this,
         [this, title, message]() { emit loginResult(title, message); },
         Qt::QueuedConnection);
 }
-
-
-
-
-
-
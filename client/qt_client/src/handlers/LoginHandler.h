@@ -1,16 +1,18 @@
 #pragma once
 #include <QObject>
 #include <QString>
-#include <QtConcurrent>    // for QtConcurrent::run
-#include <QFutureWatcher>  // for QFutureWatcher
 
 class ClientStore;
+class DaemonClient;
 
 class LoginHandler : public QObject {
     Q_OBJECT
 public:
     explicit LoginHandler(ClientStore* store, QObject* parent = nullptr);
 
+    // With a daemon, logins unlock there once (Argon2) and this process borrows its MEK
+    void setDaemon(DaemonClient* daemon) { m_daemon = daemon; }
+
     // Exposed to QML:
     Q_INVOKABLE void validateLogin(const QString& username,
                                    const QString& password);
@@ -25,5 +27,12 @@ private:
     void doValidateLogin(const QString& username,
                          const QString& password);
 
-    ClientStore* m_store;
+    // Fetches the daemon's session (the password is its proof) and unlocks the local store with it
+    void adoptDaemonSession(const QString& username, const QString& password);
+    // Argon2 in this process, as without a daemon
+    void loginLocally(const QString& username, const QString& password);
+    void report(const QString& title, const QString& message);
+
+    ClientStore*  m_store;
+    DaemonClient* m_daemon = nullptr;
 };
@@ -0,0 +1,85 @@
+#include "diagnosticshandler.h"
+#include "../utils/metrics.h"
+
+#include <QDebug>
+#include <QVariantMap>
+
+namespace {
+
+QString formatBytes(double bytes)
+{
+    if (bytes >= 1024.0 * 1024.0)
+        return QString::number(bytes / (1024.0 * 1024.0), 'f', 1) + " MiB";
+    if (bytes >= 1024.0)
+        return QString::number(bytes / 1024.0, 'f', 1) + " KiB";
+    return QString::number(static_cast<qulonglong>(bytes)) + " B";
+}
+
+QString formatNs(double ns)
+{
+    if (ns >= 1e9)
+        return QString::number(ns / 1e9, 'f', 2) + " s";
+    if (ns >= 1e6)
+        return QString::number(ns / 1e6, 'f', 2) + " ms";
+    return QString::number(ns / 1e3, 'f', 1) + " µs";
+}
+
+QVariantMap row(const QString& section, const std::string& name, const QString& value)
+{
+    QVariantMap m;
+    m["section"] = section;
+    m["name"]    = QString::fromStdString(name);
+    m["value"]   = value;
+    return m;
+}
+
+} // namespace
+
+DiagnosticsHandler::DiagnosticsHandler(const QString& dumpPath, QObject* parent)
+    : QObject(parent)
+    , m_dumpPath(dumpPath)
+{}
+
+QVariantList DiagnosticsHandler::rows() const
+{
+    const auto snap = Metrics::instance().snapshot();
+    QVariantList out;
+
+    out << row("Process", "uptime", QString::number(snap.at("uptime_s").get<int64_t>()) + " s");
+
+    for (const auto& [name, v] : snap.at("counters").items()) {
+        const uint64_t n = v.get<uint64_t>();
+        // byte counters read better scaled
+        const bool bytes = name.find("bytes") != std::string::npos;
+        out << row("Counters", name, bytes ? formatBytes(static_cast<double>(n)) : QString::number(n));
+    }
+    for (const auto& [name, v] : snap.at("gauges").items())
+        out << row("Gauges", name, QString::number(v.get<int64_t>()));
+
+    for (const auto& [name, h] : snap.at("histograms").items()) {
+        const uint64_t count = h.at("count").get<uint64_t>();
+        if (!count) {
+            out << row("Histograms", name, QStringLiteral("–"));
+            continue;
+        }
+        auto fmt = [&](const char* key) {
+            const double v = static_cast<double>(h.at(key).get<uint64_t>());
+            return h.at("unit") == "bytes" ? formatBytes(v) : formatNs(v);
+        };
+        out << row("Histograms", name,
+                   QString("n=%1  p50 %2  p90 %3  p99 %4  max %5")
+                       .arg(count).arg(fmt("p50"), fmt("p90"), fmt("p99"), fmt("max")));
+    }
+    return out;
+}
+
+bool DiagnosticsHandler::dumpNow()
+{
+    std::string err;
+    if (!Metrics::instance().writeJson(m_dumpPath.toStdString(), err)) {
+        qWarning() << "[Diagnostics]" << QString::fromStdString(err);
+        return false;
+    }
+    qDebug() << "[Diagnostics] wrote" << m_dumpPath;
+    return true;
+}
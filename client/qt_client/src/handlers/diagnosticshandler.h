@@ -0,0 +1,32 @@
+#pragma once
+#include <QObject>
+#include <QString>
+#include <QVariantList>
+
+/**
+ * DiagnosticsHandler
+ *
+ * Backs the hidden diagnostics page (qml/Diagnostics.qml, Ctrl+Shift+D) with the
+ * process-wide Metrics registry (utils/metrics.h).
+ *
+ * QML ➜ diagnostics.rows()     one { section, name, value } per metric, values formatted
+ *                               (latencies in ms, sizes in KiB/MiB), sorted by name
+ * QML ➜ diagnostics.dumpNow()  writes the snapshot to dumpPath straight away
+ *
+ * Reading is cheap (one pass over the registry) so the page simply polls while open.
+ */
+class DiagnosticsHandler : public QObject
+{
+    Q_OBJECT
+    Q_PROPERTY(QString dumpPath READ dumpPath CONSTANT)
+public:
+    explicit DiagnosticsHandler(const QString& dumpPath, QObject* parent = nullptr);
+
+    QString dumpPath() const { return m_dumpPath; }
+
+    Q_INVOKABLE QVariantList rows() const;
+    Q_INVOKABLE bool dumpNow();
+
+private:
+    QString m_dumpPath;
+};
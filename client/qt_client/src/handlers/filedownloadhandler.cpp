@@ -1,6 +1,7 @@
 #include "FileDownloadHandler.h"
-#include "../utils/networking/asiosslclient.h"
 #include "../config.h"
+#include "../utils/metadatarecord.h"
+#include "../utils/tracing.h"
 #include <QMetaObject>
 #include <QDebug>
 #include <QFile>
@@ -17,24 +18,40 @@ static std::string toHex(const std::vector<uint8_t> &data) {
 
 FileDownloadHandler::FileDownloadHandler(ClientStore *s, QObject *parent): QObject(parent), store(s) {}
 
+void FileDownloadHandler::retire()
+{
+    m_flows.retire(this);
+}
+
 // Saves to a new file at a specified path
 bool FileDownloadHandler::saveToFile(const QString &path,
                                      const QByteArray &data)
 {
+    TRACE_SPAN_ARG("download", "persist", "bytes", data.size());
     QFile f(path);
     if (!f.open(QIODevice::WriteOnly)) return false;
     return f.write(data) == data.size();
 }
 
 
-bool FileDownloadHandler::saveToDownloads(const QString &fileName,
-                                          const QByteArray &data)
+QString FileDownloadHandler::downloadDir() const
 {
+    if (!m_downloadDir.isEmpty())
+        return m_downloadDir;
+
     // Platforms native download dir
     QString downloadsDir = QStandardPaths::writableLocation(QStandardPaths::DownloadLocation);
     if (downloadsDir.isEmpty()) {
         downloadsDir = QDir::homePath() + "/Downloads";
     }
+    return downloadsDir;
+}
+
+bool FileDownloadHandler::saveToDownloads(const QString &fileName,
+                                          const QByteArray &data,
+                                          QString *savedPath)
+{
+    QString downloadsDir = downloadDir();
 
     QDir().mkpath(downloadsDir); // ensure it exists
     QString fullPath = QDir(downloadsDir).filePath(fileName);
@@ -44,28 +61,55 @@ bool FileDownloadHandler::saveToDownloads(const QString &fileName,
         return false;
     }
     qInfo() << "[FileDownload] saved ↓" << fullPath;
+    if (savedPath)
+        *savedPath = fullPath;
     return true;
 }
 
 void FileDownloadHandler::downloadFile(qulonglong fileId)
 {
     // Process that file
-    HandlerUtils::runAsync([this, fileId]() { processSingleFile(fileId); });
+    Coro::spawn(runDownload(fileId));
 }
 
+Coro::Task<void> FileDownloadHandler::runDownload(qulonglong fileId)
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    // the store lookups and request signing happen off the GUI thread
+    co_await Coro::resumeOnCpu();
+
+    DownloadOutcome result;
+    try {
+        result = co_await processSingleFile(fileId);
+    } catch (const std::exception &ex) {
+        result = { "Exception", QString("Exception for file %1: %2")
+                                    .arg(fileId).arg(QString::fromStdString(ex.what())) };
+    }
 
+    co_await Coro::resumeOnUi(this);
+    if (flow.cancelled())
+        co_return;
+    const bool ok = result.title == "Success";
+    emit downloadResult(result.title, result.message);
+    if (ok)
+        emit fileReady(fileId, result.fileName, result.data);
+    emit downloadItemResult(fileId, result.savedPath, ok ? "downloaded" : "failed", result.message);
+}
 
-void FileDownloadHandler::processSingleFile(qulonglong fileId)
+Coro::Task<FileDownloadHandler::DownloadOutcome>
+FileDownloadHandler::processSingleFile(qulonglong fileId)
 {
+    TRACE_ASYNC(op, "download", "download");
 
     // look up FileClientData (owner-only path)
-    FileClientData *fcd = store->getFileData(fileId);
+    const auto fcd = store->getFileData(fileId);
     if (!fcd) {
         // TODO: implement for shared file
-        emit downloadResult("Error",
-                            QString("File %1 not in local store (shared download not implemented)")
-                                .arg(fileId));
-        return;
+        co_return DownloadOutcome{ "Error",
+                                   QString("File %1 not in local store (shared download not implemented)")
+                                       .arg(fileId) };
     }
 
     // Construct json body
@@ -86,23 +130,27 @@ void FileDownloadHandler::processSingleFile(qulonglong fileId)
     // HTTP POST
     HttpRequest req(HttpRequest::Method::POST, "/api/fs/download", bodyStr, headers);
 
-    AsioSslClient  client;
-    HttpResponse resp = client.sendRequest(req);
+    HttpResponse resp = co_await Coro::request(std::move(req));
 
     if (resp.statusCode != 200) {
-        emit downloadResult("Error",
-                            QString("Server returned %1 for file %2").arg(resp.statusCode).arg(fileId));
-        return;
+        co_return DownloadOutcome{ "Error",
+                                   QString("Server returned %1 for file %2").arg(resp.statusCode).arg(fileId) };
     }
 
+    // Parsing, verifying and decrypting are all CPU work
+    co_await Coro::resumeOnCpu();
+
     // Parse the JSON response
-    nlohmann::json jResp = nlohmann::json::parse(resp.body);
+    nlohmann::json jResp;
+    {
+        TRACE_SPAN_ARG("download", "parse", "bytes", resp.body.size());
+        jResp = nlohmann::json::parse(resp.body);
+    }
     bool isOwner = jResp.at("is_owner").get<bool>();
     if (!isOwner) {
         // TODO: Implement this later
-        emit downloadResult("Info",
-                            QString("File %1 is shared; client lacks sharing support").arg(fileId));
-        return;
+        co_return DownloadOutcome{ "Info",
+                                   QString("File %1 is shared; client lacks sharing support").arg(fileId) };
     }
 
     std::string fileB64 = jResp.at("file_content").get<std::string>();
@@ -139,35 +187,37 @@ void FileDownloadHandler::processSingleFile(qulonglong fileId)
     if (!verifySignatures(username, fileB64, metaB64,
                           edSigB64, pqSigB64,
                           userInfo.publicBundle, verifyErr)) {
-        emit downloadResult("Error",
-                            QString("Signature verification failed: %1").arg(
-                                QString::fromStdString(verifyErr)));
-        return;
+        co_return DownloadOutcome{ "Error",
+                                   QString("Signature verification failed: %1").arg(
+                                       QString::fromStdString(verifyErr)) };
     }
 
     // Decrypt
-    std::vector<uint8_t> fileCipher = FileClientData::base64_decode(fileB64);
-    std::vector<uint8_t> metaCipher = FileClientData::base64_decode(metaB64);
-
-    Symmetric::Plaintext plainFile = Symmetric::decrypt(
-        fileCipher,
-        std::vector<uint8_t>(fcd->fek.begin(), fcd->fek.end()),
-        std::vector<uint8_t>(fcd->file_nonce.begin(), fcd->file_nonce.end())
-        );
-
-    Symmetric::Plaintext plainMeta = Symmetric::decrypt(
-        metaCipher,
-        std::vector<uint8_t>(fcd->mek.begin(), fcd->mek.end()),
-        std::vector<uint8_t>(fcd->metadata_nonce.begin(), fcd->metadata_nonce.end())
-        );
+    Symmetric::Plaintext plainFile, plainMeta;
+    {
+        TRACE_SPAN("download", "decrypt");
+        std::vector<uint8_t> fileCipher = FileClientData::base64_decode(fileB64);
+        std::vector<uint8_t> metaCipher = FileClientData::base64_decode(metaB64);
+
+        plainFile = Symmetric::decrypt(
+            fileCipher,
+            std::vector<uint8_t>(fcd->fek.begin(), fcd->fek.end()),
+            std::vector<uint8_t>(fcd->file_nonce.begin(), fcd->file_nonce.end())
+            );
+
+        plainMeta = Symmetric::decrypt(
+            metaCipher,
+            std::vector<uint8_t>(fcd->mek.begin(), fcd->mek.end()),
+            std::vector<uint8_t>(fcd->metadata_nonce.begin(), fcd->metadata_nonce.end())
+            );
+    }
 
     // Get filename from metadata
     std::string fileName = fcd->filename;
     try {
-        nlohmann::json jMeta = nlohmann::json::parse(
-            std::string(reinterpret_cast<char*>(plainMeta.data.data()),
-                        plainMeta.data.size()));
-        fileName = jMeta.value("filename", fileName);
+        MetadataRecord::Fields meta;
+        MetadataRecord::decode(plainMeta.data.data(), plainMeta.data.size(), meta);
+        fileName.assign(meta.filename.begin(), meta.filename.end());
     } catch (...) {
         qDebug().nospace() << "Filename not found in metadata, defaulting to the filename stored in file client data";
     }
@@ -175,15 +225,16 @@ void FileDownloadHandler::processSingleFile(qulonglong fileId)
     QByteArray ba(reinterpret_cast<const char*>(plainFile.data.data()),
                   static_cast<int>(plainFile.data.size()));
 
-    // Save the byte array to downloads
-    if (!saveToDownloads(QString::fromStdString(fileName), ba)) {
-        emit downloadResult("Error", "Could not write into Downloads folder");
-        return;
+    // Save the byte array to downloads; a blocking write, so on the I/O pool
+    co_await Coro::resumeOnIo();
+    QString savedPath;
+    if (!saveToDownloads(QString::fromStdString(fileName), ba, &savedPath)) {
+        co_return DownloadOutcome{ "Error", QString("Could not write into %1").arg(downloadDir()) };
     }
 
-    emit downloadResult("Success",
-                        QString("Saved to Downloads (%1 bytes)").arg(ba.size()));
-    emit fileReady(fileId, QString::fromStdString(fileName), ba);
+    co_return DownloadOutcome{ "Success",
+                               QString("Saved to %1 (%2 bytes)").arg(savedPath).arg(ba.size()),
+                               QString::fromStdString(fileName), savedPath, ba };
 }
 
 bool FileDownloadHandler::verifySignatures(const std::string &username,
@@ -194,6 +245,8 @@ bool FileDownloadHandler::verifySignatures(const std::string &username,
                                            const KeyBundle   &pubBundle,
                                            std::string       &outError)
 {
+    TRACE_SPAN("download", "verify");
+
     // Decode ciphertexts
     std::vector<uint8_t> fileCipher = FileClientData::base64_decode(fileB64);
     std::vector<uint8_t> metaCipher = FileClientData::base64_decode(metaB64);
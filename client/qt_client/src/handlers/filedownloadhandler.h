@@ -13,6 +13,7 @@
 #include "../utils/crypto/DerUtils.h"
 #include "../utils/NetworkAuthUtils.h"
 #include "../utils/HandlerUtils.h"
+#include "../utils/coro.h"
 #include "../utils/networking/AsioHttpClient.h"
 #include "../utils/networking/HttpRequest.h"
 #include "../utils/networking/HttpResponse.h"
@@ -30,11 +31,17 @@ class FileDownloadHandler : public QObject {
 
 public:
     explicit FileDownloadHandler(ClientStore *store, QObject *parent = nullptr);
-    ~FileDownloadHandler() override = default;
+    // Cancels the flows in flight and deletes this once they have stopped; use instead of delete
+    void retire();
 
     Q_INVOKABLE void downloadFile(qulonglong fileId);
     Q_INVOKABLE bool saveToFile(const QString &path, const QByteArray &data);
-    bool saveToDownloads(const QString& fileName, const QByteArray& data);
+    // Writes into downloadDir(); savedPath (if given) receives the full path
+    bool saveToDownloads(const QString& fileName, const QByteArray& data, QString* savedPath = nullptr);
+
+    // Where downloads land; the platform Downloads folder unless set. Set before downloading.
+    void setDownloadDir(const QString& dir) { m_downloadDir = dir; }
+    QString downloadDir() const;
 
 signals:
     //title = "Success" | "Error" | "Exception"; message = user-friendly
@@ -43,12 +50,27 @@ signals:
     // Used for toast notifcation (not implemented yet
     void fileReady(qulonglong fileId, const QString &fileName, const QByteArray &plainData);
 
+    // Per-file outcome for scripted callers; status is "downloaded" or "failed"
+    void downloadItemResult(qulonglong fileId, const QString &savedPath,
+                            const QString &status, const QString &message);
+
 private:
-    // Background worker for a single file
-    void processSingleFile(qulonglong fileId);
+    struct DownloadOutcome {
+        QString     title;
+        QString     message;
+        QString     fileName;
+        QString     savedPath;
+        QByteArray  data;
+    };
+
+    // Flow for a single file (see coro.h): runDownload reports what processSingleFile returns
+    Coro::Task<void> runDownload(qulonglong fileId);
+    Coro::Task<DownloadOutcome> processSingleFile(qulonglong fileId);
 
     // Re-computes canonical string and verify both signatures
     bool verifySignatures(const std::string &username, const std::string &fileB64, const std::string &metaB64, const std::string &edSigB64, const std::string &pqSigB64, const KeyBundle &pubBundle,std::string &outError);
 
     ClientStore *store;
+    QString m_downloadDir;
+    Coro::FlowTracker m_flows;
 };
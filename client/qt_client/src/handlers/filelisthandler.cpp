@@ -1,10 +1,14 @@
 #include "FileListHandler.h"
-#include "../utils/networking/asiosslclient.h"
 #include "../config.h"
 #include "../utils/NetworkAuthUtils.h"
-#include "../utils/handlerutils.h"
+#include "../utils/pagearena.h"
+#include "../utils/listingdecoder.h"
+#include "../utils/uieventpump.h"
+#include "../utils/coro.h"
+#include "../utils/tracing.h"
 #include <QDebug>
 #include <map>
+#include <algorithm>
 
 static std::string first8(const std::vector<uint8_t>& v)
 {
@@ -17,7 +21,15 @@ static std::string first8(const std::vector<uint8_t>& v)
 using json = nlohmann::json;
 
 FileListHandler::FileListHandler(ClientStore* store, QObject* parent)
-    : QObject(parent), m_store(store)
+    : FileListHandler(store, Mode::Live, parent)
+{
+}
+
+FileListHandler::FileListHandler(ClientStore* store, Mode mode, QObject* parent)
+    : QObject(parent), m_store(store),
+      m_cache(std::make_unique<MetadataCache>(std::string(), std::vector<uint8_t>())),
+      m_model(new FileListModel(this)),
+      m_view(new FileFilterProxyModel(m_model, this))
 {
     // Immediately fetch the logged-in user’s info from ClientStore
     auto userOpt = m_store->getUser();
@@ -31,25 +43,101 @@ FileListHandler::FileListHandler(ClientStore* store, QObject* parent)
     const auto& info = *userOpt;
     m_username   = QString::fromStdString(info.username);
     m_privBundle = info.fullBundle;
+
+    // Warm start: the cached listing and its cursor, so the first sync only asks for what changed
+    std::string cachePath = m_store->directory() + "/metadata_cache_" + info.username + ".json";
+    m_cache = std::make_unique<MetadataCache>(cachePath, info.masterKey);
+    m_cache->load();
+
+    m_cursor = m_cache->cursor();
+    for (const auto& df : m_cache->entries())
+        m_listing[df.file_id] = df;
+
+    // The saved search index is only trusted if it covers exactly the cached listing;
+    // otherwise the model rebuilds it row by row as the listing arrives.
+    TrigramIndex& index = m_model->searchIndex();
+    if (auto blob = m_cache->blob(kSearchIndexBlob); blob && index.deserialize(*blob)) {
+        bool matches = index.size() == m_listing.size();
+        for (auto it = m_listing.begin(); matches && it != m_listing.end(); ++it)
+            matches = index.contains(it->first);
+        if (!matches)
+            index.clear();
+    }
+
+    if (mode == Mode::OneShot)
+        return;
+
+    // Server push: every "your feed moved" event becomes one delta sync, no polling
+    m_events = std::make_unique<ChangeSubscriber>(
+        m_username, m_privBundle,
+        [this]() {
+            std::lock_guard<std::mutex> lock(m_listingMutex);
+            return m_cursor;
+        });
+    connect(m_events.get(), &ChangeSubscriber::changesAvailable,
+            this, &FileListHandler::syncChanges, Qt::QueuedConnection);
+    m_events->start();
 }
 
-void FileListHandler::listAllFiles(int page) {
-    fetchPage(page, false, false);
+FileListHandler::~FileListHandler()
+{
+    // stop the event stream before anything it might call into goes away
+    if (m_events)
+        m_events->stop();
+
+    // m_cache writes itself out when it is destroyed right after this
+    m_cache->setBlob(kSearchIndexBlob, m_model->searchIndex().serialize());
 }
 
-void FileListHandler::listOwnedFiles(int page) {
-    fetchPage(page, true, false);
+void FileListHandler::retire()
+{
+    // no more syncs from the server; the flows use the store, cache, model and listing from
+    // the pools, so this is deleted once the last of them has stopped
+    if (m_events)
+        m_events->stop();
+    m_flows.retire(this);
+}
+
+void FileListHandler::listAllFiles(int page) {
+    Coro::spawn(fetchPage(page));
 }
 
-void FileListHandler::listSharedFiles(int page) {
-    fetchPage(page, false, true);
+Coro::Task<void> FileListHandler::fetchPage(int page) {
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    TRACE_ASYNC(op, "list", "page");
+    QString httpError;
+    auto maybeJson = co_await requestPage(page, httpError);
+    if (flow.cancelled())
+        co_return;
+    if (!maybeJson.has_value()) {
+        co_await Coro::resumeOnUi(this);
+        if (flow.cancelled())
+            co_return;
+        emit errorOccurred(httpError);
+        co_return;
+    }
+
+    // Decrypt the page and diff it into the model
+    co_await Coro::resumeOnCpu();
+    auto decryptedList = processFileArray((*maybeJson)["fileData"]);
+
+    co_await Coro::resumeOnUi(this);
+    if (flow.cancelled())
+        co_return;
+    // the table no longer shows the synced listing
+    m_listingShown = false;
+    m_model->applySnapshot(std::move(decryptedList));
+    emit filesLoaded(m_model->count());
 }
 
-void FileListHandler::fetchPage(int page, bool onlyOwned, bool onlyShared) {
+Coro::Task<std::optional<json>> FileListHandler::requestPage(int page, QString& outError) {
     // Build POST body
     std::string bodyStr = buildPostBody(page);
 
-    // Create Canonical String
+    // Create Canonical String (two signatures, so on the CPU pool)
+    co_await Coro::resumeOnCpu();
     auto headersMap = NetworkAuthUtils::makeAuthHeaders(
         m_username.toStdString(),
         m_privBundle,
@@ -60,27 +148,301 @@ void FileListHandler::fetchPage(int page, bool onlyOwned, bool onlyShared) {
     headersMap["Content-Type"] = "application/json";
 
     // Send the HTTP request
-    QString httpError;
-    auto maybeJson = sendListRequest(bodyStr, headersMap, httpError);
-    if (!maybeJson.has_value()) {
-        emit errorOccurred(httpError);
+    auto maybeJson = co_await sendListRequest("/api/fs/list", bodyStr, headersMap, outError);
+    if (!maybeJson.has_value())
+        co_return std::nullopt;
+
+    // Validate that “fileData” exists and is an array
+    if (!maybeJson->contains("fileData") || !(*maybeJson)["fileData"].is_array()) {
+        outError = "Malformed response: missing fileData[]";
+        qWarning() << "[FileList]" << outError;
+        co_return std::nullopt;
+    }
+    co_return std::move(maybeJson);
+}
+
+void FileListHandler::listAllPages()
+{
+    auto stream = std::make_shared<PageStream>();
+    stream->generation = ++m_streamGeneration;
+    m_listingShown = false;
+
+    // through the pump like the batches, so listingStarted always reaches QML first
+    UiEventPump::instance().post(this, [this]() { emit listingStarted(); });
+
+    Coro::spawn(runPageStream(stream));
+}
+
+Coro::Task<void> FileListHandler::runPageStream(std::shared_ptr<PageStream> stream)
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    // the workers overlap their page requests; the run closes once the last one is done
+    co_await Coro::resumeOnIo();
+    std::vector<Coro::Task<void>> workers;
+    for (int i = 0; i < kPageWorkers; ++i)
+        workers.push_back(pageWorker(stream));
+    co_await Coro::whenAll(std::move(workers));
+    finishPageStream(stream);
+}
+
+Coro::Task<void> FileListHandler::pageWorker(std::shared_ptr<PageStream> stream)
+{
+    const uint64_t generation = stream->generation;
+    const uint64_t rowsKey = UiEventPump::key(stream.get());
+    // every worker's batches in a frame reach the model as one upsert
+    auto postBatch = [this, generation, rowsKey, &stream](const std::vector<DecryptedFile>& batch) {
+        {
+            std::lock_guard<std::mutex> lock(stream->seenMutex);
+            stream->seen.insert(stream->seen.end(), batch.begin(), batch.end());
+        }
+        UiEventPump::instance().postAppend<DecryptedFile>(
+            this, rowsKey, batch,
+            [this, generation](std::vector<DecryptedFile>& rows) {
+                if (generation != m_streamGeneration)
+                    return;
+                dropPendingDeletes(rows);
+                m_model->upsert(rows);
+            });
+    };
+
+    // each worker claims the next unfetched page until one comes back without hasNextPage
+    PageArena arena;
+    while (generation == m_streamGeneration && !m_flows.closing()) {
+        int page = stream->nextPage.fetch_add(1);
+        if (page > stream->lastPage)
+            break;
+        TRACE_ASYNC(pageSpan, "list", "page");
+
+        QString httpError;
+        auto maybeJson = co_await requestPage(page, httpError);
+        if (!maybeJson.has_value()) {
+            stream->lastPage = 0;
+            stream->failed = true;
+            UiEventPump::instance().post(this, [this, httpError]() { emit errorOccurred(httpError); });
+            break;
+        }
+
+        const json& resp = *maybeJson;
+        if (!resp.value("hasNextPage", false)) {
+            int last = stream->lastPage;
+            while (page < last && !stream->lastPage.compare_exchange_weak(last, page)) {}
+        }
+
+        // decrypt on the CPU pool and hand rows over as soon as a batch is ready
+        co_await Coro::resumeOnCpu();
+        TRACE_SPAN_ARG("list", "decrypt", "entries", resp["fileData"].size());
+        std::vector<DecryptedFile> batch;
+        batch.reserve(kBatchSize);
+        for (const auto& jFile : resp["fileData"]) {
+            if (generation != m_streamGeneration)
+                break;
+            auto maybeDec = parseAndDecryptSingle(jFile, arena.resource());
+            if (!maybeDec.has_value()) {
+                qWarning() << "[FileList] Skipping file_id="
+                           << static_cast<qulonglong>(jFile.value("file_id", 0))
+                           << "due to decrypt error.";
+                continue;
+            }
+            batch.push_back(std::move(*maybeDec));
+            if (batch.size() >= static_cast<size_t>(kBatchSize)) {
+                postBatch(batch);
+                batch.clear();
+            }
+        }
+        if (!batch.empty())
+            postBatch(batch);
+        arena.reset();
+    }
+}
+
+void FileListHandler::finishPageStream(const std::shared_ptr<PageStream>& stream)
+{
+    const uint64_t generation = stream->generation;
+    m_cache->save();
+
+    // a complete run is the whole listing, so rows it never produced are stale
+    std::vector<DecryptedFile> all;
+    if (!stream->failed && generation == m_streamGeneration) {
+        std::lock_guard<std::mutex> lock(stream->seenMutex);
+        all = std::move(stream->seen);
+    }
+    const bool complete = !stream->failed;
+    auto snapshot = std::make_shared<std::vector<DecryptedFile>>(std::move(all));
+    UiEventPump::instance().post(this, [this, generation, complete, snapshot]() {
+        if (generation != m_streamGeneration)
+            return;
+        if (complete) {
+            dropPendingDeletes(*snapshot);
+            m_model->applySnapshot(std::move(*snapshot));
+        }
+        emit filesLoaded(m_model->count());
+        emit listingFinished();
+    });
+
+    if (m_syncAfterStream.exchange(false))
+        syncChanges();
+}
+
+void FileListHandler::syncChanges()
+{
+    // Cold start (nothing cached): stream the paged listing first so rows paint after one
+    // RTT. It also fills m_cache, so the full feed replay that follows is all cache hits.
+    bool cold;
+    {
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        cold = m_cursor == 0 && m_listing.empty();
+    }
+    if (cold && !m_streamedOnce.exchange(true)) {
+        m_syncAfterStream = true;
+        listAllPages();
         return;
     }
-    json fullResp = *maybeJson;
+    // the cold stream is still running and already ends with a sync
+    if (m_syncAfterStream)
+        return;
 
-    // Validate that “fileData” exists and is an array
-    if (!fullResp.contains("fileData") || !fullResp["fileData"].is_array()) {
-        QString errMsg = "Malformed response: missing fileData[]";
-        qWarning() << "[FileList]" << errMsg;
-        emit errorOccurred(errMsg);
+    // one sync at a time; a call that lands mid-sync makes the running one go round again
+    m_syncRequested = true;
+    if (m_syncRunning.exchange(true))
         return;
+
+    Coro::spawn(runSync());
+}
+
+Coro::Task<void> FileListHandler::runSync()
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    co_await Coro::resumeOnIo();
+    do {
+        while (m_syncRequested.exchange(false)) {
+            std::optional<bool> changed = co_await pullChanges();
+            if (flow.cancelled())
+                co_return;
+            if (changed.has_value() && (*changed || !m_listingShown))
+                emitListing();
+        }
+        m_syncRunning = false;
+    } while (m_syncRequested && !m_syncRunning.exchange(true));
+}
+
+Coro::Task<std::optional<bool>> FileListHandler::pullChanges()
+{
+    bool changed = false;
+    bool hasMore = true;
+    PageArena arena;
+
+    while (hasMore && !m_flows.closing()) {
+        uint64_t cursor;
+        {
+            std::lock_guard<std::mutex> lock(m_listingMutex);
+            cursor = m_cursor;
+        }
+
+        std::string bodyStr = json{ { "cursor", cursor } }.dump();
+        co_await Coro::resumeOnCpu();
+        auto headersMap = NetworkAuthUtils::makeAuthHeaders(
+            m_username.toStdString(),
+            m_privBundle,
+            "POST",
+            "/api/fs/changes",
+            bodyStr
+            );
+        headersMap["Content-Type"] = "application/json";
+
+        QString httpError;
+        auto maybeJson = co_await sendListRequest("/api/fs/changes", bodyStr, headersMap, httpError);
+        if (!maybeJson.has_value()
+            || !maybeJson->contains("changes") || !(*maybeJson)["changes"].is_array()
+            || !maybeJson->contains("cursor")) {
+            if (httpError.isEmpty())
+                httpError = "Malformed response: missing changes[]";
+            qWarning() << "[FileList]" << httpError;
+            UiEventPump::instance().post(this, [this, httpError]() { emit errorOccurred(httpError); });
+            co_return std::nullopt;
+        }
+
+        const json& resp = *maybeJson;
+        std::vector<uint64_t> dropKeys;
+        co_await Coro::resumeOnCpu();
+        for (const auto& change : resp["changes"])
+            changed |= applyChange(change, dropKeys, arena.resource());
+        co_await Coro::resumeOnIo();
+        m_store->removeFileDataBatch(dropKeys);
+        arena.reset();
+
+        {
+            std::lock_guard<std::mutex> lock(m_listingMutex);
+            m_cursor = resp["cursor"].get<uint64_t>();
+            m_cache->setCursor(m_cursor);
+        }
+        hasMore = resp.value("hasMore", false);
     }
 
-    // Process the array into a QVariantList
-    auto decryptedList = processFileArray(fullResp["fileData"], onlyOwned, onlyShared);
+    m_cache->save();
+    co_return changed;
+}
 
-    // Emit results
-    emit filesLoaded(decryptedList);
+bool FileListHandler::applyChange(const json& change, std::vector<uint64_t>& dropKeys,
+                                  std::pmr::memory_resource* arena)
+{
+    uint64_t fileId = change.at("file_id").get<uint64_t>();
+    std::string type = change.at("change_type").get<std::string>();
+
+    if (type == "added" || type == "changed") {
+        if (!change.contains("file"))
+            return false;
+
+        auto maybeDec = parseAndDecryptSingle(change["file"], arena);
+        if (!maybeDec.has_value()) {
+            qWarning() << "[FileList] Skipping change for file_id="
+                       << static_cast<qulonglong>(fileId)
+                       << "due to decrypt error.";
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        // being deleted by us: the server just hasn't caught up yet
+        if (m_pendingDeletes.count(fileId))
+            return false;
+        m_listing[fileId] = std::move(*maybeDec);
+        return true;
+    }
+
+    // "unshared" / "deleted": the file is gone for us, and so are any cached keys
+    bool wasListed;
+    {
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        wasListed = m_listing.erase(fileId) > 0;
+    }
+    m_cache->remove(fileId);
+    if (m_store->getFileData(fileId))
+        dropKeys.push_back(fileId);
+    return wasListed;
+}
+
+std::vector<DecryptedFile> FileListHandler::listingSnapshot() const
+{
+    std::lock_guard<std::mutex> lock(m_listingMutex);
+    std::vector<DecryptedFile> snapshot;
+    snapshot.reserve(m_listing.size());
+    // newest first, same order as /api/fs/list and the model
+    for (auto it = m_listing.rbegin(); it != m_listing.rend(); ++it)
+        snapshot.push_back(it->second);
+    return snapshot;
+}
+
+void FileListHandler::emitListing()
+{
+    m_listingShown = true;
+    auto rows = std::make_shared<std::vector<DecryptedFile>>(listingSnapshot());
+    UiEventPump::instance().post(this, [this, rows]() {
+        m_model->applySnapshot(std::move(*rows));
+        emit filesLoaded(m_model->count());
+    });
 }
 
 std::string FileListHandler::buildPostBody(int page) const {
@@ -90,143 +452,240 @@ std::string FileListHandler::buildPostBody(int page) const {
 
 void FileListHandler::deleteFile(qulonglong fileId)
 {
-    HandlerUtils::runAsync([this, fileId]() {
-        auto maybeUser = m_store->getUser();
-        if (!maybeUser.has_value()) {
-            QMetaObject::invokeMethod(
-                this, [this]() { emit errorOccurred("Not logged-in"); },
-                Qt::QueuedConnection);
-            return;
+    deleteFiles({ QVariant::fromValue(fileId) });
+}
+
+void FileListHandler::deleteFiles(const QVariantList& fileIds)
+{
+    auto batch = std::make_shared<DeleteBatch>();
+    std::vector<uint64_t> ids;
+    for (const QVariant& v : fileIds) {
+        uint64_t id = v.toULongLong();
+        if (std::find(ids.begin(), ids.end(), id) == ids.end())
+            ids.push_back(id);
+    }
+    if (ids.empty())
+        return;
+
+    // optimistic: the rows go now, and come back one by one if their delete fails
+    {
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        for (uint64_t id : ids) {
+            PendingDelete item;
+            item.fileId = id;
+            item.row    = m_model->find(id);
+            auto it = m_listing.find(id);
+            if (it != m_listing.end()) {
+                item.listed = true;
+                if (!item.row.has_value())
+                    item.row = it->second;
+                m_listing.erase(it);
+            }
+            m_pendingDeletes.insert(id);
+            batch->items.push_back(std::move(item));
         }
-        const auto& user   = *maybeUser;
-        const auto& uname  = user.username;
-        const auto& bundle = user.fullBundle;
-
-        // build JSON body
-        nlohmann::json jBody; jBody["file_id"] = static_cast<uint64_t>(fileId);
-        std::string bodyStr = jBody.dump();
-
-        auto headers = NetworkAuthUtils::makeAuthHeaders(
-            uname, bundle, "POST", "/api/fs/delete", bodyStr);
-
-        HttpRequest  req(HttpRequest::Method::POST,
-                        "/api/fs/delete", bodyStr, headers);
-        AsioSslClient cli;
-        HttpResponse  resp = cli.sendRequest(req);
-
-        if (resp.statusCode != 200) {
-            QMetaObject::invokeMethod(
-                this, [this]() {
-                    emit deleteResult("Error",  "Delete Failed");
-                    emit errorOccurred("Delete Failed");
-                },
-                Qt::QueuedConnection);
-            return;
+    }
+    m_model->removeFiles(ids);
+    emit filesLoaded(m_model->count());
+
+    Coro::spawn(runDeleteBatch(batch));
+}
+
+Coro::Task<void> FileListHandler::runDeleteBatch(std::shared_ptr<DeleteBatch> batch)
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    // bulk work: Low, so listing and sync requests queued meanwhile go first
+    co_await Coro::resumeOnIo(Executor::Priority::Low);
+    const int workers = std::min<int>(kDeleteWorkers, static_cast<int>(batch->items.size()));
+    std::vector<Coro::Task<void>> tasks;
+    for (int i = 0; i < workers; ++i)
+        tasks.push_back(deleteWorker(batch));
+    co_await Coro::whenAll(std::move(tasks));
+    finishDeleteBatch(batch);
+}
+
+Coro::Task<void> FileListHandler::deleteWorker(std::shared_ptr<DeleteBatch> batch)
+{
+    UiEventPump& pump = UiEventPump::instance();
+    const int total = static_cast<int>(batch->items.size());
+    const uint64_t progressKey = UiEventPump::key(batch.get(), 0);
+    const uint64_t failuresKey = UiEventPump::key(batch.get(), 1);
+
+    // a closing handler stops claiming items; the batch still settles what was deleted
+    for (size_t i = batch->next.fetch_add(1); i < batch->items.size() && !m_flows.closing();
+         i = batch->next.fetch_add(1)) {
+        const PendingDelete& item = batch->items[i];
+
+        QString error;
+        const bool ok = co_await sendDelete(item.fileId, error);
+        const int done = ++batch->done;
+        pump.postLatest(this, progressKey, [this, done, total]() { emit deleteProgress(done, total); });
+
+        if (ok) {
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            batch->deleted.push_back(item.fileId);
+            continue;
         }
 
-        // success – remove cached keys
-        m_store->removeFileData(fileId);
+        qWarning() << "[FileList] delete failed for file_id=" << static_cast<qulonglong>(item.fileId) << error;
+        {
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            ++batch->failed;
+        }
+        // roll this row back; the rest of the batch carries on
+        {
+            std::lock_guard<std::mutex> lock(m_listingMutex);
+            m_pendingDeletes.erase(item.fileId);
+            if (item.listed && item.row.has_value())
+                m_listing[item.fileId] = *item.row;
+        }
+        // failures landing in the same frame come back as one upsert
+        pump.postAppend<DeleteFailure>(
+            this, failuresKey, { DeleteFailure{ item, error } },
+            [this](std::vector<DeleteFailure>& failures) {
+                std::vector<DecryptedFile> rows;
+                for (const auto& f : failures)
+                    if (f.item.row.has_value())
+                        rows.push_back(*f.item.row);
+                m_model->upsert(rows);
+                for (const auto& f : failures)
+                    emit deleteFailed(static_cast<qulonglong>(f.item.fileId), f.error);
+            });
+    }
+}
 
-        // refresh list (still off UI thread)
-        listAllFiles(1);
+void FileListHandler::finishDeleteBatch(const std::shared_ptr<DeleteBatch>& batch)
+{
+    // settles local state for the whole batch in one go
+    m_store->removeFileDataBatch(batch->deleted);
+    for (uint64_t id : batch->deleted)
+        m_cache->remove(id);
+    m_cache->save();
+    {
+        std::lock_guard<std::mutex> lock(m_listingMutex);
+        for (uint64_t id : batch->deleted)
+            m_pendingDeletes.erase(id);
+    }
 
-        QMetaObject::invokeMethod(
-            this, [this]() {
-                emit deleteResult("Success", "File deleted successfully");
-            },
-            Qt::QueuedConnection);
+    const int deleted = static_cast<int>(batch->deleted.size());
+    const int failed  = batch->failed;
+    UiEventPump& pump = UiEventPump::instance();
+
+    // the final count goes through the workers' coalesced slot: two workers can post their
+    // counts out of order, and a stale one must not be the last progress the view sees
+    const int done  = batch->done;
+    const int total = static_cast<int>(batch->items.size());
+    pump.postLatest(this, UiEventPump::key(batch.get(), 0),
+                    [this, done, total]() { emit deleteProgress(done, total); });
+    pump.post(this, [this, deleted, failed]() {
+        if (failed == 0)
+            emit deleteResult("Success", deleted == 1
+                              ? QString("File deleted successfully")
+                              : QString("%1 files deleted").arg(deleted));
+        else
+            emit deleteResult("Error", QString("%1 of %2 deletes failed")
+                              .arg(failed).arg(deleted + failed));
+        emit filesLoaded(m_model->count());
     });
+
+    // pick up anything else that changed meanwhile
+    syncChanges();
 }
 
+Coro::Task<bool> FileListHandler::sendDelete(uint64_t fileId, QString& outError)
+{
+    std::string bodyStr = json{ { "file_id", fileId } }.dump();
+    co_await Coro::resumeOnCpu(Executor::Priority::Low);
+    auto headers = NetworkAuthUtils::makeAuthHeaders(
+        m_username.toStdString(), m_privBundle, "POST", "/api/fs/delete", bodyStr);
+
+    HttpRequest  req(HttpRequest::Method::POST, "/api/fs/delete", bodyStr, headers);
+    HttpResponse resp = co_await Coro::request(std::move(req), Executor::Priority::Low);
 
-std::optional<json> FileListHandler::sendListRequest(
-    const std::string& bodyStr,
-    const std::map<std::string, std::string>& headers,
+    if (resp.statusCode != 200) {
+        outError = QString("Delete failed (HTTP %1)").arg(resp.statusCode);
+        co_return false;
+    }
+    co_return true;
+}
+
+void FileListHandler::dropPendingDeletes(std::vector<DecryptedFile>& files)
+{
+    std::lock_guard<std::mutex> lock(m_listingMutex);
+    if (m_pendingDeletes.empty())
+        return;
+    files.erase(std::remove_if(files.begin(), files.end(),
+                               [this](const DecryptedFile& f) { return m_pendingDeletes.count(f.file_id) > 0; }),
+                files.end());
+}
+
+
+Coro::Task<std::optional<json>> FileListHandler::sendListRequest(
+    std::string path,
+    std::string bodyStr,
+    std::map<std::string, std::string> headers,
     QString& outError
     ) {
-    AsioSslClient client;
-
     // Build and send the request
     HttpRequest req(
         HttpRequest::Method::POST,
-        "/api/fs/list",
+        path,
         bodyStr,
         headers
         );
-    HttpResponse resp = client.sendRequest(req);
+    HttpResponse resp = co_await Coro::request(std::move(req));
 
     if (resp.statusCode != 200) {
-        outError = QString("ListFiles HTTP %1: %2")
+        outError = QString("%1 HTTP %2: %3")
+                       .arg(QString::fromStdString(path))
                        .arg(resp.statusCode)
                        .arg(QString::fromStdString(resp.body));
         qWarning() << "[FileList]" << outError;
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     // Parse response body as JSON
     try {
-        return json::parse(resp.body);
+        TRACE_SPAN_ARG("list", "parse", "bytes", resp.body.size());
+        co_return json::parse(resp.body);
     }
     catch (const std::exception& ex) {
-        outError = QString("Failed to parse JSON from /api/fs/list: %1")
+        outError = QString("Failed to parse JSON from %1: %2")
+                       .arg(QString::fromStdString(path))
                        .arg(ex.what());
         qWarning() << "[FileList]" << outError;
-        return std::nullopt;
+        co_return std::nullopt;
     }
 }
 
-QVariantList FileListHandler::processFileArray(
-    const json& fileArray,
-    bool onlyOwned,
-    bool onlyShared
+std::vector<DecryptedFile> FileListHandler::processFileArray(
+    const json& fileArray
     ) {
-    QVariantList outList;
+    TRACE_SPAN_ARG("list", "decrypt", "entries", fileArray.size());
+    std::vector<DecryptedFile> outList;
     outList.reserve(fileArray.size());
+    PageArena arena;
 
     for (const auto& jFile : fileArray) {
-        bool isOwner = jFile.at("is_owner").get<bool>();
-        if (onlyOwned  && !isOwner)  continue;
-        if (onlyShared && isOwner)   continue;
-
-        // Decrypt & turn into QVariantMap
-        auto maybeMap = decryptSingleToVariant(jFile);
-        if (!maybeMap.has_value()) {
+        // Decrypt (or fetch from the metadata cache)
+        auto maybeDec = parseAndDecryptSingle(jFile, arena.resource());
+        if (!maybeDec.has_value()) {
             qWarning() << "[FileList] Skipping file_id="
                        << static_cast<qulonglong>(jFile.value("file_id", 0))
                        << "due to decrypt error.";
             continue;
         }
-        outList.push_back(*maybeMap);
+        outList.push_back(std::move(*maybeDec));
     }
 
     return outList;
 }
 
-std::optional<QVariantMap> FileListHandler::decryptSingleToVariant(
-    const json& singleFileJson
-    ) {
-    // Parse & decrypt into our intermediate struct
-    auto maybeDec = parseAndDecryptSingle(singleFileJson);
-    if (!maybeDec.has_value()) {
-        return std::nullopt;
-    }
-    const DecryptedFile& df = *maybeDec;
-
-    // Build a QVariantMap with exactly the keys QML expects
-    QVariantMap singleMap;
-    singleMap["file_id"]     = (qulonglong) df.file_id;
-    singleMap["filename"]    = df.filename;
-    singleMap["size"]        = (qulonglong) df.size_bytes;
-    singleMap["modified"]    = df.upload_timestamp;
-    singleMap["is_owner"]    = df.is_owner;
-    singleMap["is_shared"]   = df.is_shared;
-    singleMap["shared_from"] = df.shared_from;
-
-    return singleMap;
-}
-
 std::optional<DecryptedFile> FileListHandler::parseAndDecryptSingle(
-    const json& singleFileJson
+    const json& singleFileJson,
+    std::pmr::memory_resource* arena
     ) {
     DecryptedFile result;
     result.file_id   = singleFileJson.at("file_id").get<uint64_t>();
@@ -234,25 +693,35 @@ std::optional<DecryptedFile> FileListHandler::parseAndDecryptSingle(
     result.is_shared = singleFileJson.contains("shared_access");
     result.shared_from.clear();
 
-    // Retrieve local FileClientData for this file_id
-    FileClientData* fcd = m_store->getFileData(result.file_id);
+    // Unchanged ciphertext → same plaintext; shared entries also need their unwrapped keys
+    // still on hand, otherwise take the slow path once to re-cache them
+    const std::string& metaB64 = singleFileJson.at("metadata").get_ref<const std::string&>();
+    std::string metaDigest = MetadataCache::digestOf(metaB64);
+    if (auto cached = m_cache->lookup(result.file_id, metaDigest)) {
+        if (cached->is_owner == result.is_owner
+            && (result.is_owner || m_store->getFileData(result.file_id)))
+            return cached;
+    }
 
-    std::vector<uint8_t> finalMEK(32);
-    std::vector<uint8_t> iv_metadata(16);
+    // owned files decrypt straight from the ClientStore copy; only shares own their keys here
+    const uint8_t* finalMEK    = nullptr;
+    const uint8_t* iv_metadata = nullptr;
+    std::optional<FileClientData> ownFcd;
+    std::vector<uint8_t> sharedMEK;
+    std::vector<uint8_t> sharedIV;
 
     if (result.is_owner)
     {
         /* we really need the local copy for owned files */
-        FileClientData* fcdPtr = m_store->getFileData(result.file_id);
-        if (!fcdPtr) {
+        ownFcd = m_store->getFileData(result.file_id);
+        if (!ownFcd) {
             qWarning() << "[FileList]    owner but no local keys for file_id="
                        << result.file_id;
             return std::nullopt;
         }
 
-        finalMEK    = { fcdPtr->mek.begin(), fcdPtr->mek.end() };
-        iv_metadata = { fcdPtr->metadata_nonce.begin(),
-                       fcdPtr->metadata_nonce.end() };
+        finalMEK    = ownFcd->mek.data();
+        iv_metadata = ownFcd->metadata_nonce.data();
     }
     else                // ───── shared file path ─────
     {
@@ -264,21 +733,23 @@ std::optional<DecryptedFile> FileListHandler::parseAndDecryptSingle(
             // ❷  IV that the sharer sent for the metadata blob
             std::string ivB64 = singleFileJson["shared_access"]["metadata_nonce"]
                                     .get<std::string>();
-            iv_metadata = FileClientData::base64_decode(ivB64);
-            if (iv_metadata.size() != FileClientData::PUBLIC_NONCE_LEN)
+            sharedIV = FileClientData::base64_decode(ivB64);
+            if (sharedIV.size() != FileClientData::PUBLIC_NONCE_LEN)
                            throw std::runtime_error("metadata_nonce wrong length");
 
-                        finalMEK = std::move(rawMEK);
-
-                        /* optional – cache for later downloads */
-                       FileClientData cache(result.file_id);
+            /* optional – cache for later downloads */
+            FileClientData cache(result.file_id);
             cache.file_id = result.file_id;              // ctor that zeros
             std::copy(rawMEK.begin(),  rawMEK.end(),  cache.mek.begin());
             std::copy(rawFEK.begin(),  rawFEK.end(),  cache.fek.begin());
-            std::copy(iv_metadata.begin(), iv_metadata.end(),
+            std::copy(sharedIV.begin(), sharedIV.end(),
                       cache.metadata_nonce.begin());
             m_store->upsertFileData(cache);
 
+            sharedMEK   = std::move(rawMEK);
+            finalMEK    = sharedMEK.data();
+            iv_metadata = sharedIV.data();
+
             result.shared_from =
                 QString::fromStdString(
                     singleFileJson["owner_username"].get<std::string>());
@@ -290,54 +761,27 @@ std::optional<DecryptedFile> FileListHandler::parseAndDecryptSingle(
         }
     }
 
-    // Base64‐decode “metadata” ciphertext, then AES-CTR‐decrypt with finalMEK + iv_metadata
-    std::string metaB64 = singleFileJson.at("metadata").get<std::string>();
-    std::vector<uint8_t> metaCipherBytes = FileClientData::base64_decode(metaB64);
-
-    Symmetric::Ciphertext ctext;
-    ctext.data = metaCipherBytes;
-    ctext.iv   = iv_metadata;
-
-    Symmetric::Plaintext ptxt;
-    try {
-        ptxt = Symmetric::decrypt(ctext.data, finalMEK, ctext.iv);
-    }
-    catch (const std::exception& ex) {
-        qWarning() << "[FileList] Failed to decrypt metadata for file_id="
-                   << result.file_id << ":" << ex.what();
-        return std::nullopt;
-    }
-
-    // Parse the plaintext JSON of metadata
-    std::string metaJsonStr(reinterpret_cast<char*>(ptxt.data.data()), ptxt.data.size());
-
-    json metaJson;
+    // Base64-decode, AES-CTR-decrypt and read the metadata JSON, all in the page arena
+    std::optional<ListingDecoder::DecodedMetadata> meta;
     try {
-        metaJson = json::parse(metaJsonStr);
+        meta.emplace(ListingDecoder::decodeMetadata(metaB64, finalMEK, iv_metadata, arena));
     }
     catch (const std::exception& ex) {
-        qWarning() << "[FileList] Invalid metadata JSON for file_id="
-                   << result.file_id << ":" << ex.what();
-        return std::nullopt;
-    }
-
-    // Fill out filename + size
-    if (!metaJson.contains("filename") || !metaJson.contains("filesize")) {
-        qWarning() << "[FileList] metadata for file_id=" << result.file_id
-                   << "is missing filename / filesize – skipping.";
+        qWarning() << "[FileList] Unreadable metadata for file_id="
+                   << result.file_id << ":" << ex.what() << "– skipping.";
         return std::nullopt;            // skip this entry instead of aborting
     }
 
-
-    result.filename   = QString::fromStdString(
-        metaJson.at("filename").get<std::string>()
-        );
-    result.size_bytes = metaJson.at("filesize").get<uint64_t>();
+    result.filename   = QString::fromUtf8(meta->filename.data(),
+                                          static_cast<qsizetype>(meta->filename.size()));
+    result.size_bytes = meta->size_bytes;
 
     // timestamp: prefer metadata, else fallback to server’s field
-    if (metaJson.contains("upload_timestamp")) {
-        std::string ts = metaJson["upload_timestamp"].get<std::string>();
-        QDateTime dt = QDateTime::fromString(QString::fromStdString(ts), Qt::ISODate);
+    if (meta->has_timestamp) {
+        QDateTime dt = QDateTime::fromString(
+            QString::fromUtf8(meta->upload_timestamp.data(),
+                              static_cast<qsizetype>(meta->upload_timestamp.size())),
+            Qt::ISODate);
         result.upload_timestamp = dt.isValid() ? dt : QDateTime();
     }
     else if (singleFileJson.contains("upload_timestamp")) {
@@ -349,6 +793,7 @@ std::optional<DecryptedFile> FileListHandler::parseAndDecryptSingle(
         result.upload_timestamp = QDateTime();
     }
 
+    m_cache->insert(result, metaDigest);
     return result;
 }
 
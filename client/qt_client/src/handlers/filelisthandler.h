@@ -7,60 +7,155 @@
 #include <vector>
 #include <optional>
 #include <map>
+#include <set>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <limits>
+#include <memory_resource>
 #include <nlohmann/json.hpp>
 #include "../utils/ClientStore.h"
+#include "../utils/decryptedfile.h"
+#include "../utils/metadatacache.h"
+#include "../utils/changesubscriber.h"
+#include "../utils/coro.h"
+#include "../models/filelistmodel.h"
+#include "../models/filefilterproxymodel.h"
 #include "../utils/crypto/KeyBundle.h"
 #include "../utils/crypto/Symmetric.h"
 #include "../utils/crypto/FileClientData.h"
 
-/**
- * A simplified struct representing one file’s decrypted metadata.
- */
-struct DecryptedFile {
-    uint64_t    file_id;
-    QString     filename;
-    uint64_t    size_bytes;
-    QDateTime   upload_timestamp;
-    bool        is_owner;
-    bool        is_shared;
-    QString     shared_from;  // If shared, the username of the sharer (optional)
-};
-
 class FileListHandler : public QObject {
     Q_OBJECT
+    // Rows for FileTable.qml; every list/sync/delete lands here as a row-level diff
+    Q_PROPERTY(FileListModel* model READ model CONSTANT)
+    // What the table shows: model filtered by search and ownership, sorted by view.sortKey
+    Q_PROPERTY(FileFilterProxyModel* view READ view CONSTANT)
 
 public:
+    // Live subscribes to the server's change feed and syncs on every push; OneShot is for a
+    // single listing (ssshare-cli list) and opens no event stream
+    enum class Mode { Live, OneShot };
+
     explicit FileListHandler(ClientStore* store, QObject* parent = nullptr);
+    FileListHandler(ClientStore* store, Mode mode, QObject* parent = nullptr);
+    ~FileListHandler() override;
+    // Stops the event stream, cancels the flows in flight and deletes this once they have
+    // stopped; owners call this instead of delete
+    void retire();
+
+    FileListModel* model() const { return m_model; }
+    FileFilterProxyModel* view() const { return m_view; }
+
+    // The change-feed listing as of now, newest first; safe from any thread
+    std::vector<DecryptedFile> listingSnapshot() const;
 
+    // Single page view; "My files" / "Shared with me" are view.ownership flips, not requests
     Q_INVOKABLE void listAllFiles(int page = 1);
-    Q_INVOKABLE void listOwnedFiles(int page = 1);
-    Q_INVOKABLE void listSharedFiles(int page = 1);
+
+    // "All files" mode: fetches every page with a few concurrent workers and streams
+    // decrypted rows into the model in small batches (listingStarted → … → listingFinished).
+    Q_INVOKABLE void listAllPages();
+
+    // Pulls every change since the last cursor from /api/fs/changes and applies it to the
+    // local listing. With nothing new this costs one small request and emits nothing.
+    // Also triggered by the server's /api/fs/events push (ChangeSubscriber).
+    Q_INVOKABLE void syncChanges();
 
     // file delete goes into this handler for simplicity
     Q_INVOKABLE void deleteFile(qulonglong fileId);
 
+    // Drops the rows from model() immediately, then deletes on the server with a few
+    // concurrent workers. A failed delete puts just that row back (deleteFailed); the
+    // batch reports deleteProgress at most once a frame and ends with one deleteResult
+    // and a single ClientStore save.
+    Q_INVOKABLE void deleteFiles(const QVariantList& fileIds);
+
 signals:
-    // Emitted after a page of files is fetched & decrypted.
-    // Each QVariantMap has keys: file_id, filename, size, modified, is_owner, is_shared, shared_from.
-    void filesLoaded(const QVariantList& decryptedFiles);
+    // Emitted after a page or sync has been applied to model(); fileCount is the new row count.
+    void filesLoaded(int fileCount);
+
+    // Bracket a listAllPages() run; rows stream into model() in between, in no particular order.
+    void listingStarted();
+    void listingFinished();
 
     // Emitted if something goes wrong (e.g. network error, JSON parse error, decryption failure).
     void errorOccurred(const QString& message);
 
     void deleteResult(const QString& title, const QString& message);
+    void deleteFailed(qulonglong fileId, const QString& message);
+    void deleteProgress(int done, int total);
 
 private:
-    void fetchPage(int page, bool onlyOwned, bool onlyShared);
+    // Shared state of one listAllPages() run; workers of a superseded run see a stale generation and stop
+    struct PageStream {
+        uint64_t            generation = 0;
+        std::atomic<int>    nextPage{1};
+        std::atomic<int>    lastPage{std::numeric_limits<int>::max()};
+        std::atomic<bool>   failed{false};
+
+        // every row streamed so far; applied as one snapshot at the end to drop stale rows
+        std::mutex                  seenMutex;
+        std::vector<DecryptedFile>  seen;
+    };
+
+    // One deleteFiles() call; rows are restored from `row` when their delete fails
+    struct PendingDelete {
+        uint64_t                        fileId = 0;
+        std::optional<DecryptedFile>    row;
+        bool                            listed = false;     // was in m_listing
+    };
+    struct DeleteFailure {
+        PendingDelete   item;
+        QString         error;
+    };
+    struct DeleteBatch {
+        std::vector<PendingDelete>  items;
+        std::atomic<size_t>         next{0};
+        std::atomic<int>            done{0};
+
+        std::mutex                  mutex;
+        std::vector<uint64_t>       deleted;
+        int                         failed = 0;
+    };
+
+    static constexpr int kPageWorkers = 4;
+    static constexpr int kDeleteWorkers = 6;
+    static constexpr int kBatchSize   = 8;
+    static constexpr const char* kSearchIndexBlob = "search_index";
+
+    // Flows (see coro.h); a flow's reference parameters must outlive it, so callers co_await at once
+    Coro::Task<void> fetchPage(int page);
+    Coro::Task<std::optional<nlohmann::json>> requestPage(int page, QString& outError);
+    // kPageWorkers pageWorker()s claiming pages in turn, then finishPageStream()
+    Coro::Task<void> runPageStream(std::shared_ptr<PageStream> stream);
+    Coro::Task<void> pageWorker(std::shared_ptr<PageStream> stream);
+    void finishPageStream(const std::shared_ptr<PageStream>& stream);
     std::string buildPostBody(int page) const;
-    std::optional<nlohmann::json> sendListRequest(const std::string& bodyStr, const std::map<std::string, std::string>& headers, QString& outError);
+    Coro::Task<std::optional<nlohmann::json>> sendListRequest(std::string path, std::string bodyStr, std::map<std::string, std::string> headers, QString& outError);
+
+    Coro::Task<void> runSync();
+    // Drains the change feed from m_cursor; true if the local listing changed, empty if a request failed
+    Coro::Task<std::optional<bool>> pullChanges();
+    // dropKeys collects files whose ClientStore keys should go, removed in one save by the caller
+    bool applyChange(const nlohmann::json& change, std::vector<uint64_t>& dropKeys,
+                     std::pmr::memory_resource* arena);
+    void emitListing();
 
-    // Given the “fileData” array, filter (owned/shared) & decrypt all entries to QVariantList
-    QVariantList processFileArray(const nlohmann::json& fileArray, bool onlyOwned, bool onlyShared);
+    Coro::Task<void> runDeleteBatch(std::shared_ptr<DeleteBatch> batch);
+    Coro::Task<void> deleteWorker(std::shared_ptr<DeleteBatch> batch);
+    void finishDeleteBatch(const std::shared_ptr<DeleteBatch>& batch);
+    Coro::Task<bool> sendDelete(uint64_t fileId, QString& outError);
+    // Filters rows whose delete is still in flight out of a server listing
+    void dropPendingDeletes(std::vector<DecryptedFile>& files);
 
-    // Decrypt metadata & build a QVariantMap
-    std::optional<QVariantMap> decryptSingleToVariant(const nlohmann::json& singleFileJson);
+    // Given the “fileData” array, decrypt all entries
+    std::vector<DecryptedFile> processFileArray(const nlohmann::json& fileArray);
 
-    std::optional<DecryptedFile> parseAndDecryptSingle(const nlohmann::json& singleFileJson);
+    // Served from m_cache when the metadata ciphertext is unchanged, otherwise decrypted and
+    // cached. Decode scratch comes from arena, which the caller resets once per page.
+    std::optional<DecryptedFile> parseAndDecryptSingle(const nlohmann::json& singleFileJson,
+                                                       std::pmr::memory_resource* arena);
 
     // Unwrap FEK/MEK via X25519 + AES-CTR
     std::pair<std::vector<uint8_t>, std::vector<uint8_t>> unwrapKeysFromJson(const nlohmann::json& singleFileJson, const KeyBundle& privBundle);
@@ -69,4 +164,25 @@ private:
     ClientStore*    m_store;
     QString         m_username;
     KeyBundle       m_privBundle;
+    std::unique_ptr<MetadataCache> m_cache;
+    FileListModel*  m_model;
+    FileFilterProxyModel* m_view;
+
+    std::unique_ptr<ChangeSubscriber> m_events;
+
+    // local listing kept in step with the server's change feed
+    mutable std::mutex                  m_listingMutex;
+    std::map<uint64_t, DecryptedFile>   m_listing;
+    uint64_t                            m_cursor = 0;
+    std::set<uint64_t>                  m_pendingDeletes;
+    std::atomic<bool>                   m_listingShown{false};
+    std::atomic<bool>                   m_syncRunning{false};
+    std::atomic<bool>                   m_syncRequested{false};
+
+    std::atomic<uint64_t>               m_streamGeneration{0};
+    std::atomic<bool>                   m_streamedOnce{false};
+    std::atomic<bool>                   m_syncAfterStream{false};
+
+    // every spawned flow; retire() deletes this once they are done
+    Coro::FlowTracker                   m_flows;
 };
@@ -4,10 +4,12 @@
 #include <nlohmann/json.hpp>
 #include <QMetaObject>
 #include <QDebug>
+#include <algorithm>
 #include <sodium.h>
 #include <openssl/rand.h>
-#include "../utils/networking/asiosslclient.h"
 #include "../utils/crypto/hash.h"
+#include "../utils/uieventpump.h"
+#include "../utils/tracing.h"
 
 using json = nlohmann::json;
 
@@ -17,6 +19,12 @@ FileShareHandler::FileShareHandler(ClientStore* s, QObject* parent)
     qDebug() << "[FileShareHandler] Constructor called; this =" << this;
 }
 
+void FileShareHandler::retire()
+{
+    // shares and revokes read m_store and report through this from the pools
+    m_flows.retire(this);
+}
+
 // Called from QML: shareFile(fileId, username)
 void FileShareHandler::shareFile(qulonglong fileId,
                                  const QString& targetUserQ)
@@ -24,14 +32,34 @@ void FileShareHandler::shareFile(qulonglong fileId,
     qDebug() << "[FileShareHandler] shareFile() invoked from QML"
              << " fileId =" << fileId
              << " targetUser =" << targetUserQ;
-    // Spin the heavy crypto / I/O in a background thread
-    HandlerUtils::runAsync([=]() {
-        processShare(fileId, targetUserQ.toStdString());
-    });
+    Coro::spawn(runShare(fileId, targetUserQ.toStdString()));
+}
+
+Coro::Task<void> FileShareHandler::runShare(qulonglong fileId, std::string targetUser)
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    // the store lookups and key wrapping happen off the GUI thread
+    co_await Coro::resumeOnCpu();
+    ShareOutcome result;
+    try {
+        result = co_await processShare(fileId, targetUser);
+    } catch (const std::exception& ex) {
+        result = { "Exception", QString::fromStdString(ex.what()) };
+    }
+    co_await Coro::resumeOnUi(this);
+    if (flow.cancelled())
+        co_return;
+    emit shareResult(result.title, result.message);
+    emit shareItemResult(fileId, QString::fromStdString(targetUser),
+                         result.title == "Success" ? "shared" : "failed", result.message);
 }
 
-void FileShareHandler::processShare(qulonglong fileId, const std::string &targetUser)
+Coro::Task<FileShareHandler::ShareOutcome>
+FileShareHandler::processShare(qulonglong fileId, const std::string &targetUser)
 {
+    TRACE_ASYNC(op, "share", "share");
     qDebug() << "[processShare] Entered. fileId =" << fileId
              << " targetUser =" << QString::fromStdString(targetUser);
 
@@ -39,8 +67,7 @@ void FileShareHandler::processShare(qulonglong fileId, const std::string &target
     auto maybeUser = m_store->getUser();
     if (!maybeUser.has_value()) {
         qWarning() << "[processShare] ERROR: No logged‑in user in ClientStore";
-        emit shareResult("Error", "Not logged‑in");
-        return;
+        co_return ShareOutcome{ "Error", "Not logged‑in" };
     }
     const auto &me      = *maybeUser;
     const auto &myUname = me.username;
@@ -49,40 +76,45 @@ void FileShareHandler::processShare(qulonglong fileId, const std::string &target
     // Prevent sharing with self
     if (myUname == targetUser) {
         qWarning() << "[processShare] ERROR: Attempt to share with self";
-        emit shareResult("Error", "Cannot share with yourself");
-        return;
+        co_return ShareOutcome{ "Error", "Cannot share with yourself" };
     }
 
     // ─── 1. Look up FileClientData; must own the file ─────────────────────────
-    FileClientData *fcdPtr = m_store->getFileData(fileId);
-    if (!fcdPtr) {
+    // our own copy: it has to outlive the key-bundle fetch below
+    const auto maybeFcd = m_store->getFileData(fileId);
+    if (!maybeFcd) {
         QString msg = QString("No local FileClientData for file_id=%1").arg(fileId);
         qWarning() << "[processShare] ERROR:" << msg;
-        emit shareResult("Error", msg);
-        return;
+        co_return ShareOutcome{ "Error", msg };
     }
-    const FileClientData &fcd = *fcdPtr;
+    const FileClientData &fcd = *maybeFcd;
 
     // ─── 2. Fetch Bob’s key bundle ────────────────────────────────────────────
     std::string errFetch;
-    auto maybeBobPub = fetchPublicBundle(targetUser, errFetch);
+    auto maybeBobPub = co_await fetchPublicBundle(targetUser, errFetch);
+    if (m_flows.closing())
+        co_return ShareOutcome{ "Error", "Cancelled" };
     if (!maybeBobPub.has_value()) {
         QString msg = QString("Key‑bundle fetch failed: %1").arg(QString::fromStdString(errFetch));
-        emit shareResult("Error", msg);
-        return;
+        co_return ShareOutcome{ "Error", msg };
     }
     const KeyBundle &bobPub = *maybeBobPub;
 
+    // the response resumed us on the I/O pool; the key work belongs on the CPU pool
+    co_await Coro::resumeOnCpu();
+
     // ─── 3. Ephemeral X25519 → sharedSecret ─────────────────────────────────
     Kem_Ecdh eph;
-    eph.keygen();
-    std::vector<uint8_t> ephPub  = eph.pub();
-    std::vector<uint8_t> ephPriv = eph.getSecretKey();
-
+    std::vector<uint8_t> ephPub, ephPriv;
     std::vector<uint8_t> shared(crypto_scalarmult_BYTES);
-    if (crypto_scalarmult(shared.data(), ephPriv.data(), bobPub.getX25519Pub().data()) != 0) {
-        emit shareResult("Error", "ECDH failed");
-        return;
+    {
+        TRACE_SPAN("share", "key_agreement");
+        eph.keygen();
+        ephPub  = eph.pub();
+        ephPriv = eph.getSecretKey();
+        if (crypto_scalarmult(shared.data(), ephPriv.data(), bobPub.getX25519Pub().data()) != 0) {
+            co_return ShareOutcome{ "Error", "ECDH failed" };
+        }
     }
     qDebug() << "[processShare] Derived raw secret (32 B) ="
              << QByteArray::fromRawData(reinterpret_cast<const char *>(shared.data()), static_cast<int>(shared.size())).toHex();
@@ -97,6 +129,7 @@ void FileShareHandler::processShare(qulonglong fileId, const std::string &target
                        std::string &outCtB64,
                        std::string &outIvB64) -> bool {
         try {
+            TRACE_SPAN("share", "wrap_key");
             Symmetric::Ciphertext c = Symmetric::encrypt({key.begin(), key.end()}, aesKey);
             outCtB64 = FileClientData::base64_encode(c.data.data(), c.data.size());
             outIvB64 = FileClientData::base64_encode(c.iv.data(), c.iv.size());
@@ -109,8 +142,7 @@ void FileShareHandler::processShare(qulonglong fileId, const std::string &target
 
     std::string encFekB64, ivFekB64, encMekB64, ivMekB64;
     if (!wrapKey(fcd.fek, encFekB64, ivFekB64) || !wrapKey(fcd.mek, encMekB64, ivMekB64)) {
-        emit shareResult("Error", "Failed to wrap FEK/MEK");
-        return;
+        co_return ShareOutcome{ "Error", "Failed to wrap FEK/MEK" };
     }
 
     // ─── 5. Build JSON body exactly as server expects ────────────────────────
@@ -127,18 +159,145 @@ void FileShareHandler::processShare(qulonglong fileId, const std::string &target
 
     // ─── 6. POST /api/fs/share ───────────────────────────────────────────────
     std::string errSend;
-    if (!sendShareRequest(body, errSend)) {
-        emit shareResult("Error", QString::fromStdString(errSend));
-        return;
+    if (!co_await sendShareRequest(std::move(body), errSend)) {
+        co_return ShareOutcome{ "Error", QString::fromStdString(errSend) };
     }
 
     // ─── 7. Success → notify QML ─────────────────────────────────────────────
-    emit shareResult("Success", "File shared successfully");
+    co_return ShareOutcome{ "Success", "File shared successfully" };
+}
+
+void FileShareHandler::revokeAccess(qulonglong fileId, const QString& username)
+{
+    startRevokeBatch({ RevokeItem{ static_cast<uint64_t>(fileId), username.toStdString() } });
+}
+
+void FileShareHandler::revokeMany(const QVariantList& items)
+{
+    std::vector<RevokeItem> pairs;
+    pairs.reserve(items.size());
+    for (const QVariant& v : items) {
+        QVariantMap m = v.toMap();
+        pairs.push_back({ m.value("file_id").toULongLong(), m.value("username").toString().toStdString() });
+    }
+    startRevokeBatch(std::move(pairs));
+}
+
+void FileShareHandler::revokeUserFromFiles(const QString& username, const QVariantList& fileIds)
+{
+    std::vector<RevokeItem> pairs;
+    pairs.reserve(fileIds.size());
+    for (const QVariant& v : fileIds)
+        pairs.push_back({ v.toULongLong(), username.toStdString() });
+    startRevokeBatch(std::move(pairs));
+}
+
+void FileShareHandler::startRevokeBatch(std::vector<RevokeItem> items)
+{
+    qDebug() << "[FileShareHandler] revoking" << items.size() << "share(s)";
+    if (items.empty())
+        return;
+
+    auto maybeUser = m_store->getUser();
+    if (!maybeUser.has_value()) {
+        emit revokeResult("Error", "Not logged‑in");
+        return;
+    }
+
+    // credentials are read once for the batch, not per request
+    auto batch = std::make_shared<RevokeBatch>();
+    batch->myUsername = maybeUser->username;
+    batch->myBundle   = maybeUser->fullBundle;
+    batch->items      = std::move(items);
+
+    Coro::spawn(runRevokeBatch(batch));
+}
+
+Coro::Task<void> FileShareHandler::runRevokeBatch(std::shared_ptr<RevokeBatch> batch)
+{
+    auto flow = m_flows.enter();
+    if (flow.cancelled())
+        co_return;
+    // bulk work: Low, so single shares and listing requests queued meanwhile go first
+    co_await Coro::resumeOnIo(Executor::Priority::Low);
+    const int workers = std::min<int>(m_revokeWorkers, static_cast<int>(batch->items.size()));
+    std::vector<Coro::Task<void>> tasks;
+    for (int i = 0; i < workers; ++i)
+        tasks.push_back(revokeWorker(batch));
+    co_await Coro::whenAll(std::move(tasks));
+    finishRevokeBatch(batch);
+}
+
+Coro::Task<void> FileShareHandler::revokeWorker(std::shared_ptr<RevokeBatch> batch)
+{
+    UiEventPump& pump = UiEventPump::instance();
+    const int total = static_cast<int>(batch->items.size());
+    const uint64_t progressKey = UiEventPump::key(batch.get(), 0);
+    const uint64_t outcomesKey = UiEventPump::key(batch.get(), 1);
+
+    auto report = [&](qulonglong fileId, const QString& username,
+                      const QString& status, const QString& message) {
+        pump.postAppend<RevokeOutcome>(
+            this, outcomesKey, { RevokeOutcome{ fileId, username, status, message } },
+            [this](std::vector<RevokeOutcome>& outcomes) {
+                for (const auto& o : outcomes)
+                    emit revokeItemResult(o.fileId, o.username, o.status, o.message);
+            });
+        const int done = ++batch->done;
+        pump.postLatest(this, progressKey, [this, done, total]() { emit revokeProgress(done, total); });
+    };
+
+    for (size_t i = batch->next.fetch_add(1); i < batch->items.size() && !m_flows.closing();
+         i = batch->next.fetch_add(1)) {
+        const RevokeItem& item = batch->items[i];
+        const qulonglong fileId = static_cast<qulonglong>(item.fileId);
+        const QString username  = QString::fromStdString(item.username);
+
+        if (item.username == batch->myUsername) {
+            ++batch->failed;
+            report(fileId, username, "failed", "Cannot revoke access from yourself");
+            continue;
+        }
+
+        std::string errSend;
+        int status = co_await sendRevokeRequest(*batch, item, errSend);
+        if (status == 200) {
+            ++batch->revoked;
+            report(fileId, username, "revoked", QString());
+        } else if (status == 404) {
+            ++batch->notShared;
+            report(fileId, username, "not_shared", QString::fromStdString(errSend));
+        } else {
+            ++batch->failed;
+            qWarning() << "[FileShareHandler] revoke failed for file_id =" << fileId
+                       << "user =" << username << ":" << QString::fromStdString(errSend);
+            report(fileId, username, "failed", QString::fromStdString(errSend));
+        }
+    }
+}
+
+void FileShareHandler::finishRevokeBatch(const std::shared_ptr<RevokeBatch>& batch)
+{
+    const int total = static_cast<int>(batch->items.size());
+    const int revoked = batch->revoked, notShared = batch->notShared, failed = batch->failed;
+    UiEventPump& pump = UiEventPump::instance();
+
+    // through the workers' coalesced slot, so a stale count posted late can't outlast it
+    const int done = batch->done;
+    pump.postLatest(this, UiEventPump::key(batch.get(), 0),
+                    [this, done, total]() { emit revokeProgress(done, total); });
+    pump.post(this, [this, revoked, notShared, failed, total]() {
+        if (failed == 0)
+            emit revokeResult("Success", QString("Revoked %1 share(s)").arg(revoked));
+        else
+            emit revokeResult("Error", QString("%1 of %2 revokes failed").arg(failed).arg(total));
+        emit revokeFinished(revoked, notShared, failed);
+    });
 }
 
 //     Helper: fetch public bundle for `uname` (POST /api/identity/get-bundle)
-std::optional<KeyBundle>
-FileShareHandler::fetchPublicBundle(const std::string& uname,
+Coro::Task<std::optional<KeyBundle>>
+FileShareHandler::fetchPublicBundle(std::string uname,
                                     std::string& outErr) const
 {
     qDebug() << "[fetchPublicBundle] Called for username =" << QString::fromStdString(uname);
@@ -153,7 +312,7 @@ FileShareHandler::fetchPublicBundle(const std::string& uname,
     if (!maybeUser.has_value()) {
         outErr = "ClientStore has no user";
         qWarning() << "[fetchPublicBundle] ERROR:" << QString::fromStdString(outErr);
-        return std::nullopt;
+        co_return std::nullopt;
     }
     const auto& me = *maybeUser;
     qDebug() << "[fetchPublicBundle] Signing request as =" << QString::fromStdString(me.username);
@@ -174,8 +333,7 @@ FileShareHandler::fetchPublicBundle(const std::string& uname,
     HttpRequest  req(HttpRequest::Method::POST,
                     "/api/keyhandler/getbundle",
                     bodyStr, headers);
-    AsioSslClient cli;
-    HttpResponse resp = cli.sendRequest(req);
+    HttpResponse resp = co_await Coro::request(std::move(req));
 
     qDebug() << "[fetchPublicBundle] HTTP status code =" << resp.statusCode;
     qDebug() << "[fetchPublicBundle] HTTP response body ="
@@ -183,7 +341,7 @@ FileShareHandler::fetchPublicBundle(const std::string& uname,
 
     if (resp.statusCode != 200) {
         outErr = "HTTP " + std::to_string(resp.statusCode);
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     // Parse JSON
@@ -194,33 +352,34 @@ FileShareHandler::fetchPublicBundle(const std::string& uname,
         outErr = std::string("Invalid JSON: ") + ex.what();
         qWarning() << "[fetchPublicBundle] ERROR: JSON parse failed:"
                    << QString::fromStdString(outErr);
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     if (!jResp.contains("key_bundle")) {
         outErr = "Response does not contain key_bundle field";
         qWarning() << "[fetchPublicBundle] ERROR:" << QString::fromStdString(outErr);
-        return std::nullopt;
+        co_return std::nullopt;
     }
 
     // Construct KeyBundle
     try {
+        TRACE_SPAN("share", "parse_bundle");
         std::string kbJsonStr = jResp["key_bundle"].dump();
         qDebug() << "[fetchPublicBundle] key_bundle JSON ="
                  << QString::fromStdString(kbJsonStr);
-        return KeyBundle::fromJson(kbJsonStr);
+        co_return KeyBundle::fromJson(kbJsonStr);
     } catch (const std::exception& ex) {
         outErr = std::string("KeyBundle::fromJson failed: ") + ex.what();
         qWarning() << "[fetchPublicBundle] ERROR:" << QString::fromStdString(outErr);
-        return std::nullopt;
+        co_return std::nullopt;
     }
 }
 
 //───────────────────────────────────────────────────────────────────────────────
 // Helper: POST /api/fs/share
 //───────────────────────────────────────────────────────────────────────────────
-bool FileShareHandler::sendShareRequest(const nlohmann::ordered_json& body,
-                                        std::string& outErr) const
+Coro::Task<bool> FileShareHandler::sendShareRequest(nlohmann::ordered_json body,
+                                                    std::string& outErr) const
 {
     qDebug() << "[sendShareRequest] Called";
 
@@ -233,7 +392,7 @@ bool FileShareHandler::sendShareRequest(const nlohmann::ordered_json& body,
     if (!maybeUser.has_value()) {
         outErr = "ClientStore has no user for share";
         qWarning() << "[sendShareRequest] ERROR:" << QString::fromStdString(outErr);
-        return false;
+        co_return false;
     }
     const auto& me = *maybeUser;
     qDebug() << "[sendShareRequest] Signed by =" << QString::fromStdString(me.username);
@@ -255,14 +414,13 @@ bool FileShareHandler::sendShareRequest(const nlohmann::ordered_json& body,
     // Build and send
     HttpRequest  req(HttpRequest::Method::POST, "/api/fs/share",
                     bodyStr, headers);
-    AsioSslClient cli;
-    HttpResponse  resp = cli.sendRequest(req);
+    HttpResponse  resp = co_await Coro::request(std::move(req));
 
     qDebug() << "[sendShareRequest] HTTP status =" << resp.statusCode;
     qDebug() << "[sendShareRequest] HTTP body =" << QString::fromStdString(resp.body);
 
     if (resp.statusCode == 201) {
-        return true;
+        co_return true;
     }
 
     // Try to extract “message” from JSON
@@ -276,5 +434,39 @@ bool FileShareHandler::sendShareRequest(const nlohmann::ordered_json& body,
     if (outErr.empty()) {
         outErr = "HTTP " + std::to_string(resp.statusCode);
     }
-    return false;
+    co_return false;
+}
+
+//───────────────────────────────────────────────────────────────────────────────
+// Helper: POST /api/fs/revoke
+//───────────────────────────────────────────────────────────────────────────────
+Coro::Task<int> FileShareHandler::sendRevokeRequest(const RevokeBatch& batch,
+                                                    const RevokeItem& item,
+                                                    std::string& outErr) const
+{
+    json body = { { "file_id", item.fileId }, { "username", item.username } };
+    std::string bodyStr = body.dump();
+
+    auto headers = NetworkAuthUtils::makeAuthHeaders(
+        batch.myUsername, batch.myBundle,
+        "POST", "/api/fs/revoke", bodyStr
+        );
+    headers["Content-Type"] = "application/json";
+
+    HttpRequest  req(HttpRequest::Method::POST, "/api/fs/revoke",
+                    bodyStr, headers);
+    HttpResponse  resp = co_await Coro::request(std::move(req), Executor::Priority::Low);
+
+    if (resp.statusCode != 200) {
+        // Try to extract “message” from JSON
+        try {
+            json jr = json::parse(resp.body);
+            if (jr.contains("message"))
+                outErr = jr["message"].get<std::string>();
+        } catch (...) { }
+
+        if (outErr.empty())
+            outErr = "HTTP " + std::to_string(resp.statusCode);
+    }
+    co_return resp.statusCode;
 }
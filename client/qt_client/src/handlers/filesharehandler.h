@@ -1,6 +1,11 @@
 #pragma once
 #include <QObject>
 #include <QString>
+#include <QVariant>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include "../utils/ClientStore.h"
 #include "../utils/crypto/FileClientData.h"
 #include "../utils/crypto/Kem_Ecdh.h"
@@ -9,6 +14,7 @@
 #include "../utils/networking/HttpRequest.h"
 #include "../utils/networking/HttpResponse.h"
 #include "../utils/HandlerUtils.h"
+#include "../utils/coro.h"
 
 /**
  * FileShareHandler
@@ -21,28 +27,106 @@
  *      • POST /api/fs/share
  *
  * Emits shareResult(title, message) so QML can show a toast/snackbar.
+ *
+ *  revokeMany([{file_id, username}, …])  →
+ *      • POST /api/fs/revoke per pair, a few at a time (kRevokeWorkers)
+ *      • revokeItemResult for every pair as it completes, delivered a frame at a time
+ *      • revokeProgress(done, total) at most once a frame
+ *      • revokeFinished(revoked, notShared, failed) once the whole batch is done
+ *
+ * A pair that was never shared ("not_shared") is not a failure, so offboarding a user
+ * can simply revoke them from every selected file.
  */
 class FileShareHandler : public QObject {
     Q_OBJECT
 public:
     explicit FileShareHandler(ClientStore* store, QObject* parent = nullptr);
+    // Cancels the flows in flight and deletes this once they have stopped; use instead of delete
+    void retire();
 
     /** Invoked from QML: share fileId with username */
     Q_INVOKABLE void shareFile(qulonglong fileId,
                                const QString& targetUsername);
 
+    /** Invoked from QML: revoke username's access to fileId */
+    Q_INVOKABLE void revokeAccess(qulonglong fileId, const QString& username);
+
+    /** Invoked from QML: revoke a list of { file_id, username } pairs concurrently */
+    Q_INVOKABLE void revokeMany(const QVariantList& items);
+
+    /** Offboarding: revoke one user from each of fileIds */
+    Q_INVOKABLE void revokeUserFromFiles(const QString& username, const QVariantList& fileIds);
+
+    /** How many revoke requests a batch keeps in flight (default kRevokeWorkers) */
+    void setRevokeWorkers(int workers) { m_revokeWorkers = std::max(1, workers); }
+
 signals:
     void shareResult(const QString& title, const QString& message);
+    // Per-share outcome for scripted callers; status is "shared" or "failed"
+    void shareItemResult(qulonglong fileId, const QString& username,
+                         const QString& status, const QString& message);
+
+    // status is "revoked", "not_shared" or "failed"
+    void revokeItemResult(qulonglong fileId, const QString& username,
+                          const QString& status, const QString& message);
+    void revokeResult(const QString& title, const QString& message);
+    void revokeProgress(int done, int total);
+    void revokeFinished(int revoked, int notShared, int failed);
 
 private:
-    void processShare(qulonglong fileId,
-                      const std::string& targetUsername);
+    struct RevokeItem {
+        uint64_t    fileId = 0;
+        std::string username;
+    };
+
+    struct RevokeOutcome {
+        qulonglong  fileId = 0;
+        QString     username;
+        QString     status;
+        QString     message;
+    };
+
+    // One revokeMany() call, shared by its workers
+    struct RevokeBatch {
+        std::string                 myUsername;
+        KeyBundle                   myBundle;
+        std::vector<RevokeItem>     items;
+        std::atomic<size_t>         next{0};
+        std::atomic<int>            done{0};
+        std::atomic<int>            revoked{0};
+        std::atomic<int>            notShared{0};
+        std::atomic<int>            failed{0};
+    };
+
+    struct ShareOutcome {
+        QString     title;
+        QString     message;
+    };
+
+    static constexpr int kRevokeWorkers = 6;
+
+    // Flows (see coro.h); reference parameters must outlive the flow, so callers co_await at once
+    void startRevokeBatch(std::vector<RevokeItem> items);
+    Coro::Task<void> runRevokeBatch(std::shared_ptr<RevokeBatch> batch);
+    Coro::Task<void> revokeWorker(std::shared_ptr<RevokeBatch> batch);
+    // Reports the batch once every worker has returned
+    void finishRevokeBatch(const std::shared_ptr<RevokeBatch>& batch);
+
+    // Returns the HTTP status (0 if the request never completed); outErr holds the server's message
+    Coro::Task<int> sendRevokeRequest(const RevokeBatch& batch, const RevokeItem& item,
+                                      std::string& outErr) const;
+
+    Coro::Task<void> runShare(qulonglong fileId, std::string targetUsername);
+    Coro::Task<ShareOutcome> processShare(qulonglong fileId,
+                                          const std::string& targetUsername);
 
     // Helpers
-    std::optional<KeyBundle> fetchPublicBundle(const std::string& uname,
-                                               std::string& outErr) const;
-    bool sendShareRequest(const nlohmann::ordered_json& body,
-                          std::string& outErr) const;
+    Coro::Task<std::optional<KeyBundle>> fetchPublicBundle(std::string uname,
+                                                           std::string& outErr) const;
+    Coro::Task<bool> sendShareRequest(nlohmann::ordered_json body,
+                                      std::string& outErr) const;
 
     ClientStore* m_store;
+    int          m_revokeWorkers = kRevokeWorkers;
+    Coro::FlowTracker m_flows;
 };
@@ -6,8 +6,9 @@
 #include <sstream>
 #include <system_error>
 #include <fstream>
-#include "../utils/networking/asiosslclient.h"
 #include "../config.h"
+#include "../utils/metadatarecord.h"
+#include "../utils/tracing.h"
 
 
 // Static helper to convert a byte‐vector into lowercase hex
@@ -30,56 +31,60 @@ FileUploadHandler::FileUploadHandler(ClientStore* store, QObject* parent)
 {
 }
 
+void FileUploadHandler::retire()
+{
+    // an upload in flight writes its keys to the store when the server answers
+    m_flows.retire(this);
+}
+
 
 void FileUploadHandler::uploadFiles(const QStringList& fileUrls)
 {
-    FileUploadHandler* self = this;
-
-    // Run in background; each fileUrl is processed sequentially in that thread
-    HandlerUtils::runAsync([self, fileUrls] {
-        for (const QString& qurl : fileUrls) {
-            std::string localPath = qurl.toStdString();
-            try {
-                // Process that file
-                uint64_t file_id = self->processSingleFile(localPath);
-                if (file_id == 0) {
-                    QString msg = QString("Failed to upload %1").arg(qurl);
-                    QMetaObject::invokeMethod(
-                        self,
-                        [self, msg]() { emit self->uploadResult("Error", msg); },
-                        Qt::QueuedConnection
-                        );
-                } else {
-                    QString msg = QString("Uploaded %1 (id=%2)")
-                                      .arg(qurl).arg(file_id);
-                    QMetaObject::invokeMethod(
-                        self,
-                        [self, msg]() { emit self->uploadResult("Success", msg); },
-                        Qt::QueuedConnection
-                        );
-                }
-            }
-            catch (const std::exception& ex) {
-                QString msg = QString("Exception for %1: %2")
-                                  .arg(qurl, QString::fromStdString(ex.what()));
-                QMetaObject::invokeMethod(
-                    self,
-                    [self, msg]() { emit self->uploadResult("Exception", msg); },
-                    Qt::QueuedConnection
-                    );
+    Coro::spawn(uploadAll(fileUrls));
+}
+
+Coro::Task<void> FileUploadHandler::uploadAll(QStringList fileUrls)
+{
+    auto flow = m_flows.enter();
+    // each fileUrl is processed in turn; no thread is held while one is on the wire
+    for (const QString& qurl : fileUrls) {
+        if (flow.cancelled())
+            co_return;
+        QString title, msg;
+        uint64_t file_id = 0;
+        try {
+            // Process that file
+            file_id = co_await processSingleFile(qurl.toStdString());
+            if (file_id == 0) {
+                title = "Error";
+                msg = QString("Failed to upload %1").arg(qurl);
+            } else {
+                title = "Success";
+                msg = QString("Uploaded %1 (id=%2)").arg(qurl).arg(file_id);
             }
         }
-    });
+        catch (const std::exception& ex) {
+            title = "Exception";
+            msg = QString("Exception for %1: %2")
+                      .arg(qurl, QString::fromStdString(ex.what()));
+        }
+        co_await Coro::resumeOnUi(this);
+        if (flow.cancelled())
+            co_return;
+        emit uploadResult(title, msg);
+        emit uploadItemResult(qurl, file_id, file_id ? "uploaded" : "failed", msg);
+    }
 }
 
-uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
+std::optional<FileUploadHandler::PreparedUpload>
+FileUploadHandler::prepareUpload(const std::string& localPath)
 {
     // Read the file bytes
     std::vector<uint8_t> plaintext = readFileBytes(localPath);
     if (plaintext.empty()) {
         qWarning() << "[ERROR]" << "readFileBytes returned empty for"
                    << QString::fromStdString(localPath);
-        return 0ULL;
+        return std::nullopt;
     }
 
     // Construct FileClientData with random values
@@ -89,6 +94,7 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
     // Encrypt file contents with AES-256-CTR
     Symmetric::Ciphertext encFile; // Ciphertext struct
     try {
+        TRACE_SPAN_ARG("upload", "encrypt", "bytes", plaintext.size());
         encFile = Symmetric::encrypt(
             plaintext,
             std::vector<uint8_t>(fcd.fek.begin(), fcd.fek.end())
@@ -96,29 +102,18 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
     }
     catch (const std::exception& ex) {
         qWarning() << "[ERROR]" << "Symmetric::encrypt(file) threw:" << ex.what();
-        return 0ULL;
+        return std::nullopt;
     }
 
     // Copy IV into fcd.file_nonce
     fcd.file_nonce.fill(0);
     std::copy(encFile.iv.begin(), encFile.iv.end(), fcd.file_nonce.begin());
 
-    // Build metadata JSON
-    nlohmann::json jmeta;
-    try {
-        jmeta["filename"] = fcd.filename;
-        jmeta["filesize"] = plaintext.size();
-    }
-    catch (const std::exception& ex) {
-        qWarning() << "[ERROR]" << "building metadata JSON threw:" << ex.what();
-        return 0ULL;
-    }
-    std::string metaPlain = jmeta.dump();
-
-    // Encrypt metadata JSON with AES-256-CTR
+    // Build the binary metadata record and encrypt it with AES-256-CTR
     Symmetric::Ciphertext encMeta;
     try {
-        std::vector<uint8_t> metaBytes(metaPlain.begin(), metaPlain.end());
+        TRACE_SPAN("upload", "encrypt_metadata");
+        std::vector<uint8_t> metaBytes = MetadataRecord::encode(fcd.filename, plaintext.size());
         encMeta = Symmetric::encrypt(
             metaBytes,
             std::vector<uint8_t>(fcd.mek.begin(), fcd.mek.end())
@@ -126,7 +121,7 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
     }
     catch (const std::exception& ex) {
         qWarning() << "[ERROR]" << "Symmetric::encrypt(metadata) threw:" << ex.what();
-        return 0ULL;
+        return std::nullopt;
     }
 
     // Copy IV into fcd.metadata_nonce
@@ -139,12 +134,13 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
     };
     std::string fileB64, metaB64;
     try {
+        TRACE_SPAN("upload", "encode");
         fileB64 = encodeB64(encFile.data);
         metaB64 = encodeB64(encMeta.data);
     }
     catch (const std::exception& ex) {
         qWarning() << "[ERROR]" << "base64_encode threw:" << ex.what();
-        return 0ULL;
+        return std::nullopt;
     }
 
     // fetch fresh store info
@@ -174,10 +170,14 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
             );
     }
 
-    Signer_Ed signerEd;
-    signerEd.loadPrivateKey(edPrivRaw.data(), edPrivRaw.size());
-    std::vector<uint8_t> edSig = signerEd.sign(msgBytes);
-    std::string edSigB64 = FileClientData::base64_encode(edSig.data(), edSig.size());
+    std::string edSigB64;
+    {
+        TRACE_SPAN("upload", "sign_ed25519");
+        Signer_Ed signerEd;
+        signerEd.loadPrivateKey(edPrivRaw.data(), edPrivRaw.size());
+        std::vector<uint8_t> edSig = signerEd.sign(msgBytes);
+        edSigB64 = FileClientData::base64_encode(edSig.data(), edSig.size());
+    }
 
 
 
@@ -185,10 +185,14 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
     // Dilithium sign that sigInput
     std::string pqPrivB64 = keybundle.getDilithiumPrivateKeyBase64();
     std::vector<uint8_t> pqPrivRaw = FileClientData::base64_decode(pqPrivB64);
-    Signer_Dilithium signerPQ;
-    signerPQ.loadPrivateKey(pqPrivRaw.data(), pqPrivRaw.size());
-    std::vector<uint8_t> pqSig = signerPQ.sign(msgBytes);
-    std::string pqSigB64 = FileClientData::base64_encode(pqSig.data(), pqSig.size());
+    std::string pqSigB64;
+    {
+        TRACE_SPAN("upload", "sign_dilithium");
+        Signer_Dilithium signerPQ;
+        signerPQ.loadPrivateKey(pqPrivRaw.data(), pqPrivRaw.size());
+        std::vector<uint8_t> pqSig = signerPQ.sign(msgBytes);
+        pqSigB64 = FileClientData::base64_encode(pqSig.data(), pqSig.size());
+    }
 
 
     // ─── Debug / sanity check for Dilithium key length ───
@@ -223,11 +227,26 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
         bodyString
         );
 
+    return PreparedUpload{ std::move(fcd), std::move(bodyString), std::move(headers) };
+}
+
+Coro::Task<uint64_t> FileUploadHandler::processSingleFile(std::string localPath)
+{
+    TRACE_ASYNC(op, "upload", "upload");
+
+    // Encrypting and signing is CPU work; the send after it waits without a thread
+    co_await Coro::resumeOnCpu();
+    auto prepared = prepareUpload(localPath);
+    if (!prepared.has_value())
+        co_return 0ULL;
+    FileClientData& fcd = prepared->fcd;
+    const std::string& bodyString = prepared->body;
+    const auto& headers = prepared->headers;
+
     // Build request (no need to add Host manually; toString() will do it)
     HttpRequest req(HttpRequest::Method::POST, "/api/fs/upload", bodyString, headers);
 
-    AsioSslClient client;
-    HttpResponse resp = client.sendRequest(req);   // uses Config::instance().serverHost/port
+    HttpResponse resp = co_await Coro::request(std::move(req));   // uses Config::instance().serverHost/port
 
     qDebug() << "[CLIENT]" << "→ HTTP status code =" << resp.statusCode;
     qDebug() << "[CLIENT]" << "→ HTTP body =" << QString::fromStdString(resp.body);
@@ -241,21 +260,23 @@ uint64_t FileUploadHandler::processSingleFile(const std::string& localPath)
         }
         catch (const std::exception& ex) {
             qWarning() << "[ERROR]" << "parsing response JSON threw:" << ex.what();
-            return 0ULL;
+            co_return 0ULL;
         }
 
         // On success store FileClientData
         fcd.file_id = newFileId;
+        TRACE_SPAN("upload", "persist");
         store->upsertFileData(fcd);
-        return newFileId;
+        co_return newFileId;
     }
 
     // On error
-    return 0ULL;
+    co_return 0ULL;
 }
 
 std::vector<uint8_t> FileUploadHandler::readFileBytes(const std::string& path)
 {
+    TRACE_SPAN("upload", "read");
     std::ifstream in(path, std::ios::binary);
     if (!in.good()) return {};
 
@@ -275,6 +296,8 @@ std::string FileUploadHandler::buildSignatureInput(const std::string& uname,
                                                    const std::string& fileB64,
                                                    const std::string& metaB64)
 {
+    TRACE_SPAN("upload", "hash");
+
     // Decode base64 back to ciphertext
     std::vector<uint8_t> fileCipher = FileClientData::base64_decode(fileB64);
     std::vector<uint8_t> metaCipher = FileClientData::base64_decode(metaB64);
@@ -1,6 +1,8 @@
 #pragma once
 #include <QObject>
 #include <QStringList>
+#include <map>
+#include <optional>
 #include <nlohmann/json.hpp>
 #include "../utils/ClientStore.h"
 #include "../utils/crypto/FileClientData.h"
@@ -11,6 +13,7 @@
 #include "../utils/crypto/Hash.h"
 #include "../utils/NetworkAuthUtils.h"
 #include "../utils/HandlerUtils.h"
+#include "../utils/coro.h"
 #include "../utils/networking/HttpRequest.h"
 #include "../utils/networking/HttpResponse.h"
 
@@ -33,7 +36,8 @@ class FileUploadHandler : public QObject {
 
 public:
     explicit FileUploadHandler(ClientStore* store, QObject* parent = nullptr);
-    ~FileUploadHandler() override = default;
+    // Cancels the flows in flight and deletes this once they have stopped; use instead of delete
+    void retire();
 
     /** Invoked from QML: uploads all files in the list */
     Q_INVOKABLE void uploadFiles(const QStringList& fileUrls);
@@ -42,9 +46,26 @@ signals:
     /** For each file, emits Success/Error/Exception + message */
     void uploadResult(const QString& title, const QString& message);
 
+    /** Per-file outcome for scripted callers; status is "uploaded" or "failed", fileId 0 on failure */
+    void uploadItemResult(const QString& path, qulonglong fileId,
+                          const QString& status, const QString& message);
+
 private:
+    /** An encrypted, signed upload, ready to send */
+    struct PreparedUpload {
+        FileClientData                      fcd;
+        std::string                         body;
+        std::map<std::string, std::string>  headers;
+    };
+
+    /** Uploads fileUrls one after another, emitting uploadResult for each */
+    Coro::Task<void> uploadAll(QStringList fileUrls);
+
     /** Process one file.  Returns new file_id or 0 on failure. */
-    uint64_t processSingleFile(const std::string& localPath);
+    Coro::Task<uint64_t> processSingleFile(std::string localPath);
+
+    /** Steps 1-6 short of the POST; runs on the CPU pool. Empty on failure. */
+    std::optional<PreparedUpload> prepareUpload(const std::string& localPath);
 
     /** Read entire file into vector<uint8_t>. */
     std::vector<uint8_t> readFileBytes(const std::string& path);
@@ -57,4 +78,5 @@ private:
     ClientStore* store;
     std::string username;
     KeyBundle keybundle;
+    Coro::FlowTracker m_flows;
 };
@@ -1,5 +1,6 @@
 #include "PasswordChangeHandler.h"
 #include "../utils/ClientStore.h"
+#include "../utils/handlerutils.h"
 
 #include <QMetaObject>
 #include <QDebug>
@@ -23,13 +24,8 @@ void PasswordChangeHandler::changePassword(const QString& newPwd,
         return;
     }
 
-    /* heavy lifting in a worker thread */
-    auto fut = QtConcurrent::run([=] { doChange(newPwd); });
-
-    auto *watch = new QFutureWatcher<void>(this);
-    connect(watch, &QFutureWatcher<void>::finished,
-            watch, &QObject::deleteLater);
-    watch->setFuture(fut);
+    /* heavy lifting (re-deriving the store key) on the CPU pool */
+    HandlerUtils::runAsync([=] { doChange(newPwd); }, Executor::Pool::Cpu);
 }
 
 void PasswordChangeHandler::doChange(const QString& newPwd)
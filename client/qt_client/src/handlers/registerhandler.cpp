@@ -30,7 +30,8 @@ void RegisterHandler::registerUser(const QString &username,
 
 void RegisterHandler::doRegister(QString username, QString password)
 {
-    KeyBundle kb;
+    // key generation is pure CPU; this I/O worker only waits for it
+    KeyBundle kb = Executor::instance().compute([] { return KeyBundle(); });
 
     nlohmann::json j;
     j["username"]   = username.toStdString();
@@ -44,17 +45,25 @@ void RegisterHandler::doRegister(QString username, QString password)
         { { "Content-Type", "application/json" } }
         );
 
-    AsioSslClient httpClient;
-    HttpResponse resp = httpClient.sendRequest(req);
+    HttpResponse resp;
+    if (std::shared_ptr<NetworkClient> transport = NetworkClient::transport()) {
+        const Config& cfg = Config::instance();
+        resp = transport->sendRequest(cfg.serverHost, cfg.serverPort, req);
+    } else {
+        AsioSslClient httpClient;
+        resp = httpClient.sendRequest(req);
+    }
 
     QString title, msg;
     if (resp.statusCode == 201) {
         try {
-            store->setUserWithPassword(
-                username.toStdString(),
-                password.toStdString(),
-                kb
-                );
+            Executor::instance().compute([&] {
+                store->setUserWithPassword(
+                    username.toStdString(),
+                    password.toStdString(),
+                    kb
+                    );
+            });
             title = "Success";
             msg   = "Registration successful – you are now logged in.";
         } catch (const std::exception &ex) {
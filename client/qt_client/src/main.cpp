@@ -3,6 +3,7 @@
 #include <QQmlContext>
 #include <QQuickStyle>
 #include <QDir>
+#include <QFileInfo>
 #include <QDebug>
 
 #include "handlers/LoginHandler.h"
@@ -12,8 +13,14 @@
 #include "handlers/filedownloadhandler.h"
 #include "handlers/passwordchangehandler.h"
 #include "handlers/filesharehandler.h"
+#include "handlers/diagnosticshandler.h"
 #include "utils/ClientStore.h"
+#include "utils/uieventpump.h"
+#include "utils/tracing.h"
+#include "utils/metrics.h"
+#include "utils/alloctracker.h"
 #include "utils/networking/asiosslclient.h"
+#include "daemon/daemonclient.h"
 
 static QString defaultStorePath() {
 #ifdef Q_OS_WIN
@@ -25,9 +32,19 @@ static QString defaultStorePath() {
 
 int main(int argc, char *argv[])
 {
+    // allocation-tracking builds only: OpenSSL's allocator must be hooked before first use
+    AllocTracker::install();
+
     QGuiApplication app(argc, argv);
     QQuickStyle::setStyle("Material");  // Use Material style
 
+    // worker → GUI event pump; created here so it lives on the GUI thread
+    UiEventPump::instance();
+
+    // SSSHARE_SPANS=<file.json> records handler stage spans until exit
+    Tracing::setThreadName("ui");
+    Tracing::startFromEnvironment();
+
 
 
     // 1) Load (or create) the ClientStore
@@ -35,6 +52,11 @@ int main(int argc, char *argv[])
     ClientStore clientStore(storeFile.toStdString());
     clientStore.load();
 
+    // metrics snapshot next to the store, every SSSHARE_METRICS_INTERVAL seconds and at exit
+    const QString metricsFile = QFileInfo(storeFile).dir().filePath("metrics-gui.json");
+    Metrics::Dumper metricsDumper(metricsFile.toStdString(), Metrics::dumpInterval());
+    DiagnosticsHandler diagnostics(metricsFile);
+
     // 2) Create LoginHandler & RegisterHandler (they do NOT need fullBundle yet)
     LoginHandler    loginHandler(&clientStore);
     RegisterHandler registerHandler(&clientStore);
@@ -45,6 +67,7 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty("loginHandler",    &loginHandler);
     engine.rootContext()->setContextProperty("registerHandler", &registerHandler);
     engine.rootContext()->setContextProperty("passwordHandler", &pwdHandler);
+    engine.rootContext()->setContextProperty("diagnostics",     &diagnostics);
 
 
     // 4) Placeholder pointers for upload/list; will create them only on successful login/register
@@ -53,6 +76,15 @@ int main(int argc, char *argv[])
     FileDownloadHandler* downloadHandler = nullptr;
     FileShareHandler* fileShareHandler = nullptr;
 
+    // A previous session's handlers are retired rather than deleted: each one goes once the
+    // flows it still has on the pools have stopped
+    auto retireHandlers = [&]() {
+        if (uploadHandler)    { uploadHandler->retire();    uploadHandler = nullptr; }
+        if (fileListHandler)  { fileListHandler->retire();  fileListHandler = nullptr; }
+        if (downloadHandler)  { downloadHandler->retire();  downloadHandler = nullptr; }
+        if (fileShareHandler) { fileShareHandler->retire(); fileShareHandler = nullptr; }
+    };
+
     auto &cfg = Config::instance();
     QString absPem = QDir(QCoreApplication::applicationDirPath())
                          .filePath(QString::fromStdString(cfg.caBundle));
@@ -61,16 +93,21 @@ int main(int argc, char *argv[])
     AsioSslClient httpClient;
     httpClient.init(Config::instance().caBundle);
 
+    // Attach to this user's ssshared (starting it if need be) for the shared unlock only:
+    // once it is unlocked, a login here is checked against it without another Argon2 run.
+    // The handlers below are still this process's own.
+    DaemonClient daemon;
+    loginHandler.setDaemon(&daemon);
+    daemon.attach();
+
     // 5) Once login succeeds, construct + expose FileUploadHandler & FileListHandler
     QObject::connect(
         &loginHandler,
         &LoginHandler::loginResult,
         [&](QString title, QString message) {
             if (title == "Success") {
-                // If we already had these from a previous session, delete them:
-                if (uploadHandler)   { delete uploadHandler; }
-                if (fileListHandler) { delete fileListHandler; }
-                if (downloadHandler) { delete downloadHandler; }
+                // If we already had these from a previous session, retire them:
+                retireHandlers();
 
                 // Now clientStore.getUser()->fullBundle is valid
                 uploadHandler   = new FileUploadHandler(&clientStore);
@@ -83,7 +120,11 @@ int main(int argc, char *argv[])
                 engine.rootContext()->setContextProperty("downloadHandler", downloadHandler);
                 engine.rootContext()->setContextProperty("shareHandler", fileShareHandler);
 
-                fileListHandler->listAllFiles(1);
+                // a finished revoke batch is picked up as a change-feed delta, not a re-list
+                QObject::connect(fileShareHandler, &FileShareHandler::revokeFinished,
+                                 fileListHandler, &FileListHandler::syncChanges);
+
+                fileListHandler->syncChanges();
             }
             // if login fails, QML login dialog will show error (already implemented)
         }
@@ -95,9 +136,7 @@ int main(int argc, char *argv[])
         &RegisterHandler::registerResult,
         [&](QString title, QString message) {
             if (title == "Success") {
-                if (uploadHandler)   { delete uploadHandler; }
-                if (fileListHandler) { delete fileListHandler; }
-                if (downloadHandler) { delete downloadHandler; }
+                retireHandlers();
 
 
                 uploadHandler   = new FileUploadHandler(&clientStore);
@@ -110,12 +149,22 @@ int main(int argc, char *argv[])
                 engine.rootContext()->setContextProperty("downloadHandler", downloadHandler);
                 engine.rootContext()->setContextProperty("shareHandler", fileShareHandler);
 
+                // a finished revoke batch is picked up as a change-feed delta, not a re-list
+                QObject::connect(fileShareHandler, &FileShareHandler::revokeFinished,
+                                 fileListHandler, &FileListHandler::syncChanges);
 
-                fileListHandler->listAllFiles(1);
+
+                fileListHandler->syncChanges();
             }
         }
         );
 
+    // Let the list handler persist its metadata cache and search index on exit: exec() still
+    // runs the deferred deletes after aboutToQuit, so an idle handler goes (and saves) here
+    QObject::connect(&app, &QCoreApplication::aboutToQuit, [&]() {
+        retireHandlers();
+    });
+
     // 7) Finally load our root QML (which decides to show Login/Register vs. MainView)
     engine.load(QUrl(QStringLiteral("qrc:/qml/Main.qml")));
     if (engine.rootObjects().isEmpty())
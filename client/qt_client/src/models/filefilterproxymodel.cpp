@@ -0,0 +1,186 @@
+#include "filefilterproxymodel.h"
+#include <algorithm>
+
+FileFilterProxyModel::FileFilterProxyModel(FileListModel* source, QObject* parent)
+    : QSortFilterProxyModel(parent), m_source(source)
+{
+    // "file10" after "file9", and "Report" next to "report"
+    m_collator.setNumericMode(true);
+    m_collator.setCaseSensitivity(Qt::CaseInsensitive);
+
+    setSourceModel(source);
+    setDynamicSortFilter(true);
+    sort(0, Qt::DescendingOrder);     // newest first, as the server lists them
+
+    connect(source, &QAbstractItemModel::rowsAboutToBeRemoved, this,
+            [this](const QModelIndex&, int first, int last) { dropNameKeys(first, last); });
+    connect(source, &QAbstractItemModel::modelReset, this, [this]() { m_nameKeys.clear(); });
+
+    connect(this, &QAbstractItemModel::rowsInserted, this, &FileFilterProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved,  this, &FileFilterProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::modelReset,   this, &FileFilterProxyModel::countChanged);
+    connect(this, &QAbstractItemModel::layoutChanged, this, &FileFilterProxyModel::countChanged);
+}
+
+void FileFilterProxyModel::setSearchText(const QString& text)
+{
+    QString trimmed = text.trimmed();
+    if (trimmed == m_searchText)
+        return;
+
+    m_searchText = trimmed;
+    m_matchesVersion = ~0ULL;
+    refreshMatches();
+    invalidateFilter();
+    emit searchTextChanged();
+    emit countChanged();
+}
+
+QString FileFilterProxyModel::ownership() const
+{
+    switch (m_ownership) {
+    case Ownership::Owned:  return QStringLiteral("owned");
+    case Ownership::Shared: return QStringLiteral("shared");
+    default:                return QStringLiteral("all");
+    }
+}
+
+void FileFilterProxyModel::setOwnership(const QString& ownership)
+{
+    Ownership next = Ownership::All;
+    if (ownership == QLatin1String("owned"))
+        next = Ownership::Owned;
+    else if (ownership == QLatin1String("shared"))
+        next = Ownership::Shared;
+
+    if (next == m_ownership)
+        return;
+
+    m_ownership = next;
+    refreshMatches();
+    invalidateFilter();
+    emit ownershipChanged();
+    emit countChanged();
+}
+
+QString FileFilterProxyModel::sortKey() const
+{
+    switch (m_sortKey) {
+    case SortKey::Name: return QStringLiteral("name");
+    case SortKey::Size: return QStringLiteral("size");
+    default:            return QStringLiteral("modified");
+    }
+}
+
+void FileFilterProxyModel::setSortKey(const QString& key)
+{
+    SortKey next = SortKey::Modified;
+    if (key == QLatin1String("name"))
+        next = SortKey::Name;
+    else if (key == QLatin1String("size"))
+        next = SortKey::Size;
+
+    if (next == m_sortKey)
+        return;
+
+    m_sortKey = next;
+    invalidate();
+    emit sortKeyChanged();
+}
+
+void FileFilterProxyModel::setSortAscending(bool ascending)
+{
+    if (ascending == sortAscending())
+        return;
+
+    sort(0, ascending ? Qt::AscendingOrder : Qt::DescendingOrder);
+    emit sortAscendingChanged();
+}
+
+QVariantList FileFilterProxyModel::fileIds() const
+{
+    QVariantList out;
+    const int rows = rowCount();
+    out.reserve(rows);
+    for (int row = 0; row < rows; ++row)
+        out.append(static_cast<qulonglong>(m_source->at(mapToSource(index(row, 0)).row()).file_id));
+    return out;
+}
+
+void FileFilterProxyModel::refreshMatches()
+{
+    const TrigramIndex& index = m_source->searchIndex();
+    if (m_searchText.isEmpty() || m_matchesVersion == index.version())
+        return;
+    m_matches = index.search(m_searchText);
+    m_matchesVersion = index.version();
+}
+
+bool FileFilterProxyModel::matchesSearch(uint64_t fileId) const
+{
+    const TrigramIndex& index = m_source->searchIndex();
+    if (m_matchesVersion == index.version())
+        return std::binary_search(m_matches.begin(), m_matches.end(), fileId);
+    // the index moved since the last full search: rows streaming in are checked on their own
+    return index.matches(fileId, m_searchText);
+}
+
+const QCollatorSortKey& FileFilterProxyModel::nameKey(const DecryptedFile& f) const
+{
+    auto it = m_nameKeys.find(f.file_id);
+    if (it != m_nameKeys.end() && it->second.name == f.filename)
+        return it->second.key;
+
+    if (it != m_nameKeys.end())
+        m_nameKeys.erase(it);
+    return m_nameKeys.emplace(f.file_id, NameKey{ f.filename, m_collator.sortKey(f.filename) })
+        .first->second.key;
+}
+
+void FileFilterProxyModel::dropNameKeys(int first, int last)
+{
+    for (int row = first; row <= last; ++row)
+        m_nameKeys.erase(m_source->at(row).file_id);
+}
+
+bool FileFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const
+{
+    if (sourceParent.isValid())
+        return false;
+
+    const DecryptedFile& f = m_source->at(sourceRow);
+    if (m_ownership == Ownership::Owned && !f.is_owner)
+        return false;
+    if (m_ownership == Ownership::Shared && f.is_owner)
+        return false;
+
+    if (m_searchText.isEmpty())
+        return true;
+
+    return matchesSearch(f.file_id);
+}
+
+bool FileFilterProxyModel::lessThan(const QModelIndex& left, const QModelIndex& right) const
+{
+    const DecryptedFile& a = m_source->at(left.row());
+    const DecryptedFile& b = m_source->at(right.row());
+
+    switch (m_sortKey) {
+    case SortKey::Name: {
+        int cmp = nameKey(a).compare(nameKey(b));
+        if (cmp != 0)
+            return cmp < 0;
+        break;
+    }
+    case SortKey::Size:
+        if (a.size_bytes != b.size_bytes)
+            return a.size_bytes < b.size_bytes;
+        break;
+    case SortKey::Modified:
+        if (a.upload_timestamp != b.upload_timestamp)
+            return a.upload_timestamp < b.upload_timestamp;
+        break;
+    }
+    // ties keep upload order, so equal keys never shuffle between updates
+    return a.file_id < b.file_id;
+}
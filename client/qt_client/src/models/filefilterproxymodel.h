@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QSortFilterProxyModel>
+#include <QCollator>
+#include <QCollatorSortKey>
+#include <QString>
+#include <unordered_map>
+#include <vector>
+#include "filelistmodel.h"
+
+/**
+ * FileFilterProxyModel is what FileTable.qml actually shows: FileListModel filtered
+ * by the search box and the sidebar's ownership choice, sorted by the selected column.
+ *
+ * A search is answered by the source model's TrigramIndex once, and the sorted hit
+ * list is reused by filterAcceptsRow while the index is unchanged, so a full re-filter
+ * stays a binary search per row. Rows that arrive or change afterwards (a page stream
+ * landing while a search is active) move the index on; they are checked one by one
+ * against their own index entry rather than re-running the whole search per row.
+ *
+ * "My files" / "Shared with me" are just a different ownership predicate over the
+ * same rows, so switching views never touches the network.
+ *
+ * Name ordering compares QCollatorSortKeys cached per file_id, so a re-sort does no
+ * locale collation work for names it has already seen. Every ordering falls back to
+ * file_id, which makes it total: rows with equal keys never swap places between
+ * incremental updates.
+ */
+class FileFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+    Q_PROPERTY(QString searchText READ searchText WRITE setSearchText NOTIFY searchTextChanged)
+    // "all", "owned" or "shared"
+    Q_PROPERTY(QString ownership READ ownership WRITE setOwnership NOTIFY ownershipChanged)
+    // "modified", "name" or "size"
+    Q_PROPERTY(QString sortKey READ sortKey WRITE setSortKey NOTIFY sortKeyChanged)
+    Q_PROPERTY(bool sortAscending READ sortAscending WRITE setSortAscending NOTIFY sortAscendingChanged)
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    explicit FileFilterProxyModel(FileListModel* source, QObject* parent = nullptr);
+
+    QString searchText() const { return m_searchText; }
+    void setSearchText(const QString& text);
+
+    QString ownership() const;
+    void setOwnership(const QString& ownership);
+
+    QString sortKey() const;
+    void setSortKey(const QString& key);
+
+    bool sortAscending() const { return sortOrder() == Qt::AscendingOrder; }
+    void setSortAscending(bool ascending);
+
+    int count() const { return rowCount(); }
+
+    // file_ids of the visible rows in view order, e.g. for "select all"
+    Q_INVOKABLE QVariantList fileIds() const;
+
+signals:
+    void searchTextChanged();
+    void ownershipChanged();
+    void sortKeyChanged();
+    void sortAscendingChanged();
+    void countChanged();
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex& sourceParent) const override;
+    bool lessThan(const QModelIndex& left, const QModelIndex& right) const override;
+
+private:
+    enum class Ownership { All, Owned, Shared };
+    enum class SortKey { Modified, Name, Size };
+
+    struct NameKey {
+        QString             name;   // what the key was built from; a rename rebuilds it
+        QCollatorSortKey    key;
+    };
+
+    // Runs the search again if the index moved; before filtering every row at once
+    void refreshMatches();
+    bool matchesSearch(uint64_t fileId) const;
+    const QCollatorSortKey& nameKey(const DecryptedFile& f) const;
+    void dropNameKeys(int first, int last);
+
+    FileListModel*                  m_source;
+    QString                         m_searchText;
+    Ownership                       m_ownership = Ownership::All;
+    SortKey                         m_sortKey   = SortKey::Modified;
+
+    // hits for m_searchText, valid while the index is still at m_matchesVersion
+    std::vector<uint64_t>           m_matches;
+    uint64_t                        m_matchesVersion = ~0ULL;
+
+    QCollator                                       m_collator;
+    mutable std::unordered_map<uint64_t, NameKey>   m_nameKeys;
+};
@@ -0,0 +1,200 @@
+#include "filelistmodel.h"
+#include <algorithm>
+
+FileListModel::FileListModel(QObject* parent)
+    : QAbstractListModel(parent)
+{
+}
+
+int FileListModel::rowCount(const QModelIndex& parent) const
+{
+    if (parent.isValid())
+        return 0;
+    return count();
+}
+
+QVariant FileListModel::data(const QModelIndex& index, int role) const
+{
+    if (!index.isValid() || index.row() < 0 || index.row() >= count())
+        return {};
+
+    const DecryptedFile& f = m_rows[static_cast<size_t>(index.row())];
+    switch (role) {
+    case FileIdRole:     return static_cast<qulonglong>(f.file_id);
+    case Qt::DisplayRole:
+    case NameRole:       return f.filename;
+    case SizeRole:       return static_cast<qulonglong>(f.size_bytes);
+    case ModifiedRole:   return f.upload_timestamp;
+    case IsOwnerRole:    return f.is_owner;
+    case IsSharedRole:   return f.is_shared;
+    case SharedFromRole: return f.shared_from;
+    default:             return {};
+    }
+}
+
+QHash<int, QByteArray> FileListModel::roleNames() const
+{
+    // names match what FileTable.qml's delegate reads
+    return {
+        { FileIdRole,     "file_id" },
+        { NameRole,       "name" },
+        { SizeRole,       "size" },
+        { ModifiedRole,   "modified" },
+        { IsOwnerRole,    "is_owner" },
+        { IsSharedRole,   "is_shared" },
+        { SharedFromRole, "shared_from" },
+    };
+}
+
+void FileListModel::applySnapshot(std::vector<DecryptedFile> files)
+{
+    std::sort(files.begin(), files.end(),
+              [](const DecryptedFile& a, const DecryptedFile& b) { return a.file_id > b.file_id; });
+    files.erase(std::unique(files.begin(), files.end(),
+                            [](const DecryptedFile& a, const DecryptedFile& b) { return a.file_id == b.file_id; }),
+                files.end());
+
+    const int before = count();
+
+    // 1) drop rows missing from the snapshot, walking backwards and removing contiguous runs at once
+    size_t j = files.size();
+    int row = count() - 1;
+    while (row >= 0) {
+        const uint64_t id = m_rows[static_cast<size_t>(row)].file_id;
+        while (j > 0 && files[j - 1].file_id < id)
+            --j;
+        if (j > 0 && files[j - 1].file_id == id) {
+            --row;
+            continue;
+        }
+
+        int last = row;
+        while (row - 1 >= 0) {
+            const uint64_t prevId = m_rows[static_cast<size_t>(row - 1)].file_id;
+            while (j > 0 && files[j - 1].file_id < prevId)
+                --j;
+            if (j > 0 && files[j - 1].file_id == prevId)
+                break;
+            --row;
+        }
+        beginRemoveRows(QModelIndex(), row, last);
+        for (int r = row; r <= last; ++r)
+            m_index.remove(m_rows[static_cast<size_t>(r)].file_id);
+        m_rows.erase(m_rows.begin() + row, m_rows.begin() + last + 1);
+        endRemoveRows();
+        --row;
+    }
+
+    // 2) every remaining row is in the snapshot; merge in new ones and refresh changed ones
+    for (const auto& f : files)
+        upsertOne(f);
+
+    if (count() != before)
+        emit countChanged();
+}
+
+void FileListModel::upsert(const std::vector<DecryptedFile>& files)
+{
+    const int before = count();
+    for (const auto& f : files)
+        upsertOne(f);
+    if (count() != before)
+        emit countChanged();
+}
+
+void FileListModel::removeFile(uint64_t fileId)
+{
+    int row = lowerBound(fileId);
+    if (row >= count() || m_rows[static_cast<size_t>(row)].file_id != fileId)
+        return;
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_index.remove(fileId);
+    m_rows.erase(m_rows.begin() + row);
+    endRemoveRows();
+    emit countChanged();
+}
+
+void FileListModel::removeFiles(const std::vector<uint64_t>& fileIds)
+{
+    std::vector<int> rows;
+    rows.reserve(fileIds.size());
+    for (uint64_t id : fileIds) {
+        int row = lowerBound(id);
+        if (row < count() && m_rows[static_cast<size_t>(row)].file_id == id)
+            rows.push_back(row);
+    }
+    if (rows.empty())
+        return;
+
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+
+    // bottom-up, so the row numbers still to be removed stay valid
+    int i = static_cast<int>(rows.size()) - 1;
+    while (i >= 0) {
+        const int last = rows[static_cast<size_t>(i)];
+        int first = last;
+        while (i > 0 && rows[static_cast<size_t>(i - 1)] == first - 1)
+            first = rows[static_cast<size_t>(--i)];
+        --i;
+
+        beginRemoveRows(QModelIndex(), first, last);
+        for (int r = first; r <= last; ++r)
+            m_index.remove(m_rows[static_cast<size_t>(r)].file_id);
+        m_rows.erase(m_rows.begin() + first, m_rows.begin() + last + 1);
+        endRemoveRows();
+    }
+    emit countChanged();
+}
+
+std::optional<DecryptedFile> FileListModel::find(uint64_t fileId) const
+{
+    int row = lowerBound(fileId);
+    if (row >= count() || m_rows[static_cast<size_t>(row)].file_id != fileId)
+        return std::nullopt;
+    return m_rows[static_cast<size_t>(row)];
+}
+
+int FileListModel::lowerBound(uint64_t fileId) const
+{
+    auto it = std::lower_bound(m_rows.begin(), m_rows.end(), fileId,
+                               [](const DecryptedFile& f, uint64_t id) { return f.file_id > id; });
+    return static_cast<int>(it - m_rows.begin());
+}
+
+void FileListModel::upsertOne(const DecryptedFile& file)
+{
+    int row = lowerBound(file.file_id);
+    if (row < count() && m_rows[static_cast<size_t>(row)].file_id == file.file_id) {
+        DecryptedFile& existing = m_rows[static_cast<size_t>(row)];
+        if (sameContents(existing, file))
+            return;
+        existing = file;
+        m_index.insert(file.file_id, searchText(file));
+        QModelIndex idx = index(row);
+        emit dataChanged(idx, idx);
+        return;
+    }
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_index.insert(file.file_id, searchText(file));
+    m_rows.insert(m_rows.begin() + row, file);
+    endInsertRows();
+}
+
+QString FileListModel::searchText(const DecryptedFile& f)
+{
+    // newline never appears in a query, so no match can straddle the two fields
+    return f.shared_from.isEmpty() ? f.filename : f.filename + QLatin1Char('\n') + f.shared_from;
+}
+
+bool FileListModel::sameContents(const DecryptedFile& a, const DecryptedFile& b)
+{
+    return a.filename == b.filename
+        && a.size_bytes == b.size_bytes
+        && a.upload_timestamp == b.upload_timestamp
+        && a.is_owner == b.is_owner
+        && a.is_shared == b.is_shared
+        && a.shared_from == b.shared_from;
+}
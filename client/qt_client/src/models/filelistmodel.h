@@ -0,0 +1,77 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <optional>
+#include <vector>
+#include "../utils/decryptedfile.h"
+#include "../utils/trigramindex.h"
+
+/**
+ * FileListModel backs FileTable.qml with decrypted listing rows.
+ *
+ * Rows are kept sorted newest-first (file_id descending, the server's order) so a
+ * file_id lookup is a binary search. Updates arrive as whole snapshots or partial
+ * upserts and are applied as row-level diffs (beginInsertRows / dataChanged /
+ * beginRemoveRows), so a refresh only repaints the delegates that actually changed.
+ *
+ * Every row mutation also updates a TrigramIndex over filename + sharer, which the
+ * filter proxy queries for search.
+ *
+ * GUI thread only; FileListHandler posts updates here from its workers.
+ */
+class FileListModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int count READ count NOTIFY countChanged)
+
+public:
+    enum Roles {
+        FileIdRole = Qt::UserRole + 1,
+        NameRole,
+        SizeRole,
+        ModifiedRole,
+        IsOwnerRole,
+        IsSharedRole,
+        SharedFromRole,
+    };
+
+    explicit FileListModel(QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int count() const { return static_cast<int>(m_rows.size()); }
+
+    // Makes the model hold exactly `files`; only rows that differ are touched.
+    void applySnapshot(std::vector<DecryptedFile> files);
+
+    // Inserts new rows and updates existing ones; rows not mentioned are left alone.
+    void upsert(const std::vector<DecryptedFile>& files);
+
+    void removeFile(uint64_t fileId);
+
+    // Removes every listed row, one beginRemoveRows per contiguous run; unknown ids are ignored.
+    void removeFiles(const std::vector<uint64_t>& fileIds);
+
+    std::optional<DecryptedFile> find(uint64_t fileId) const;
+
+    // Direct row access for the proxy's comparators; row must be in range
+    const DecryptedFile& at(int row) const { return m_rows[static_cast<size_t>(row)]; }
+
+    const TrigramIndex& searchIndex() const { return m_index; }
+    TrigramIndex& searchIndex() { return m_index; }
+
+signals:
+    void countChanged();
+
+private:
+    // Index of the row for fileId, or of the position it would be inserted at
+    int lowerBound(uint64_t fileId) const;
+    void upsertOne(const DecryptedFile& file);
+
+    static bool sameContents(const DecryptedFile& a, const DecryptedFile& b);
+    static QString searchText(const DecryptedFile& f);
+
+    std::vector<DecryptedFile> m_rows;
+    TrigramIndex               m_index;
+};
@@ -8,6 +8,7 @@
 #include "crypto/Signer_Ed.h"
 #include "crypto/Signer_Dilithium.h"
 #include "crypto/FileClientData.h"
+#include "tracing.h"
 
 /**
  * NetworkAuthUtils
@@ -69,6 +70,8 @@ makeAuthHeaders(
     const std::string& bodyJson
     )
 {
+    TRACE_SPAN("auth", "sign_request");
+
     // 1) timestamp in ISO8601 UTC (Qt::ISODate gives e.g. "2025-06-03T15:42:00Z")
     QString qsNow = QDateTime::currentDateTimeUtc().toString(Qt::ISODate);
     std::string timestamp = qsNow.toStdString();
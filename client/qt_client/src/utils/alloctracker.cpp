@@ -0,0 +1,275 @@
+// Only compiled with QT_CLIENT_ALLOC_TRACKING=ON; see alloctracker.h
+#include "alloctracker.h"
+#include "metrics.h"
+#include <openssl/crypto.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <utility>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#else
+#include <malloc.h>
+#endif
+
+namespace {
+
+// Plain thread_local PODs: safe to touch from operator new at any point of a thread's life
+struct ThreadCounts {
+    uint64_t    allocs;
+    uint64_t    frees;
+    uint64_t    bytes;
+    int64_t     live;
+    int64_t     peak;
+    bool        bookkeeping;    // Scope's own Metrics lookups are not charged to stages
+};
+
+thread_local constinit ThreadCounts tl{};
+
+// The process high-water mark needs one shared counter; this is an instrumentation build
+std::atomic<uint64_t>   g_allocs{ 0 };
+std::atomic<uint64_t>   g_frees{ 0 };
+std::atomic<uint64_t>   g_bytes{ 0 };
+std::atomic<int64_t>    g_live{ 0 };
+std::atomic<int64_t>    g_peak{ 0 };
+
+size_t usableSize(void* p)
+{
+#if defined(_WIN32)
+    return _msize(p);
+#elif defined(__APPLE__)
+    return malloc_size(p);
+#else
+    return malloc_usable_size(p);
+#endif
+}
+
+void counted(size_t size)
+{
+    const auto n = static_cast<int64_t>(size);
+    if (!tl.bookkeeping) {
+        ++tl.allocs;
+        tl.bytes += size;
+        tl.live += n;
+        tl.peak = std::max(tl.peak, tl.live);
+    }
+    g_allocs.fetch_add(1, std::memory_order_relaxed);
+    g_bytes.fetch_add(size, std::memory_order_relaxed);
+    const int64_t live = g_live.fetch_add(n, std::memory_order_relaxed) + n;
+    int64_t peak = g_peak.load(std::memory_order_relaxed);
+    while (live > peak && !g_peak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+}
+
+void uncounted(size_t size)
+{
+    if (!tl.bookkeeping) {
+        ++tl.frees;
+        tl.live -= static_cast<int64_t>(size);
+    }
+    g_frees.fetch_add(1, std::memory_order_relaxed);
+    g_live.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+}
+
+void* allocate(size_t n)
+{
+    void* p = std::malloc(n ? n : 1);
+    if (p)
+        counted(usableSize(p));
+    return p;
+}
+
+void release(void* p)
+{
+    if (!p)
+        return;
+    uncounted(usableSize(p));
+    std::free(p);
+}
+
+void* allocateAligned(size_t n, std::align_val_t al)
+{
+    const size_t align = static_cast<size_t>(al);
+#if defined(_WIN32)
+    void* p = _aligned_malloc(n ? n : 1, align);
+    if (p)
+        counted(_aligned_msize(p, align, 0));
+#else
+    void* p = nullptr;
+    if (posix_memalign(&p, std::max(align, sizeof(void*)), n ? n : 1) != 0)
+        p = nullptr;
+    if (p)
+        counted(usableSize(p));
+#endif
+    return p;
+}
+
+void releaseAligned(void* p, std::align_val_t al)
+{
+    if (!p)
+        return;
+#if defined(_WIN32)
+    uncounted(_aligned_msize(p, static_cast<size_t>(al), 0));
+    _aligned_free(p);
+#else
+    (void)al;
+    release(p);
+#endif
+}
+
+// OpenSSL's hooks (CRYPTO_set_mem_functions)
+void* sslMalloc(size_t n, const char*, int) { return allocate(n); }
+void  sslFree(void* p, const char*, int) { release(p); }
+
+void* sslRealloc(void* p, size_t n, const char*, int)
+{
+    if (!p)
+        return allocate(n);
+    const size_t before = usableSize(p);
+    void* q = std::realloc(p, n);
+    if (!q)
+        return nullptr;     // p is untouched and still counted
+    uncounted(before);
+    counted(usableSize(q));
+    return q;
+}
+
+struct StageMetrics {
+    Metrics::Counter*   allocs;
+    Metrics::Counter*   bytes;
+    Metrics::Histogram* peak;
+};
+
+// Span names are literals or interned, so the pointers identify a stage
+StageMetrics& stageMetrics(const char* category, const char* name)
+{
+    static std::mutex mutex;
+    static std::map<std::pair<const char*, const char*>, StageMetrics> stages;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = stages.find({ category, name });
+    if (it == stages.end()) {
+        auto& metrics = Metrics::instance();
+        const std::string prefix = std::string("alloc.") + category + "." + name;
+        StageMetrics m{ &metrics.counter(prefix + ".allocs"), &metrics.counter(prefix + ".bytes"),
+                        &metrics.histogram(prefix + ".peak", Metrics::Histogram::Unit::Bytes) };
+        it = stages.emplace(std::make_pair(category, name), m).first;
+    }
+    return it->second;
+}
+
+} // namespace
+
+namespace AllocTracker {
+
+void install()
+{
+    if (!CRYPTO_set_mem_functions(sslMalloc, sslRealloc, sslFree))
+        std::fprintf(stderr, "[AllocTracker] OpenSSL has already allocated; its heap goes uncounted\n");
+
+    auto& metrics = Metrics::instance();
+    metrics.probe("alloc.process.allocs", []() { return static_cast<int64_t>(process().allocs); });
+    metrics.probe("alloc.process.bytes",  []() { return static_cast<int64_t>(process().bytes); });
+    metrics.probe("alloc.process.live",   []() { return process().live; });
+    metrics.probe("alloc.process.peak",   []() { return process().peak; });
+}
+
+Counts thisThread()
+{
+    return { tl.allocs, tl.frees, tl.bytes, tl.live, tl.peak };
+}
+
+Counts process()
+{
+    return { g_allocs.load(std::memory_order_relaxed), g_frees.load(std::memory_order_relaxed),
+             g_bytes.load(std::memory_order_relaxed), g_live.load(std::memory_order_relaxed),
+             g_peak.load(std::memory_order_relaxed) };
+}
+
+void resetPeak()
+{
+    g_peak.store(g_live.load(std::memory_order_relaxed), std::memory_order_relaxed);
+}
+
+Scope::Scope(const char* category, const char* name)
+    : m_category(category), m_name(name),
+      m_allocs(tl.allocs), m_bytes(tl.bytes), m_live(tl.live), m_outerPeak(tl.peak)
+{
+    // the stage's own high-water mark starts where the heap stands now
+    tl.peak = tl.live;
+}
+
+Scope::~Scope()
+{
+    const uint64_t allocs = tl.allocs - m_allocs;
+    const uint64_t bytes  = tl.bytes - m_bytes;
+    const int64_t  peak   = tl.peak - m_live;
+    tl.peak = std::max(m_outerPeak, tl.peak);
+
+    const bool outer = tl.bookkeeping;
+    tl.bookkeeping = true;
+    StageMetrics& m = stageMetrics(m_category, m_name);
+    m.allocs->add(allocs);
+    m.bytes->add(bytes);
+    m.peak->record(static_cast<uint64_t>(std::max<int64_t>(peak, 0)));
+    tl.bookkeeping = outer;
+}
+
+} // namespace AllocTracker
+
+// ── Global replacements ──────────────────────────────────────────────────────────────
+
+void* operator new(std::size_t n)
+{
+    if (void* p = allocate(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n)
+{
+    if (void* p = allocate(n))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return allocate(n); }
+
+void* operator new(std::size_t n, std::align_val_t al)
+{
+    if (void* p = allocateAligned(n, al))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t n, std::align_val_t al)
+{
+    if (void* p = allocateAligned(n, al))
+        return p;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateAligned(n, al); }
+void* operator new[](std::size_t n, std::align_val_t al, const std::nothrow_t&) noexcept { return allocateAligned(n, al); }
+
+void operator delete(void* p) noexcept { release(p); }
+void operator delete[](void* p) noexcept { release(p); }
+void operator delete(void* p, std::size_t) noexcept { release(p); }
+void operator delete[](void* p, std::size_t) noexcept { release(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { release(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { release(p); }
+
+void operator delete(void* p, std::align_val_t al) noexcept { releaseAligned(p, al); }
+void operator delete[](void* p, std::align_val_t al) noexcept { releaseAligned(p, al); }
+void operator delete(void* p, std::size_t, std::align_val_t al) noexcept { releaseAligned(p, al); }
+void operator delete[](void* p, std::size_t, std::align_val_t al) noexcept { releaseAligned(p, al); }
+void operator delete(void* p, std::align_val_t al, const std::nothrow_t&) noexcept { releaseAligned(p, al); }
+void operator delete[](void* p, std::align_val_t al, const std::nothrow_t&) noexcept { releaseAligned(p, al); }
@@ -0,0 +1,95 @@
+#pragma once
+#include <cstdint>
+
+/**
+ * AllocTracker – heap accounting for the instrumentation build
+ * (cmake -DQT_CLIENT_ALLOC_TRACKING=ON, which defines SSSHARE_ALLOC_TRACKING=1).
+ *
+ * Replaces the global operator new / delete and, once install() has run, OpenSSL's
+ * allocator, and counts into plain per-thread counters. Every TRACE_SPAN stage
+ * (tracing.h) opens a Scope, so what a stage allocates lands in Metrics (metrics.h):
+ *
+ *   alloc.<category>.<name>.allocs / .bytes    counters, nested stages included
+ *   alloc.<category>.<name>.peak               bytes histogram: how far one run of the
+ *                                              stage raised its thread's live heap
+ *   alloc.process.*                            live / peak heap and totals, all threads
+ *
+ * so it shows up on the diagnostics page, in the metrics dumps and in transfer_bench.
+ *
+ * A stage only sees its own thread: a buffer it hands to another thread and is freed
+ * there still counts as its peak. Sizes are what the allocator actually reserved
+ * (malloc_usable_size), a little above what was asked for. libsodium allocates nothing
+ * on our paths except Argon2's scratch, and liboqs has no allocator hook; those
+ * (the login KDF, ML-DSA) call malloc directly and go uncounted.
+ *
+ * Without the option every function here is an empty inline and nothing is replaced.
+ */
+
+#ifndef SSSHARE_ALLOC_TRACKING
+#define SSSHARE_ALLOC_TRACKING 0
+#endif
+
+namespace AllocTracker {
+
+struct Counts {
+    uint64_t    allocs = 0;
+    uint64_t    frees  = 0;
+    uint64_t    bytes  = 0;     // total allocated
+    int64_t     live   = 0;     // allocated minus freed
+    int64_t     peak   = 0;     // highest `live` since the last resetPeak()
+};
+
+#if SSSHARE_ALLOC_TRACKING
+
+constexpr bool kEnabled = true;
+
+/**
+ * Hooks OpenSSL's allocator and registers the alloc.process.* probes. Call first thing
+ * in main(): OpenSSL refuses new hooks once it has allocated anything.
+ */
+void install();
+
+/** The calling thread's counters; live may go negative if it frees others' memory */
+Counts thisThread();
+
+/** Every thread together */
+Counts process();
+
+/** Starts a new process high-water mark at the current live heap (between bench phases) */
+void resetPeak();
+
+/** Charges what the current thread allocates until destruction to category.name */
+class Scope {
+public:
+    Scope(const char* category, const char* name);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    uint64_t    m_allocs;
+    uint64_t    m_bytes;
+    int64_t     m_live;
+    int64_t     m_outerPeak;
+};
+
+#else
+
+constexpr bool kEnabled = false;
+
+inline void install() {}
+inline Counts thisThread() { return {}; }
+inline Counts process() { return {}; }
+inline void resetPeak() {}
+
+class Scope {
+public:
+    Scope(const char*, const char*) {}
+};
+
+#endif
+
+} // namespace AllocTracker
@@ -0,0 +1,148 @@
+#include "changesubscriber.h"
+#include "NetworkAuthUtils.h"
+#include "networking/asiosslclient.h"
+#include <nlohmann/json.hpp>
+#include <QDebug>
+#include <algorithm>
+#include <chrono>
+
+using json = nlohmann::json;
+
+ChangeSubscriber::ChangeSubscriber(const QString& username, const KeyBundle& bundle,
+                                   std::function<uint64_t()> cursorFn, QObject* parent)
+    : QObject(parent),
+      m_username(username.toStdString()),
+      m_bundle(bundle),
+      m_cursorFn(std::move(cursorFn))
+{
+}
+
+ChangeSubscriber::~ChangeSubscriber()
+{
+    stop();
+}
+
+void ChangeSubscriber::start()
+{
+    if (m_thread.joinable())
+        return;
+    m_stopping = false;
+    m_thread = std::thread([this]() { run(); });
+}
+
+void ChangeSubscriber::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        if (m_client)
+            m_client->cancel();
+    }
+    m_wake.notify_all();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void ChangeSubscriber::run()
+{
+    int backoff = kMinBackoffSeconds;
+    while (!m_stopping) {
+        if (runOnce())
+            backoff = kMinBackoffSeconds;
+        emit connectedChanged(false);
+        if (m_stopping)
+            break;
+
+        qDebug() << "[ChangeSubscriber] stream closed, reconnecting in" << backoff << "s";
+        waitBackoff(backoff);
+        backoff = std::min(backoff * 2, kMaxBackoffSeconds);
+    }
+}
+
+bool ChangeSubscriber::runOnce()
+{
+    std::string bodyStr = json{ { "cursor", m_cursorFn() } }.dump();
+    auto headers = NetworkAuthUtils::makeAuthHeaders(
+        m_username, m_bundle, "POST", "/api/fs/events", bodyStr);
+    headers["Content-Type"] = "application/json";
+    headers["Accept"]       = "text/event-stream";
+    HttpRequest req(HttpRequest::Method::POST, "/api/fs/events", bodyStr, headers);
+
+    auto client = std::make_shared<AsioSslClient>();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (m_stopping)
+            return false;
+        m_client = client;
+    }
+
+    m_buffer.clear();
+    bool sawReady = false;
+    std::string error;
+    int status = client->streamRequest(
+        req,
+        [this, &sawReady](const std::string& chunk) { return consume(chunk, sawReady); },
+        error);
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_client.reset();
+    }
+
+    if ((status != 200 || !error.empty()) && !m_stopping)
+        qWarning() << "[ChangeSubscriber] events stream failed:" << status << QString::fromStdString(error);
+    return sawReady;
+}
+
+bool ChangeSubscriber::consume(const std::string& chunk, bool& sawReady)
+{
+    if (m_stopping)
+        return false;
+
+    m_buffer += chunk;
+    std::string::size_type end;
+    while ((end = m_buffer.find("\n\n")) != std::string::npos) {
+        std::string block = m_buffer.substr(0, end);
+        m_buffer.erase(0, end + 2);
+
+        std::string event = "message", data;
+        std::string::size_type pos = 0;
+        while (pos <= block.size()) {
+            auto eol = block.find('\n', pos);
+            std::string line = block.substr(pos, eol == std::string::npos ? std::string::npos : eol - pos);
+            if (line.rfind("event: ", 0) == 0)
+                event = line.substr(7);
+            else if (line.rfind("data: ", 0) == 0)
+                data += line.substr(6);
+            if (eol == std::string::npos)
+                break;
+            pos = eol + 1;
+        }
+        if (data.empty())
+            continue;       // ": ping" heartbeat
+
+        try {
+            json j = json::parse(data);
+            if (event == "ready") {
+                sawReady = true;
+                emit connectedChanged(true);
+                if (j.value("behind", true))
+                    emit changesAvailable();
+            }
+            else if (event == "changes") {
+                emit changesAvailable();
+            }
+        }
+        catch (const std::exception& ex) {
+            qWarning() << "[ChangeSubscriber] bad event:" << ex.what();
+            return false;
+        }
+    }
+    return true;
+}
+
+void ChangeSubscriber::waitBackoff(int seconds)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_wake.wait_for(lock, std::chrono::seconds(seconds), [this]() { return m_stopping.load(); });
+}
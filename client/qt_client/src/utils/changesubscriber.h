@@ -0,0 +1,64 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "crypto/KeyBundle.h"
+
+class AsioSslClient;
+
+/**
+ * ChangeSubscriber holds a server-sent-events stream open on /api/fs/events and
+ * emits changesAvailable() whenever the server says the user's change feed moved.
+ *
+ *  • Events carry no file data; the listener pulls the delta from /api/fs/changes,
+ *    so there is nothing to decrypt here and nothing to poll.
+ *  • The stream is opened with the current cursor (from cursorFn); the server's
+ *    "ready" event says whether anything was missed while disconnected.
+ *  • Dropped or silent connections are retried with capped exponential backoff.
+ *
+ * Runs on its own thread; changesAvailable() is emitted from it (queued to receivers).
+ */
+class ChangeSubscriber : public QObject {
+    Q_OBJECT
+
+public:
+    ChangeSubscriber(const QString& username, const KeyBundle& bundle,
+                     std::function<uint64_t()> cursorFn, QObject* parent = nullptr);
+    ~ChangeSubscriber() override;
+
+    void start();
+    void stop();
+
+signals:
+    void changesAvailable();
+    void connectedChanged(bool connected);
+
+private:
+    void run();
+    // Returns true if the stream got as far as "ready", i.e. the backoff can reset
+    bool runOnce();
+    // Parses complete events out of m_buffer; false if the stream should be dropped
+    bool consume(const std::string& chunk, bool& sawReady);
+    void waitBackoff(int seconds);
+
+    static constexpr int kMinBackoffSeconds = 1;
+    static constexpr int kMaxBackoffSeconds = 30;
+
+    std::string                 m_username;
+    KeyBundle                   m_bundle;
+    std::function<uint64_t()>   m_cursorFn;
+
+    std::thread                 m_thread;
+    std::atomic<bool>           m_stopping{false};
+    std::mutex                  m_mutex;        // guards m_client; pairs with m_wake for backoff sleeps
+    std::condition_variable     m_wake;
+    std::shared_ptr<AsioSslClient> m_client;
+    std::string                 m_buffer;
+};
@@ -6,11 +6,14 @@
 #include <filesystem>
 #include <nlohmann/json.hpp>
 #include <QDebug>
+#include <QLockFile>
 
 #include <sodium.h>
 #include <stdexcept>
 #include <cstring>
 #include "crypto/symmetric.h"
+#include "metrics.h"
+#include "tracing.h"
 
 using json = nlohmann::json;
 
@@ -109,6 +112,8 @@ void ClientStore::load() {
     try {
         from_json(j);
         CLS_LOG("load") << "from_json() succeeded";
+        std::error_code ec;
+        m_diskTime = std::filesystem::last_write_time(m_path, ec);
     }
     catch (const std::exception& ex) {
         CLS_LOG("load") << "from_json() threw exception: " << ex.what();
@@ -116,25 +121,98 @@ void ClientStore::load() {
 }
 
 void ClientStore::save() {
+    TRACE_SPAN("store", "save");
+    Metrics::Timer timer(METRICS_HISTOGRAM("store.save"));
+    METRICS_COUNTER("store.saves").add();
     CLS_LOG("save") << "called";
     std::lock_guard<std::mutex> locker(m_mutex);
-    CLS_LOG("save") << "called; building JSON (files=" << m_files.size() << ")";
 
+    // the GUI and ssshared share this file: one read-merge-write at a time
+    QLockFile diskLock(QString::fromStdString(m_path + ".lock"));
+    if (!diskLock.lock())
+        CLS_LOG("save") << "cannot take " << diskLock.fileName() << ", saving without it";
+    mergeFromDisk(true);
+
+    CLS_LOG("save") << "called; building JSON (files=" << m_files.size() << ")";
+    METRICS_GAUGE("store.files").set(static_cast<int64_t>(m_files.size()));
     json j = to_json();
 
-    std::ofstream out(m_path, std::ios::out | std::ios::trunc);
-    if (!out.good()) {
-        CLS_LOG("save") << "cannot open for writing: " << QString::fromStdString(m_path);
+    // write-then-rename, so a reader in another process never sees a torn file
+    std::string tmpPath = m_path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::out | std::ios::trunc);
+        if (!out.good()) {
+            CLS_LOG("save") << "cannot open for writing: " << QString::fromStdString(tmpPath);
+            return;
+        }
+
+        out << j.dump(4) << std::endl;
+        out.flush();
+        if (!out.good()) {
+            CLS_LOG("save") << "write to " << QString::fromStdString(tmpPath) << " failed";
+            return;
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, m_path, ec);
+    if (ec) {
+        CLS_LOG("save") << "rename to " << QString::fromStdString(m_path)
+                        << " failed: " << QString::fromStdString(ec.message());
         return;
     }
+    m_changedFiles.clear();
+    m_removedFiles.clear();
+    m_diskTime = std::filesystem::last_write_time(m_path, ec);
+    CLS_LOG("save") << "wrote JSON to " << QString::fromStdString(m_path);
+}
 
-    out << j.dump(4) << std::endl;
-    out.flush();
-    if (!out.good()) {
-        CLS_LOG("save") << "write to " << QString::fromStdString(m_path) << " failed";
-    } else {
-        CLS_LOG("save") << "wrote JSON to " << QString::fromStdString(m_path);
+bool ClientStore::mergeFromDisk(bool dropRemoved) {
+    // Assumes caller already holds m_mutex
+    std::error_code ec;
+    auto diskTime = std::filesystem::last_write_time(m_path, ec);
+    if (ec || (diskTime == m_diskTime && !(dropRemoved && m_dropPending)))
+        return false;
+
+    std::unordered_set<uint64_t> onDisk;
+    std::vector<FileClientData> added;
+    try {
+        std::ifstream in(m_path);
+        json j;
+        in >> j;
+        if (j.contains("files")) {
+            for (const auto& fj : j.at("files")) {
+                FileClientData fcd = FileClientData::from_json(fj);
+                onDisk.insert(fcd.file_id);
+                if (!m_files.count(fcd.file_id) && !m_removedFiles.count(fcd.file_id))
+                    added.push_back(std::move(fcd));
+            }
+        }
+    }
+    catch (const std::exception& ex) {
+        CLS_LOG("merge") << "cannot read " << QString::fromStdString(m_path) << ": " << ex.what();
+        return false;
+    }
+    m_diskTime = diskTime;
+    m_dropPending = !dropRemoved;
+
+    size_t dropped = 0;
+    for (auto it = m_files.begin(); dropRemoved && it != m_files.end();) {
+        if (!onDisk.count(it->first) && !m_changedFiles.count(it->first)) {
+            it = m_files.erase(it);
+            ++dropped;
+        } else {
+            ++it;
+        }
     }
+    for (auto& fcd : added)
+        m_files.emplace(fcd.file_id, std::move(fcd));
+
+    if (added.empty() && dropped == 0)
+        return false;
+    CLS_LOG("merge") << "took " << added.size() << " new and " << dropped
+                     << " removed entries from another process";
+    return true;
 }
 
 std::optional<ClientStore::UserInfo> ClientStore::getUser() const {
@@ -149,21 +227,28 @@ void ClientStore::clearUser() {
     m_user.reset();
 }
 
-FileClientData* ClientStore::getFileData(uint64_t file_id) {
+std::optional<FileClientData> ClientStore::getFileData(uint64_t file_id) {
     std::lock_guard<std::mutex> locker(m_mutex);
     auto it = m_files.find(file_id);
+    // another process (e.g. ssshared) may have uploaded it since we last read the file
+    if (it == m_files.end() && mergeFromDisk(false))
+        it = m_files.find(file_id);
     if (it == m_files.end()) {
+        METRICS_COUNTER("store.lookup_misses").add();
         CLS_LOG("getFileData") << "no entry for file_id=" << file_id;
-        return nullptr;
+        return std::nullopt;
     }
+    METRICS_COUNTER("store.lookup_hits").add();
     CLS_LOG("getFileData") << "found entry for file_id=" << file_id;
-    return &it->second;
+    return it->second;
 }
 
 void ClientStore::upsertFileData(const FileClientData& fcd) {
     {
         std::lock_guard<std::mutex> locker(m_mutex);
         m_files[fcd.file_id] = fcd;
+        m_changedFiles.insert(fcd.file_id);
+        m_removedFiles.erase(fcd.file_id);
         CLS_LOG("upsertFileData") << "stored FileClientData for file_id=" << fcd.file_id;
     }
     save();
@@ -172,6 +257,8 @@ void ClientStore::upsertFileData(const FileClientData& fcd) {
 void ClientStore::removeFileData(uint64_t file_id) {
     {
         std::lock_guard<std::mutex> locker(m_mutex);
+        m_removedFiles.insert(file_id);
+        m_changedFiles.erase(file_id);
         if (m_files.erase(file_id)) {
             CLS_LOG("removeFileData") << "erased entry for file_id=" << file_id;
         } else {
@@ -181,6 +268,25 @@ void ClientStore::removeFileData(uint64_t file_id) {
     save();
 }
 
+void ClientStore::removeFileDataBatch(const std::vector<uint64_t>& file_ids) {
+    size_t erased = 0;
+    {
+        std::lock_guard<std::mutex> locker(m_mutex);
+        for (uint64_t file_id : file_ids) {
+            m_removedFiles.insert(file_id);
+            m_changedFiles.erase(file_id);
+            erased += m_files.erase(file_id);
+        }
+        CLS_LOG("removeFileDataBatch") << "erased " << erased << " of " << file_ids.size() << " entries";
+    }
+    if (erased > 0)
+        save();
+}
+
+std::string ClientStore::directory() const {
+    return std::filesystem::path(m_path).parent_path().string();
+}
+
 json ClientStore::to_json() const {
     // Assumes caller already holds m_mutex
     json j;
@@ -266,6 +372,7 @@ bool ClientStore::derivePasswordKey(const std::string& password,
                                     const std::vector<uint8_t>& salt,
                                     std::vector<uint8_t>& outKey)
 {
+    TRACE_SPAN("login", "kdf");
     CLS_LOG("argon2id") << "pwdLen=" << password.size()
                         << " saltLen=" << salt.size();
     // Argon2id with moderate ops/memory limits
@@ -411,34 +518,12 @@ bool ClientStore::loginAndDecrypt(const std::string& username,
             return false;
         }
 
-        // 3) Decrypt private KeyBundle JSON ← AES-CTR(privEnc, privNonce, MEK)
-        Symmetric::Plaintext privPlain = Symmetric::decrypt(
-            stored.privEnc,
-            MEK,
-            stored.privNonce
-            );
-        CLS_LOG("decrypt") << "priv cipher="   << stored.privEnc.size()
-                           << " keyLen="        << MEK.size()
-                           << " ivLen="         << stored.privNonce.size()
-                           << " plainLen="      << privPlain.data.size();
-        std::vector<uint8_t> privJsonBytes = std::move(privPlain.data);
-        if (privJsonBytes.empty()) {
-            outError = "Decrypting private KeyBundle failed";
+        // 3) – 5) Decrypt the private KeyBundle and keep it, with the MEK, in memory
+        if (!decryptPrivateBundle(stored, std::move(MEK), outError)) {
             CLS_LOG("login") << "private bundle decrypt failed";
             return false;
         }
 
-        std::string privJson(reinterpret_cast<char*>(privJsonBytes.data()),
-                             privJsonBytes.size());
-        json j = json::parse(privJson);
-
-        // 4) Reconstruct full KeyBundle
-        KeyBundle fullKb = KeyBundle::fromJsonPrivate(j);
-
-        // 5) Store decrypted MEK and fullBundle in memory
-        stored.masterKey  = std::move(MEK);
-        stored.fullBundle = std::move(fullKb);
-
         CLS_LOG("login") << "SUCCESS – user fully decrypted";
     }
 
@@ -448,6 +533,68 @@ bool ClientStore::loginAndDecrypt(const std::string& username,
     return true;
 }
 
+bool ClientStore::unlockWithMasterKey(const std::string& username,
+                                      const std::vector<uint8_t>& masterKey,
+                                      std::string& outError)
+{
+    std::lock_guard<std::mutex> locker(m_mutex);
+    CLS_LOG("unlock") << "username=" << QString::fromStdString(username);
+
+    if (!m_user.has_value()) {
+        outError = "No stored user found";
+        return false;
+    }
+    if (m_user->username != username) {
+        outError = "Username mismatch";
+        return false;
+    }
+    if (!decryptPrivateBundle(*m_user, masterKey, outError)) {
+        CLS_LOG("unlock") << "private bundle decrypt failed";
+        return false;
+    }
+    CLS_LOG("unlock") << "SUCCESS – user decrypted with a handed-over MEK";
+    return true;
+}
+
+bool ClientStore::decryptPrivateBundle(UserInfo& stored,
+                                       std::vector<uint8_t> MEK,
+                                       std::string& outError)
+{
+    TRACE_SPAN("login", "decrypt");
+
+    // Decrypt private KeyBundle JSON ← AES-CTR(privEnc, privNonce, MEK)
+    Symmetric::Plaintext privPlain = Symmetric::decrypt(
+        stored.privEnc,
+        MEK,
+        stored.privNonce
+        );
+    CLS_LOG("decrypt") << "priv cipher="   << stored.privEnc.size()
+                       << " keyLen="        << MEK.size()
+                       << " ivLen="         << stored.privNonce.size()
+                       << " plainLen="      << privPlain.data.size();
+    std::vector<uint8_t> privJsonBytes = std::move(privPlain.data);
+    if (privJsonBytes.empty()) {
+        outError = "Decrypting private KeyBundle failed";
+        return false;
+    }
+
+    // CTR has no tag: a wrong key shows up as JSON that does not parse
+    try {
+        std::string privJson(reinterpret_cast<char*>(privJsonBytes.data()),
+                             privJsonBytes.size());
+        json j = json::parse(privJson);
+        stored.fullBundle = KeyBundle::fromJsonPrivate(j);
+    }
+    catch (const std::exception& ex) {
+        outError = "Decrypting private KeyBundle failed (wrong password or corrupted data)";
+        CLS_LOG("decrypt") << "private bundle does not parse: " << ex.what();
+        return false;
+    }
+
+    stored.masterKey = std::move(MEK);
+    return true;
+}
+
 bool ClientStore::changePassword(const std::string& newPassword,
                                  std::string& outError)
 {
@@ -4,6 +4,8 @@
 #include "crypto/KeyBundle.h"
 #include <nlohmann/json.hpp>
 #include <unordered_map>
+#include <unordered_set>
+#include <filesystem>
 #include <mutex>
 #include <optional>
 #include <string>
@@ -42,6 +44,11 @@
  *
  * After any setUser or password change, ClientStore::save() will write the JSON to disk.
  *
+ * The store file can be shared by several processes (the GUI and ssshared). save() merges
+ * the file entries another process wrote since we last looked, under a lock file, and
+ * replaces the file with write-then-rename; getFileData() re-reads it on a miss, but only
+ * ever adds entries there: removals are applied by save().
+ *
  * Chris C++ Requirement:
  *  - Call by reference
  */
@@ -130,6 +137,22 @@ public:
                          const std::string& password,
                          std::string& outError);
 
+    /**
+     * Unlock with a MEK that another process already derived (ssshared hands it to the GUI),
+     * skipping Argon2. Same result and failure rules as loginAndDecrypt().
+     */
+    bool unlockWithMasterKey(const std::string& username,
+                             const std::vector<uint8_t>& masterKey,
+                             std::string& outError);
+
+    /**
+     * Argon2id(password, salt) → 32-byte key, the cost paid on every login.
+     * Returns true on success, false on failure.
+     */
+    static bool derivePasswordKey(const std::string& password,
+                                  const std::vector<uint8_t>& salt,
+                                  std::vector<uint8_t>& outKey);
+
     /**
      * Change the user’s password.  Takes the old password & a new password.
      * Re-wraps the existing MEK under Argon2id(newPassword), and updates (salt, masterEnc, masterNonce).
@@ -149,10 +172,11 @@ public:
 
     /**
      * Once a user is logged in, we store “which files” they own → FileClientData.
-     * getFileData() returns a pointer to the FileClientData for a given file_id,
-     * or nullptr if not found.
+     * getFileData() returns a copy of the FileClientData for a given file_id,
+     * or std::nullopt if not found. A copy, because callers hold it across co_await
+     * and worker threads while other threads upsert, remove or merge entries.
      */
-    FileClientData* getFileData(uint64_t file_id);
+    std::optional<FileClientData> getFileData(uint64_t file_id);
 
     /**
      * Insert or update a FileClientData entry (e.g. after upload).  Then save().
@@ -164,6 +188,16 @@ public:
      */
     void removeFileData(uint64_t file_id);
 
+    /**
+     * Remove several file_ids with a single save() (e.g. after a batch delete).
+     */
+    void removeFileDataBatch(const std::vector<uint64_t>& file_ids);
+
+    /**
+     * Directory holding the store file; per-user caches (e.g. MetadataCache) live beside it.
+     */
+    std::string directory() const;
+
 private:
     // Full path to the JSON file, e.g. "/home/alice/.ssshare/client_store.json"
     std::string m_path;
@@ -173,17 +207,30 @@ private:
     std::optional<UserInfo> m_user;   // populated only after login
     std::unordered_map<uint64_t, FileClientData> m_files;  // file_id → FileClientData
 
+    // Local edits since the last save, so a merge with the file on disk keeps them
+    std::unordered_set<uint64_t> m_changedFiles;
+    std::unordered_set<uint64_t> m_removedFiles;
+    std::filesystem::file_time_type m_diskTime{};   // write time of the file we last read or wrote
+    bool m_dropPending = false;     // a read-path merge saw the file but left its removals for save()
+
     // Helpers to (de)serialize to/from JSON.  Caller holds m_mutex before calling.
     nlohmann::json to_json() const;
     void from_json(const nlohmann::json& j);
 
     /**
-     * Internal helper: Argon2id(password, salt) → 32-byte key.
-     * Returns true on success, false on failure.
+     * Pull in file entries another process saved since m_diskTime: adds theirs, keeps our
+     * unsaved edits and, with dropRemoved, drops the ones they removed. Lookups pass false
+     * so a read never erases an entry; save() passes true. Returns true if m_files changed.
+     * Caller holds m_mutex.
      */
-    static bool derivePasswordKey(const std::string& password,
-                                  const std::vector<uint8_t>& salt,
-                                  std::vector<uint8_t>& outKey);
+    bool mergeFromDisk(bool dropRemoved);
+
+    /**
+     * Decrypt the private KeyBundle with MEK into `stored`.  Caller holds m_mutex.
+     */
+    static bool decryptPrivateBundle(UserInfo& stored,
+                                     std::vector<uint8_t> MEK,
+                                     std::string& outError);
 
     /**
      * Generate a vector of `numBytes` cryptographically secure random bytes.
@@ -0,0 +1,464 @@
+#pragma once
+
+#include <QDebug>
+#include <QObject>
+#include <QPointer>
+#include <atomic>
+#include <coroutine>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "executor.h"
+#include "uieventpump.h"
+#include "networking/asyncsslclient.h"
+#include "networking/NetworkClient.h"
+#include "networking/HttpRequest.h"
+#include "networking/HttpResponse.h"
+
+/**
+ * Coroutine support for handler flows.
+ *
+ * A flow is a Coro::Task<T> that says where each step runs instead of blocking a thread
+ * for the whole of it:
+ *
+ *   Coro::Task<void> Handler::flow(Input in)          // parameters by value!
+ *   {
+ *       co_await Coro::resumeOnCpu();                 // sign / encrypt on the CPU pool
+ *       HttpRequest req = ...;
+ *       HttpResponse resp = co_await Coro::request(req);   // no thread while waiting
+ *       co_await Coro::resumeOnUi(this);              // back on the Qt thread
+ *       emit done(...);
+ *   }
+ *
+ *   Coro::spawn(flow(in));                            // from a Q_INVOKABLE
+ *
+ * Tasks are lazy: nothing runs until the task is awaited or spawned, and a spawned task
+ * runs on the caller's thread up to its first co_await, so a flow started from QML
+ * should hop off the GUI thread first.
+ *
+ * Awaiting a network request holds a coroutine frame and a socket, not a thread; the
+ * flow resumes on the I/O pool once the response is in. whenAll() runs several tasks at
+ * once and resumes when the last one finishes, which is how flows overlap requests.
+ *
+ * Exceptions thrown in a task come out of the co_await on it. If resumeOnUi()'s context
+ * is destroyed before the hop, the flow resumes on the I/O pool with Coro::Cancelled
+ * instead, so it unwinds rather than leaking; spawn() swallows Cancelled quietly.
+ *
+ * A flow that uses its handler's members on the pools holds a ticket from the handler's
+ * FlowTracker for its whole run. Owners retire() such a handler instead of deleting it: that
+ * cancels the flows, and the handler is deleted later, once the last ticket is gone:
+ *
+ *   Coro::Task<void> Handler::flow(Input in)
+ *   {
+ *       auto flow = m_flows.enter();
+ *       if (flow.cancelled())                         // spawned after retire()
+ *           co_return;
+ *       HttpResponse resp = co_await Coro::request(req);
+ *       if (flow.cancelled())                         // retired meanwhile
+ *           co_return;
+ *       co_await Coro::resumeOnUi(this);
+ *       if (flow.cancelled())
+ *           co_return;
+ *       emit done(...);
+ *   }
+ */
+namespace Coro {
+
+// Thrown out of resumeOnUi() when its context object is gone
+struct Cancelled : std::runtime_error {
+    Cancelled() : std::runtime_error("cancelled") {}
+};
+
+template <class T = void>
+class Task;
+
+namespace detail {
+
+struct PromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr      error;
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+
+    // Hands control straight to whoever awaited the task (symmetric transfer, no stack growth)
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <class P>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) const noexcept
+        {
+            std::coroutine_handle<> next = h.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+    FinalAwaiter final_suspend() noexcept { return {}; }
+
+    void unhandled_exception() noexcept { error = std::current_exception(); }
+};
+
+template <class T>
+struct Promise : PromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <class U>
+    void return_value(U&& v) { value.emplace(std::forward<U>(v)); }
+
+    T take()
+    {
+        if (error)
+            std::rethrow_exception(error);
+        return std::move(*value);
+    }
+};
+
+template <>
+struct Promise<void> : PromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() noexcept {}
+    void take()
+    {
+        if (error)
+            std::rethrow_exception(error);
+    }
+};
+
+// Fire-and-forget frame: starts at once, frees itself when it ends
+struct Detached {
+    struct promise_type {
+        Detached get_return_object() noexcept { return {}; }
+        std::suspend_never initial_suspend() noexcept { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+template <class T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::Promise<T>;
+
+    Task(Task&& other) noexcept : m_handle(std::exchange(other.m_handle, {})) {}
+    Task& operator=(Task&& other) noexcept
+    {
+        if (this != &other) {
+            if (m_handle)
+                m_handle.destroy();
+            m_handle = std::exchange(other.m_handle, {});
+        }
+        return *this;
+    }
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+    ~Task()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    bool await_ready() const noexcept { return false; }
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+    {
+        m_handle.promise().continuation = awaiting;
+        return m_handle;
+    }
+    T await_resume() { return m_handle.promise().take(); }
+
+private:
+    friend promise_type;
+    explicit Task(std::coroutine_handle<promise_type> h) : m_handle(h) {}
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+namespace detail {
+
+template <class T>
+Task<T> Promise<T>::get_return_object() noexcept
+{
+    return Task<T>(std::coroutine_handle<Promise<T>>::from_promise(*this));
+}
+
+inline Task<void> Promise<void>::get_return_object() noexcept
+{
+    return Task<void>(std::coroutine_handle<Promise<void>>::from_promise(*this));
+}
+
+inline Detached runDetached(Task<void> task)
+{
+    try {
+        co_await task;
+    } catch (const Cancelled&) {
+        qDebug() << "[Coro] flow cancelled: its context object is gone";
+    } catch (const std::exception& ex) {
+        qWarning() << "[Coro] flow threw:" << ex.what();
+    } catch (...) {
+        qWarning() << "[Coro] flow threw a non-std exception";
+    }
+}
+
+} // namespace detail
+
+// Starts task on this thread; it owns itself from here on
+inline void spawn(Task<void> task)
+{
+    detail::runDetached(std::move(task));
+}
+
+// co_await resumeOn(pool) continues the coroutine on an Executor pool
+struct ResumeOn {
+    Executor::Pool      pool;
+    Executor::Priority  priority;
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h) const
+    {
+        Executor::instance().submit(pool, [h]() { h.resume(); }, priority);
+    }
+    void await_resume() const noexcept {}
+};
+
+inline ResumeOn resumeOnCpu(Executor::Priority priority = Executor::Priority::Normal)
+{
+    return { Executor::Pool::Cpu, priority };
+}
+
+inline ResumeOn resumeOnIo(Executor::Priority priority = Executor::Priority::Normal)
+{
+    return { Executor::Pool::Io, priority };
+}
+
+// co_await resumeOnUi(ctx) continues on the GUI thread, in order with ctx's other pump posts
+class ResumeOnUi {
+public:
+    explicit ResumeOnUi(QObject* context) : m_context(context) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        // posted against the pump itself, so a dead context still gets the hop and can unwind
+        UiEventPump& pump = UiEventPump::instance();
+        pump.post(&pump, [this, h]() {
+            if (m_context) {
+                h.resume();
+                return;
+            }
+            m_cancelled = true;
+            Executor::instance().submit(Executor::Pool::Io, [h]() { h.resume(); });
+        });
+    }
+    void await_resume() const
+    {
+        if (m_cancelled)
+            throw Cancelled();
+    }
+
+private:
+    QPointer<QObject>   m_context;
+    bool                m_cancelled = false;
+};
+
+inline ResumeOnUi resumeOnUi(QObject* context)
+{
+    return ResumeOnUi(context);
+}
+
+// Counts one handler's flows in flight, so the handler is only deleted once none of them can
+// touch it any more. Owners retire() a handler instead of deleting it; see RetireLater.
+class FlowTracker {
+    struct State {
+        std::atomic<int>    inFlight{0};
+        std::atomic<bool>   closing{false};
+        std::atomic<bool>   deleteQueued{false};
+        QObject*            owner = nullptr;    // set by retire(), before closing
+
+        // the last one out (a ticket or retire() itself) queues the delete, exactly once;
+        // seq_cst on both sides so a ticket and retire() can't each miss the other's store
+        void deleteIfIdle()
+        {
+            if (closing.load()
+                && inFlight.load() == 0
+                && !deleteQueued.exchange(true))
+                owner->deleteLater();
+        }
+    };
+
+public:
+    class Ticket {
+    public:
+        explicit Ticket(std::shared_ptr<State> state) : m_state(std::move(state))
+        {
+            m_state->inFlight.fetch_add(1);
+        }
+        ~Ticket()
+        {
+            // only the shared state is touched from here: the handler may go at any moment
+            m_state->inFlight.fetch_sub(1);
+            m_state->deleteIfIdle();
+        }
+
+        Ticket(const Ticket&) = delete;
+        Ticket& operator=(const Ticket&) = delete;
+
+        // True once the handler is retired: stop at the next step, results go nowhere
+        bool cancelled() const { return m_state->closing.load(); }
+
+    private:
+        std::shared_ptr<State> m_state;
+    };
+
+    // Taken on a flow's first line, before its first co_await
+    Ticket enter() { return Ticket(m_state); }
+
+    bool closing() const { return m_state->closing.load(); }
+
+    // From the GUI thread, once: cancels the flows and deleteLater()s owner when the last
+    // one has ended (straight away if none is running). Never blocks.
+    void retire(QObject* owner)
+    {
+        m_state->owner = owner;
+        m_state->closing.store(true);
+        m_state->deleteIfIdle();
+    }
+
+private:
+    std::shared_ptr<State> m_state = std::make_shared<State>();
+};
+
+// Deleter for handlers held in a unique_ptr: retire() them rather than delete them
+struct RetireLater {
+    template <class Handler>
+    void operator()(Handler* handler) const { handler->retire(); }
+};
+
+// co_await request(req) sends req on AsyncSslClient (or NetworkClient::transport() when one is
+// set) and resumes on the I/O pool with the response
+class RequestAwaiter {
+public:
+    RequestAwaiter(HttpRequest request, int timeoutSeconds, Executor::Priority priority)
+        : m_request(std::move(request)), m_timeoutSeconds(timeoutSeconds), m_priority(priority) {}
+
+    bool await_ready() const noexcept { return false; }
+    void await_suspend(std::coroutine_handle<> h)
+    {
+        const Executor::Priority priority = m_priority;
+        auto done = [this, h, priority](HttpResponse resp) {
+            m_response = std::move(resp);
+            Executor::instance().submit(Executor::Pool::Io, [h]() { h.resume(); }, priority);
+        };
+        if (std::shared_ptr<NetworkClient> transport = NetworkClient::transport())
+            transport->sendAsync(std::move(m_request), std::move(done), m_timeoutSeconds);
+        else
+            AsyncSslClient::instance().send(m_request, std::move(done), m_timeoutSeconds);
+    }
+    HttpResponse await_resume() { return std::move(m_response); }
+
+private:
+    HttpRequest         m_request;
+    int                 m_timeoutSeconds;
+    Executor::Priority  m_priority;
+    HttpResponse        m_response;
+};
+
+inline RequestAwaiter request(HttpRequest req,
+                              Executor::Priority priority = Executor::Priority::Normal,
+                              int timeoutSeconds = AsyncSslClient::kDefaultTimeoutSeconds)
+{
+    return RequestAwaiter(std::move(req), timeoutSeconds, priority);
+}
+
+namespace detail {
+
+template <class T>
+struct AllState : std::enable_shared_from_this<AllState<T>> {
+    explicit AllState(size_t n) : results(n) {}
+
+    std::atomic<size_t>             remaining{0};
+    std::coroutine_handle<>         parent;
+    std::vector<std::optional<T>>   results;
+    std::mutex                      errorMutex;
+    std::exception_ptr              error;
+};
+
+template <>
+struct AllState<void> : std::enable_shared_from_this<AllState<void>> {
+    explicit AllState(size_t) {}
+
+    std::atomic<size_t>         remaining{0};
+    std::coroutine_handle<>     parent;
+    std::mutex                  errorMutex;
+    std::exception_ptr          error;
+};
+
+// Runs one child to completion, then counts it off; the last one in resumes the parent
+template <class T>
+Detached runChild(Task<T>& task, std::shared_ptr<AllState<T>> state, size_t index)
+{
+    try {
+        if constexpr (std::is_void_v<T>)
+            co_await task;
+        else
+            state->results[index].emplace(co_await task);
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(state->errorMutex);
+        if (!state->error)
+            state->error = std::current_exception();
+    }
+    if (state->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        state->parent.resume();
+}
+
+// Trivially destructible on purpose: some GCC releases mishandle non-trivial temporaries in co_await
+template <class T>
+struct StartAll {
+    std::vector<Task<T>>&   tasks;
+    AllState<T>*            state;
+
+    bool await_ready() const noexcept { return tasks.empty(); }
+    bool await_suspend(std::coroutine_handle<> parent)
+    {
+        state->parent = parent;
+        // one extra count for this call, so no child can resume the parent before the loop is done
+        state->remaining = tasks.size() + 1;
+        for (size_t i = 0; i < tasks.size(); ++i)
+            runChild(tasks[i], state->shared_from_this(), i);
+        return state->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1;
+    }
+    void await_resume() const noexcept {}
+};
+
+} // namespace detail
+
+// Runs every task at once; resumes when all have finished and rethrows the first failure
+template <class T>
+Task<std::vector<T>> whenAll(std::vector<Task<T>> tasks)
+{
+    auto state = std::make_shared<detail::AllState<T>>(tasks.size());
+    co_await detail::StartAll<T>{ tasks, state.get() };
+    if (state->error)
+        std::rethrow_exception(state->error);
+
+    std::vector<T> out;
+    out.reserve(tasks.size());
+    for (auto& r : state->results)
+        out.push_back(std::move(*r));
+    co_return out;
+}
+
+inline Task<void> whenAll(std::vector<Task<void>> tasks)
+{
+    auto state = std::make_shared<detail::AllState<void>>(tasks.size());
+    co_await detail::StartAll<void>{ tasks, state.get() };
+    if (state->error)
+        std::rethrow_exception(state->error);
+}
+
+} // namespace Coro
@@ -135,6 +135,31 @@ struct FileClientData : public CryptoBase {
         return out;
     }
 
+    /**
+     * Same as base64_decode, into any byte vector (e.g. a std::pmr::vector drawn from a
+     * per-page arena); `out` is resized to the decoded length.
+     */
+    template <class ByteVector>
+    static void base64_decode_into(const char* b64, size_t len, ByteVector& out) {
+        size_t maxDecodedLen = (len / 4) * 3 + 1;
+        out.resize(maxDecodedLen);
+
+        size_t actualLen = 0;
+        if (sodium_base642bin(
+                out.data(),
+                maxDecodedLen,
+                b64,
+                len,
+                nullptr,
+                &actualLen,
+                nullptr,
+                sodium_base64_VARIANT_ORIGINAL) != 0)
+        {
+            throw std::runtime_error("base64_decode: invalid input");
+        }
+        out.resize(actualLen);
+    }
+
     nlohmann::json to_json() const {
         nlohmann::json j;
         j["file_id"]            = file_id;
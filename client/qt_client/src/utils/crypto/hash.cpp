@@ -1,4 +1,5 @@
 #include "Hash.h"
+#include "../metrics.h"
 #include <openssl/err.h>
 #include <cstring>
 #include <stdexcept>
@@ -16,6 +17,8 @@ namespace Hash {
     }
 
     std::vector<uint8_t> sha256(const uint8_t* dataPtr, size_t len) {
+        Metrics::Timer timer(METRICS_HISTOGRAM("crypto.sha256"));
+        METRICS_COUNTER("crypto.sha256.bytes").add(len);
         // Create an EVP_MD_CTX
         EVP_MD_CTX* ctx = EVP_MD_CTX_new();
         if (!ctx) {
@@ -1,4 +1,5 @@
 #include "Kem_Ecdh.h"
+#include "../metrics.h"
 #include <stdexcept>
 
 Kem_Ecdh::Kem_Ecdh() {
@@ -37,6 +38,7 @@ std::vector<uint8_t> Kem_Ecdh::pub() const {
 
 // generate ephemeral keypair, compute shared secret
 Encaps Kem_Ecdh::encap(const std::vector<uint8_t>& peerPk) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.x25519.encap"));
     if (peerPk.size() != crypto_scalarmult_BYTES) {
         throw std::invalid_argument("peer public key must be 32 bytes");
     }
@@ -62,6 +64,7 @@ Encaps Kem_Ecdh::encap(const std::vector<uint8_t>& peerPk) const {
 
 // compute shared secret from peer’s ephemeral pubkey
 std::vector<uint8_t> Kem_Ecdh::decap(const std::vector<uint8_t>& ciphertext) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.x25519.decap"));
     if (ciphertext.size() != crypto_scalarmult_BYTES) {
         throw std::invalid_argument("ciphertext must be 32 bytes");
     }
@@ -1,4 +1,5 @@
 #include "Signer_Dilithium.h"
+#include "../metrics.h"
 #include <sodium.h>
 #include <cstring>
 #include <stdexcept>
@@ -29,6 +30,7 @@ std::vector<uint8_t> Signer_Dilithium::pub() const { return _pk; }
 
 std::vector<uint8_t>
 Signer_Dilithium::sign(const std::vector<uint8_t>& msg) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.mldsa.sign"));
     std::vector<uint8_t> sig(_oqs->length_signature);   // 4 595 B
     size_t siglen = 0;
 
@@ -43,6 +45,7 @@ Signer_Dilithium::sign(const std::vector<uint8_t>& msg) const {
 
 bool Signer_Dilithium::verify(const std::vector<uint8_t>& msg,
                               const std::vector<uint8_t>& sig) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.mldsa.verify"));
     if (sig.size() != _oqs->length_signature) return false;
 
     return OQS_SIG_verify(_oqs,
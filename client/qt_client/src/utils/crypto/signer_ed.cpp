@@ -1,5 +1,6 @@
 #include "Signer_Ed.h"
 
+#include "../metrics.h"
 #include <stdexcept>
 #include <sodium.h>
 #include <openssl/evp.h>
@@ -39,6 +40,7 @@ std::vector<uint8_t> Signer_Ed::pub() const {
 }
 
 std::vector<uint8_t> Signer_Ed::sign(const std::vector<uint8_t>& msg) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.ed25519.sign"));
     std::vector<uint8_t> sig(crypto_sign_BYTES);
     unsigned long long siglen = 0;
     if (crypto_sign_detached(
@@ -53,6 +55,7 @@ std::vector<uint8_t> Signer_Ed::sign(const std::vector<uint8_t>& msg) const {
 
 bool Signer_Ed::verify(const std::vector<uint8_t>& msg,
                        const std::vector<uint8_t>& signature) const {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.ed25519.verify"));
     if (signature.size() != crypto_sign_BYTES) {
         return false;
     }
@@ -1,4 +1,5 @@
 #include "Symmetric.h"
+#include "../metrics.h"
 #include <memory>
 #include <openssl/evp.h>
 #include <stdexcept>
@@ -19,6 +20,8 @@ EVP_CIPHER_CTX* Symmetric::create_ctx() {
 
 Symmetric::Ciphertext Symmetric::encrypt(const std::vector<uint8_t>& plaintext,
                                          const std::vector<uint8_t>& key) {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.aes.encrypt"));
+    METRICS_COUNTER("crypto.aes.bytes").add(plaintext.size());
     // Validate key length
     if (key.size() != 32) {
         throw std::invalid_argument("Symmetric::encrypt: key must be 32 bytes for AES-256");
@@ -67,6 +70,8 @@ Symmetric::Ciphertext Symmetric::encrypt(const std::vector<uint8_t>& plaintext,
 Symmetric::Plaintext Symmetric::decrypt(const std::vector<uint8_t>& ciphertext,
                                         const std::vector<uint8_t>& key,
                                         const std::vector<uint8_t>& iv) {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.aes.decrypt"));
+    METRICS_COUNTER("crypto.aes.bytes").add(ciphertext.size());
     if (key.size() != 32) {
         throw std::invalid_argument("Symmetric::decrypt: key must be 32 bytes for AES-256");
     }
@@ -105,3 +110,29 @@ Symmetric::Plaintext Symmetric::decrypt(const std::vector<uint8_t>& ciphertext,
 
     return Plaintext{ std::move(plaintext) };
 }
+
+
+void Symmetric::decryptInto(const uint8_t* ciphertext, size_t len,
+                            const uint8_t* key, const uint8_t* iv,
+                            uint8_t* out) {
+    Metrics::Timer timer(METRICS_HISTOGRAM("crypto.aes.decrypt"));
+    METRICS_COUNTER("crypto.aes.bytes").add(len);
+    EVP_CIPHER_CTX* raw_ctx = create_ctx();
+    std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(raw_ctx, EVP_CIPHER_CTX_free);
+
+    if (1 != EVP_DecryptInit_ex(ctx.get(), EVP_aes_256_ctr(), nullptr, key, iv)) {
+        throw std::runtime_error("Symmetric::decryptInto: EVP_DecryptInit_ex failed");
+    }
+
+    int out_len1 = 0;
+    if (1 != EVP_DecryptUpdate(ctx.get(), out, &out_len1, ciphertext, static_cast<int>(len))) {
+        throw std::runtime_error("Symmetric::decryptInto: EVP_DecryptUpdate failed");
+    }
+
+    // CTR is a stream mode: Final_ex emits nothing, but still reports errors
+    int out_len2 = 0;
+    if (1 != EVP_DecryptFinal_ex(ctx.get(), out + out_len1, &out_len2)
+        || static_cast<size_t>(out_len1 + out_len2) != len) {
+        throw std::runtime_error("Symmetric::decryptInto: EVP_DecryptFinal_ex failed");
+    }
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <vector>
+#include <cstddef>
 #include <cstdint>
 #include <openssl/evp.h>
 #include <openssl/rand.h>
@@ -33,6 +34,14 @@ public:
                              const std::vector<uint8_t>& key,
                              const std::vector<uint8_t>& iv);
 
+    /**
+     * Decrypts `len` bytes into a caller-owned buffer of at least `len` bytes; CTR
+     * mode never changes the length. Lets hot paths decrypt into arena memory.
+     */
+    static void decryptInto(const uint8_t* ciphertext, size_t len,
+                            const uint8_t* key, const uint8_t* iv,
+                            uint8_t* out);
+
 private:
     // Helper
     static EVP_CIPHER_CTX* create_ctx();
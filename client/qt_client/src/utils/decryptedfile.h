@@ -0,0 +1,18 @@
+#pragma once
+
+#include <QString>
+#include <QDateTime>
+#include <cstdint>
+
+/**
+ * A simplified struct representing one file’s decrypted metadata.
+ */
+struct DecryptedFile {
+    uint64_t    file_id;
+    QString     filename;
+    uint64_t    size_bytes;
+    QDateTime   upload_timestamp;
+    bool        is_owner;
+    bool        is_shared;
+    QString     shared_from;  // If shared, the username of the sharer (optional)
+};
@@ -0,0 +1,196 @@
+#include "executor.h"
+#include "metrics.h"
+#include "tracing.h"
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// Which pool (and which slot in it) the current thread works for, if any
+thread_local const void* tl_pool   = nullptr;
+thread_local size_t      tl_worker = 0;
+
+}
+
+Executor& Executor::instance()
+{
+    static Executor executor;
+    return executor;
+}
+
+Executor::Executor()
+{
+    m_cpu.kind = Pool::Cpu;
+    m_io.kind  = Pool::Io;
+    start(m_cpu, std::max(2u, std::thread::hardware_concurrency()));
+    start(m_io, kIoThreads);
+
+    auto probe = [this](std::string name, std::function<int64_t()> read) {
+        Metrics::instance().probe(name, std::move(read));
+        m_probes.push_back(std::move(name));
+    };
+    probe("executor.cpu.queued", [this]() { return static_cast<int64_t>(stats(Pool::Cpu).queued); });
+    probe("executor.cpu.active", [this]() { return static_cast<int64_t>(stats(Pool::Cpu).active); });
+    probe("executor.cpu.steals", [this]() { return static_cast<int64_t>(stats(Pool::Cpu).steals); });
+    probe("executor.io.queued",  [this]() { return static_cast<int64_t>(stats(Pool::Io).queued); });
+    probe("executor.io.active",  [this]() { return static_cast<int64_t>(stats(Pool::Io).active); });
+    // per worker: whether stealing is spread out or one worker keeps raiding the rest
+    for (size_t i = 0; i < m_cpu.workers.size(); ++i) {
+        const Worker* worker = m_cpu.workers[i].get();
+        probe("executor.cpu.worker" + std::to_string(i) + ".steals",
+              [worker]() { return static_cast<int64_t>(worker->steals.load(std::memory_order_relaxed)); });
+    }
+}
+
+Executor::~Executor()
+{
+    // Metrics outlives us (it was constructed inside our constructor)
+    for (const std::string& name : m_probes)
+        Metrics::instance().removeProbe(name);
+
+    m_stopping = true;
+    for (PoolState* pool : { &m_cpu, &m_io }) {
+        {
+            std::lock_guard<std::mutex> lock(pool->sleepMutex);
+        }
+        pool->sleepCv.notify_all();
+        for (auto& worker : pool->workers)
+            if (worker->thread.joinable())
+                worker->thread.join();
+    }
+}
+
+void Executor::start(PoolState& pool, size_t threads)
+{
+    for (size_t i = 0; i < threads; ++i)
+        pool.workers.push_back(std::make_unique<Worker>());
+    // only start threads once every Worker exists, since they steal from each other
+    for (size_t i = 0; i < threads; ++i)
+        pool.workers[i]->thread = std::thread([this, &pool, i]() { workerLoop(pool, i); });
+}
+
+void Executor::InjectionQueue::push(Task task, Priority priority)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    lanes[static_cast<int>(priority)].push_back(std::move(task));
+}
+
+bool Executor::InjectionQueue::pop(Task& out)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& lane : lanes) {
+        if (!lane.empty()) {
+            out = std::move(lane.front());
+            lane.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void Executor::submit(Pool kind, Task task, Priority priority)
+{
+    PoolState& pool = kind == Pool::Cpu ? m_cpu : m_io;
+
+    // counted before it is visible: a worker may pop it (and decrement) before push returns
+    pool.queued.fetch_add(1);
+
+    // a CPU task's Normal children stay on its own deque, where they're likely still in cache
+    if (kind == Pool::Cpu && tl_pool == &pool && priority == Priority::Normal) {
+        Worker& self = *pool.workers[tl_worker];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        self.local.push_back(std::move(task));
+    }
+    else {
+        pool.injected.push(std::move(task), priority);
+    }
+    wakeOne(pool);
+}
+
+void Executor::wakeOne(PoolState& pool)
+{
+    // taking the lock orders this after a sleeper's predicate check, so the wake isn't lost
+    {
+        std::lock_guard<std::mutex> lock(pool.sleepMutex);
+    }
+    pool.sleepCv.notify_one();
+}
+
+bool Executor::findTask(PoolState& pool, size_t index, Task& out)
+{
+    if (pool.kind == Pool::Cpu) {
+        Worker& self = *pool.workers[index];
+        std::lock_guard<std::mutex> lock(self.mutex);
+        if (!self.local.empty()) {
+            out = std::move(self.local.back());
+            self.local.pop_back();
+            return true;
+        }
+    }
+
+    if (pool.injected.pop(out))
+        return true;
+
+    if (pool.kind == Pool::Cpu) {
+        const size_t n = pool.workers.size();
+        for (size_t k = 1; k < n; ++k) {
+            Worker& victim = *pool.workers[(index + k) % n];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.local.empty()) {
+                out = std::move(victim.local.front());
+                victim.local.pop_front();
+                pool.steals.fetch_add(1, std::memory_order_relaxed);
+                pool.workers[index]->steals.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void Executor::workerLoop(PoolState& pool, size_t index)
+{
+    tl_pool   = &pool;
+    tl_worker = index;
+    Tracing::setThreadName((pool.kind == Pool::Cpu ? "cpu-" : "io-") + std::to_string(index));
+
+    while (!m_stopping) {
+        Task task;
+        if (findTask(pool, index, task)) {
+            pool.queued.fetch_sub(1);
+            pool.active.fetch_add(1);
+            try {
+                task();
+            }
+            catch (const std::exception& ex) {
+                qWarning() << "[Executor] task threw:" << ex.what();
+            }
+            catch (...) {
+                qWarning() << "[Executor] task threw a non-std exception";
+            }
+            pool.active.fetch_sub(1);
+            pool.executed.fetch_add(1, std::memory_order_relaxed);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(pool.sleepMutex);
+        pool.sleepCv.wait(lock, [&]() { return m_stopping || pool.queued.load() > 0; });
+    }
+}
+
+bool Executor::onCpuWorker() const
+{
+    return tl_pool == &m_cpu;
+}
+
+Executor::Stats Executor::stats(Pool kind) const
+{
+    const PoolState& pool = kind == Pool::Cpu ? m_cpu : m_io;
+    Stats s;
+    s.threads  = pool.workers.size();
+    s.queued   = pool.queued.load();
+    s.active   = pool.active.load();
+    s.executed = pool.executed.load();
+    s.steals   = pool.steals.load();
+    return s;
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+/**
+ * Executor is the client's one place to run background work, split by what the work
+ * waits on:
+ *
+ *  • Pool::Cpu — crypto, encoding, decoding. One thread per core, work-stealing: a task
+ *    spawned from a CPU worker lands on that worker's own deque (LIFO, cache-warm), idle
+ *    workers steal from the other end of their neighbours' deques.
+ *  • Pool::Io  — anything that blocks on the network. A fixed, small set of threads, so
+ *    a burst of requests queues up instead of spawning threads or parking cores.
+ *
+ * Submissions from outside a pool go through its injection queue, served High before
+ * Normal before Low; bulk jobs run Low so they never hold up interactive work.
+ *
+ * I/O tasks that hit a CPU-heavy stretch hand it over with compute(), which runs it on
+ * the CPU pool and waits; on a CPU worker it just runs inline.
+ *
+ * stats() reports queue depth, running tasks, completions and steals per pool; the same
+ * counts, and the steals of each CPU worker, are published as Metrics probes.
+ */
+class Executor {
+public:
+    enum class Pool { Cpu, Io };
+    enum class Priority { High = 0, Normal = 1, Low = 2 };
+
+    struct Stats {
+        size_t      threads  = 0;
+        size_t      queued   = 0;
+        size_t      active   = 0;
+        uint64_t    executed = 0;
+        uint64_t    steals   = 0;
+    };
+
+    static constexpr size_t kIoThreads = 12;
+
+    static Executor& instance();
+
+    void submit(Pool pool, std::function<void()> task, Priority priority = Priority::Normal);
+
+    // Runs fn on the CPU pool and blocks until it returns (or rethrows). Not for the GUI thread.
+    template <class F>
+    auto compute(F&& fn) -> std::invoke_result_t<F&>
+    {
+        using R = std::invoke_result_t<F&>;
+        if (onCpuWorker())
+            return fn();
+
+        auto task = std::make_shared<std::packaged_task<R()>>(std::forward<F>(fn));
+        std::future<R> result = task->get_future();
+        submit(Pool::Cpu, [task]() { (*task)(); }, Priority::High);
+        return result.get();
+    }
+
+    bool onCpuWorker() const;
+
+    Stats stats(Pool pool) const;
+
+    ~Executor();
+
+private:
+    using Task = std::function<void()>;
+
+    // Three FIFO lanes, one per priority, under one lock
+    struct InjectionQueue {
+        std::mutex          mutex;
+        std::deque<Task>    lanes[3];
+
+        void push(Task task, Priority priority);
+        bool pop(Task& out);
+    };
+
+    struct Worker {
+        std::mutex              mutex;
+        std::deque<Task>        local;  // owner pops the back, thieves take the front
+        std::thread             thread;
+        std::atomic<uint64_t>   steals{0};  // tasks this worker took from the others
+    };
+
+    struct PoolState {
+        Pool                                    kind;
+        InjectionQueue                          injected;
+        std::vector<std::unique_ptr<Worker>>    workers;
+
+        std::mutex                  sleepMutex;
+        std::condition_variable     sleepCv;
+        std::atomic<size_t>         queued{0};
+        std::atomic<size_t>         active{0};
+        std::atomic<uint64_t>       executed{0};
+        std::atomic<uint64_t>       steals{0};
+    };
+
+    Executor();
+    Executor(const Executor&) = delete;
+    Executor& operator=(const Executor&) = delete;
+
+    void start(PoolState& pool, size_t threads);
+    void workerLoop(PoolState& pool, size_t index);
+    bool findTask(PoolState& pool, size_t index, Task& out);
+    void wakeOne(PoolState& pool);
+
+    PoolState                   m_cpu;
+    PoolState                   m_io;
+    std::atomic<bool>           m_stopping{false};
+    std::vector<std::string>    m_probes;   // registered with Metrics, removed on destruction
+};
@@ -1,49 +1,38 @@
 #pragma once
 #include <functional>
 #include <nlohmann/json.hpp>
-#include <QFutureWatcher>
-#include <QtConcurrent>
+#include "executor.h"
 #include "networking/AsioHttpClient.h"
 #include "networking/HttpRequest.h"
 #include "networking/HttpResponse.h"
 
-// A raw function pointer which takes (const HttpResult&, void* userData)
-using HttpResultCallback = void(*)(const HttpResult&, void*);
 /**
  * HandlerUtils
  *
- * 1) runAsync(fn) ⇒ runs fn() in a QtConcurrent worker and auto‐deletes the QFutureWatcher when done.
+ * 1) runAsync(fn) ⇒ runs fn() on the Executor (I/O pool unless told otherwise).
  * 2) postJson(host, port, path, jsonBody) ⇒ serializes jsonBody, builds a POST HttpRequest, calls AsioHttpClient::sendRequest.
  *
  * Chris C++ Requirements:
  * - Inline Functions
- * - Function Pointers: Declaration and Usage, Passing Functions as Arguments
  */
 namespace HandlerUtils {
 
     /**
-         * Runs `task()` off the UI thread, then automatically deletes the watcher when finished.
+         * Runs `task()` off the UI thread on the project Executor. Handler work mostly
+         * waits on the server, so it defaults to the I/O pool; CPU-heavy stretches inside
+         * it go through Executor::compute(). Flows that wait on several requests are
+         * better written as coroutines (coro.h), which hold no thread while waiting.
          *
          * Usage:
          *   runAsync([=] {
          *      // ... do heavy work on background thread ...
          *   });
          */
-    inline void runAsync(const std::function<void()>& task)
+    inline void runAsync(std::function<void()> task,
+                         Executor::Pool pool = Executor::Pool::Io,
+                         Executor::Priority priority = Executor::Priority::Normal)
     {
-        auto future = QtConcurrent::run(task);
-        auto *watcher = new QFutureWatcher<void>();
-        QObject::connect(watcher, &QFutureWatcher<void>::finished,
-                         watcher, &QObject::deleteLater);
-        watcher->setFuture(future);
-    }
-
-    inline void runAsyncStd(const std::function<void()>& task)
-    {
-        std::thread worker([task]() {
-            task();
-        });
-        worker.detach();
+        Executor::instance().submit(pool, std::move(task), priority);
     }
 
     /**
@@ -69,54 +58,5 @@ namespace HandlerUtils {
         return client.sendRequest(host, port, req);
     }
 
-    /**
-     * spawnRequest
-     *
-     * Runs a blocking AsioHttpClient::sendRequest(host, port, request) in a new thread,
-     * then invokes `callback(HttpResult)` once complete.  Detaches the thread so it
-     * does not block the caller.
-     *
-     * @param host       server hostname (e.g. "localhost")
-     * @param port       server port (e.g. 3000)
-     * @param request    an HttpRequest object containing method/path/headers/body
-     * @param callback   a function pointer: void callback(const HttpResult&)
-     */
-    inline void spawnRequest(
-        const std::string& host,
-        int                port,
-        const HttpRequest& request,
-        HttpResultCallback userCallback,
-        void*              userData
-        ) {
-        // We simply start a new std::thread to perform the blocking sendRequest() call.
-        std::thread worker([=]() {
-            AsioHttpClient client;
-            client.init(""); // no TLS in this example
-
-            HttpResponse resp = client.sendRequest(host, port, request);
-            HttpResult    result;
-
-            if (resp.statusCode >= 200 && resp.statusCode < 300) {
-                // Success path: fill in statusCode, headers, body
-                result.errorCode  = {}; // no error
-                result.statusCode = resp.statusCode;
-                result.headers    = std::move(resp.headers);
-                result.body       = std::move(resp.body);
-            } else {
-                // Treat any non-2xx as an “error condition” (you can customize).
-                result.errorCode    = std::make_error_code(std::errc::protocol_error);
-                result.errorMessage = "HTTP error " + std::to_string(resp.statusCode) + ": " + resp.body;
-            }
-
-            // Finally invoke the raw function pointer, passing back the userData.
-            if (userCallback) {
-                userCallback(result, userData);
-            }
-        });
-
-        // Detach so it runs independently; the callback must be prepared to be called on a background thread.
-        worker.detach();
-    }
-
 
 }
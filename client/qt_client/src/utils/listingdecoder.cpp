@@ -0,0 +1,21 @@
+#include "listingdecoder.h"
+#include "crypto/symmetric.h"
+#include "crypto/FileClientData.h"
+
+#include <vector>
+
+ListingDecoder::DecodedMetadata ListingDecoder::decodeMetadata(std::string_view metadataB64,
+                                                               const uint8_t* mek,
+                                                               const uint8_t* iv,
+                                                               std::pmr::memory_resource* arena)
+{
+    std::pmr::vector<uint8_t> cipher(arena);
+    FileClientData::base64_decode_into(metadataB64.data(), metadataB64.size(), cipher);
+
+    std::pmr::vector<uint8_t> plain(cipher.size(), arena);
+    Symmetric::decryptInto(cipher.data(), cipher.size(), mek, iv, plain.data());
+
+    DecodedMetadata out(arena);
+    MetadataRecord::decode(plain.data(), plain.size(), out);
+    return out;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "metadatarecord.h"
+
+#include <cstdint>
+#include <memory_resource>
+#include <string_view>
+
+/**
+ * ListingDecoder turns one listing entry's encrypted "metadata" blob into the fields
+ * the file table shows, with every intermediate drawn from a caller-supplied memory
+ * resource (normally a PageArena that is reset once per page):
+ *
+ *   base64 text → ciphertext bytes → AES-CTR plaintext → MetadataRecord fields
+ *
+ * Binary records are a few bounds-checked loads; legacy JSON records go through a SAX
+ * handler, so no json DOM is built for either. Qt-free, so the listing benchmark can
+ * drive it directly.
+ */
+namespace ListingDecoder {
+
+using DecodedMetadata = MetadataRecord::Fields;
+
+/**
+ * Decodes and decrypts metadataB64 with the 32-byte MEK and 16-byte IV.
+ * Throws std::runtime_error on bad base64, a malformed record or missing filename/filesize.
+ */
+DecodedMetadata decodeMetadata(std::string_view metadataB64,
+                               const uint8_t* mek,
+                               const uint8_t* iv,
+                               std::pmr::memory_resource* arena);
+
+}
@@ -0,0 +1,223 @@
+#include "metadatacache.h"
+#include "crypto/symmetric.h"
+#include "crypto/hash.h"
+#include "crypto/FileClientData.h"
+#include "metrics.h"
+#include "tracing.h"
+
+#include <fstream>
+#include <filesystem>
+#include <nlohmann/json.hpp>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QLockFile>
+
+using json = nlohmann::json;
+
+static constexpr int CACHE_VERSION = 1;
+
+MetadataCache::MetadataCache(const std::string& path, const std::vector<uint8_t>& masterKey)
+    : m_path(path), m_key(masterKey)
+{
+}
+
+MetadataCache::~MetadataCache()
+{
+    save();
+}
+
+void MetadataCache::load()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries.clear();
+    m_blobs.clear();
+    m_cursor = 0;
+    m_dirty = false;
+
+    if (m_key.empty() || !std::filesystem::exists(m_path))
+        return;
+
+    try {
+        std::ifstream in(m_path);
+        json outer = json::parse(in);
+        std::vector<uint8_t> iv   = FileClientData::base64_decode(outer.at("iv").get<std::string>());
+        std::vector<uint8_t> data = FileClientData::base64_decode(outer.at("data").get<std::string>());
+
+        Symmetric::Plaintext pt = Symmetric::decrypt(data, m_key, iv);
+        json j = json::parse(pt.data.begin(), pt.data.end());
+        if (j.at("version").get<int>() != CACHE_VERSION)
+            return;
+
+        m_cursor = j.at("cursor").get<uint64_t>();
+        for (const auto& e : j.at("entries")) {
+            Entry entry;
+            entry.digest                = e.at("digest").get<std::string>();
+            entry.file.file_id          = e.at("file_id").get<uint64_t>();
+            entry.file.filename         = QString::fromStdString(e.at("filename").get<std::string>());
+            entry.file.size_bytes       = e.at("size").get<uint64_t>();
+            entry.file.upload_timestamp = QDateTime::fromString(
+                QString::fromStdString(e.at("modified").get<std::string>()), Qt::ISODateWithMs);
+            entry.file.is_owner         = e.at("is_owner").get<bool>();
+            entry.file.is_shared        = e.at("is_shared").get<bool>();
+            entry.file.shared_from      = QString::fromStdString(e.at("shared_from").get<std::string>());
+            m_entries.emplace(entry.file.file_id, std::move(entry));
+        }
+        if (j.contains("blobs")) {
+            for (const auto& [name, b64] : j["blobs"].items()) {
+                std::vector<uint8_t> bytes = FileClientData::base64_decode(b64.get<std::string>());
+                m_blobs[name] = std::string(bytes.begin(), bytes.end());
+            }
+        }
+        qDebug() << "[MetadataCache] loaded" << m_entries.size() << "entries, cursor" << m_cursor;
+    }
+    catch (const std::exception& ex) {
+        // wrong key, truncated write or old format: rebuild from the server
+        qWarning() << "[MetadataCache] discarding unreadable cache:" << ex.what();
+        m_entries.clear();
+        m_blobs.clear();
+        m_cursor = 0;
+    }
+}
+
+void MetadataCache::save()
+{
+    TRACE_SPAN("store", "metadata_cache_save");
+    // one save at a time, so an older snapshot can't be renamed over a newer one
+    std::lock_guard<std::mutex> saveLock(m_saveMutex);
+    json j;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (!m_dirty || m_key.empty())
+            return;
+
+        j["version"] = CACHE_VERSION;
+        j["cursor"]  = m_cursor;
+        json arr = json::array();
+        for (const auto& [id, entry] : m_entries) {
+            arr.push_back({
+                { "file_id",     id },
+                { "digest",      entry.digest },
+                { "filename",    entry.file.filename.toStdString() },
+                { "size",        entry.file.size_bytes },
+                { "modified",    entry.file.upload_timestamp.toString(Qt::ISODateWithMs).toStdString() },
+                { "is_owner",    entry.file.is_owner },
+                { "is_shared",   entry.file.is_shared },
+                { "shared_from", entry.file.shared_from.toStdString() },
+            });
+        }
+        j["entries"] = std::move(arr);
+
+        json blobs = json::object();
+        for (const auto& [name, bytes] : m_blobs)
+            blobs[name] = FileClientData::base64_encode(
+                reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size());
+        j["blobs"] = std::move(blobs);
+        m_dirty = false;
+    }
+
+    try {
+        std::string plain = j.dump();
+        Symmetric::Ciphertext ct = Symmetric::encrypt(
+            std::vector<uint8_t>(plain.begin(), plain.end()), m_key);
+
+        json outer;
+        outer["iv"]   = FileClientData::base64_encode(ct.iv.data(), ct.iv.size());
+        outer["data"] = FileClientData::base64_encode(ct.data.data(), ct.data.size());
+
+        // the GUI, ssshared and ssshare-cli may all keep this cache; one writer at a time,
+        // each through its own temp file
+        QLockFile diskLock(QString::fromStdString(m_path + ".lock"));
+        if (!diskLock.lock())
+            qWarning() << "[MetadataCache] cannot take" << diskLock.fileName() << ", saving without it";
+
+        // write-then-rename so a crash mid-save never leaves a torn cache behind
+        std::string tmpPath = m_path + "." + std::to_string(QCoreApplication::applicationPid()) + ".tmp";
+        {
+            std::ofstream out(tmpPath, std::ios::trunc);
+            out << outer.dump();
+        }
+        std::filesystem::rename(tmpPath, m_path);
+    }
+    catch (const std::exception& ex) {
+        qWarning() << "[MetadataCache] save failed:" << ex.what();
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_dirty = true;
+    }
+}
+
+std::optional<DecryptedFile> MetadataCache::lookup(uint64_t fileId, const std::string& metaDigest) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_entries.find(fileId);
+    if (it == m_entries.end() || it->second.digest != metaDigest) {
+        METRICS_COUNTER("cache.metadata_misses").add();
+        return std::nullopt;
+    }
+    METRICS_COUNTER("cache.metadata_hits").add();
+    return it->second.file;
+}
+
+void MetadataCache::insert(const DecryptedFile& file, const std::string& metaDigest)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_entries[file.file_id] = Entry{ metaDigest, file };
+    m_dirty = true;
+}
+
+void MetadataCache::remove(uint64_t fileId)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_entries.erase(fileId) > 0)
+        m_dirty = true;
+}
+
+std::vector<DecryptedFile> MetadataCache::entries() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<DecryptedFile> out;
+    out.reserve(m_entries.size());
+    for (const auto& [id, entry] : m_entries)
+        out.push_back(entry.file);
+    return out;
+}
+
+uint64_t MetadataCache::cursor() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_cursor;
+}
+
+void MetadataCache::setCursor(uint64_t cursor)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_cursor != cursor) {
+        m_cursor = cursor;
+        m_dirty = true;
+    }
+}
+
+std::optional<std::string> MetadataCache::blob(const std::string& name) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = m_blobs.find(name);
+    if (it == m_blobs.end())
+        return std::nullopt;
+    return it->second;
+}
+
+void MetadataCache::setBlob(const std::string& name, std::string bytes)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_blobs[name];
+    if (slot != bytes) {
+        slot = std::move(bytes);
+        m_dirty = true;
+    }
+}
+
+std::string MetadataCache::digestOf(const std::string& metadataB64)
+{
+    std::vector<uint8_t> digest = Hash::sha256(
+        reinterpret_cast<const uint8_t*>(metadataB64.data()), metadataB64.size());
+    return FileClientData::base64_encode(digest.data(), digest.size());
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "decryptedfile.h"
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * MetadataCache remembers what each listing entry decrypted to, so a refresh
+ * only pays for base64 / X25519 / AES / JSON on entries whose metadata changed.
+ *
+ *  • Entries are keyed by file_id and tagged with a SHA-256 digest of the metadata
+ *    ciphertext as served; a lookup only hits when both match.
+ *  • The cache also holds the change-feed cursor the cached listing corresponds to,
+ *    plus opaque named blobs derived from the listing (e.g. the search index).
+ *  • On disk it is one AES-256-CTR blob under the user's master key (MEK), next to
+ *    the client store, so filenames never touch the disk in clear.
+ *
+ * Thread-safe; handlers call it from Executor workers. Several processes may share
+ * the file: save() writes under a lock file and whoever saves last wins.
+ */
+class MetadataCache {
+public:
+    MetadataCache(const std::string& path, const std::vector<uint8_t>& masterKey);
+    ~MetadataCache();
+
+    // Loads and decrypts the cache file; a missing or unreadable file just starts empty.
+    void load();
+
+    // Writes the cache back to disk if anything changed since the last load/save.
+    void save();
+
+    std::optional<DecryptedFile> lookup(uint64_t fileId, const std::string& metaDigest) const;
+    void insert(const DecryptedFile& file, const std::string& metaDigest);
+    void remove(uint64_t fileId);
+
+    std::vector<DecryptedFile> entries() const;
+
+    uint64_t cursor() const;
+    void setCursor(uint64_t cursor);
+
+    std::optional<std::string> blob(const std::string& name) const;
+    void setBlob(const std::string& name, std::string bytes);
+
+    // Digest of the base64 metadata ciphertext exactly as the server sent it
+    static std::string digestOf(const std::string& metadataB64);
+
+private:
+    struct Entry {
+        std::string    digest;
+        DecryptedFile  file;
+    };
+
+    std::string                            m_path;
+    std::vector<uint8_t>                   m_key;
+    mutable std::mutex                     m_mutex;
+    std::mutex                             m_saveMutex;     // serialises save()s
+    std::unordered_map<uint64_t, Entry>    m_entries;
+    std::map<std::string, std::string>     m_blobs;
+    uint64_t                               m_cursor = 0;
+    bool                                   m_dirty = false;
+};
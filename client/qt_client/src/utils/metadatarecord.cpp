@@ -0,0 +1,195 @@
+#include "metadatarecord.h"
+
+#include <nlohmann/json.hpp>
+#include <stdexcept>
+
+using json = nlohmann::json;
+
+namespace {
+
+enum Tag : uint64_t {
+    kTagFilename = 1,
+    kTagFilesize = 2,
+};
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+    while (v >= 0x80) {
+        out.push_back(static_cast<uint8_t>(v) | 0x80);
+        v >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+// Advances p; never reads past end and rejects varints wider than 64 bits
+uint64_t getVarint(const uint8_t*& p, const uint8_t* end)
+{
+    uint64_t v = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (p == end)
+            throw std::runtime_error("metadata record truncated");
+        uint8_t b = *p++;
+        if (shift == 63 && b > 1)
+            throw std::runtime_error("metadata varint overflows 64 bits");
+        v |= static_cast<uint64_t>(b & 0x7f) << shift;
+        if (!(b & 0x80))
+            return v;
+    }
+    throw std::runtime_error("metadata varint overflows 64 bits");
+}
+
+void decodeBinary(const uint8_t* p, const uint8_t* end, MetadataRecord::Fields& out)
+{
+    bool hasFilename = false;
+    bool hasSize     = false;
+
+    while (p != end) {
+        uint64_t tag = getVarint(p, end);
+        uint64_t len = getVarint(p, end);
+        if (len > static_cast<uint64_t>(end - p))
+            throw std::runtime_error("metadata field runs past the record");
+        const uint8_t* value = p;
+        p += len;
+
+        switch (tag) {
+        case kTagFilename:
+            out.filename.assign(reinterpret_cast<const char*>(value), len);
+            hasFilename = true;
+            break;
+        case kTagFilesize: {
+            const uint8_t* v = value;
+            out.size_bytes = getVarint(v, p);
+            hasSize = true;
+            break;
+        }
+        default:
+            break;      // a newer writer's field
+        }
+    }
+
+    if (!hasFilename || !hasSize)
+        throw std::runtime_error("metadata is missing filename / filesize");
+}
+
+// Collects filename / filesize / upload_timestamp from the top-level object and ignores
+// everything else, nested values included
+class JsonSax : public json::json_sax_t {
+public:
+    explicit JsonSax(MetadataRecord::Fields& out) : m_out(out) {}
+
+    bool hasFilename = false;
+    bool hasSize     = false;
+
+    bool null() override                                    { return done(); }
+    bool boolean(bool) override                             { return done(); }
+    bool number_integer(number_integer_t v) override
+    {
+        if (atTop() && m_field == Field::Size) {
+            if (v < 0)
+                return false;
+            m_out.size_bytes = static_cast<uint64_t>(v);
+            hasSize = true;
+        }
+        return done();
+    }
+    bool number_unsigned(number_unsigned_t v) override
+    {
+        if (atTop() && m_field == Field::Size) {
+            m_out.size_bytes = v;
+            hasSize = true;
+        }
+        return done();
+    }
+    bool number_float(number_float_t v, const string_t&) override
+    {
+        if (atTop() && m_field == Field::Size) {
+            if (v < 0)
+                return false;
+            m_out.size_bytes = static_cast<uint64_t>(v);
+            hasSize = true;
+        }
+        return done();
+    }
+    bool string(string_t& v) override
+    {
+        if (atTop() && m_field == Field::Filename) {
+            m_out.filename.assign(v.data(), v.size());
+            hasFilename = true;
+        }
+        else if (atTop() && m_field == Field::Timestamp) {
+            m_out.upload_timestamp.assign(v.data(), v.size());
+            m_out.has_timestamp = true;
+        }
+        return done();
+    }
+    bool binary(binary_t&) override                         { return done(); }
+
+    bool start_object(std::size_t) override                 { ++m_depth; m_field = Field::None; return true; }
+    bool end_object() override                              { --m_depth; return done(); }
+    bool start_array(std::size_t) override                  { ++m_depth; m_field = Field::None; return true; }
+    bool end_array() override                               { --m_depth; return done(); }
+
+    bool key(string_t& k) override
+    {
+        m_field = Field::None;
+        if (m_depth == 1) {
+            if (k == "filename")              m_field = Field::Filename;
+            else if (k == "filesize")         m_field = Field::Size;
+            else if (k == "upload_timestamp") m_field = Field::Timestamp;
+        }
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
+    {
+        throw std::runtime_error(std::string("invalid metadata JSON: ") + ex.what());
+    }
+
+private:
+    enum class Field { None, Filename, Size, Timestamp };
+
+    // a value right under a top-level key; the key's field is consumed by it
+    bool atTop() const { return m_depth == 1; }
+    bool done() { if (m_depth <= 1) m_field = Field::None; return true; }
+
+    MetadataRecord::Fields& m_out;
+    int     m_depth = 0;
+    Field   m_field = Field::None;
+};
+
+void decodeJson(const uint8_t* p, const uint8_t* end, MetadataRecord::Fields& out)
+{
+    JsonSax sax(out);
+    if (!json::sax_parse(p, end, &sax))
+        throw std::runtime_error("metadata is not valid JSON");
+    if (!sax.hasFilename || !sax.hasSize)
+        throw std::runtime_error("metadata is missing filename / filesize");
+}
+
+}
+
+std::vector<uint8_t> MetadataRecord::encode(const std::string& filename, uint64_t filesize)
+{
+    std::vector<uint8_t> out;
+    out.reserve(filename.size() + 16);
+    out.push_back(kVersion1);
+
+    putVarint(out, kTagFilename);
+    putVarint(out, filename.size());
+    out.insert(out.end(), filename.begin(), filename.end());
+
+    std::vector<uint8_t> size;
+    putVarint(size, filesize);
+    putVarint(out, kTagFilesize);
+    putVarint(out, size.size());
+    out.insert(out.end(), size.begin(), size.end());
+    return out;
+}
+
+void MetadataRecord::decode(const uint8_t* data, size_t len, Fields& out)
+{
+    if (len > 0 && data[0] == kVersion1)
+        decodeBinary(data + 1, data + len, out);
+    else
+        decodeJson(data, data + len, out);
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <string>
+#include <vector>
+
+/**
+ * MetadataRecord is the plaintext that gets encrypted under a file's MEK.
+ *
+ * Version 1 is a compact binary record:
+ *
+ *   byte 0      0x01, the format version (a JSON record always opens with '{' or space)
+ *   then        fields, each  varint tag | varint length | <length> bytes
+ *                 tag 1  filename   UTF-8
+ *                 tag 2  filesize   varint
+ *
+ * Varints are unsigned LEB128. Readers skip tags they don't know by their length, so
+ * later versions can add fields without breaking older clients.
+ *
+ * Files uploaded before the binary record carry {"filename":…,"filesize":…} JSON;
+ * decode() tells the two apart from the first byte and reads either.
+ */
+namespace MetadataRecord {
+
+constexpr uint8_t kVersion1 = 0x01;
+
+struct Fields {
+    explicit Fields(std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : filename(mr), upload_timestamp(mr) {}
+
+    std::pmr::string    filename;
+    uint64_t            size_bytes = 0;
+    bool                has_timestamp = false;
+    std::pmr::string    upload_timestamp;   // ISO-8601; only ever present in JSON records
+};
+
+// Builds a version 1 record
+std::vector<uint8_t> encode(const std::string& filename, uint64_t filesize);
+
+/**
+ * Reads a binary or JSON record into out, whose strings draw from out's resource.
+ * Throws std::runtime_error on a truncated / malformed record or a missing filename or
+ * filesize.
+ */
+void decode(const uint8_t* data, size_t len, Fields& out);
+
+}
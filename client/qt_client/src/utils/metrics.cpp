@@ -0,0 +1,222 @@
+#include "metrics.h"
+#include <algorithm>
+#include <bit>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+using json = nlohmann::json;
+
+size_t Metrics::Histogram::bucketOf(uint64_t value)
+{
+    constexpr uint64_t limit = (uint64_t(1) << (kMaxExponent + 1)) - 1;
+    if (value > limit)
+        value = limit;
+    if (value < kSubBuckets)
+        return static_cast<size_t>(value);
+    // the leading one selects the octave, the next kSubBucketBits bits the slot within it
+    const int shift = std::bit_width(value) - 1 - kSubBucketBits;
+    const uint64_t sub = (value >> shift) & (kSubBuckets - 1);
+    return static_cast<size_t>((shift + 1) * kSubBuckets + sub);
+}
+
+uint64_t Metrics::Histogram::highestIn(size_t bucket)
+{
+    if (bucket < kSubBuckets)
+        return bucket;
+    const int shift = static_cast<int>(bucket / kSubBuckets) - 1;
+    const uint64_t lowest = (kSubBuckets + bucket % kSubBuckets) << shift;
+    return lowest + (uint64_t(1) << shift) - 1;
+}
+
+void Metrics::Histogram::record(uint64_t value)
+{
+    m_buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    m_count.fetch_add(1, std::memory_order_relaxed);
+    m_sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t seen = m_max.load(std::memory_order_relaxed);
+    while (value > seen && !m_max.compare_exchange_weak(seen, value, std::memory_order_relaxed)) {}
+}
+
+uint64_t Metrics::Histogram::percentile(double p) const
+{
+    // the buckets are summed rather than trusting m_count, which may run ahead of them
+    uint64_t total = 0;
+    for (const auto& b : m_buckets)
+        total += b.load(std::memory_order_relaxed);
+    if (total == 0)
+        return 0;
+
+    const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * total + 0.5));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBuckets; ++i) {
+        seen += m_buckets[i].load(std::memory_order_relaxed);
+        if (seen >= rank)
+            return std::min(highestIn(i), max());
+    }
+    return max();
+}
+
+json Metrics::Histogram::toJson() const
+{
+    const uint64_t n = count();
+    return {
+        { "unit",  m_unit == Unit::Bytes ? "bytes" : "ns" },
+        { "count", n },
+        { "mean",  n ? sum() / n : 0 },
+        { "p50",   percentile(0.50) },
+        { "p90",   percentile(0.90) },
+        { "p99",   percentile(0.99) },
+        { "p999",  percentile(0.999) },
+        { "max",   max() },
+    };
+}
+
+Metrics& Metrics::instance()
+{
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Counter& Metrics::counter(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_counters[name];
+    if (!slot)
+        slot = std::make_unique<Counter>();
+    return *slot;
+}
+
+Metrics::Gauge& Metrics::gauge(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_gauges[name];
+    if (!slot)
+        slot = std::make_unique<Gauge>();
+    return *slot;
+}
+
+Metrics::Histogram& Metrics::histogram(const std::string& name, Histogram::Unit unit)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& slot = m_histograms[name];
+    if (!slot)
+        slot = std::make_unique<Histogram>(unit);
+    return *slot;
+}
+
+void Metrics::probe(const std::string& name, std::function<int64_t()> read)
+{
+    std::lock_guard<std::mutex> lock(m_probeMutex);
+    m_probes[name] = std::move(read);
+}
+
+void Metrics::removeProbe(const std::string& name)
+{
+    std::lock_guard<std::mutex> lock(m_probeMutex);
+    m_probes.erase(name);
+}
+
+json Metrics::snapshot() const
+{
+    json counters = json::object();
+    json gauges = json::object();
+    json histograms = json::object();
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (const auto& [name, c] : m_counters)
+            counters[name] = c->value();
+        for (const auto& [name, g] : m_gauges)
+            gauges[name] = g->value();
+        for (const auto& [name, h] : m_histograms)
+            histograms[name] = h->toJson();
+    }
+    // not under m_mutex: a probe may record metrics of its own
+    {
+        std::lock_guard<std::mutex> lock(m_probeMutex);
+        for (const auto& [name, read] : m_probes)
+            gauges[name] = read();
+    }
+
+    const auto uptime = std::chrono::duration_cast<std::chrono::seconds>(
+        std::chrono::steady_clock::now() - m_start).count();
+    return {
+        { "uptime_s",   uptime },
+        { "counters",   std::move(counters) },
+        { "gauges",     std::move(gauges) },
+        { "histograms", std::move(histograms) },
+    };
+}
+
+bool Metrics::writeJson(const std::string& path, std::string& outError) const
+{
+    const std::string text = snapshot().dump(2);
+
+    // write-then-rename, so whoever tails the file never sees half a snapshot
+    const std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        if (!out) {
+            outError = "cannot create " + tmpPath;
+            return false;
+        }
+        out << text << '\n';
+        out.flush();
+        if (!out) {
+            outError = "write to " + tmpPath + " failed";
+            return false;
+        }
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    if (ec) {
+        outError = "rename to " + path + " failed: " + ec.message();
+        return false;
+    }
+    return true;
+}
+
+std::chrono::seconds Metrics::dumpInterval()
+{
+    const char* env = std::getenv("SSSHARE_METRICS_INTERVAL");
+    if (!env || !*env)
+        return std::chrono::seconds(60);
+    return std::chrono::seconds(std::strtoll(env, nullptr, 10));
+}
+
+Metrics::Dumper::Dumper(std::string path, std::chrono::seconds interval)
+    : m_path(std::move(path)), m_interval(interval)
+{
+    if (m_interval.count() <= 0)
+        return;
+    m_thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        while (!m_wake.wait_for(lock, m_interval, [this]() { return m_stopping; })) {
+            lock.unlock();
+            dump();
+            lock.lock();
+        }
+    });
+}
+
+Metrics::Dumper::~Dumper()
+{
+    if (!m_thread.joinable())
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_all();
+    m_thread.join();
+    dump();
+}
+
+void Metrics::Dumper::dump()
+{
+    std::string err;
+    if (!Metrics::instance().writeJson(m_path, err))
+        std::fprintf(stderr, "[Metrics] %s\n", err.c_str());
+}
@@ -0,0 +1,180 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <nlohmann/json.hpp>
+
+/**
+ * Metrics – always-on counters, gauges and latency histograms for the networking layer,
+ * the crypto primitives and the client store, read by the diagnostics page
+ * (qml/Diagnostics.qml, Ctrl+Shift+D), the daemon's "metrics" request and a periodic
+ * dump next to the client store (Metrics::Dumper).
+ *
+ *   METRICS_COUNTER("net.requests").add();
+ *   METRICS_HISTOGRAM("crypto.aes.encrypt").record(ns);
+ *   Metrics::Timer t(METRICS_HISTOGRAM("store.save"));      // records on scope exit
+ *
+ * Updating a metric is a relaxed atomic add: no locks, nothing a worker waits on. Only
+ * looking a name up takes the registry lock, so the macros do it once per call site and
+ * keep the reference; metrics are never removed, so references stay valid.
+ *
+ * Histograms are log-linear (HDR-style): 32 linear sub-buckets per power of two, so any
+ * recorded value is reported within ~3% across nanoseconds to hours (or bytes to TiB).
+ *
+ * Kept free of Qt so that benchmarks compiling single primitives can link it.
+ */
+class Metrics {
+public:
+    class Counter {
+    public:
+        void add(uint64_t n = 1) { m_value.fetch_add(n, std::memory_order_relaxed); }
+        uint64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<uint64_t> m_value{ 0 };
+    };
+
+    class Gauge {
+    public:
+        void set(int64_t v) { m_value.store(v, std::memory_order_relaxed); }
+        void add(int64_t d) { m_value.fetch_add(d, std::memory_order_relaxed); }
+        int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<int64_t> m_value{ 0 };
+    };
+
+    class Histogram {
+    public:
+        enum class Unit { Nanoseconds, Bytes };
+
+        static constexpr int      kSubBucketBits = 5;
+        static constexpr uint64_t kSubBuckets    = uint64_t(1) << kSubBucketBits;
+        static constexpr int      kMaxExponent   = 44;     // ~4.9 h in ns; larger values clamp
+        static constexpr size_t   kBuckets       = (kMaxExponent - kSubBucketBits + 2) * kSubBuckets;
+
+        explicit Histogram(Unit unit = Unit::Nanoseconds) : m_unit(unit) {}
+
+        void record(uint64_t value);
+
+        Unit unit() const { return m_unit; }
+        uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+        uint64_t sum() const { return m_sum.load(std::memory_order_relaxed); }
+        uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+        /** Highest value equivalent to the p-th quantile (0 < p <= 1); 0 while empty */
+        uint64_t percentile(double p) const;
+
+        nlohmann::json toJson() const;
+
+    private:
+        static size_t bucketOf(uint64_t value);
+        static uint64_t highestIn(size_t bucket);
+
+        Unit                                        m_unit;
+        std::array<std::atomic<uint64_t>, kBuckets> m_buckets{};
+        std::atomic<uint64_t>                       m_count{ 0 };
+        std::atomic<uint64_t>                       m_sum{ 0 };
+        std::atomic<uint64_t>                       m_max{ 0 };
+    };
+
+    /** Records the lifetime of the scope, in ns, into a histogram */
+    class Timer {
+    public:
+        explicit Timer(Histogram& histogram)
+            : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+
+        ~Timer()
+        {
+            m_histogram.record(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - m_start).count());
+        }
+
+        Timer(const Timer&) = delete;
+        Timer& operator=(const Timer&) = delete;
+
+    private:
+        Histogram&                              m_histogram;
+        std::chrono::steady_clock::time_point   m_start;
+    };
+
+    /**
+     * Writes snapshot() to a file every interval on its own thread, and once more when
+     * destroyed. Construct it in main() so it stops before the sources it samples go away.
+     * An interval of zero writes nothing.
+     */
+    class Dumper {
+    public:
+        Dumper(std::string path, std::chrono::seconds interval);
+        ~Dumper();
+
+        Dumper(const Dumper&) = delete;
+        Dumper& operator=(const Dumper&) = delete;
+
+    private:
+        void dump();
+
+        std::string                 m_path;
+        std::chrono::seconds        m_interval;
+        std::mutex                  m_mutex;
+        std::condition_variable     m_wake;
+        bool                        m_stopping = false;
+        std::thread                 m_thread;
+    };
+
+    static Metrics& instance();
+
+    Counter& counter(const std::string& name);
+    Gauge& gauge(const std::string& name);
+    Histogram& histogram(const std::string& name, Histogram::Unit unit = Histogram::Unit::Nanoseconds);
+
+    /**
+     * A gauge read only when a snapshot is taken (queue depths, in-flight requests).
+     * read() is called from whichever thread asks for the snapshot, so it must be
+     * thread-safe and its captures must live until removeProbe(name).
+     */
+    void probe(const std::string& name, std::function<int64_t()> read);
+
+    /** For the probe owner's destructor; waits out a snapshot that is reading it */
+    void removeProbe(const std::string& name);
+
+    /** { uptime_s, counters, gauges, histograms }; values are as of each read */
+    nlohmann::json snapshot() const;
+
+    /** Writes snapshot() with write-then-rename; false with outError set on failure */
+    bool writeJson(const std::string& path, std::string& outError) const;
+
+    /** SSSHARE_METRICS_INTERVAL in seconds (0 turns the dump off); one minute by default */
+    static std::chrono::seconds dumpInterval();
+
+private:
+    Metrics() = default;
+
+    mutable std::mutex                                      m_mutex;    // the registry only
+    std::map<std::string, std::unique_ptr<Counter>>         m_counters;
+    std::map<std::string, std::unique_ptr<Gauge>>           m_gauges;
+    std::map<std::string, std::unique_ptr<Histogram>>       m_histograms;
+    mutable std::mutex                                      m_probeMutex;   // held while probes run
+    std::map<std::string, std::function<int64_t()>>         m_probes;
+    const std::chrono::steady_clock::time_point             m_start = std::chrono::steady_clock::now();
+};
+
+// Registry lookups cached per call site; names must be string literals
+#define METRICS_COUNTER(name) \
+    ([]() -> Metrics::Counter& { static Metrics::Counter& m = Metrics::instance().counter(name); return m; }())
+#define METRICS_GAUGE(name) \
+    ([]() -> Metrics::Gauge& { static Metrics::Gauge& m = Metrics::instance().gauge(name); return m; }())
+#define METRICS_HISTOGRAM(name) \
+    ([]() -> Metrics::Histogram& { static Metrics::Histogram& m = Metrics::instance().histogram(name); return m; }())
+#define METRICS_BYTES_HISTOGRAM(name) \
+    ([]() -> Metrics::Histogram& { \
+        static Metrics::Histogram& m = Metrics::instance().histogram(name, Metrics::Histogram::Unit::Bytes); \
+        return m; }())
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <new>
+
+/**
+ * MpscRing is a bounded, lock-free, multi-producer / single-consumer queue
+ * (Vyukov's sequence-numbered ring).
+ *
+ *  • Each cell carries a sequence number that says whose turn it is: producers claim a
+ *    slot with one CAS on the tail, fill it, then publish it by bumping the sequence.
+ *  • The single consumer owns the head outright, so popping is two atomic loads and a
+ *    store, no CAS.
+ *  • tryPush() fails instead of blocking when the ring is full, and leaves the value
+ *    untouched so the caller can retry or fall back.
+ *
+ * Capacity is rounded up to a power of two. T must be default-constructible and movable.
+ */
+template <class T>
+class MpscRing {
+public:
+    explicit MpscRing(size_t capacity)
+    {
+        size_t cap = 2;
+        while (cap < capacity)
+            cap <<= 1;
+        m_mask  = cap - 1;
+        m_cells = std::make_unique<Cell[]>(cap);
+        for (size_t i = 0; i < cap; ++i)
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    // Any thread. Moves from value only on success.
+    bool tryPush(T& value)
+    {
+        size_t pos = m_tail.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            size_t seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(pos);
+            if (diff == 0) {
+                if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    break;
+            }
+            else if (diff < 0) {
+                return false;       // full: the consumer hasn't freed this cell yet
+            }
+            else {
+                pos = m_tail.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T& out)
+    {
+        Cell* cell = &m_cells[m_head & m_mask];
+        size_t seq = cell->seq.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(seq) - static_cast<std::ptrdiff_t>(m_head + 1) < 0)
+            return false;           // empty, or the next producer hasn't published yet
+
+        out = std::move(cell->value);
+        cell->value = T();
+        cell->seq.store(m_head + m_mask + 1, std::memory_order_release);
+        ++m_head;
+        return true;
+    }
+
+    // Consumer thread only; a push that is mid-publish still counts as empty
+    bool empty() const
+    {
+        const Cell& cell = m_cells[m_head & m_mask];
+        return cell.seq.load(std::memory_order_acquire) != m_head + 1;
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+private:
+    static constexpr size_t kLine = 64;
+
+    struct Cell {
+        std::atomic<size_t> seq{0};
+        T                   value{};
+    };
+
+    std::unique_ptr<Cell[]>         m_cells;
+    size_t                          m_mask = 0;
+    alignas(kLine) std::atomic<size_t> m_tail{0};
+    alignas(kLine) size_t           m_head = 0;
+};
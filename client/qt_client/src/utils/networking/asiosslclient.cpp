@@ -1,14 +1,19 @@
 #include "AsioSslClient.h"
 #include <boost/asio/connect.hpp>
 #include <boost/asio/read_until.hpp>
+#include <boost/asio/steady_timer.hpp>
 #include <boost/asio/streambuf.hpp>
 #include <boost/asio/write.hpp>
 #include <openssl/ssl.h>
+#include <algorithm>
+#include <chrono>
 #include <filesystem>
+#include <iterator>
 #include <sstream>
 #include <QDebug>
 #include <boost/asio/ssl/host_name_verification.hpp>
 #include "../../config.h"
+#include "../tracing.h"
 
 std::shared_ptr<boost::asio::ssl::context> AsioSslClient::s_ctx_{};
 std::vector<boost::asio::ip::tcp::endpoint> AsioSslClient::s_cached_eps_{};
@@ -20,12 +25,18 @@ AsioSslClient::AsioSslClient()
     : io_(std::make_shared<boost::asio::io_context>()),
     resolver_(std::make_shared<boost::asio::ip::tcp::resolver>(*io_))
 {
-    if (!s_ctx_) {
+    sslCtx_ = sharedContext();
+}
+
+std::shared_ptr<boost::asio::ssl::context> AsioSslClient::sharedContext()
+{
+    static std::once_flag once;
+    std::call_once(once, []() {
         s_ctx_ = std::make_shared<boost::asio::ssl::context>(
             boost::asio::ssl::context::tls_client);
         s_ctx_->set_verify_mode(boost::asio::ssl::verify_peer);
-    }
-    sslCtx_ = s_ctx_;
+    });
+    return s_ctx_;
 }
 
 
@@ -73,13 +84,9 @@ HttpResponse AsioSslClient::sendRequest(const std::string& host,
     return sendRequest(request, timeoutSeconds);
 }
 
-HttpResponse AsioSslClient::sendRequest(const HttpRequest& request,
-                                        int timeoutSeconds)
+bool AsioSslClient::openStream(const std::string& host, int port, std::string& outError)
 {
-    const auto& cfg = Config::instance();
-     std::string host = cfg.serverHost;
-    int port =  cfg.serverPort;
-
+    TRACE_SPAN("net", "connect");
     boost::system::error_code ec;
 
     // DNS
@@ -88,39 +95,86 @@ HttpResponse AsioSslClient::sendRequest(const HttpRequest& request,
         std::scoped_lock lk(s_eps_mtx_);
         if (s_cached_eps_.empty()) {
             auto results = resolver_->resolve(host, std::to_string(port), ec);
-            if (ec) return makeError("DNS failed: " + ec.message());
+            if (ec) { outError = "DNS failed: " + ec.message(); return false; }
 
-                            s_cached_eps_.clear();
-                    for (const auto& entry : results)
-                               s_cached_eps_.push_back(entry.endpoint());
-            }
+            s_cached_eps_.clear();
+            for (const auto& entry : results)
+                s_cached_eps_.push_back(entry.endpoint());
+        }
         eps = s_cached_eps_;
     }
 
     // TLS
-    stream_.reset(new boost::asio::ssl::stream<
-                  boost::asio::ip::tcp::socket>(*io_, *sslCtx_));
+    {
+        std::scoped_lock lk(cancelMtx_);
+        if (cancelled_) { outError = "cancelled"; return false; }
+        stream_.reset(new boost::asio::ssl::stream<
+                      boost::asio::ip::tcp::socket>(*io_, *sslCtx_));
+    }
 
-    if (!SSL_set_tlsext_host_name(stream_->native_handle(), host.c_str()))
-        return makeError("SNI set failed");
+    if (!SSL_set_tlsext_host_name(stream_->native_handle(), host.c_str())) {
+        outError = "SNI set failed";
+        return false;
+    }
 
     // TCP connect
     boost::asio::connect(stream_->next_layer(), eps, ec);
     if (ec) {
         std::scoped_lock lk(s_eps_mtx_);
         s_cached_eps_.clear();
-        return makeError("connect: " + ec.message());
+        outError = "connect: " + ec.message();
+        return false;
     }
 
     // Handshake
     stream_->set_verify_callback(boost::asio::ssl::host_name_verification(host));    // ⭐ hostname ✔
     stream_->handshake(boost::asio::ssl::stream_base::client, ec);
-    if (ec) return makeError("TLS handshake: " + ec.message());
+    if (ec) { outError = "TLS handshake: " + ec.message(); return false; }
+
+    std::scoped_lock lk(cancelMtx_);
+    if (cancelled_) { outError = "cancelled"; return false; }
+    return true;
+}
+
+HttpResponse AsioSslClient::sendRequest(const HttpRequest& request,
+                                        int timeoutSeconds)
+{
+    const auto started = TraceRecorder::Clock::now();
+    HttpResponse resp = exchange(request, timeoutSeconds);
+    countExchange(request.path(), resp.statusCode, request.body().size(), resp.body.size(), started);
+
+    auto trace = NetworkClient::traceRecorder();
+    if (!trace)
+        return resp;
+    trace->record(started, static_cast<uint8_t>(request.method()), TraceRecorder::Transport::Sync,
+                  request.path(), resp.statusCode, request.body().size(), resp.body.size(),
+                  request.body());
+    return resp;
+}
+
+HttpResponse AsioSslClient::exchange(const HttpRequest& request,
+                                     int timeoutSeconds)
+{
+    TRACE_SPAN("net", Tracing::enabled() ? Tracing::intern(request.path()) : "request");
+    const auto& cfg = Config::instance();
+     std::string host = cfg.serverHost;
+    int port =  cfg.serverPort;
+
+    boost::system::error_code ec;
+
+    std::string openError;
+    if (!openStream(host, port, openError))
+        return makeError(openError);
 
     std::string rawReq = request.toString();
-    boost::asio::write(*stream_, boost::asio::buffer(rawReq), ec);
+    {
+        TRACE_SPAN_ARG("net", "send", "bytes", rawReq.size());
+        boost::asio::write(*stream_, boost::asio::buffer(rawReq), ec);
+    }
     if (ec) return makeError("write: " + ec.message());
 
+    // waiting for the server and reading its reply
+    TRACE_SPAN("net", "receive");
     boost::asio::streambuf buf;
     boost::asio::read_until(*stream_, buf, "\r\n\r\n", ec);
     if (ec && ec != boost::asio::error::eof)
@@ -156,7 +210,9 @@ HttpResponse AsioSslClient::sendRequest(const HttpRequest& request,
     if (chunked) {
         while (true) {
             std::string sz; std::getline(respStream,sz); if (!sz.empty()&&sz.back()=='\r') sz.pop_back();
-            std::size_t n = std::stoul(sz,nullptr,16); if (!n) { respStream.ignore(2); break; }
+            std::size_t n = 0;
+            if (!HttpResponse::parseChunkSize(sz, n)) return makeError("malformed chunk size");
+            if (!n) { respStream.ignore(2); break; }
             std::vector<char> tmp(n); respStream.read(tmp.data(),n); body.append(tmp.data(),n); respStream.ignore(2);
         }
     } else {
@@ -179,3 +235,145 @@ HttpResponse AsioSslClient::sendRequest(const HttpRequest& request,
 
     return HttpResponse::fromRaw(raw.str());
 }
+
+namespace {
+
+using SslStream = boost::asio::ssl::stream<boost::asio::ip::tcp::socket>;
+
+// Runs the one async read that start(handler) queues on `io` to completion, closing the socket
+// if it takes longer than idleSeconds. Asio's blocking reads retry EAGAIN without a limit, so
+// SO_RCVTIMEO can't bound them; a timer can.
+template <class Start>
+boost::system::error_code readWithin(boost::asio::io_context& io, SslStream& stream,
+                                     int idleSeconds, std::size_t& bytes, Start start)
+{
+    boost::system::error_code result;
+    bool timedOut = false;
+    boost::asio::steady_timer timer(io, std::chrono::seconds(idleSeconds));
+
+    start([&](const boost::system::error_code& ec, std::size_t n) {
+        result = ec;
+        bytes = n;
+        timer.cancel();
+    });
+    timer.async_wait([&](const boost::system::error_code& ec) {
+        if (ec)
+            return;                 // the read won
+        timedOut = true;
+        boost::system::error_code ignored;
+        stream.next_layer().close(ignored);
+    });
+
+    io.restart();
+    io.run();
+    return timedOut ? boost::system::error_code(boost::asio::error::timed_out) : result;
+}
+
+} // namespace
+
+int AsioSslClient::streamRequest(const HttpRequest& request,
+                                 const std::function<bool(const std::string&)>& onChunk,
+                                 std::string& outError,
+                                 int idleSeconds)
+{
+    const auto& cfg = Config::instance();
+    if (!openStream(cfg.serverHost, cfg.serverPort, outError))
+        return 0;
+
+    boost::system::error_code ec;
+    std::string rawReq = request.toString();
+    boost::asio::write(*stream_, boost::asio::buffer(rawReq), ec);
+    if (ec) { outError = "write: " + ec.message(); return 0; }
+
+    // every read gets idleSeconds (the server pings every few seconds), so a half-open
+    // connection ends the stream instead of hanging the subscriber thread
+    boost::asio::streambuf buf;
+    std::size_t got = 0;
+    ec = readWithin(*io_, *stream_, idleSeconds, got, [&](auto handler) {
+        boost::asio::async_read_until(*stream_, buf, "\r\n\r\n", handler);
+    });
+    if (ec) { outError = "read_until: " + ec.message(); return 0; }
+
+    std::istream respStream(&buf);
+    std::string statusLine; std::getline(respStream, statusLine);
+    int status = 0; { std::istringstream ss(statusLine); std::string tmp; ss >> tmp >> status; }
+
+    bool chunked = false;
+    std::string line;
+    while (std::getline(respStream, line) && line != "\r") {
+        std::transform(line.begin(), line.end(), line.begin(), ::tolower);
+        if (line.rfind("transfer-encoding:", 0) == 0 && line.find("chunked") != std::string::npos)
+            chunked = true;
+    }
+
+    // whatever read_until pulled past the headers is the start of the body
+    std::string pending(std::istreambuf_iterator<char>(respStream), {});
+    std::string payload;
+    bool malformed = false;
+
+    // decode as much of `pending` as is complete; false once the final chunk is seen
+    // or the framing is broken (`malformed`)
+    auto drain = [&]() -> bool {
+        if (!chunked) {
+            payload.swap(pending);
+            pending.clear();
+            return true;
+        }
+        while (true) {
+            auto eol = pending.find("\r\n");
+            if (eol == std::string::npos)
+                return true;
+            std::size_t n = 0;
+            if (!HttpResponse::parseChunkSize(pending.substr(0, eol), n)) {
+                malformed = true;
+                return false;
+            }
+            if (n == 0)
+                return false;
+            if (pending.size() < eol + 2 + n + 2)
+                return true;
+            payload.append(pending, eol + 2, n);
+            pending.erase(0, eol + 2 + n + 2);
+        }
+    };
+
+    qDebug() << "[HTTPS] stream" << QString::fromStdString(request.path()) << status;
+
+    while (true) {
+        bool more = drain();
+        if (!payload.empty()) {
+            if (!onChunk(payload))
+                break;
+            payload.clear();
+        }
+        if (malformed) {
+            outError = "malformed chunk size";
+            break;
+        }
+        if (!more)
+            break;
+
+        char tmp[4096];
+        ec = readWithin(*io_, *stream_, idleSeconds, got, [&](auto handler) {
+            stream_->async_read_some(boost::asio::buffer(tmp), handler);
+        });
+        if (ec) {
+            if (ec != boost::asio::error::eof && ec != boost::asio::ssl::error::stream_truncated)
+                outError = "read: " + ec.message();
+            break;
+        }
+        pending.append(tmp, got);
+    }
+    return status;
+}
+
+void AsioSslClient::cancel()
+{
+    std::scoped_lock lk(cancelMtx_);
+    cancelled_ = true;
+    if (stream_ && stream_->next_layer().is_open()) {
+        // shutdown (not close) is safe against a read blocked on another thread
+        boost::system::error_code ec;
+        stream_->next_layer().shutdown(boost::asio::ip::tcp::socket::shutdown_both, ec);
+    }
+}
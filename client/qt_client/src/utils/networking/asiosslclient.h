@@ -4,7 +4,9 @@
 #include "HttpResponse.h"
 #include <boost/asio.hpp>
 #include <boost/asio/ssl.hpp>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
 
 class AsioSslClient : public NetworkClient {
@@ -24,7 +26,29 @@ public:
                              const HttpRequest& request,
                              int timeoutSeconds = DEFAULT_TIMEOUT) override;
 
+    /**
+     * Streaming HTTPS request for long-lived responses (server-sent events).
+     * Sends `request`, then hands each decoded body chunk to onChunk as it arrives,
+     * until the server closes, onChunk returns false, nothing (not even a heartbeat)
+     * arrives for idleSeconds, or cancel() is called.
+     *
+     * Returns the HTTP status, or 0 if the connection failed before one was read.
+     */
+    int streamRequest(const HttpRequest& request,
+                      const std::function<bool(const std::string&)>& onChunk,
+                      std::string& outError,
+                      int idleSeconds = 20);
+
+    /**  Thread-safe: unblocks a streamRequest() running on another thread. */
+    void cancel();
+
+    /**  The process-wide TLS client context (CA bundle, verify mode); AsyncSslClient uses it too. */
+    static std::shared_ptr<boost::asio::ssl::context> sharedContext();
+
 private:
+    /**  DNS (cached) + TCP connect + TLS handshake into stream_; false with outError set on failure. */
+    bool openStream(const std::string& host, int port, std::string& outError);
+
     std::shared_ptr<boost::asio::io_context> io_;
     std::shared_ptr<boost::asio::ssl::context> sslCtx_;
     std::shared_ptr<boost::asio::ip::tcp::resolver> resolver_;
@@ -35,6 +59,12 @@ private:
     static std::vector<boost::asio::ip::tcp::endpoint> s_cached_eps_;
     static std::mutex s_eps_mtx_;
 
+    std::mutex cancelMtx_;      // guards stream_ against cancel() from another thread
+    bool       cancelled_ = false;
+
+    /**  The request/response itself; sendRequest() adds tracing around it. */
+    HttpResponse exchange(const HttpRequest& request, int timeoutSeconds);
+
     /** tiny helper that prints & returns a 500 HttpResponse in one line */
     static HttpResponse makeError(const std::string& why);
 };
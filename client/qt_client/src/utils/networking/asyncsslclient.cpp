@@ -0,0 +1,300 @@
+#include "asyncsslclient.h"
+#include "asiosslclient.h"
+#include "tracerecorder.h"
+#include "../metrics.h"
+#include "../tracing.h"
+#include <boost/asio/ssl/host_name_verification.hpp>
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <cstdlib>
+#include <istream>
+#include <sstream>
+#include <QDebug>
+#include "../../config.h"
+
+namespace asio = boost::asio;
+using tcp = asio::ip::tcp;
+
+// One request/response; kept alive by the handlers of whatever operation is pending on it
+struct AsyncSslClient::Exchange {
+    Exchange(asio::io_context& io, asio::ssl::context& ctx)
+        : stream(io, ctx), timer(io) {}
+
+    asio::ssl::stream<tcp::socket>  stream;
+    asio::steady_timer              timer;
+    std::string                     host;
+    std::string                     rawRequest;
+    std::string                     path;
+    Completion                      done;
+    bool                            finished = false;
+    TraceRecorder::Clock::time_point started;
+
+    // set only while tracing (NetworkClient::traceRecorder())
+    std::shared_ptr<TraceRecorder>  trace;
+    uint8_t                         method = 0;
+    uint64_t                        requestBytes = 0;
+    std::string                     requestBody;    // only if the trace keeps bodies
+
+    // set only while spans are recorded (tracing.h): one async track per request
+    uint64_t                        spanId = 0;
+    const char*                     spanName = nullptr;
+    const char*                     stage = nullptr;
+
+    asio::streambuf                     buf;
+    int                                 status = 0;
+    std::map<std::string, std::string>  headers;
+    bool                                chunked = false;
+    bool                                hasLength = false;
+    size_t                              length = 0;
+    std::string                         pending;    // undecoded chunked bytes
+    std::string                         body;
+    bool                                malformed = false;  // a chunk size line was not hex
+
+    // Moves complete chunks from `pending` into `body`; true once the last chunk is in, or
+    // once a malformed size line makes the rest unreadable (then `malformed` is set)
+    bool drainChunks()
+    {
+        while (true) {
+            auto eol = pending.find("\r\n");
+            if (eol == std::string::npos)
+                return false;
+            size_t n = 0;
+            if (!HttpResponse::parseChunkSize(pending.substr(0, eol), n)) {
+                malformed = true;
+                return true;
+            }
+            if (n == 0)
+                return true;
+            if (pending.size() < eol + 2 + n + 2)
+                return false;
+            body.append(pending, eol + 2, n);
+            pending.erase(0, eol + 2 + n + 2);
+        }
+    }
+
+    bool complete()
+    {
+        if (chunked)
+            return drainChunks();
+        return hasLength && body.size() >= length;
+    }
+
+    // Closes the running stage span and opens `next` (nullptr: none)
+    void enter(const char* next)
+    {
+        if (!spanId)
+            return;
+        const uint64_t now = Tracing::now();
+        if (stage)
+            Tracing::asyncEnd("net", stage, spanId, now);
+        stage = next;
+        if (stage)
+            Tracing::asyncBegin("net", stage, spanId, now);
+    }
+};
+
+AsyncSslClient& AsyncSslClient::instance()
+{
+    static AsyncSslClient client;
+    return client;
+}
+
+AsyncSslClient::AsyncSslClient()
+    : m_work(asio::make_work_guard(m_io)),
+    m_resolver(m_io)
+{
+    m_thread = std::thread([this]() {
+        Tracing::setThreadName("network");
+        m_io.run();
+    });
+    Metrics::instance().probe("net.in_flight", [this]() { return static_cast<int64_t>(inFlight()); });
+}
+
+AsyncSslClient::~AsyncSslClient()
+{
+    Metrics::instance().removeProbe("net.in_flight");
+    m_work.reset();
+    m_io.stop();
+    if (m_thread.joinable())
+        m_thread.join();
+}
+
+void AsyncSslClient::send(const HttpRequest& request, Completion done, int timeoutSeconds)
+{
+    const auto& cfg = Config::instance();
+    auto ex = std::make_shared<Exchange>(m_io, *AsioSslClient::sharedContext());
+    ex->host       = cfg.serverHost;
+    ex->rawRequest = request.toString();
+    ex->path       = request.path();
+    ex->done       = std::move(done);
+    ex->started    = TraceRecorder::Clock::now();
+    if ((ex->trace = NetworkClient::traceRecorder())) {
+        ex->method       = static_cast<uint8_t>(request.method());
+        ex->requestBytes = request.body().size();
+        if (ex->trace->bodies() != TraceRecorder::Bodies::None)
+            ex->requestBody = request.body();
+    }
+    if (Tracing::enabled()) {
+        ex->spanId   = Tracing::newAsyncId();
+        ex->spanName = Tracing::intern(ex->path);
+        Tracing::asyncBegin("net", ex->spanName, ex->spanId, Tracing::now());
+        ex->enter("queue");
+    }
+    ++m_inFlight;
+
+    // everything from here on happens on the network thread
+    asio::post(m_io, [this, ex, timeoutSeconds, port = cfg.serverPort]() {
+        ex->timer.expires_after(std::chrono::seconds(timeoutSeconds));
+        ex->timer.async_wait([this, ex](const boost::system::error_code& ec) {
+            if (!ec)
+                finish(ex, HttpResponse(500, {}, "timeout"));
+        });
+
+        if (!m_endpoints.empty()) {
+            connect(ex);
+            return;
+        }
+        ex->enter("resolve");
+        m_resolver.async_resolve(ex->host, std::to_string(port),
+            [this, ex](const boost::system::error_code& ec, tcp::resolver::results_type results) {
+                if (ec)
+                    return finish(ex, HttpResponse(500, {}, "DNS failed: " + ec.message()));
+                m_endpoints.clear();
+                for (const auto& entry : results)
+                    m_endpoints.push_back(entry.endpoint());
+                connect(ex);
+            });
+    });
+}
+
+void AsyncSslClient::connect(const std::shared_ptr<Exchange>& ex)
+{
+    if (ex->finished)
+        return;
+    if (!SSL_set_tlsext_host_name(ex->stream.native_handle(), ex->host.c_str()))
+        return finish(ex, HttpResponse(500, {}, "SNI set failed"));
+
+    ex->enter("connect");
+    asio::async_connect(ex->stream.next_layer(), m_endpoints,
+        [this, ex](const boost::system::error_code& ec, const tcp::endpoint&) {
+            if (ec) {
+                // the cached address may be stale; resolve again next time
+                m_endpoints.clear();
+                return finish(ex, HttpResponse(500, {}, "connect: " + ec.message()));
+            }
+            handshake(ex);
+        });
+}
+
+void AsyncSslClient::handshake(const std::shared_ptr<Exchange>& ex)
+{
+    ex->enter("handshake");
+    ex->stream.set_verify_callback(asio::ssl::host_name_verification(ex->host));
+    ex->stream.async_handshake(asio::ssl::stream_base::client,
+        [this, ex](const boost::system::error_code& ec) {
+            if (ec)
+                return finish(ex, HttpResponse(500, {}, "TLS handshake: " + ec.message()));
+            ex->enter("send");
+            asio::async_write(ex->stream, asio::buffer(ex->rawRequest),
+                [this, ex](const boost::system::error_code& ec, size_t) {
+                    if (ec)
+                        return finish(ex, HttpResponse(500, {}, "write: " + ec.message()));
+                    readHeaders(ex);
+                });
+        });
+}
+
+void AsyncSslClient::readHeaders(const std::shared_ptr<Exchange>& ex)
+{
+    // until the first response bytes: the server's time plus one round trip
+    ex->enter("wait");
+    asio::async_read_until(ex->stream, ex->buf, "\r\n\r\n",
+        [this, ex](const boost::system::error_code& ec, size_t) {
+            if (ec)
+                return finish(ex, HttpResponse(500, {}, "read_until: " + ec.message()));
+
+            std::istream in(&ex->buf);
+            std::string statusLine;
+            std::getline(in, statusLine);
+            { std::istringstream ss(statusLine); std::string tmp; ss >> tmp >> ex->status; }
+
+            std::string line;
+            while (std::getline(in, line) && line != "\r") {
+                auto pos = line.find(':');
+                if (pos == std::string::npos)
+                    continue;
+                std::string k = line.substr(0, pos);
+                std::string v = line.substr(std::min(pos + 2, line.size()));    // skip ": "
+                if (!v.empty() && v.back() == '\r')
+                    v.pop_back();
+
+                std::string lower = k;
+                std::transform(lower.begin(), lower.end(), lower.begin(), ::tolower);
+                if (lower == "content-length") {
+                    ex->hasLength = true;
+                    ex->length = std::strtoull(v.c_str(), nullptr, 10);
+                } else if (lower == "transfer-encoding") {
+                    std::transform(v.begin(), v.end(), v.begin(), ::tolower);
+                    ex->chunked = v.find("chunked") != std::string::npos;
+                }
+                ex->headers[k] = v;
+            }
+            ex->enter("receive");
+            readBody(ex);
+        });
+}
+
+void AsyncSslClient::readBody(const std::shared_ptr<Exchange>& ex)
+{
+    // whatever is buffered past the headers is body
+    if (ex->buf.size() > 0) {
+        std::string more(asio::buffers_begin(ex->buf.data()), asio::buffers_end(ex->buf.data()));
+        ex->buf.consume(ex->buf.size());
+        (ex->chunked ? ex->pending : ex->body).append(more);
+    }
+    if (ex->complete()) {
+        if (ex->malformed)
+            return finish(ex, HttpResponse(500, {}, "malformed chunk size"));
+        return finish(ex, HttpResponse(ex->status, ex->headers, ex->body));
+    }
+
+    asio::async_read(ex->stream, ex->buf, asio::transfer_at_least(1),
+        [this, ex](const boost::system::error_code& ec, size_t) {
+            if (ec) {
+                // no length and no chunking: the body runs to the end of the connection
+                const bool closed = ec == asio::error::eof || ec == asio::ssl::error::stream_truncated;
+                if (closed && !ex->chunked && !ex->hasLength)
+                    return finish(ex, HttpResponse(ex->status, ex->headers, ex->body));
+                return finish(ex, HttpResponse(500, {}, "read: " + ec.message()));
+            }
+            readBody(ex);
+        });
+}
+
+void AsyncSslClient::finish(const std::shared_ptr<Exchange>& ex, HttpResponse resp)
+{
+    if (ex->finished)
+        return;
+    ex->finished = true;
+    ex->timer.cancel();
+
+    // no TLS close_notify: the connection is not reused, and the peer does not wait for one
+    boost::system::error_code ignored;
+    ex->stream.lowest_layer().close(ignored);
+    --m_inFlight;
+
+    qDebug() << "[HTTPS]" << QString::fromStdString(ex->path)
+             << resp.statusCode << "(" << ex->rawRequest.size() << "→" << resp.body.size() << ")";
+    if (ex->spanId) {
+        ex->enter(nullptr);
+        Tracing::asyncEnd("net", ex->spanName, ex->spanId, Tracing::now());
+    }
+    NetworkClient::countExchange(ex->path, resp.statusCode, ex->rawRequest.size(), resp.body.size(), ex->started);
+    if (ex->trace) {
+        ex->trace->record(ex->started, ex->method, TraceRecorder::Transport::Async, ex->path,
+                          resp.statusCode, ex->requestBytes, resp.body.size(), ex->requestBody);
+    }
+
+    Completion done = std::move(ex->done);
+    done(std::move(resp));
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include "HttpRequest.h"
+#include "HttpResponse.h"
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * AsyncSslClient sends HTTPS requests without tying up a thread per request.
+ *
+ * One io_context on one network thread drives every connection (resolve, connect,
+ * handshake, write, read), so a request in flight costs a socket and a small state
+ * object, not a parked worker. Each request uses its own connection, like AsioSslClient.
+ *
+ * `done` runs on the network thread exactly once: with the response, or with a 500
+ * carrying the reason (connect/TLS/read failure, timeout). Keep it short and hand real
+ * work to the Executor — Coro::request() does exactly that.
+ *
+ * TLS settings come from AsioSslClient::sharedContext(), so the CA bundle loaded by
+ * AsioSslClient::init() applies here too.
+ */
+class AsyncSslClient {
+public:
+    using Completion = std::function<void(HttpResponse)>;
+
+    static constexpr int kDefaultTimeoutSeconds = 30;
+
+    static AsyncSslClient& instance();
+
+    void send(const HttpRequest& request, Completion done,
+              int timeoutSeconds = kDefaultTimeoutSeconds);
+
+    size_t inFlight() const { return m_inFlight.load(); }
+
+    ~AsyncSslClient();
+
+private:
+    struct Exchange;
+
+    AsyncSslClient();
+    AsyncSslClient(const AsyncSslClient&) = delete;
+    AsyncSslClient& operator=(const AsyncSslClient&) = delete;
+
+    // resolve → connect → handshake + write → headers → body, each step chaining the next
+    void connect(const std::shared_ptr<Exchange>& ex);
+    void handshake(const std::shared_ptr<Exchange>& ex);
+    void readHeaders(const std::shared_ptr<Exchange>& ex);
+    void readBody(const std::shared_ptr<Exchange>& ex);
+    void finish(const std::shared_ptr<Exchange>& ex, HttpResponse resp);
+
+    boost::asio::io_context                                             m_io;
+    boost::asio::executor_work_guard<boost::asio::io_context::executor_type> m_work;
+    boost::asio::ip::tcp::resolver                                      m_resolver;
+    // only touched on the network thread
+    std::vector<boost::asio::ip::tcp::endpoint>                         m_endpoints;
+    std::atomic<size_t>                                                 m_inFlight{0};
+    std::thread                                                         m_thread;
+};
@@ -22,6 +22,10 @@ const std::map<std::string, std::string>& HttpRequest::headers() const {
     return headers_;
 }
 
+std::string HttpRequest::takeBody() {
+    return std::move(body_);
+}
+
 void HttpRequest::addHeader(const std::string& name, const std::string& value) {
     this->headers_[name] = value;
 }
@@ -18,6 +18,9 @@ public:
     const std::string& body() const;
     const std::map<std::string, std::string>& headers() const;
 
+    // Moves the body out, leaving it empty (for in-process transports, which need no copy)
+    std::string takeBody();
+
     // Add or overwrite a header
     void addHeader(const std::string& name, const std::string& value);
 
@@ -1,5 +1,6 @@
 #include "HttpResponse.h"
 #include <cstring>
+#include <algorithm>
 #include <cctype>
 
 HttpResponse::HttpResponse() : statusCode(0)
@@ -66,3 +67,22 @@ HttpResponse HttpResponse::fromRaw(const std::string& raw) {
     delete[] buffer;  // free heap allocation
     return HttpResponse(code, hdrs, bodyStr);
 }
+
+bool HttpResponse::parseChunkSize(const std::string& line, std::size_t& out)
+{
+    const std::size_t digits = std::min(line.find(';'), line.size());
+    // 15 hex digits already exceed any body we would accept; more could overflow
+    if (digits == 0 || digits > 15)
+        return false;
+    std::size_t n = 0;
+    for (std::size_t i = 0; i < digits; ++i) {
+        const char c = line[i];
+        if (!std::isxdigit(static_cast<unsigned char>(c)))
+            return false;
+        n = n * 16 + static_cast<std::size_t>(std::isdigit(static_cast<unsigned char>(c))
+                                                  ? c - '0'
+                                                  : std::tolower(static_cast<unsigned char>(c)) - 'a' + 10);
+    }
+    out = n;
+    return true;
+}
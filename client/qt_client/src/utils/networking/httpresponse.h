@@ -16,4 +16,7 @@ public:
 
     // Parse a raw HTTP response into statusCode, headers, and body
     static HttpResponse fromRaw(const std::string& raw);
+
+    // The size line of a chunked body (hex digits, then optional ";ext"); false if malformed
+    static bool parseChunkSize(const std::string& line, std::size_t& out);
 };
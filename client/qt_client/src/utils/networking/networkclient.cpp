@@ -1,4 +1,17 @@
 #include "NetworkClient.h"
+#include "../metrics.h"
+#include <cstdlib>
+#include <mutex>
+#include <QDebug>
+
+namespace {
+std::mutex                      s_traceMutex;
+std::shared_ptr<TraceRecorder>  s_trace;
+std::once_flag                  s_traceFromEnv;
+
+std::mutex                      s_transportMutex;
+std::shared_ptr<NetworkClient>  s_transport;
+}
 
 NetworkClient::~NetworkClient() = default;
 
@@ -7,7 +20,76 @@ HttpResponse NetworkClient::sendRequest(const HttpRequest& request) {
     return sendRequest(this->host_, this->port_, request, DEFAULT_TIMEOUT);
 }
 
+void NetworkClient::sendAsync(HttpRequest request, Completion done, int timeoutSeconds) {
+    done(sendRequest(this->host_, this->port_, request, timeoutSeconds));
+}
+
 void NetworkClient::setHostPort(const std::string& host, int port) {
     this->host_ = host;
     this->port_ = port;
 }
+
+std::shared_ptr<TraceRecorder> NetworkClient::traceRecorder()
+{
+    std::call_once(s_traceFromEnv, []() {
+        const char* path = std::getenv("SSSHARE_TRACE");
+        if (!path || !*path)
+            return;
+        const char* mode = std::getenv("SSSHARE_TRACE_BODIES");
+        const std::string m = mode ? mode : "";
+        const TraceRecorder::Bodies bodies = m == "full"     ? TraceRecorder::Bodies::Full
+                                           : m == "redacted" ? TraceRecorder::Bodies::Redacted
+                                                             : TraceRecorder::Bodies::None;
+        std::string err;
+        auto recorder = TraceRecorder::open(path, bodies, err);
+        if (!recorder) {
+            qWarning() << "[Trace]" << QString::fromStdString(err);
+            return;
+        }
+        qDebug() << "[Trace] recording to" << path;
+        std::lock_guard<std::mutex> lock(s_traceMutex);
+        if (!s_trace)
+            s_trace = std::move(recorder);
+    });
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    return s_trace;
+}
+
+void NetworkClient::setTraceRecorder(std::shared_ptr<TraceRecorder> recorder)
+{
+    // an explicit recorder wins over the environment
+    std::call_once(s_traceFromEnv, []() {});
+    std::lock_guard<std::mutex> lock(s_traceMutex);
+    s_trace = std::move(recorder);
+}
+
+std::shared_ptr<NetworkClient> NetworkClient::transport()
+{
+    std::lock_guard<std::mutex> lock(s_transportMutex);
+    return s_transport;
+}
+
+void NetworkClient::setTransport(std::shared_ptr<NetworkClient> transport)
+{
+    std::lock_guard<std::mutex> lock(s_transportMutex);
+    s_transport = std::move(transport);
+}
+
+void NetworkClient::countExchange(const std::string& path, int status, uint64_t requestBytes,
+                                  uint64_t responseBytes, std::chrono::steady_clock::time_point started)
+{
+    const uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - started).count();
+    METRICS_COUNTER("net.requests").add();
+    if (status == 0 || status >= 400)
+        METRICS_COUNTER("net.failures").add();
+    METRICS_COUNTER("net.bytes_sent").add(requestBytes);
+    METRICS_COUNTER("net.bytes_received").add(responseBytes);
+    METRICS_BYTES_HISTOGRAM("net.response_bytes").record(responseBytes);
+    METRICS_HISTOGRAM("net.latency").record(ns);
+
+    // the per-path lookup takes the registry lock; one per request is noise next to the
+    // round trip. Query strings are dropped so cursors do not each get a histogram.
+    const std::string endpoint = path.substr(0, path.find('?'));
+    Metrics::instance().histogram("net.latency " + endpoint).record(ns);
+}
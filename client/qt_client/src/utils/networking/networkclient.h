@@ -1,6 +1,10 @@
 #pragma once
 #include "HttpRequest.h"
 #include "HttpResponse.h"
+#include "tracerecorder.h"
+#include <chrono>
+#include <functional>
+#include <memory>
 #include <string>
 
 /**
@@ -14,6 +18,8 @@
  */
 class NetworkClient {
 public:
+    using Completion = std::function<void(HttpResponse)>;
+
     virtual ~NetworkClient();
 
     /// Initialize the TLS/SSL context (e.g. load CA certificates, set up trust store).
@@ -35,11 +41,43 @@ public:
      */
     HttpResponse sendRequest(const HttpRequest& request);
 
+    /**
+     * Send without waiting: `done` runs exactly once with the response, on whichever
+     * thread the transport finishes on. The request is taken by value so a transport
+     * can move its body instead of copying it. The default blocks in sendRequest() on
+     * the stored host and port.
+     */
+    virtual void sendAsync(HttpRequest request, Completion done, int timeoutSeconds = DEFAULT_TIMEOUT);
+
     /**
      * Stores a default host and port so you don't have to specify a port and host on every call
      */
     void setHostPort(const std::string& host, int port);
 
+    /**
+     * A process-wide replacement for the real network, or null (the default) to use
+     * AsyncSslClient / AsioSslClient. Coro::request() and RegisterHandler send through
+     * it when set, so benchmarks can run the handlers against an in-process fake
+     * (bench/loopbackclient.h). Set it before any handler runs.
+     */
+    static std::shared_ptr<NetworkClient> transport();
+    static void setTransport(std::shared_ptr<NetworkClient> transport);
+
+    /**
+     * The process-wide traffic recorder (tracerecorder.h) every client reports to, or
+     * null while tracing is off. The first call honours SSSHARE_TRACE /
+     * SSSHARE_TRACE_BODIES; setTraceRecorder() replaces it (nullptr stops tracing).
+     */
+    static std::shared_ptr<TraceRecorder> traceRecorder();
+    static void setTraceRecorder(std::shared_ptr<TraceRecorder> recorder);
+
+    /**
+     * Feeds one finished exchange into Metrics (metrics.h): request, failure and byte
+     * counters plus an overall and a per-path latency histogram ("net.latency /api/fs/list").
+     */
+    static void countExchange(const std::string& path, int status, uint64_t requestBytes,
+                              uint64_t responseBytes, std::chrono::steady_clock::time_point started);
+
 protected:
     static constexpr int DEFAULT_TIMEOUT = 30;
 
@@ -0,0 +1,217 @@
+#include "tracerecorder.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+constexpr char    kMagic[8]      = { 'S', 'S', 'T', 'R', 'A', 'C', 'E', '1' };
+constexpr uint8_t kPathRecord     = 1;
+constexpr uint8_t kExchangeRecord = 2;
+
+// flush every so many records, so a crash loses little and the writes stay cheap
+constexpr uint64_t kFlushEvery = 64;
+
+bool readVarint(std::istream& in, uint64_t& out)
+{
+    out = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        const int c = in.get();
+        if (c == EOF)
+            return false;
+        out |= uint64_t(c & 0x7F) << shift;
+        if (!(c & 0x80))
+            return true;
+    }
+    return false;
+}
+
+bool readString(std::istream& in, std::string& out)
+{
+    uint64_t len = 0;
+    if (!readVarint(in, len) || len > (uint64_t(1) << 32))
+        return false;
+    out.resize(len);
+    return len == 0 || static_cast<bool>(in.read(out.data(), static_cast<std::streamsize>(len)));
+}
+
+uint64_t microsSince(TraceRecorder::Clock::time_point from, TraceRecorder::Clock::time_point to)
+{
+    if (to <= from)
+        return 0;
+    return std::chrono::duration_cast<std::chrono::microseconds>(to - from).count();
+}
+
+} // namespace
+
+std::shared_ptr<TraceRecorder> TraceRecorder::open(const std::string& path, Bodies bodies,
+                                                   std::string& outError)
+{
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        outError = "cannot create " + path;
+        return nullptr;
+    }
+    return std::shared_ptr<TraceRecorder>(new TraceRecorder(std::move(out), bodies));
+}
+
+TraceRecorder::TraceRecorder(std::ofstream out, Bodies bodies)
+    : m_out(std::move(out)), m_bodies(bodies), m_start(Clock::now())
+{
+    const uint64_t unixMicros = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    m_out.write(kMagic, sizeof(kMagic));
+    m_out.put(static_cast<char>(m_bodies));
+    writeVarint(unixMicros);
+}
+
+TraceRecorder::~TraceRecorder()
+{
+    flush();
+}
+
+void TraceRecorder::record(Clock::time_point startedAt, uint8_t method, Transport transport,
+                           const std::string& path, int status, uint64_t requestBytes,
+                           uint64_t responseBytes, const std::string& requestBody)
+{
+    const Clock::time_point now = Clock::now();
+    // redaction is the expensive part; keep it outside the lock
+    std::string body;
+    if (m_bodies == Bodies::Redacted)
+        body = redact(requestBody);
+    else if (m_bodies == Bodies::Full)
+        body = requestBody;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto [it, added] = m_pathIds.emplace(path, m_pathIds.size());
+    if (added) {
+        m_out.put(static_cast<char>(kPathRecord));
+        writeVarint(it->second);
+        writeString(path);
+    }
+
+    m_out.put(static_cast<char>(kExchangeRecord));
+    writeVarint(microsSince(m_start, startedAt));
+    writeVarint(microsSince(startedAt, now));
+    m_out.put(static_cast<char>(method));
+    m_out.put(static_cast<char>(transport));
+    writeVarint(it->second);
+    writeVarint(static_cast<uint64_t>(std::max(0, status)));
+    writeVarint(requestBytes);
+    writeVarint(responseBytes);
+    if (m_bodies != Bodies::None)
+        writeString(body);
+
+    if (++m_unflushed >= kFlushEvery) {
+        m_out.flush();
+        m_unflushed = 0;
+    }
+}
+
+void TraceRecorder::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_out.flush();
+    m_unflushed = 0;
+}
+
+void TraceRecorder::writeVarint(uint64_t v)
+{
+    char buf[10];
+    int n = 0;
+    do {
+        uint8_t b = v & 0x7F;
+        v >>= 7;
+        if (v)
+            b |= 0x80;
+        buf[n++] = static_cast<char>(b);
+    } while (v);
+    m_out.write(buf, n);
+}
+
+void TraceRecorder::writeString(const std::string& s)
+{
+    writeVarint(s.size());
+    m_out.write(s.data(), static_cast<std::streamsize>(s.size()));
+}
+
+bool TraceRecorder::read(const std::string& path, Trace& out, std::string& outError)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        outError = "cannot open " + path;
+        return false;
+    }
+    char magic[sizeof(kMagic)];
+    const int mode = (in.read(magic, sizeof(magic)), in.get());
+    if (!in || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0 || mode > int(Bodies::Full)
+        || !readVarint(in, out.startUnixMicros)) {
+        outError = path + " is not a trace file";
+        return false;
+    }
+    out.bodies = static_cast<Bodies>(mode);
+    out.exchanges.clear();
+
+    std::map<uint64_t, std::string> paths;
+    for (int kind = in.get(); kind != EOF; kind = in.get()) {
+        if (kind == kPathRecord) {
+            uint64_t id = 0;
+            if (!readVarint(in, id) || !readString(in, paths[id]))
+                break;
+            continue;
+        }
+        if (kind != kExchangeRecord)
+            break;
+
+        Exchange e;
+        uint64_t pathId = 0, status = 0;
+        if (!readVarint(in, e.startMicros) || !readVarint(in, e.durationMicros))
+            break;
+        const int method = in.get(), transport = in.get();
+        if (transport == EOF || !readVarint(in, pathId) || !readVarint(in, status)
+            || !readVarint(in, e.requestBytes) || !readVarint(in, e.responseBytes))
+            break;
+        if (out.bodies != Bodies::None && !readString(in, e.body))
+            break;
+        e.method    = static_cast<uint8_t>(method);
+        e.transport = static_cast<Transport>(transport);
+        e.status    = static_cast<int>(status);
+        e.path      = paths[pathId];
+        out.exchanges.push_back(std::move(e));
+    }
+    // a truncated tail (the app was killed mid-write) only costs the last record
+    return true;
+}
+
+std::string TraceRecorder::redact(const std::string& body)
+{
+    const size_t first = body.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos || (body[first] != '{' && body[first] != '['))
+        return std::string(body.size(), 'x');
+
+    std::string out = body;
+    size_t i = first;
+    while (i < out.size()) {
+        if (out[i] != '"') {
+            ++i;
+            continue;
+        }
+        // find the closing quote, stepping over escapes
+        size_t end = i + 1;
+        while (end < out.size() && out[end] != '"')
+            end += out[end] == '\\' ? 2 : 1;
+        // unterminated (a truncated body): fail closed, nothing after the quote is readable
+        if (end >= out.size()) {
+            std::memset(&out[i], 'x', out.size() - i);
+            break;
+        }
+
+        // a string followed by ':' is a key and stays readable
+        size_t next = end + 1;
+        while (next < out.size() && (out[next] == ' ' || out[next] == '\t' || out[next] == '\r' || out[next] == '\n'))
+            ++next;
+        if (next >= out.size() || out[next] != ':')
+            std::memset(&out[i + 1], 'x', end - i - 1);
+        i = end + 1;
+    }
+    return out;
+}
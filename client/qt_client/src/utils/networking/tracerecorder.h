@@ -0,0 +1,97 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * TraceRecorder – opt-in capture of the client's HTTPS traffic shape into a compact
+ * binary trace, for reproducing field performance reports (bench/trace_replay.cpp).
+ *
+ * Each exchange records when it started, how long it took, method, path, request and
+ * response body sizes, status and which client sent it. Bodies are left out unless asked
+ * for: Redacted keeps a JSON body's structure and exact length but overwrites every
+ * string value (file contents, keys, signatures) with 'x'; Full keeps it verbatim and
+ * is meant for test accounts only. Headers, and with them usernames and signatures, are
+ * never written.
+ *
+ * Switched on with NetworkClient::setTraceRecorder(), or for any build by setting
+ * SSSHARE_TRACE=<file> (and optionally SSSHARE_TRACE_BODIES=redacted|full).
+ *
+ * Format (little-endian, integers as LEB128 varints unless noted):
+ *   header   "SSTRACE1", u8 bodies mode, varint start time (µs since the Unix epoch)
+ *   records  u8 kind, then
+ *     kind 1 (path)      varint id, string             — each path is written once
+ *     kind 2 (exchange)  varint start (µs after the header's time), varint duration µs,
+ *                        u8 method, u8 transport, varint path id, varint status,
+ *                        varint request bytes, varint response bytes,
+ *                        [string body, only when the header's mode is not None]
+ *   strings are a varint length and the bytes
+ */
+class TraceRecorder {
+public:
+    enum class Bodies : uint8_t { None = 0, Redacted = 1, Full = 2 };
+    enum class Transport : uint8_t { Sync = 0, Async = 1 };
+
+    struct Exchange {
+        uint64_t        startMicros = 0;        // since the trace started
+        uint64_t        durationMicros = 0;
+        uint8_t         method = 0;             // HttpRequest::Method
+        Transport       transport = Transport::Async;
+        std::string     path;
+        int             status = 0;
+        uint64_t        requestBytes = 0;
+        uint64_t        responseBytes = 0;
+        std::string     body;                   // as recorded; empty with Bodies::None
+    };
+
+    struct Trace {
+        Bodies                  bodies = Bodies::None;
+        uint64_t                startUnixMicros = 0;
+        std::vector<Exchange>   exchanges;      // in completion order
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    /** Creates (truncates) path; nullptr with outError set if it cannot be opened */
+    static std::shared_ptr<TraceRecorder> open(const std::string& path, Bodies bodies,
+                                               std::string& outError);
+
+    /** Reads a whole trace back; false with outError set if it is not one */
+    static bool read(const std::string& path, Trace& out, std::string& outError);
+
+    /** JSON-aware redaction: every string value becomes 'x's of the same length; an
+     *  unterminated string masks everything from its opening quote to the end */
+    static std::string redact(const std::string& body);
+
+    ~TraceRecorder();
+
+    Bodies bodies() const { return m_bodies; }
+
+    /**
+     * Thread-safe; startedAt is when the request was handed to the client. requestBody
+     * is only looked at when bodies() is not None, so callers may pass it empty then.
+     */
+    void record(Clock::time_point startedAt, uint8_t method, Transport transport,
+                const std::string& path, int status, uint64_t requestBytes,
+                uint64_t responseBytes, const std::string& requestBody = {});
+
+    void flush();
+
+private:
+    TraceRecorder(std::ofstream out, Bodies bodies);
+
+    void writeVarint(uint64_t v);
+    void writeString(const std::string& s);
+
+    std::mutex                      m_mutex;
+    std::ofstream                   m_out;
+    Bodies                          m_bodies;
+    Clock::time_point               m_start;
+    std::map<std::string, uint64_t> m_pathIds;
+    uint64_t                        m_unflushed = 0;
+};
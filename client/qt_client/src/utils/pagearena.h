@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+
+/**
+ * PageArena is the scratch allocator for decoding one listing page.
+ *
+ * Everything a page needs only while it is being decoded (base64 output, ciphertext
+ * and plaintext buffers, metadata strings) is bump-allocated from a
+ * std::pmr::monotonic_buffer_resource and dropped wholesale by reset() before the
+ * next page. The first kInitialBytes come from one up-front block, so a typical page
+ * never reaches the global heap at all.
+ *
+ * Upstream (heap) traffic is counted, which is what the listing benchmark reports.
+ * One arena per worker (a thread, or a coroutine flow that owns it); it is not thread-safe.
+ */
+class PageArena {
+public:
+    static constexpr std::size_t kInitialBytes = 256 * 1024;
+
+    PageArena()
+        : m_initial(std::make_unique<std::byte[]>(kInitialBytes)),
+          m_resource(m_initial.get(), kInitialBytes, &m_counter)
+    {
+    }
+
+    PageArena(const PageArena&) = delete;
+    PageArena& operator=(const PageArena&) = delete;
+
+    std::pmr::memory_resource* resource() { return &m_resource; }
+
+    // Frees everything allocated since the last reset; the initial block is reused.
+    void reset() { m_resource.release(); }
+
+    // Allocations that spilled past the initial block to the heap, over the arena's lifetime
+    std::size_t upstreamAllocations() const { return m_counter.allocations; }
+
+private:
+    struct CountingResource : std::pmr::memory_resource {
+        std::size_t allocations = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t align) override
+        {
+            ++allocations;
+            return std::pmr::new_delete_resource()->allocate(bytes, align);
+        }
+        void do_deallocate(void* p, std::size_t bytes, std::size_t align) override
+        {
+            std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+        }
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+        {
+            return this == &other;
+        }
+    };
+
+    std::unique_ptr<std::byte[]>        m_initial;
+    CountingResource                    m_counter;
+    std::pmr::monotonic_buffer_resource m_resource;
+};
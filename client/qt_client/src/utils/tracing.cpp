@@ -0,0 +1,241 @@
+#include "tracing.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <vector>
+#include <QDebug>
+
+namespace Tracing {
+
+namespace detail {
+std::atomic<bool> g_enabled{ false };
+}
+
+namespace {
+
+struct Event {
+    const char* category;
+    const char* name;
+    const char* argName;
+    int64_t     arg;
+    uint64_t    ts;         // ns on the trace clock
+    uint64_t    dur;        // 'X' only
+    uint64_t    id;         // 'b' / 'e' only
+    char        phase;      // 'X' complete, 'b' / 'e' async begin / end
+};
+
+// One per recording thread; only that thread writes, the exporter reads after stop()
+struct Ring {
+    uint32_t                tid = 0;
+    std::string             name;
+    std::vector<Event>      events;
+    std::atomic<uint64_t>   written{ 0 };
+};
+
+const std::chrono::steady_clock::time_point s_epoch = std::chrono::steady_clock::now();
+
+std::mutex                          s_mutex;        // the registry, names and interned strings
+std::vector<std::shared_ptr<Ring>>  s_rings;        // outlive their threads until the next start()
+size_t                              s_capacity = kDefaultEventsPerThread;
+uint32_t                            s_nextTid = 1;
+std::set<std::string>               s_interned;
+std::atomic<uint64_t>               s_nextAsyncId{ 1 };
+
+thread_local Ring*          tl_ring = nullptr;
+thread_local std::string    tl_name;
+
+Ring* ring()
+{
+    if (tl_ring)
+        return tl_ring;
+    auto r = std::make_shared<Ring>();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    r->tid  = s_nextTid++;
+    r->name = tl_name.empty() ? "thread-" + std::to_string(r->tid) : tl_name;
+    r->events.resize(s_capacity);
+    s_rings.push_back(r);
+    tl_ring = r.get();
+    return tl_ring;
+}
+
+void append(const Event& e)
+{
+    Ring* r = ring();
+    const uint64_t slot = r->written.load(std::memory_order_relaxed);
+    r->events[slot % r->events.size()] = e;
+    r->written.store(slot + 1, std::memory_order_release);
+}
+
+void writeEscaped(std::ostream& out, const char* s)
+{
+    for (; *s; ++s) {
+        const char c = *s;
+        if (c == '"' || c == '\\')
+            out << '\\' << c;
+        else if (static_cast<unsigned char>(c) < 0x20)
+            out << ' ';
+        else
+            out << c;
+    }
+}
+
+std::string s_exitPath;
+
+void writeAtExit()
+{
+    stop();
+    std::string err;
+    if (!writeJson(s_exitPath, err))
+        std::fprintf(stderr, "[Tracing] %s\n", err.c_str());
+}
+
+} // namespace
+
+void start(size_t eventsPerThread)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_capacity = std::max<size_t>(eventsPerThread, 64);
+    // rings of threads that are still alive are reused; restart them empty
+    for (auto& r : s_rings) {
+        r->written.store(0, std::memory_order_relaxed);
+        if (r->events.size() != s_capacity)
+            r->events.assign(s_capacity, Event{});
+    }
+    detail::g_enabled.store(true, std::memory_order_release);
+}
+
+void stop()
+{
+    detail::g_enabled.store(false, std::memory_order_release);
+}
+
+bool startFromEnvironment()
+{
+    const char* path = std::getenv("SSSHARE_SPANS");
+    if (!path || !*path)
+        return false;
+    const char* events = std::getenv("SSSHARE_SPANS_EVENTS");
+    const size_t perThread = events ? std::strtoull(events, nullptr, 10) : 0;
+
+    s_exitPath = path;
+    start(perThread ? perThread : kDefaultEventsPerThread);
+    std::atexit(writeAtExit);
+    qDebug() << "[Tracing] recording spans to" << path;
+    return true;
+}
+
+bool writeJson(const std::string& path, std::string& outError)
+{
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        outError = "cannot create " + path;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    auto separator = [&]() {
+        if (!first)
+            out << ",\n";
+        first = false;
+    };
+
+    char ts[64];
+    for (const auto& r : s_rings) {
+        separator();
+        out << "{\"ph\":\"M\",\"pid\":1,\"tid\":" << r->tid << ",\"name\":\"thread_name\",\"args\":{\"name\":\"";
+        writeEscaped(out, r->name.c_str());
+        out << "\"}}";
+
+        const uint64_t written = r->written.load(std::memory_order_acquire);
+        const uint64_t cap = r->events.size();
+        for (uint64_t i = written > cap ? written - cap : 0; i < written; ++i) {
+            const Event& e = r->events[i % cap];
+            if (!e.name)
+                continue;
+            separator();
+            std::snprintf(ts, sizeof(ts), "%.3f", e.ts / 1000.0);
+            out << "{\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << r->tid << ",\"ts\":" << ts
+                << ",\"cat\":\"";
+            writeEscaped(out, e.category);
+            out << "\",\"name\":\"";
+            writeEscaped(out, e.name);
+            out << '"';
+            if (e.phase == 'X') {
+                std::snprintf(ts, sizeof(ts), "%.3f", e.dur / 1000.0);
+                out << ",\"dur\":" << ts;
+            } else {
+                out << ",\"id\":\"0x" << std::hex << e.id << std::dec << '"';
+            }
+            if (e.argName) {
+                out << ",\"args\":{\"";
+                writeEscaped(out, e.argName);
+                out << "\":" << e.arg << '}';
+            }
+            out << '}';
+        }
+    }
+    out << "\n]}\n";
+    out.flush();
+    if (!out) {
+        outError = "write to " + path + " failed";
+        return false;
+    }
+    return true;
+}
+
+void setThreadName(const std::string& name)
+{
+    tl_name = name;
+    if (tl_ring) {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        tl_ring->name = name;
+    }
+}
+
+const char* intern(const std::string& s)
+{
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_interned.insert(s).first->c_str();
+}
+
+uint64_t now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - s_epoch).count() + 1;     // 0 means "not started"
+}
+
+uint64_t newAsyncId()
+{
+    return s_nextAsyncId.fetch_add(1, std::memory_order_relaxed);
+}
+
+void complete(const char* category, const char* name, uint64_t startNs, uint64_t endNs,
+              const char* argName, int64_t arg)
+{
+    if (!enabled())
+        return;
+    append({ category, name, argName, arg, startNs, endNs > startNs ? endNs - startNs : 0, 0, 'X' });
+}
+
+void asyncBegin(const char* category, const char* name, uint64_t id, uint64_t ts)
+{
+    if (!enabled())
+        return;
+    append({ category, name, nullptr, 0, ts, 0, id, 'b' });
+}
+
+void asyncEnd(const char* category, const char* name, uint64_t id, uint64_t ts)
+{
+    // an end after stop() is dropped; the viewer shows its begin as still open
+    if (!enabled())
+        return;
+    append({ category, name, nullptr, 0, ts, 0, id, 'e' });
+}
+
+} // namespace Tracing
@@ -0,0 +1,162 @@
+#pragma once
+#include "alloctracker.h"
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Tracing – timed spans across the handler stages, exported as Chrome trace-event JSON
+ * (open in ui.perfetto.dev or chrome://tracing).
+ *
+ *   TRACE_SPAN("upload", "encrypt");                    // until the end of the scope
+ *   TRACE_SPAN_ARG("upload", "read", "bytes", n);       // with one numeric argument
+ *   TRACE_ASYNC(op, "upload", "upload");                // may outlive co_awaits / threads
+ *
+ * Every thread appends to its own ring buffer (no locks, nothing shared on the hot path);
+ * when a ring is full the oldest events are overwritten, so a long session keeps its most
+ * recent stretch. While tracing is off a span costs one relaxed atomic load. Building
+ * with QT_CLIENT_TRACING=OFF (SSSHARE_TRACING=0) compiles the macros away entirely.
+ *
+ * TRACE_SPAN must not span a co_await: it closes on whichever thread the coroutine
+ * resumed on. Use TRACE_ASYNC for a whole operation; it shows up as its own track.
+ *
+ * Names and categories must be string literals (or Tracing::intern()ed), since events
+ * only keep the pointers.
+ *
+ * SSSHARE_SPANS=<file.json> starts tracing at launch and writes the file at exit
+ * (startFromEnvironment(), called by each front-end's main()).
+ *
+ * In the allocation-tracking build every Span is also an AllocTracker::Scope, whether
+ * tracing is on or not (alloctracker.h).
+ */
+
+#ifndef SSSHARE_TRACING
+#define SSSHARE_TRACING 1
+#endif
+
+namespace Tracing {
+
+constexpr size_t kDefaultEventsPerThread = 16384;   // ~1 MiB per thread that records
+
+namespace detail {
+extern std::atomic<bool> g_enabled;
+}
+
+inline bool enabled()
+{
+    return detail::g_enabled.load(std::memory_order_relaxed);
+}
+
+/** Clears every ring and starts recording; rings are sized on each thread's first event */
+void start(size_t eventsPerThread = kDefaultEventsPerThread);
+void stop();
+
+/** Honours SSSHARE_SPANS (and SSSHARE_SPANS_EVENTS); true if tracing was started */
+bool startFromEnvironment();
+
+/**
+ * Writes everything still in the rings as trace-event JSON. Call after stop(): an event
+ * being written meanwhile may be missing or torn.
+ */
+bool writeJson(const std::string& path, std::string& outError);
+
+/** Names the calling thread's track ("cpu-3", "network"); the name is copied */
+void setThreadName(const std::string& name);
+
+/** A stable pointer for a runtime string (request paths); keep the set of values small */
+const char* intern(const std::string& s);
+
+/** Nanoseconds on the trace clock */
+uint64_t now();
+
+uint64_t newAsyncId();
+
+void complete(const char* category, const char* name, uint64_t startNs, uint64_t endNs,
+              const char* argName = nullptr, int64_t arg = 0);
+void asyncBegin(const char* category, const char* name, uint64_t id, uint64_t ts);
+void asyncEnd(const char* category, const char* name, uint64_t id, uint64_t ts);
+
+/** A synchronous stage on the current thread (TRACE_SPAN) */
+class Span {
+public:
+    Span(const char* category, const char* name, const char* argName = nullptr, int64_t arg = 0)
+        : m_category(category), m_name(name), m_argName(argName), m_arg(arg),
+#if SSSHARE_ALLOC_TRACKING
+          m_alloc(category, name),
+#endif
+          m_start(enabled() ? now() : 0) {}
+
+    ~Span()
+    {
+        if (m_start)
+            complete(m_category, m_name, m_start, now(), m_argName, m_arg);
+    }
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+    void setArg(const char* argName, int64_t arg)
+    {
+        m_argName = argName;
+        m_arg = arg;
+    }
+
+private:
+    const char* m_category;
+    const char* m_name;
+    const char* m_argName;
+    int64_t     m_arg;
+#if SSSHARE_ALLOC_TRACKING
+    AllocTracker::Scope m_alloc;
+#endif
+    uint64_t    m_start;
+};
+
+/** An operation that may begin and end on different threads (TRACE_ASYNC) */
+class AsyncSpan {
+public:
+    AsyncSpan(const char* category, const char* name)
+        : m_category(category), m_name(name), m_id(enabled() ? newAsyncId() : 0)
+    {
+        if (m_id)
+            asyncBegin(m_category, m_name, m_id, now());
+    }
+
+    ~AsyncSpan() { end(); }
+
+    AsyncSpan(const AsyncSpan&) = delete;
+    AsyncSpan& operator=(const AsyncSpan&) = delete;
+
+    void end()
+    {
+        if (m_id)
+            asyncEnd(m_category, m_name, m_id, now());
+        m_id = 0;
+    }
+
+private:
+    const char* m_category;
+    const char* m_name;
+    uint64_t    m_id;
+};
+
+} // namespace Tracing
+
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+
+#if SSSHARE_TRACING
+#define TRACE_SPAN(category, name) \
+    Tracing::Span TRACE_CONCAT(traceSpan_, __LINE__)(category, name)
+#define TRACE_SPAN_ARG(category, name, argName, value) \
+    Tracing::Span TRACE_CONCAT(traceSpan_, __LINE__)(category, name, argName, static_cast<int64_t>(value))
+#define TRACE_ASYNC(var, category, name) Tracing::AsyncSpan var(category, name)
+#define TRACE_ASYNC_END(var) var.end()
+#else
+#define TRACE_SPAN(category, name) ((void)0)
+#define TRACE_SPAN_ARG(category, name, argName, value) ((void)0)
+#define TRACE_ASYNC(var, category, name) ((void)0)
+#define TRACE_ASYNC_END(var) ((void)0)
+#endif
@@ -0,0 +1,225 @@
+#include "trigramindex.h"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+    const char kMagic[4] = { 'T', 'G', 'I', '1' };
+
+    void putVarint(std::string& out, uint64_t v)
+    {
+        while (v >= 0x80) {
+            out.push_back(static_cast<char>((v & 0x7F) | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<char>(v));
+    }
+
+    bool getVarint(const std::string& in, size_t& pos, uint64_t& v)
+    {
+        v = 0;
+        for (int shift = 0; shift < 64 && pos < in.size(); shift += 7) {
+            uint8_t b = static_cast<uint8_t>(in[pos++]);
+            v |= static_cast<uint64_t>(b & 0x7F) << shift;
+            if (!(b & 0x80))
+                return true;
+        }
+        return false;
+    }
+}
+
+QString TrigramIndex::normalize(const QString& text)
+{
+    return text.toCaseFolded();
+}
+
+std::vector<TrigramIndex::Trigram> TrigramIndex::trigramsOf(const QString& folded)
+{
+    std::vector<Trigram> out;
+    if (folded.size() < 3)
+        return out;
+
+    out.reserve(static_cast<size_t>(folded.size()) - 2);
+    for (qsizetype i = 0; i + 2 < folded.size(); ++i) {
+        out.push_back((static_cast<Trigram>(folded[i].unicode()) << 32)
+                      | (static_cast<Trigram>(folded[i + 1].unicode()) << 16)
+                      | static_cast<Trigram>(folded[i + 2].unicode()));
+    }
+    std::sort(out.begin(), out.end());
+    out.erase(std::unique(out.begin(), out.end()), out.end());
+    return out;
+}
+
+void TrigramIndex::insert(uint64_t fileId, const QString& text)
+{
+    QString folded = normalize(text);
+    auto it = m_docs.find(fileId);
+    if (it != m_docs.end()) {
+        if (it->second == folded)
+            return;
+        remove(fileId);
+    }
+
+    for (Trigram t : trigramsOf(folded)) {
+        auto& list = m_postings[t];
+        list.insert(std::lower_bound(list.begin(), list.end(), fileId), fileId);
+    }
+    m_docs.emplace(fileId, std::move(folded));
+    ++m_version;
+}
+
+void TrigramIndex::remove(uint64_t fileId)
+{
+    auto it = m_docs.find(fileId);
+    if (it == m_docs.end())
+        return;
+
+    for (Trigram t : trigramsOf(it->second)) {
+        auto pit = m_postings.find(t);
+        if (pit == m_postings.end())
+            continue;
+        auto& list = pit->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), fileId);
+        if (pos != list.end() && *pos == fileId)
+            list.erase(pos);
+        if (list.empty())
+            m_postings.erase(pit);
+    }
+    m_docs.erase(it);
+    ++m_version;
+}
+
+void TrigramIndex::clear()
+{
+    m_docs.clear();
+    m_postings.clear();
+    ++m_version;
+}
+
+bool TrigramIndex::matches(uint64_t fileId, const QString& query) const
+{
+    auto it = m_docs.find(fileId);
+    return it != m_docs.end() && it->second.contains(normalize(query));
+}
+
+std::vector<uint64_t> TrigramIndex::search(const QString& query) const
+{
+    std::vector<uint64_t> out;
+    QString folded = normalize(query);
+
+    // too short to form a trigram: plain scan
+    if (folded.size() < 3) {
+        for (const auto& [id, text] : m_docs) {
+            if (text.contains(folded))
+                out.push_back(id);
+        }
+        std::sort(out.begin(), out.end());
+        return out;
+    }
+
+    std::vector<const std::vector<uint64_t>*> lists;
+    for (Trigram t : trigramsOf(folded)) {
+        auto it = m_postings.find(t);
+        if (it == m_postings.end())
+            return out;
+        lists.push_back(&it->second);
+    }
+    std::sort(lists.begin(), lists.end(),
+              [](const auto* a, const auto* b) { return a->size() < b->size(); });
+
+    // intersect, shortest list first, so the candidate set only shrinks
+    std::vector<uint64_t> candidates = *lists.front();
+    std::vector<uint64_t> next;
+    for (size_t i = 1; i < lists.size() && !candidates.empty(); ++i) {
+        next.clear();
+        std::set_intersection(candidates.begin(), candidates.end(),
+                              lists[i]->begin(), lists[i]->end(),
+                              std::back_inserter(next));
+        candidates.swap(next);
+    }
+
+    // trigrams can match out of order; confirm the real substring
+    out.reserve(candidates.size());
+    for (uint64_t id : candidates) {
+        auto it = m_docs.find(id);
+        if (it != m_docs.end() && it->second.contains(folded))
+            out.push_back(id);
+    }
+    return out;
+}
+
+std::string TrigramIndex::serialize() const
+{
+    std::string out(kMagic, sizeof(kMagic));
+
+    putVarint(out, m_docs.size());
+    for (const auto& [id, text] : m_docs) {
+        putVarint(out, id);
+        putVarint(out, static_cast<uint64_t>(text.size()));
+        for (QChar c : text)
+            putVarint(out, c.unicode());
+    }
+
+    putVarint(out, m_postings.size());
+    for (const auto& [trigram, ids] : m_postings) {
+        putVarint(out, trigram);
+        putVarint(out, ids.size());
+        uint64_t prev = 0;
+        for (uint64_t id : ids) {       // sorted → small deltas
+            putVarint(out, id - prev);
+            prev = id;
+        }
+    }
+    return out;
+}
+
+bool TrigramIndex::deserialize(const std::string& blob)
+{
+    if (blob.size() < sizeof(kMagic) || blob.compare(0, sizeof(kMagic), kMagic, sizeof(kMagic)) != 0)
+        return false;
+
+    std::unordered_map<uint64_t, QString> docs;
+    std::unordered_map<Trigram, std::vector<uint64_t>> postings;
+    size_t pos = sizeof(kMagic);
+    uint64_t n = 0;
+
+    if (!getVarint(blob, pos, n))
+        return false;
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t id = 0, len = 0;
+        if (!getVarint(blob, pos, id) || !getVarint(blob, pos, len) || len > blob.size())
+            return false;
+        QString text;
+        text.reserve(static_cast<qsizetype>(len));
+        for (uint64_t k = 0; k < len; ++k) {
+            uint64_t unit = 0;
+            if (!getVarint(blob, pos, unit) || unit > 0xFFFF)
+                return false;
+            text.append(QChar(static_cast<char16_t>(unit)));
+        }
+        docs.emplace(id, std::move(text));
+    }
+
+    if (!getVarint(blob, pos, n))
+        return false;
+    for (uint64_t i = 0; i < n; ++i) {
+        uint64_t trigram = 0, count = 0;
+        if (!getVarint(blob, pos, trigram) || !getVarint(blob, pos, count) || count > blob.size())
+            return false;
+        std::vector<uint64_t> ids;
+        ids.reserve(count);
+        uint64_t prev = 0;
+        for (uint64_t k = 0; k < count; ++k) {
+            uint64_t delta = 0;
+            if (!getVarint(blob, pos, delta))
+                return false;
+            prev += delta;
+            ids.push_back(prev);
+        }
+        postings.emplace(trigram, std::move(ids));
+    }
+
+    m_docs.swap(docs);
+    m_postings.swap(postings);
+    ++m_version;
+    return true;
+}
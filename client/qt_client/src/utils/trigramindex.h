@@ -0,0 +1,51 @@
+#pragma once
+
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * TrigramIndex answers case-insensitive substring queries over decrypted filenames.
+ *
+ *  • Every document (file_id → case-folded text) is split into overlapping 3-unit
+ *    trigrams; each trigram keeps a sorted posting list of file_ids.
+ *  • A query of 3+ units intersects the posting lists of its trigrams, shortest first,
+ *    then verifies the few survivors against the stored text.
+ *  • Queries shorter than a trigram fall back to a scan of the stored texts.
+ *
+ * version() moves on every mutation, so callers can cache query results cheaply.
+ * Not thread-safe; FileListModel owns it on the GUI thread.
+ */
+class TrigramIndex {
+public:
+    // Adds or replaces the document for fileId; unchanged text is a no-op
+    void insert(uint64_t fileId, const QString& text);
+    void remove(uint64_t fileId);
+    void clear();
+
+    // Sorted file_ids whose text contains query (case-insensitive)
+    std::vector<uint64_t> search(const QString& query) const;
+
+    // The same test for one document, for callers that only need to check a few new rows
+    bool matches(uint64_t fileId, const QString& query) const;
+
+    bool contains(uint64_t fileId) const { return m_docs.count(fileId) > 0; }
+    size_t size() const { return m_docs.size(); }
+    uint64_t version() const { return m_version; }
+
+    // Compact binary form for MetadataCache blobs; deserialize() returns false on a bad blob
+    std::string serialize() const;
+    bool deserialize(const std::string& blob);
+
+private:
+    using Trigram = uint64_t;
+
+    static QString normalize(const QString& text);
+    static std::vector<Trigram> trigramsOf(const QString& folded);
+
+    std::unordered_map<uint64_t, QString>               m_docs;      // file_id → folded text
+    std::unordered_map<Trigram, std::vector<uint64_t>>  m_postings;  // trigram → sorted file_ids
+    uint64_t                                            m_version = 0;
+};
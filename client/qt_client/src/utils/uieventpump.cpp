@@ -0,0 +1,165 @@
+#include "uieventpump.h"
+#include <QCoreApplication>
+#include <QThread>
+#include <thread>
+#include <unordered_map>
+
+UiEventPump& UiEventPump::instance()
+{
+    static UiEventPump* pump = [] {
+        auto* p = new UiEventPump();
+        p->moveToThread(QCoreApplication::instance()->thread());
+        return p;
+    }();
+    return *pump;
+}
+
+uint64_t UiEventPump::key(const void* owner, uint64_t id)
+{
+    // splitmix-style mix so (owner, id) pairs don't collide on their low bits
+    uint64_t k = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(owner)) ^ (id * 0x9E3779B97F4A7C15ULL);
+    k = (k ^ (k >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    k = (k ^ (k >> 27)) * 0x94D049BB133111EBULL;
+    return k ^ (k >> 31);
+}
+
+UiEventPump::UiEventPump()
+    : m_ring(kCapacity), m_frame(this)
+{
+    m_frame.setInterval(kFrameMs);
+    m_frame.setTimerType(Qt::PreciseTimer);
+    connect(&m_frame, &QTimer::timeout, this, &UiEventPump::onFrame);
+    m_batch.reserve(kMaxEventsPerFrame);
+}
+
+void UiEventPump::post(QObject* context, std::function<void()> fn)
+{
+    Event ev;
+    ev.kind    = Kind::Call;
+    ev.context = context;
+    ev.fn      = std::move(fn);
+    push(std::move(ev));
+}
+
+void UiEventPump::postLatest(QObject* context, uint64_t key, std::function<void()> fn)
+{
+    Event ev;
+    ev.kind    = Kind::Latest;
+    ev.context = context;
+    ev.key     = key;
+    ev.fn      = std::move(fn);
+    push(std::move(ev));
+}
+
+void UiEventPump::push(Event ev)
+{
+    while (!m_ring.tryPush(ev)) {
+        if (QThread::currentThread() == thread()) {
+            // waiting here would wait on ourselves
+            auto pending = std::make_shared<Event>(std::move(ev));
+            QMetaObject::invokeMethod(
+                this, [pending]() { runOne(*pending); },
+                Qt::QueuedConnection);
+            return;
+        }
+        std::this_thread::yield();
+    }
+    wake();
+}
+
+void UiEventPump::wake()
+{
+    // one queued wake-up per idle period; while frames are ticking, producers post nothing
+    if (!m_wakePending.exchange(true))
+        QMetaObject::invokeMethod(this, &UiEventPump::onWake, Qt::QueuedConnection);
+}
+
+void UiEventPump::onWake()
+{
+    if (m_frame.isActive() || m_draining)
+        return;
+    // the first event of a burst goes out at once; the rest at frame rate
+    m_frame.start();
+    drainFrame();
+}
+
+void UiEventPump::onFrame()
+{
+    if (m_draining || drainFrame() > 0)
+        return;
+
+    // idle: stop ticking, unless a producer slipped in after the drain
+    m_wakePending = false;
+    if (!m_ring.empty() && !m_wakePending.exchange(true))
+        return;
+    m_frame.stop();
+}
+
+size_t UiEventPump::drainFrame()
+{
+    m_batch.clear();
+    Event ev;
+    while (m_batch.size() < kMaxEventsPerFrame && m_ring.tryPop(ev))
+        m_batch.push_back(std::move(ev));
+    if (m_batch.empty())
+        return 0;
+
+    m_draining = true;
+    std::unordered_map<uint64_t, size_t> newest;
+    for (size_t i = 0; i < m_batch.size(); ++i)
+        if (m_batch[i].kind == Kind::Latest)
+            newest[m_batch[i].key] = i;
+
+    // append runs still collecting items, in the order they started
+    std::vector<Event*> open;
+    auto flush = [&open]() {
+        for (Event* run : open)
+            runOne(*run);
+        open.clear();
+    };
+
+    for (size_t i = 0; i < m_batch.size(); ++i) {
+        Event& e = m_batch[i];
+        switch (e.kind) {
+        case Kind::Append: {
+            bool merged = false;
+            for (Event* run : open) {
+                if (run->key == e.key && run->context == e.context
+                    && run->append->absorb(*e.append)) {
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged)
+                open.push_back(&e);
+            break;
+        }
+        case Kind::Latest:
+            if (newest[e.key] != i)
+                break;
+            flush();
+            runOne(e);
+            break;
+        case Kind::Call:
+            flush();
+            runOne(e);
+            break;
+        }
+    }
+    flush();
+
+    const size_t taken = m_batch.size();
+    m_batch.clear();
+    m_draining = false;
+    return taken;
+}
+
+void UiEventPump::runOne(Event& ev)
+{
+    if (!ev.context)
+        return;
+    if (ev.kind == Kind::Append)
+        ev.append->deliver();
+    else
+        ev.fn();
+}
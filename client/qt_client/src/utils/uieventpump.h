@@ -0,0 +1,119 @@
+#pragma once
+
+#include <QObject>
+#include <QPointer>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <vector>
+#include "mpscring.h"
+
+/**
+ * UiEventPump carries results from worker threads to the GUI thread.
+ *
+ * Workers push into one lock-free MpscRing; the GUI thread drains it at most once per
+ * frame (~16 ms) while there is traffic, and sleeps otherwise. Within a frame:
+ *
+ *  • post()        runs in order, exactly like a queued invokeMethod.
+ *  • postLatest()  keeps only the newest call per key — progress counters and other
+ *                  "latest value wins" updates cost one call per frame, not per item.
+ *  • postAppend()  merges the items of every post under a key into one vector and hands
+ *                  it to the sink once, so a burst of per-row results becomes one model
+ *                  insert.
+ *
+ * Order is kept across kinds: a post() or postLatest() first delivers any append
+ * batches posted before it. Each call names a context QObject; if the context is gone by
+ * the time the frame runs, the call is dropped, as with invokeMethod.
+ *
+ * A full ring makes worker threads yield until the GUI catches up; posting from the GUI
+ * thread itself never waits and falls back to a queued call.
+ */
+class UiEventPump : public QObject {
+    Q_OBJECT
+
+public:
+    // The one app-wide pump; first used from the GUI thread in main()
+    static UiEventPump& instance();
+
+    // Packs an owner (typically a batch or handler pointer) and an id into a key
+    static uint64_t key(const void* owner, uint64_t id = 0);
+
+    void post(QObject* context, std::function<void()> fn);
+    void postLatest(QObject* context, uint64_t key, std::function<void()> fn);
+
+    // One item type per key; the sink of the first post in a run is the one that's called
+    template <class T>
+    void postAppend(QObject* context, uint64_t key, std::vector<T> items,
+                    std::function<void(std::vector<T>&)> sink)
+    {
+        auto append = std::make_unique<Append<T>>();
+        append->items = std::move(items);
+        append->sink  = std::move(sink);
+
+        Event ev;
+        ev.kind    = Kind::Append;
+        ev.context = context;
+        ev.key     = key;
+        ev.append  = std::move(append);
+        push(std::move(ev));
+    }
+
+private:
+    static constexpr size_t kCapacity          = 1 << 14;
+    static constexpr size_t kMaxEventsPerFrame = 4096;
+    static constexpr int    kFrameMs           = 16;
+
+    struct AppendBase {
+        virtual ~AppendBase() = default;
+        // Takes next's items if it is the same kind of batch
+        virtual bool absorb(AppendBase& next) = 0;
+        virtual void deliver() = 0;
+    };
+
+    template <class T>
+    struct Append : AppendBase {
+        std::vector<T>                          items;
+        std::function<void(std::vector<T>&)>    sink;
+
+        bool absorb(AppendBase& next) override
+        {
+            auto* same = dynamic_cast<Append<T>*>(&next);
+            if (!same)
+                return false;
+            items.insert(items.end(),
+                         std::make_move_iterator(same->items.begin()),
+                         std::make_move_iterator(same->items.end()));
+            return true;
+        }
+        void deliver() override { sink(items); }
+    };
+
+    enum class Kind { Call, Latest, Append };
+
+    struct Event {
+        Kind                        kind = Kind::Call;
+        QPointer<QObject>           context;
+        uint64_t                    key = 0;
+        std::function<void()>       fn;
+        std::unique_ptr<AppendBase> append;
+    };
+
+    UiEventPump();
+
+    void push(Event ev);
+    void wake();
+    void onWake();
+    void onFrame();
+    // Runs up to kMaxEventsPerFrame events; returns how many it took off the ring
+    size_t drainFrame();
+    static void runOne(Event& ev);
+
+    MpscRing<Event>     m_ring;
+    std::atomic<bool>   m_wakePending{false};
+    bool                m_draining = false;     // a callback may spin a nested event loop
+    QTimer              m_frame;
+    std::vector<Event>  m_batch;    // reused between frames
+};
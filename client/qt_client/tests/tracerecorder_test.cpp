@@ -0,0 +1,57 @@
+// TraceRecorder::redact: string values are masked, keys stay readable, and a body cut off
+// inside a string (a capped capture) is masked to the end rather than left in clear text.
+//
+//   cmake -DQT_CLIENT_BUILD_TESTS=ON ... && ctest -R tracerecorder_test
+
+#include "../src/utils/networking/tracerecorder.h"
+
+#include <cstdio>
+#include <string>
+
+static int g_failures = 0;
+
+static void expectEqual(const char* name, const std::string& actual, const std::string& expected)
+{
+    if (actual == expected)
+        return;
+    std::fprintf(stderr, "FAIL %s\n  expected: %s\n  actual:   %s\n", name, expected.c_str(), actual.c_str());
+    ++g_failures;
+}
+
+int main()
+{
+    expectEqual("values masked, keys kept",
+                TraceRecorder::redact(R"({"username":"alice","size":42})"),
+                R"({"username":"xxxxx","size":42})");
+
+    expectEqual("escaped quote stays inside the value",
+                TraceRecorder::redact(R"({"k":"a\"b"})"),
+                R"({"k":"xxxx"})");
+
+    expectEqual("array values masked",
+                TraceRecorder::redact(R"(["one", "two"])"),
+                R"(["xxx", "xxx"])");
+
+    expectEqual("not JSON: everything masked",
+                TraceRecorder::redact("secret=hunter2"),
+                std::string(14, 'x'));
+
+    // truncated inside a value: the secret must not survive
+    expectEqual("truncated value fails closed",
+                TraceRecorder::redact(R"({"user":"alice","password":"hunter2)"),
+                R"({"user":"xxxxx","password":xxxxxxxx)");
+
+    // truncated inside a key: it cannot be told from a value, so it is masked too
+    expectEqual("truncated key fails closed",
+                TraceRecorder::redact(R"({"user":"alice","pass)"),
+                R"({"user":"xxxxx",xxxxx)");
+
+    // truncated right after a backslash: the escape step runs past the end
+    expectEqual("truncated escape fails closed",
+                TraceRecorder::redact(R"({"k":"ab\)"),
+                R"({"k":xxxx)");
+
+    if (g_failures == 0)
+        std::printf("tracerecorder_test: all passed\n");
+    return g_failures == 0 ? 0 : 1;
+}
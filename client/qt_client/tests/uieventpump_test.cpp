@@ -0,0 +1,161 @@
+// UiEventPump: postLatest coalescing, ordering across kinds, dropped contexts, and the
+// batch-progress pattern the delete and revoke workers use, where a final count posted
+// through the same key must be the last progress delivered even if workers posted theirs
+// out of order.
+//
+//   cmake -DQT_CLIENT_BUILD_TESTS=ON ... && ctest -R uieventpump_test
+
+#include "../src/utils/uieventpump.h"
+
+#include <QCoreApplication>
+#include <QEventLoop>
+#include <QObject>
+#include <QTimer>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+static int g_failures = 0;
+
+static void expect(const char* name, bool ok)
+{
+    if (ok)
+        return;
+    std::fprintf(stderr, "FAIL %s\n", name);
+    ++g_failures;
+}
+
+// Runs the GUI thread's event loop until `done` is set by a delivered call (or 5 s pass)
+static void runUntil(const bool& done)
+{
+    QEventLoop loop;
+    QTimer poll;
+    poll.setInterval(1);
+    QObject::connect(&poll, &QTimer::timeout, &loop, [&]() {
+        if (done)
+            loop.quit();
+    });
+    QTimer::singleShot(5000, &loop, &QEventLoop::quit);
+    poll.start();
+    loop.exec();
+}
+
+// Pushes from a worker thread, as handlers do; the GUI thread only drains
+static void fromWorker(const std::function<void()>& fn)
+{
+    std::thread worker(fn);
+    worker.join();
+}
+
+static void coalescesToTheNewest()
+{
+    UiEventPump& pump = UiEventPump::instance();
+    QObject context;
+    const uint64_t key = UiEventPump::key(&context);
+    std::vector<int> seen;
+    bool done = false;
+
+    fromWorker([&]() {
+        for (int i = 1; i <= 1000; ++i)
+            pump.postLatest(&context, key, [&seen, i]() { seen.push_back(i); });
+        pump.post(&context, [&done]() { done = true; });
+    });
+    runUntil(done);
+
+    expect("coalesce: finished", done);
+    expect("coalesce: fewer calls than posts", seen.size() < 1000);
+    expect("coalesce: newest value last", !seen.empty() && seen.back() == 1000);
+}
+
+static void keepsOrderAcrossKinds()
+{
+    UiEventPump& pump = UiEventPump::instance();
+    QObject context;
+    const uint64_t rows = UiEventPump::key(&context, 1);
+    std::string order;
+    bool done = false;
+
+    fromWorker([&]() {
+        pump.post(&context, [&order]() { order += "a"; });
+        pump.postAppend<int>(&context, rows, { 1, 2 }, [&order](std::vector<int>& items) {
+            order += "[" + std::to_string(items.size()) + "]";
+        });
+        pump.postAppend<int>(&context, rows, { 3 }, [&order](std::vector<int>& items) {
+            order += "[" + std::to_string(items.size()) + "]";
+        });
+        pump.post(&context, [&order, &done]() { order += "b"; done = true; });
+    });
+    runUntil(done);
+
+    // both appends merge into one batch, delivered before the call posted after them
+    expect("order: a, one merged batch of 3, b", order == "a[3]b");
+}
+
+static void dropsCallsForDeletedContexts()
+{
+    UiEventPump& pump = UiEventPump::instance();
+    QObject keep;
+    auto* gone = new QObject;
+    bool delivered = false;
+    bool done = false;
+
+    fromWorker([&]() {
+        pump.post(gone, [&delivered]() { delivered = true; });
+        pump.post(&keep, [&done]() { done = true; });
+    });
+    // the pump drains on a queued wake-up, so this runs first
+    delete gone;
+    runUntil(done);
+
+    expect("context: call for a deleted context dropped", done && !delivered);
+}
+
+static void finalProgressWinsOverStaleCounts()
+{
+    UiEventPump& pump = UiEventPump::instance();
+    QObject context;
+    const int total = 8;
+    const uint64_t progressKey = UiEventPump::key(&context, 0);
+    int lastDone = -1;
+    bool finished = false;
+
+    auto progress = [&](int done) {
+        pump.postLatest(&context, progressKey, [&lastDone, done]() { lastDone = done; });
+    };
+
+    // frame 1: the worker that finished last posts first
+    fromWorker([&]() { progress(total); });
+    bool firstFrame = false;
+    fromWorker([&]() { pump.post(&context, [&firstFrame]() { firstFrame = true; }); });
+    runUntil(firstFrame);
+
+    // frame 2: the slower worker's stale count lands after it, then the batch finishes
+    // the way finishDeleteBatch / finishRevokeBatch do: the final count through the same
+    // key, then the result
+    fromWorker([&]() {
+        progress(total - 1);
+        progress(total);
+        pump.post(&context, [&finished]() { finished = true; });
+    });
+    runUntil(finished);
+
+    expect("progress: batch finished", finished);
+    expect("progress: final count is the last one delivered", lastDone == total);
+}
+
+int main(int argc, char* argv[])
+{
+    QCoreApplication app(argc, argv);
+    UiEventPump::instance();    // created on the GUI thread, as main() does
+
+    coalescesToTheNewest();
+    keepsOrderAcrossKinds();
+    dropsCallsForDeletedContexts();
+    finalProgressWinsOverStaleCounts();
+
+    if (g_failures == 0)
+        std::printf("uieventpump_test: all passed\n");
+    return g_failures == 0 ? 0 : 1;
+}
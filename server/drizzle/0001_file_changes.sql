@@ -0,0 +1,15 @@
+CREATE TABLE `file_changes_table` (
+	`change_id` integer PRIMARY KEY AUTOINCREMENT NOT NULL,
+	`user_id` integer NOT NULL,
+	`file_id` integer NOT NULL,
+	`change_type` text NOT NULL,
+	`changed_at` integer DEFAULT (strftime('%s', 'now')) NOT NULL,
+	FOREIGN KEY (`user_id`) REFERENCES `users_table`(`user_id`) ON UPDATE cascade ON DELETE cascade
+);
+--> statement-breakpoint
+CREATE INDEX `fk_Changes_User_idx` ON `file_changes_table` (`user_id`,`change_id`);--> statement-breakpoint
+INSERT INTO `file_changes_table` (`user_id`, `file_id`, `change_type`)
+	SELECT `owner_user_id`, `file_id`, 'added' FROM `files_table` ORDER BY `file_id`;--> statement-breakpoint
+INSERT INTO `file_changes_table` (`user_id`, `file_id`, `change_type`)
+	SELECT `shared_with_user_id`, `file_id`, 'added' FROM `shared_access_table`
+	WHERE `shared_with_user_id` IS NOT NULL ORDER BY `access_id`;
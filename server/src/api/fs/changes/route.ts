@@ -0,0 +1,146 @@
+import { z } from "zod";
+import { BurgerRequest } from "burger-api";
+import { db } from "~/db";
+import {
+  fileChangesTable,
+  filesTable,
+  sharedAccessTable,
+  usersTable,
+} from "~/db/schema";
+import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
+import { toFileMetadataListItem } from "~/utils/FileListing";
+import type { FileChangeType } from "~/utils/ChangeFeed";
+import type { FileMetadataListItem, APIError } from "~/utils/schema";
+import { ok, err, Result } from "neverthrow";
+import { sql } from "drizzle-orm";
+
+const PAGE_SIZE = 500;
+
+export const schema = {
+  post: {
+    body: z
+      .object({
+        cursor: z.number().int().min(0).default(0),
+      })
+      .strict(),
+  },
+};
+
+interface FileChangeItem {
+  change_id: number;
+  file_id: number;
+  change_type: FileChangeType;
+  file?: FileMetadataListItem;
+}
+
+// returns the latest change per file after the cursor, oldest first
+async function getChangesSince(
+  user_id: number,
+  cursor: number
+): Promise<
+  Result<
+    { changes: FileChangeItem[]; cursor: number; hasMore: boolean },
+    APIError
+  >
+> {
+  try {
+    // collapse repeated changes to one row per file, keyed by its newest change_id,
+    // so the page boundary is always a valid resume point
+    const query = sql`
+      SELECT
+        c.change_id,
+        c.file_id,
+        c.change_type,
+        f.metadata,
+        f.pre_quantum_signature,
+        f.post_quantum_signature,
+        CASE WHEN f.owner_user_id = ${user_id} THEN 1 ELSE 0 END as is_owner,
+        u.username as owner_username,
+        sa.encrypted_fek,
+        sa.encrypted_fek_nonce,
+        sa.encrypted_mek,
+        sa.encrypted_mek_nonce,
+        sa.ephemeral_public_key,
+        sa.file_content_nonce,
+        sa.metadata_nonce
+      FROM (
+        SELECT file_id, MAX(change_id) as change_id
+        FROM ${fileChangesTable}
+        WHERE user_id = ${user_id} AND change_id > ${cursor}
+        GROUP BY file_id
+        ORDER BY change_id
+        LIMIT ${PAGE_SIZE + 1}
+      ) latest
+      INNER JOIN ${fileChangesTable} c ON c.change_id = latest.change_id
+      LEFT JOIN ${filesTable} f ON f.file_id = c.file_id
+        AND c.change_type IN ('added', 'changed')
+      LEFT JOIN ${usersTable} u ON u.user_id = f.owner_user_id
+      LEFT JOIN ${sharedAccessTable} sa ON sa.file_id = f.file_id
+        AND sa.shared_with_user_id = ${user_id}
+      ORDER BY c.change_id
+    `;
+
+    const results = await db.all(query);
+    const hasMore = results.length > PAGE_SIZE;
+    const rows = hasMore ? results.slice(0, PAGE_SIZE) : results;
+
+    const changes: FileChangeItem[] = rows.map((row: any) => {
+      const item: FileChangeItem = {
+        change_id: row.change_id,
+        file_id: row.file_id,
+        change_type: row.change_type,
+      };
+
+      if (row.change_type === "added" || row.change_type === "changed") {
+        // the file or share vanished without a recorded change; report it gone
+        if (row.metadata === null || (!row.is_owner && !row.encrypted_fek)) {
+          item.change_type = "deleted";
+        } else {
+          item.file = toFileMetadataListItem(row);
+        }
+      }
+
+      return item;
+    });
+
+    const lastChange = changes[changes.length - 1];
+    return ok({
+      changes,
+      cursor: lastChange ? lastChange.change_id : cursor,
+      hasMore,
+    });
+  } catch (error) {
+    return err({ message: "Internal Server Error", status: 500 });
+  }
+}
+
+export async function POST(
+  req: BurgerRequest<{ body: z.infer<typeof schema.post.body> }>
+) {
+  if (!req.validated?.body) {
+    return Response.json({ message: "Internal Server Error" }, { status: 500 });
+  }
+
+  // authenticate user
+  const { cursor } = req.validated.body;
+  const userResult = await getAuthenticatedUserFromRequest(
+    req,
+    JSON.stringify(req.validated.body)
+  );
+  if (userResult.isErr()) {
+    return Response.json({ message: "Unauthorized" }, { status: 401 });
+  }
+
+  // get changes after the client's cursor
+  const user = userResult.value;
+  const changesResult = await getChangesSince(user.user_id, cursor);
+  if (changesResult.isErr()) {
+    const apiError = changesResult.error;
+    return Response.json(
+      { message: apiError.message },
+      { status: apiError.status }
+    );
+  }
+
+  return Response.json(changesResult.value, { status: 200 });
+}
@@ -1,9 +1,14 @@
 import { z } from "zod";
 import { BurgerRequest } from "burger-api";
 import { db } from "~/db";
-import { filesTable } from "~/db/schema";
+import { filesTable, sharedAccessTable } from "~/db/schema";
 import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
 import type { APIError } from "~/utils/schema";
+import {
+  recordFileChanges,
+  publishFileChanges,
+  type FileChange,
+} from "~/utils/ChangeFeed";
 import { ok, err, Result } from "neverthrow";
 import { eq } from "drizzle-orm";
 import { existsSync, unlinkSync } from "node:fs";
@@ -50,19 +55,47 @@ async function getStoragePathAndVerifyFileOwnership(
   }
 }
 
+// deletes the file record (shares cascade) and tells the owner and every sharee it is gone
 async function deleteFileRecord(
-  file_id: number
+  file_id: number,
+  owner_user_id: number
 ): Promise<Result<void, APIError>> {
   try {
-    const result = await db
-      .delete(filesTable)
-      .where(eq(filesTable.file_id, file_id))
-      .returning({ file_id: filesTable.file_id });
-
-    if (result.length === 0) {
-      return err({ message: "Internal Server Error", status: 500 });
-    }
-
+    let changes: FileChange[] = [];
+    await db.transaction(async (tx) => {
+      // collect sharees before the cascade removes their access rows
+      const sharees = await tx
+        .select({ user_id: sharedAccessTable.shared_with_user_id })
+        .from(sharedAccessTable)
+        .where(eq(sharedAccessTable.file_id, file_id));
+
+      const result = await tx
+        .delete(filesTable)
+        .where(eq(filesTable.file_id, file_id))
+        .returning({ file_id: filesTable.file_id });
+
+      if (result.length === 0) {
+        tx.rollback();
+      }
+
+      const recipients = [
+        owner_user_id,
+        ...sharees
+          .map((row) => row.user_id)
+          .filter((user_id): user_id is number => user_id !== null),
+      ];
+      changes = recipients.map((user_id) => ({
+        user_id,
+        file_id,
+        change_type: "deleted" as const,
+      }));
+      const changeResult = await recordFileChanges(changes, tx);
+      if (changeResult.isErr()) {
+        tx.rollback();
+      }
+    });
+
+    publishFileChanges(changes);
     return ok();
   } catch (error) {
     return err({ message: "Internal Server Error", status: 500 });
@@ -120,7 +153,7 @@ export async function POST(
   const { storage_path } = ownershipResult.value;
 
   // delete the file record from database
-  const deleteFileResult = await deleteFileRecord(file_id);
+  const deleteFileResult = await deleteFileRecord(file_id, user.user_id);
   if (deleteFileResult.isErr()) {
     const apiError = deleteFileResult.error;
     return Response.json(
@@ -0,0 +1,120 @@
+import { z } from "zod";
+import { BurgerRequest } from "burger-api";
+import { db } from "~/db";
+import { fileChangesTable } from "~/db/schema";
+import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
+import { subscribeFileChanges } from "~/utils/ChangeFeed";
+import type { APIError } from "~/utils/schema";
+import { ok, err, Result } from "neverthrow";
+import { eq, max } from "drizzle-orm";
+
+// Bun drops connections idle for 10s, so the stream pings well inside that
+const HEARTBEAT_MS = 5_000;
+
+export const schema = {
+  post: {
+    body: z
+      .object({
+        cursor: z.number().int().min(0).default(0),
+      })
+      .strict(),
+  },
+};
+
+// newest change_id on the user's feed, 0 if the feed is empty
+async function getLatestChangeId(
+  user_id: number
+): Promise<Result<number, APIError>> {
+  try {
+    const row = await db
+      .select({ latest: max(fileChangesTable.change_id) })
+      .from(fileChangesTable)
+      .where(eq(fileChangesTable.user_id, user_id))
+      .then((rows) => rows[0]);
+
+    return ok(row?.latest ?? 0);
+  } catch (error) {
+    return err({ message: "Internal Server Error", status: 500 });
+  }
+}
+
+function formatEvent(event: string, data: unknown): string {
+  return `event: ${event}\ndata: ${JSON.stringify(data)}\n\n`;
+}
+
+// Server-sent events telling the client its change feed moved. Events only carry
+// file ids and change types; the client pulls the rows from /api/fs/changes.
+export async function POST(
+  req: BurgerRequest<{ body: z.infer<typeof schema.post.body> }>
+) {
+  if (!req.validated?.body) {
+    return Response.json({ message: "Internal Server Error" }, { status: 500 });
+  }
+
+  // authenticate user
+  const { cursor } = req.validated.body;
+  const userResult = await getAuthenticatedUserFromRequest(
+    req,
+    JSON.stringify(req.validated.body)
+  );
+  if (userResult.isErr()) {
+    return Response.json({ message: "Unauthorized" }, { status: 401 });
+  }
+
+  const user = userResult.value;
+  const encoder = new TextEncoder();
+  let cleanup = () => {};
+
+  const stream = new ReadableStream<Uint8Array>({
+    async start(controller) {
+      const send = (chunk: string) => {
+        try {
+          controller.enqueue(encoder.encode(chunk));
+        } catch {
+          // the client went away between writes
+          cleanup();
+        }
+      };
+
+      // subscribe before reading the feed head, so nothing committed in between is missed
+      const unsubscribe = subscribeFileChanges(user.user_id, (changes) =>
+        send(
+          formatEvent("changes", {
+            changes: changes.map(({ file_id, change_type }) => ({
+              file_id,
+              change_type,
+            })),
+          })
+        )
+      );
+      const heartbeat = setInterval(() => send(": ping\n\n"), HEARTBEAT_MS);
+      cleanup = () => {
+        clearInterval(heartbeat);
+        unsubscribe();
+      };
+
+      // "ready" says whether the client missed changes while it was disconnected;
+      // if the head can't be read, assume it did
+      const latestResult = await getLatestChangeId(user.user_id);
+      const latest = latestResult.unwrapOr(Number.MAX_SAFE_INTEGER);
+      send(
+        formatEvent("ready", {
+          cursor: latestResult.isOk() ? latest : cursor,
+          behind: latest > cursor,
+        })
+      );
+    },
+    cancel() {
+      cleanup();
+    },
+  });
+
+  return new Response(stream, {
+    status: 200,
+    headers: {
+      "Content-Type": "text/event-stream",
+      "Cache-Control": "no-cache",
+      Connection: "keep-alive",
+    },
+  });
+}
@@ -3,6 +3,7 @@ import { BurgerRequest } from "burger-api";
 import { db } from "~/db";
 import { filesTable, sharedAccessTable, usersTable } from "~/db/schema";
 import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
+import { toFileMetadataListItem } from "~/utils/FileListing";
 import type { FileMetadataListItem, APIError } from "~/utils/schema";
 import { ok, err, Result } from "neverthrow";
 import { sql } from "drizzle-orm";
@@ -81,43 +82,7 @@ async function getAccessibleFiles(
     const files = hasNextPage ? results.slice(0, PAGE_SIZE) : results;
 
     // format response
-    const fileList: FileMetadataListItem[] = files.map((row: any) => {
-      const baseFile: FileMetadataListItem = {
-        file_id: row.file_id,
-        metadata: Buffer.from(row.metadata).toString("base64"),
-        pre_quantum_signature: Buffer.from(row.pre_quantum_signature).toString(
-          "base64"
-        ),
-        post_quantum_signature: Buffer.from(
-          row.post_quantum_signature
-        ).toString("base64"),
-        is_owner: Boolean(row.is_owner),
-        owner_username: row.owner_username,
-      };
-
-      // Add shared access data if this is a shared file
-      if (!row.is_owner && row.encrypted_fek) {
-        baseFile.shared_access = {
-          encrypted_fek: Buffer.from(row.encrypted_fek).toString("base64"),
-          encrypted_fek_nonce: Buffer.from(row.encrypted_fek_nonce).toString(
-            "base64"
-          ),
-          encrypted_mek: Buffer.from(row.encrypted_mek).toString("base64"),
-          encrypted_mek_nonce: Buffer.from(row.encrypted_mek_nonce).toString(
-            "base64"
-          ),
-          ephemeral_public_key: Buffer.from(row.ephemeral_public_key).toString(
-            "base64"
-          ),
-          file_content_nonce: Buffer.from(row.file_content_nonce).toString(
-            "base64"
-          ),
-          metadata_nonce: Buffer.from(row.metadata_nonce).toString("base64"),
-        };
-      }
-
-      return baseFile;
-    });
+    const fileList: FileMetadataListItem[] = files.map(toFileMetadataListItem);
 
     return ok({ files: fileList, hasNextPage });
   } catch (error) {
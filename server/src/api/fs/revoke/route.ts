@@ -4,6 +4,7 @@ import { db } from "~/db";
 import { sharedAccessTable, filesTable, usersTable } from "~/db/schema";
 import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
 import { Username, type APIError } from "~/utils/schema";
+import { recordFileChanges, publishFileChanges } from "~/utils/ChangeFeed";
 import { ok, err, Result } from "neverthrow";
 import { eq, and } from "drizzle-orm";
 
@@ -91,28 +92,41 @@ async function findShareRecord(
   }
 }
 
-// deletes the share record for the given owner, shared user, and file
+// deletes the share record and tells the former recipient the file is gone
 async function deleteShareRecord(
   owner_user_id: number,
   shared_with_user_id: number,
   file_id: number
 ): Promise<Result<void, APIError>> {
   try {
-    const result = await db
-      .delete(sharedAccessTable)
-      .where(
-        and(
-          eq(sharedAccessTable.owner_user_id, owner_user_id),
-          eq(sharedAccessTable.shared_with_user_id, shared_with_user_id),
-          eq(sharedAccessTable.file_id, file_id)
+    await db.transaction(async (tx) => {
+      const result = await tx
+        .delete(sharedAccessTable)
+        .where(
+          and(
+            eq(sharedAccessTable.owner_user_id, owner_user_id),
+            eq(sharedAccessTable.shared_with_user_id, shared_with_user_id),
+            eq(sharedAccessTable.file_id, file_id)
+          )
         )
-      )
-      .returning({ access_id: sharedAccessTable.access_id });
-
-    if (result.length === 0) {
-      return err({ message: "Internal Server Error", status: 500 });
-    }
-
+        .returning({ access_id: sharedAccessTable.access_id });
+
+      if (result.length === 0) {
+        tx.rollback();
+      }
+
+      const changeResult = await recordFileChanges(
+        [{ user_id: shared_with_user_id, file_id, change_type: "unshared" }],
+        tx
+      );
+      if (changeResult.isErr()) {
+        tx.rollback();
+      }
+    });
+
+    publishFileChanges([
+      { user_id: shared_with_user_id, file_id, change_type: "unshared" },
+    ]);
     return ok();
   } catch (error) {
     return err({ message: "Internal Server Error", status: 500 });
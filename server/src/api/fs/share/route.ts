@@ -4,6 +4,7 @@ import { db } from "~/db";
 import { sharedAccessTable, filesTable, usersTable } from "~/db/schema";
 import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
 import { Username, Base64String, type APIError } from "~/utils/schema";
+import { recordFileChanges, publishFileChanges } from "~/utils/ChangeFeed";
 import { ok, err, Result } from "neverthrow";
 import { eq, and } from "drizzle-orm";
 
@@ -101,7 +102,7 @@ async function checkExistingShare(
   }
 }
 
-// creates a new share record in the database
+// creates a new share record and announces the file on the recipient's change feed
 async function createShareRecord(
   owner_user_id: number,
   shared_with_user_id: number,
@@ -117,36 +118,53 @@ async function createShareRecord(
   }
 ): Promise<Result<number, APIError>> {
   try {
-    const result = await db
-      .insert(sharedAccessTable)
-      .values({
-        owner_user_id,
-        shared_with_user_id,
-        file_id,
-        file_content_nonce: Buffer.from(shareData.file_content_nonce, "base64"),
-        metadata_nonce: Buffer.from(shareData.metadata_nonce, "base64"),
-        encrypted_fek: Buffer.from(shareData.encrypted_fek, "base64"),
-        encrypted_fek_nonce: Buffer.from(
-          shareData.encrypted_fek_nonce,
-          "base64"
-        ),
-        encrypted_mek: Buffer.from(shareData.encrypted_mek, "base64"),
-        encrypted_mek_nonce: Buffer.from(
-          shareData.encrypted_mek_nonce,
-          "base64"
-        ),
-        ephemeral_public_key: Buffer.from(
-          shareData.ephemeral_public_key,
-          "base64"
-        ),
-      })
-      .returning({ access_id: sharedAccessTable.access_id })
-      .then((rows) => rows[0]);
-    if (!result) {
-      return err({ message: "Internal Server Error", status: 500 });
-    }
+    const access_id = await db.transaction(async (tx) => {
+      const [inserted] = await tx
+        .insert(sharedAccessTable)
+        .values({
+          owner_user_id,
+          shared_with_user_id,
+          file_id,
+          file_content_nonce: Buffer.from(
+            shareData.file_content_nonce,
+            "base64"
+          ),
+          metadata_nonce: Buffer.from(shareData.metadata_nonce, "base64"),
+          encrypted_fek: Buffer.from(shareData.encrypted_fek, "base64"),
+          encrypted_fek_nonce: Buffer.from(
+            shareData.encrypted_fek_nonce,
+            "base64"
+          ),
+          encrypted_mek: Buffer.from(shareData.encrypted_mek, "base64"),
+          encrypted_mek_nonce: Buffer.from(
+            shareData.encrypted_mek_nonce,
+            "base64"
+          ),
+          ephemeral_public_key: Buffer.from(
+            shareData.ephemeral_public_key,
+            "base64"
+          ),
+        })
+        .returning({ access_id: sharedAccessTable.access_id });
+      if (!inserted) {
+        tx.rollback();
+      }
+
+      const changeResult = await recordFileChanges(
+        [{ user_id: shared_with_user_id, file_id, change_type: "added" }],
+        tx
+      );
+      if (changeResult.isErr()) {
+        tx.rollback();
+      }
+
+      return inserted.access_id;
+    });
 
-    return ok(result.access_id);
+    publishFileChanges([
+      { user_id: shared_with_user_id, file_id, change_type: "added" },
+    ]);
+    return ok(access_id);
   } catch (error) {
     return err({ message: "Internal Server Error", status: 500 });
   }
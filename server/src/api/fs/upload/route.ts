@@ -7,6 +7,7 @@ import { ml_dsa87 } from "@noble/post-quantum/ml-dsa";
 import { getAuthenticatedUserFromRequest } from "~/utils/crypto/NetworkingHelper";
 import { deserializeKeyBundlePublic } from "~/utils/crypto/KeyHelper";
 import { createFileSignature } from "~/utils/crypto/FileEncryption";
+import { recordFileChanges, publishFileChanges } from "~/utils/ChangeFeed";
 import { ok, err, Result } from "neverthrow";
 import { existsSync, writeFileSync, mkdirSync, unlinkSync } from "node:fs";
 import { join, dirname } from "node:path";
@@ -123,7 +124,7 @@ function verifyFileSignatures(
   }
 }
 
-// inserts a new file record into the database
+// inserts a new file record into the database and announces it on the owner's change feed
 async function insertFileRecord(
   user_id: number,
   storage_path: string,
@@ -134,22 +135,36 @@ async function insertFileRecord(
   try {
     const metadataBuffer = Buffer.from(metadata_payload, "base64");
 
-    const result = await db
-      .insert(filesTable)
-      .values({
-        owner_user_id: user_id,
-        storage_path,
-        metadata: metadataBuffer,
-        pre_quantum_signature: Buffer.from(pre_quantum_signature, "base64"),
-        post_quantum_signature: Buffer.from(post_quantum_signature, "base64"),
-      })
-      .returning({ file_id: filesTable.file_id });
-
-    if (!result[0]) {
-      return err({ message: "Internal Server Error", status: 500 });
-    }
-
-    return ok(result[0].file_id);
+    // the file row and its change entry commit together; rollback() throws into the catch below
+    const file_id = await db.transaction(async (tx) => {
+      const [inserted] = await tx
+        .insert(filesTable)
+        .values({
+          owner_user_id: user_id,
+          storage_path,
+          metadata: metadataBuffer,
+          pre_quantum_signature: Buffer.from(pre_quantum_signature, "base64"),
+          post_quantum_signature: Buffer.from(post_quantum_signature, "base64"),
+        })
+        .returning({ file_id: filesTable.file_id });
+
+      if (!inserted) {
+        tx.rollback();
+      }
+
+      const changeResult = await recordFileChanges(
+        [{ user_id, file_id: inserted.file_id, change_type: "added" }],
+        tx
+      );
+      if (changeResult.isErr()) {
+        tx.rollback();
+      }
+
+      return inserted.file_id;
+    });
+
+    publishFileChanges([{ user_id, file_id, change_type: "added" }]);
+    return ok(file_id);
   } catch (error) {
     return err({ message: "Internal Server Error", status: 500 });
   }
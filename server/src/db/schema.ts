@@ -121,3 +121,34 @@ export const sharedAccessTable = sqliteTable(
     shareeIdx: index("fk_UFA_Sharee_idx").on(table.shared_with_user_id),
   })
 );
+
+// append-only per-user change feed; clients sync listings from a cursor
+export const fileChangesTable = sqliteTable(
+  "file_changes_table",
+  {
+    change_id: integer("change_id").primaryKey({ autoIncrement: true }),
+    user_id: integer("user_id")
+      .notNull()
+      .references(() => usersTable.user_id, {
+        onDelete: "cascade",
+        onUpdate: "cascade",
+      }),
+
+    // not a foreign key: "deleted" rows must outlive the file they describe
+    file_id: integer("file_id").notNull(),
+
+    change_type: text("change_type", {
+      enum: ["added", "changed", "unshared", "deleted"],
+    }).notNull(),
+
+    changed_at: integer("changed_at", { mode: "timestamp" })
+      .notNull()
+      .default(sql`(strftime('%s', 'now'))`),
+  },
+  (table) => ({
+    userChangeIdx: index("fk_Changes_User_idx").on(
+      table.user_id,
+      table.change_id
+    ),
+  })
+);
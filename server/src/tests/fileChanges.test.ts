@@ -0,0 +1,180 @@
+import { expect, test, describe } from "bun:test";
+import { getTestHarness, TestData, TestScenarios } from "./setup";
+
+describe("File Changes API", () => {
+  const harness = getTestHarness();
+
+  test("empty change feed", async () => {
+    await harness.createUser("testuser");
+
+    const response = await harness.listChanges("testuser");
+    harness.expectSuccessfulResponse(response);
+
+    const responseData = (await response.json()) as any;
+    expect(responseData.changes).toEqual([]);
+    expect(responseData.cursor).toBe(0);
+    expect(responseData.hasMore).toBe(false);
+  });
+
+  test("uploaded file appears as added with listing data", async () => {
+    await harness.createUser("testuser");
+
+    const uploadResult = await harness.uploadFile(
+      "testuser",
+      TestData.simpleFile.content,
+      TestData.simpleFile.metadata
+    );
+
+    const response = await harness.listChanges("testuser");
+    harness.expectSuccessfulResponse(response);
+
+    const responseData = (await response.json()) as any;
+    expect(responseData.changes).toHaveLength(1);
+    expect(responseData.hasMore).toBe(false);
+
+    const change = responseData.changes[0];
+    expect(change.file_id).toBe(uploadResult.file_id);
+    expect(change.change_type).toBe("added");
+    expect(change.file.is_owner).toBe(true);
+    expect(change.file.owner_username).toBe("testuser");
+    expect(responseData.cursor).toBe(change.change_id);
+
+    const decryptedMetadata = harness.decryptMetadata(
+      change.file.metadata,
+      uploadResult.test_data.client_data
+    );
+    expect(decryptedMetadata.name).toBe(TestData.simpleFile.metadata.name);
+  });
+
+  test("no changes since cursor returns nothing", async () => {
+    await TestScenarios.createUserWithMultipleFiles(harness, "testuser", 3);
+
+    const firstResponse = await harness.listChanges("testuser");
+    const firstData = (await firstResponse.json()) as any;
+    expect(firstData.changes).toHaveLength(3);
+
+    const secondResponse = await harness.listChanges(
+      "testuser",
+      firstData.cursor
+    );
+    harness.expectSuccessfulResponse(secondResponse);
+
+    const secondData = (await secondResponse.json()) as any;
+    expect(secondData.changes).toEqual([]);
+    expect(secondData.cursor).toBe(firstData.cursor);
+    expect(secondData.hasMore).toBe(false);
+  });
+
+  test("only changes after the cursor are returned", async () => {
+    await harness.createUser("testuser");
+    await harness.uploadFile("testuser");
+
+    const firstResponse = await harness.listChanges("testuser");
+    const firstData = (await firstResponse.json()) as any;
+
+    const secondUpload = await harness.uploadFile("testuser");
+    const secondResponse = await harness.listChanges(
+      "testuser",
+      firstData.cursor
+    );
+    const secondData = (await secondResponse.json()) as any;
+    expect(secondData.changes).toHaveLength(1);
+    expect(secondData.changes[0].file_id).toBe(secondUpload.file_id);
+    expect(secondData.cursor).toBeGreaterThan(firstData.cursor);
+  });
+
+  test("share and revoke reach the recipient's feed", async () => {
+    const { userA, uploadResult, shareResponse } =
+      await TestScenarios.createTwoUsersWithSharedFile(harness);
+    harness.expectSuccessfulResponse(shareResponse, 201);
+
+    const sharedResponse = await harness.listChanges("userB");
+    const sharedData = (await sharedResponse.json()) as any;
+    expect(sharedData.changes).toHaveLength(1);
+    expect(sharedData.changes[0].change_type).toBe("added");
+    expect(sharedData.changes[0].file.is_owner).toBe(false);
+    expect(sharedData.changes[0].file.owner_username).toBe(
+      userA.dbUser.username
+    );
+    expect(sharedData.changes[0].file.shared_access).toBeDefined();
+
+    const revokeResponse = await harness.revokeFile(
+      "userA",
+      "userB",
+      uploadResult.file_id
+    );
+    harness.expectSuccessfulResponse(revokeResponse, 200);
+
+    const revokedResponse = await harness.listChanges(
+      "userB",
+      sharedData.cursor
+    );
+    const revokedData = (await revokedResponse.json()) as any;
+    expect(revokedData.changes).toHaveLength(1);
+    expect(revokedData.changes[0].file_id).toBe(uploadResult.file_id);
+    expect(revokedData.changes[0].change_type).toBe("unshared");
+    expect(revokedData.changes[0].file).toBeUndefined();
+
+    // the owner's feed is untouched by sharing
+    const ownerResponse = await harness.listChanges("userA");
+    const ownerData = (await ownerResponse.json()) as any;
+    expect(ownerData.changes).toHaveLength(1);
+    expect(ownerData.changes[0].change_type).toBe("added");
+  });
+
+  test("delete reaches owner and sharees", async () => {
+    const { uploadResult } =
+      await TestScenarios.createTwoUsersWithSharedFile(harness);
+
+    const ownerBefore = (await (
+      await harness.listChanges("userA")
+    ).json()) as any;
+    const shareeBefore = (await (
+      await harness.listChanges("userB")
+    ).json()) as any;
+
+    const deleteResponse = await harness.deleteFile(
+      "userA",
+      uploadResult.file_id
+    );
+    harness.expectSuccessfulResponse(deleteResponse, 200);
+
+    for (const [username, before] of [
+      ["userA", ownerBefore],
+      ["userB", shareeBefore],
+    ] as const) {
+      const response = await harness.listChanges(username, before.cursor);
+      const data = (await response.json()) as any;
+      expect(data.changes).toHaveLength(1);
+      expect(data.changes[0].file_id).toBe(uploadResult.file_id);
+      expect(data.changes[0].change_type).toBe("deleted");
+      expect(data.changes[0].file).toBeUndefined();
+    }
+  });
+
+  test("repeated changes collapse to the latest per file", async () => {
+    const { uploadResult } =
+      await TestScenarios.createTwoUsersWithSharedFile(harness);
+
+    await harness.revokeFile("userA", "userB", uploadResult.file_id);
+
+    // from a fresh cursor, userB only needs to know the file is not visible
+    const response = await harness.listChanges("userB");
+    const data = (await response.json()) as any;
+    expect(data.changes).toHaveLength(1);
+    expect(data.changes[0].change_type).toBe("unshared");
+  });
+
+  test("unauthorized request is rejected", async () => {
+    await harness.createUser("testuser");
+    await harness.createUser("otheruser");
+
+    const response = await harness.fileHelper.makeAuthenticatedRequest(
+      "/api/fs/changes",
+      { cursor: 0 },
+      harness.getUser("testuser"),
+      "otheruser"
+    );
+    harness.expectUnauthorized(response);
+  });
+});
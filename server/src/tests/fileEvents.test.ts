@@ -0,0 +1,156 @@
+import { expect, test, describe } from "bun:test";
+import { getTestHarness, TestData } from "./setup";
+
+interface StreamEvent {
+  event: string;
+  data: any;
+}
+
+// reads the next non-heartbeat event off an SSE response, failing after timeoutMs
+async function nextEvent(
+  reader: ReadableStreamDefaultReader<Uint8Array>,
+  buffer: { text: string },
+  timeoutMs = 1000
+): Promise<StreamEvent> {
+  const decoder = new TextDecoder();
+  const deadline = Date.now() + timeoutMs;
+
+  while (true) {
+    const end = buffer.text.indexOf("\n\n");
+    if (end !== -1) {
+      const block = buffer.text.slice(0, end);
+      buffer.text = buffer.text.slice(end + 2);
+
+      let event = "message";
+      let data = "";
+      for (const line of block.split("\n")) {
+        if (line.startsWith("event: ")) event = line.slice(7);
+        else if (line.startsWith("data: ")) data += line.slice(6);
+      }
+      if (data === "") continue; // heartbeat comment
+      return { event, data: JSON.parse(data) };
+    }
+
+    const remaining = deadline - Date.now();
+    if (remaining <= 0) throw new Error("timed out waiting for event");
+    const chunk = await Promise.race([
+      reader.read(),
+      new Promise<never>((_, reject) =>
+        setTimeout(() => reject(new Error("timed out waiting for event")), remaining)
+      ),
+    ]);
+    if (chunk.done) throw new Error("stream closed");
+    buffer.text += decoder.decode(chunk.value, { stream: true });
+  }
+}
+
+describe("File Events API", () => {
+  const harness = getTestHarness();
+
+  test("stream opens with a ready event", async () => {
+    await harness.createUser("testuser");
+
+    const response = await harness.openEvents("testuser");
+    harness.expectSuccessfulResponse(response);
+    expect(response.headers.get("Content-Type")).toContain("text/event-stream");
+
+    const reader = response.body!.getReader();
+    const ready = await nextEvent(reader, { text: "" });
+    expect(ready.event).toBe("ready");
+    expect(ready.data.cursor).toBe(0);
+    expect(ready.data.behind).toBe(false);
+    await reader.cancel();
+  });
+
+  test("ready reports changes missed while disconnected", async () => {
+    await harness.createUser("testuser");
+    await harness.uploadFile("testuser");
+
+    const response = await harness.openEvents("testuser", 0);
+    const reader = response.body!.getReader();
+    const ready = await nextEvent(reader, { text: "" });
+    expect(ready.event).toBe("ready");
+    expect(ready.data.behind).toBe(true);
+    expect(ready.data.cursor).toBeGreaterThan(0);
+    await reader.cancel();
+
+    // reconnecting at the head is not behind
+    const caughtUp = await harness.openEvents("testuser", ready.data.cursor);
+    const caughtUpReader = caughtUp.body!.getReader();
+    const caughtUpReady = await nextEvent(caughtUpReader, { text: "" });
+    expect(caughtUpReady.data.behind).toBe(false);
+    await caughtUpReader.cancel();
+  });
+
+  test("share is pushed to the recipient", async () => {
+    await harness.createUser("userA");
+    await harness.createUser("userB");
+    const uploadResult = await harness.uploadFile(
+      "userA",
+      TestData.simpleFile.content,
+      TestData.simpleFile.metadata
+    );
+
+    const response = await harness.openEvents("userB");
+    const reader = response.body!.getReader();
+    const buffer = { text: "" };
+    expect((await nextEvent(reader, buffer)).event).toBe("ready");
+
+    const shareResponse = await harness.shareFile(
+      "userA",
+      "userB",
+      uploadResult.file_id,
+      uploadResult.test_data.client_data.fek,
+      uploadResult.test_data.client_data.mek,
+      uploadResult.test_data.client_data.fileNonce,
+      uploadResult.test_data.client_data.metadataNonce
+    );
+    harness.expectSuccessfulResponse(shareResponse, 201);
+
+    const pushed = await nextEvent(reader, buffer);
+    expect(pushed.event).toBe("changes");
+    expect(pushed.data.changes).toEqual([
+      { file_id: uploadResult.file_id, change_type: "added" },
+    ]);
+
+    const revokeResponse = await harness.revokeFile(
+      "userA",
+      "userB",
+      uploadResult.file_id
+    );
+    harness.expectSuccessfulResponse(revokeResponse, 200);
+
+    const revoked = await nextEvent(reader, buffer);
+    expect(revoked.data.changes).toEqual([
+      { file_id: uploadResult.file_id, change_type: "unshared" },
+    ]);
+    await reader.cancel();
+  });
+
+  test("other users' changes are not pushed", async () => {
+    await harness.createUser("userA");
+    await harness.createUser("userB");
+
+    const response = await harness.openEvents("userB");
+    const reader = response.body!.getReader();
+    const buffer = { text: "" };
+    expect((await nextEvent(reader, buffer)).event).toBe("ready");
+
+    await harness.uploadFile("userA");
+    await expect(nextEvent(reader, buffer, 300)).rejects.toThrow("timed out");
+    await reader.cancel();
+  });
+
+  test("unauthorized request is rejected", async () => {
+    await harness.createUser("testuser");
+    await harness.createUser("otheruser");
+
+    const response = await harness.fileHelper.makeAuthenticatedRequest(
+      "/api/fs/events",
+      { cursor: 0 },
+      harness.getUser("testuser"),
+      "otheruser"
+    );
+    harness.expectUnauthorized(response);
+  });
+});
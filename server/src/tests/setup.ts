@@ -21,7 +21,12 @@ import {
   generateKeyBundle,
   serializeKeyBundlePublic,
 } from "~/utils/crypto/KeyHelper";
-import { usersTable, filesTable, sharedAccessTable } from "~/db/schema";
+import {
+  usersTable,
+  filesTable,
+  sharedAccessTable,
+  fileChangesTable,
+} from "~/db/schema";
 import { rmSync, existsSync } from "node:fs";
 import { eq } from "drizzle-orm";
 import { mock } from "bun:test";
@@ -210,6 +215,24 @@ class TestFileHelper {
     return await this.makeAuthenticatedRequest("/api/fs/list", listBody, user);
   }
 
+  async listChanges(user: TestUserData, cursor = 0): Promise<Response> {
+    const changesBody = { cursor };
+    return await this.makeAuthenticatedRequest(
+      "/api/fs/changes",
+      changesBody,
+      user
+    );
+  }
+
+  async openEvents(user: TestUserData, cursor = 0): Promise<Response> {
+    const eventsBody = { cursor };
+    return await this.makeAuthenticatedRequest(
+      "/api/fs/events",
+      eventsBody,
+      user
+    );
+  }
+
   async deleteFile(file_id: number, user: TestUserData): Promise<Response> {
     const deleteBody = { file_id };
     return await this.makeAuthenticatedRequest(
@@ -553,6 +576,7 @@ class TestEnvironment {
   }
 
   async cleanupDatabase(): Promise<void> {
+    await testDb.delete(fileChangesTable);
     await testDb.delete(sharedAccessTable);
     await testDb.delete(filesTable);
     await testDb.delete(usersTable);
@@ -643,6 +667,16 @@ export class TestHarness {
     return await this._fileHelper.listFiles(user, page);
   }
 
+  async listChanges(username: string, cursor = 0): Promise<Response> {
+    const user = this.getUser(username);
+    return await this._fileHelper.listChanges(user, cursor);
+  }
+
+  async openEvents(username: string, cursor = 0): Promise<Response> {
+    const user = this.getUser(username);
+    return await this._fileHelper.openEvents(user, cursor);
+  }
+
   async shareFile(
     ownerUsername: string,
     recipientUsername: string,
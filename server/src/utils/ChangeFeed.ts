@@ -0,0 +1,77 @@
+import { db } from "~/db";
+import { fileChangesTable } from "~/db/schema";
+import type { APIError } from "~/utils/schema";
+import { ok, err, Result } from "neverthrow";
+
+export type FileChangeType = "added" | "changed" | "unshared" | "deleted";
+
+// db or an open transaction, so changes commit together with the write they describe
+type DbExecutor = Pick<typeof db, "insert">;
+
+export interface FileChange {
+  user_id: number;
+  file_id: number;
+  change_type: FileChangeType;
+}
+
+// appends entries to the per-user change feed read by /api/fs/changes
+export async function recordFileChanges(
+  changes: FileChange[],
+  executor: DbExecutor = db
+): Promise<Result<void, APIError>> {
+  if (changes.length === 0) {
+    return ok();
+  }
+
+  try {
+    await executor.insert(fileChangesTable).values(changes);
+    return ok();
+  } catch (error) {
+    return err({ message: "Internal Server Error", status: 500 });
+  }
+}
+
+// in-process fan-out to open /api/fs/events streams, keyed by user_id
+type FileChangeListener = (changes: FileChange[]) => void;
+const listeners = new Map<number, Set<FileChangeListener>>();
+
+// registers a listener for one user's changes; returns the unsubscribe function
+export function subscribeFileChanges(
+  user_id: number,
+  listener: FileChangeListener
+): () => void {
+  let userListeners = listeners.get(user_id);
+  if (!userListeners) {
+    userListeners = new Set();
+    listeners.set(user_id, userListeners);
+  }
+  userListeners.add(listener);
+
+  return () => {
+    userListeners.delete(listener);
+    if (userListeners.size === 0) {
+      listeners.delete(user_id);
+    }
+  };
+}
+
+// wakes subscribers; call only once the transaction that recorded the changes has committed
+export function publishFileChanges(changes: FileChange[]): void {
+  const byUser = new Map<number, FileChange[]>();
+  for (const change of changes) {
+    const userChanges = byUser.get(change.user_id) ?? [];
+    userChanges.push(change);
+    byUser.set(change.user_id, userChanges);
+  }
+
+  for (const [user_id, userChanges] of byUser) {
+    for (const listener of listeners.get(user_id) ?? []) {
+      try {
+        listener(userChanges);
+      } catch (error) {
+        // a broken stream must not fail the write that triggered it
+        console.error("File change listener failed:", error);
+      }
+    }
+  }
+}
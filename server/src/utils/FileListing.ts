@@ -0,0 +1,40 @@
+import type { FileMetadataListItem } from "~/utils/schema";
+
+// converts a raw listing row (files joined with owner and optional share) into the transport shape
+export function toFileMetadataListItem(row: any): FileMetadataListItem {
+  const baseFile: FileMetadataListItem = {
+    file_id: row.file_id,
+    metadata: Buffer.from(row.metadata).toString("base64"),
+    pre_quantum_signature: Buffer.from(row.pre_quantum_signature).toString(
+      "base64"
+    ),
+    post_quantum_signature: Buffer.from(row.post_quantum_signature).toString(
+      "base64"
+    ),
+    is_owner: Boolean(row.is_owner),
+    owner_username: row.owner_username,
+  };
+
+  // Add shared access data if this is a shared file
+  if (!row.is_owner && row.encrypted_fek) {
+    baseFile.shared_access = {
+      encrypted_fek: Buffer.from(row.encrypted_fek).toString("base64"),
+      encrypted_fek_nonce: Buffer.from(row.encrypted_fek_nonce).toString(
+        "base64"
+      ),
+      encrypted_mek: Buffer.from(row.encrypted_mek).toString("base64"),
+      encrypted_mek_nonce: Buffer.from(row.encrypted_mek_nonce).toString(
+        "base64"
+      ),
+      ephemeral_public_key: Buffer.from(row.ephemeral_public_key).toString(
+        "base64"
+      ),
+      file_content_nonce: Buffer.from(row.file_content_nonce).toString(
+        "base64"
+      ),
+      metadata_nonce: Buffer.from(row.metadata_nonce).toString("base64"),
+    };
+  }
+
+  return baseFile;
+}